@@ -11,6 +11,7 @@
 #define RESET   "\x1B[0m"
 
 #define PAGESIZE sysconf(_SC_PAGESIZE)
+#define CACHE_LINE_SIZE 64
 #define DEF_LEVELS_NUMBER 4
 
 #define wait_user() scanf("%*c", 1, NULL)
@@ -23,6 +24,13 @@ typedef void* (*InitFunc)(Allocator*, ...);
 typedef void* (*DestructorFunc)(Allocator*, ...);
 typedef void* (*MallocFunc)(Allocator*, ...);  
 typedef void* (*FreeFunc)(Allocator*, ...);       
+// Batch entry points are typed: one indirect call for the whole batch, no va_list
+typedef int (*MallocBatchFunc)(Allocator*, size_t n, const size_t* sizes, void** out);
+typedef int (*FreeBatchFunc)(Allocator*, size_t n, void** ptrs);
+typedef void* (*ReallocFunc)(Allocator*, void* ptr, size_t size);
+typedef size_t (*UsableSizeFunc)(Allocator*, void* ptr);
+typedef void* (*MemalignFunc)(Allocator*, size_t alignment, size_t size);
+typedef void* (*CallocFunc)(Allocator*, size_t nmemb, size_t size);
 
 // Allocator structure
 struct Allocator {
@@ -30,4 +38,29 @@ struct Allocator {
     DestructorFunc dest;
     MallocFunc malloc;
     FreeFunc free; 
+    MallocBatchFunc malloc_batch; // NULL: Allocator_malloc_batch falls back to malloc
+    FreeBatchFunc free_batch; // NULL: Allocator_free_batch falls back to free
+    ReallocFunc realloc; // NULL: Allocator_realloc falls back to malloc, copy and free
+    UsableSizeFunc usable_size; // NULL: the allocator cannot tell the size of a block
+    MemalignFunc memalign; // NULL: Allocator_memalign fails for any alignment
+    CallocFunc calloc; // NULL: Allocator_calloc falls back to malloc and memset
 };
+
+// Allocate n blocks into out[] (sizes is NULL for fixed size allocators).
+// Returns how many were allocated, the failed entries of out[] are NULL
+int Allocator_malloc_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out);
+// Release n blocks (ptrs may be reordered and rejected entries set to NULL).
+// Returns how many were released
+int Allocator_free_batch(Allocator* alloc, size_t n, void** ptrs);
+// Resize the block at ptr to size bytes, keeping its contents (ptr NULL: malloc,
+// size 0: free). Returns the new block, or NULL with ptr untouched on failure
+void* Allocator_realloc(Allocator* alloc, void* ptr, size_t size);
+// Bytes usable at ptr, at least the requested size. 0 if unknown
+size_t Allocator_usable_size(Allocator* alloc, void* ptr);
+// Allocate size bytes at an address multiple of alignment (a power of two).
+// The block is released with free like any other
+void* Allocator_memalign(Allocator* alloc, size_t alignment, size_t size);
+// Allocate nmemb * size zeroed bytes, NULL if the product overflows
+void* Allocator_calloc(Allocator* alloc, size_t nmemb, size_t size);
+// Sort ptrs by address, for batch frees that coalesce neighbours
+void Allocator_sort_addresses(void** ptrs, size_t n);
@@ -1,6 +1,7 @@
 #pragma once
 #include <variable_block_allocator.h>
 #include <data_structures/bitmap.h>
+#include <helpers/huge_pages.h>
 #include <math.h>
 
 #include <stdio.h>
@@ -9,6 +10,8 @@
 #include <sys/mman.h>
 
 #define BITMAP_BUDDY_MAX_LEVELS 32
+#define BITMAP_BUDDY_DEFAULT_DECAY_MS 10000 // Free pages stay resident at least this long before going back to the kernel
+#define BITMAP_BUDDY_DECAY_TICKS 256 // Releases between two decay checks when no block of a page or more is freed
 
 #define RELEASED 0
 #define RESERVED 1
@@ -27,6 +30,22 @@ typedef struct {
     uint num_levels; // Number of levels in the hierarchy
     size_t min_block_size; // Minimum allocation size
     Bitmap bitmap; // Bitmap tracking block status
+    BitmapBuddyMetadata* aligned_meta; // Metadata of each aligned block by minimum block index, they have no header
+    size_t mapping_size; // Buddy memory, bitmap and aligned_meta, one mapping
+    ArenaBacking backing; // Pages behind the mapping
+    char* high_water; // End of the highest block ever handed out, the arena above is still zero
+    char* quick_lists[BITMAP_BUDDY_MAX_LEVELS]; // Released blocks not merged yet, per level, linked after their metadata
+    uint quick_counts[BITMAP_BUDDY_MAX_LEVELS];
+    uint quick_limit; // Blocks per quick list, 0 merges every release at once
+    size_t page_size;
+    int purge_level; // Deepest level whose blocks span a page, -1 if none does: decay works on its nodes
+    Bitmap clean_pages; // Pages purged since their last release: the free bytes in them are zero (in the mapping)
+    Bitmap dirty_old; // Nodes of purge_level released before the last decay pass, purged by the next one if free
+    Bitmap dirty_new; // Nodes of purge_level released since the last decay pass
+    long decay_ms; // Age of dirty free pages before they are purged, 0 purges at once, -1 never
+    double next_decay; // Time of the next decay pass
+    uint decay_ticks; // Releases since the last decay check
+    size_t purged_bytes; // Bytes returned to the kernel so far
 } BitmapBuddyAllocator;
 
 // Core allocator interface
@@ -34,10 +53,17 @@ void* BitmapBuddyAllocator_init(Allocator* alloc, ...);
 void* BitmapBuddyAllocator_cleanup(Allocator* alloc, ...);
 void* BitmapBuddyAllocator_reserve(Allocator* alloc, ...);
 void* BitmapBuddyAllocator_release(Allocator* alloc, ...);
+int BitmapBuddyAllocator_reserve_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out);
+int BitmapBuddyAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs);
+void* BitmapBuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+size_t BitmapBuddyAllocator_block_usable_size(Allocator* alloc, void* ptr);
+void* BitmapBuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* BitmapBuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
 
-// Helper function to create the allocator
-inline BitmapBuddyAllocator* BitmapBuddyAllocator_create(BitmapBuddyAllocator* alloc, size_t memory_size, int num_levels) {
-    if (!BitmapBuddyAllocator_init((Allocator*)alloc, memory_size, num_levels)) {
+// Helper function to create the allocator, on 2 MiB pages when pages is ARENA_PAGES_HUGE and the system has them
+inline BitmapBuddyAllocator* BitmapBuddyAllocator_create_with_pages(BitmapBuddyAllocator* alloc, size_t memory_size,
+                                                                    int num_levels, ArenaPages pages) {
+    if (!BitmapBuddyAllocator_init((Allocator*)alloc, memory_size, num_levels, pages)) {
         #ifdef DEBUG
         printf(RED "Error: Failed to initialize BitmapBuddyAllocator\n" RESET);
         #endif
@@ -46,6 +72,11 @@ inline BitmapBuddyAllocator* BitmapBuddyAllocator_create(BitmapBuddyAllocator* a
     return alloc;
 }
 
+// Helper function to create the allocator
+inline BitmapBuddyAllocator* BitmapBuddyAllocator_create(BitmapBuddyAllocator* alloc, size_t memory_size, int num_levels) {
+    return BitmapBuddyAllocator_create_with_pages(alloc, memory_size, num_levels, ARENA_PAGES_BASE);
+}
+
 inline int BitmapBuddyAllocator_destroy(BitmapBuddyAllocator* alloc) {   
     if (((Allocator*) alloc)->dest((Allocator*)alloc) != NULL) {
         #ifdef DEBUG
@@ -76,6 +107,44 @@ inline int BitmapBuddyAllocator_free(BitmapBuddyAllocator* alloc, void* ptr) {
     return 0;
 }
 
+// Allocate n blocks of sizes[i] bytes, returns how many were allocated
+inline int BitmapBuddyAllocator_malloc_batch(BitmapBuddyAllocator* alloc, size_t n, const size_t* sizes, void** out) {
+    return ((Allocator*) alloc)->malloc_batch((Allocator*)alloc, n, sizes, out);
+}
+// Release n blocks (ptrs is sorted by address), returns how many were released
+inline int BitmapBuddyAllocator_free_batch(BitmapBuddyAllocator* alloc, size_t n, void** ptrs) {
+    return ((Allocator*) alloc)->free_batch((Allocator*)alloc, n, ptrs);
+}
+// Resize the block at ptr, in place when the buddies allow it
+inline void* BitmapBuddyAllocator_realloc(BitmapBuddyAllocator* alloc, void* ptr, size_t size) {
+    return ((Allocator*) alloc)->realloc((Allocator*)alloc, ptr, size);
+}
+// Bytes usable at ptr: the block size minus the metadata
+inline size_t BitmapBuddyAllocator_usable_size(BitmapBuddyAllocator* alloc, void* ptr) {
+    return ((Allocator*) alloc)->usable_size((Allocator*)alloc, ptr);
+}
+// Allocate a block aligned to alignment, released with BitmapBuddyAllocator_free
+inline void* BitmapBuddyAllocator_memalign(BitmapBuddyAllocator* alloc, size_t alignment, size_t size) {
+    return Allocator_memalign((Allocator*)alloc, alignment, size);
+}
+// Allocate nmemb * size zeroed bytes
+inline void* BitmapBuddyAllocator_calloc(BitmapBuddyAllocator* alloc, size_t nmemb, size_t size) {
+    return Allocator_calloc((Allocator*)alloc, nmemb, size);
+}
+
+// Deferred coalescing: up to max_blocks released blocks per level wait unmerged in a
+// LIFO quick list and serve the next requests of their level. A full list merges its
+// older half, a failed request merges every list. 0 (the default) merges at once
+void BitmapBuddyAllocator_set_quick_lists(BitmapBuddyAllocator* alloc, uint max_blocks);
+// Merge the blocks of every quick list, returns how many there were
+int BitmapBuddyAllocator_flush_quick_lists(BitmapBuddyAllocator* alloc);
+
+// Purging: free pages go back to the kernel with MADV_DONTNEED once they have been
+// dirty for one to two decay_ms periods (BITMAP_BUDDY_DEFAULT_DECAY_MS)
+void BitmapBuddyAllocator_set_decay(BitmapBuddyAllocator* alloc, long decay_ms);
+// Purge every dirty free page now, whatever its age. Returns the bytes purged
+size_t BitmapBuddyAllocator_purge(BitmapBuddyAllocator* alloc);
+
 // Debug/Info functions
 int BitmapBuddyAllocator_print_state(BitmapBuddyAllocator* alloc);
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <variable_block_allocator.h>
 #include <slab_allocator.h>
+#include <data_structures/bitmap.h>
 #include <assert.h>
 
 #include <math.h>
@@ -10,6 +11,8 @@
 
 #define BUDDY_MAX_LEVELS 32
 #define BUDDY_METADATA_SIZE sizeof(BuddyNode*)
+#define BUDDY_DEFAULT_DECAY_MS 10000 // Free pages stay resident this long before going back to the kernel
+#define BUDDY_DECAY_TICKS 256 // Releases between two decay checks when no large block is released
 
 typedef struct BuddyNode {
     Node node;
@@ -18,8 +21,10 @@ typedef struct BuddyNode {
     size_t requested_size; // Requested size (for logging)
     uint level; // Level in the buddy system
     bool is_free; // Whether this block is free
+    bool in_quick_list; // Released but not merged yet: is_free stays false so its buddy cannot merge with it
     struct BuddyNode* buddy; // Pointer to buddy block
     struct BuddyNode* parent; // Pointer to parent block
+    double dirty_since; // Free block: when its oldest dirty page was released, 0 if it is all clean
 } BuddyNode;
 
 struct Buddies {
@@ -37,6 +42,22 @@ typedef struct BuddyAllocator {
     SlabAllocator list_allocator;
     SlabAllocator node_allocator;
     DoubleLinkedList** free_lists;  // Array of free lists for each level (in mmap)
+    uint32_t free_level_mask; // Bit i set when free_lists[i] is not empty
+    uint memory_order; // floor(log2(memory_size))
+    BuddyNode** aligned_nodes; // Node of each aligned block by minimum block index, they have no header
+    size_t mapping_size; // Arena, free lists and aligned_nodes, one mapping
+    ArenaBacking backing; // Pages behind the mapping
+    char* high_water; // End of the highest block ever handed out, the arena above is still zero
+    size_t page_size;
+    Bitmap clean_pages; // Pages purged since their last release: the free bytes in them are zero (in the mapping)
+    long decay_ms; // Age of dirty free pages before they are purged, 0 purges at once, -1 never
+    double next_decay; // Time of the next decay pass
+    double clock; // Last time read, small releases are stamped with it
+    uint decay_ticks; // Releases since the last decay check
+    size_t purged_bytes; // Bytes returned to the kernel so far
+    Node* quick_lists[BUDDY_MAX_LEVELS]; // Released blocks not merged yet, per level, linked through their list node
+    uint quick_counts[BUDDY_MAX_LEVELS];
+    uint quick_limit; // Blocks per quick list, 0 merges every release at once
 } BuddyAllocator;
 
 // Core allocator interface
@@ -44,15 +65,35 @@ void* BuddyAllocator_init(Allocator* alloc, ...);
 void* BuddyAllocator_cleanup(Allocator* alloc, ...);
 void* BuddyAllocator_reserve(Allocator* alloc, ...);
 void* BuddyAllocator_release(Allocator* alloc, ...);
+int BuddyAllocator_reserve_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out);
+int BuddyAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs);
+void* BuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+size_t BuddyAllocator_block_usable_size(Allocator* alloc, void* ptr);
+void* BuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* BuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
+
+// Purging: the pages of free blocks of at least a page are returned to the kernel
+// with MADV_DONTNEED once they have been free for decay_ms (BUDDY_DEFAULT_DECAY_MS)
+void BuddyAllocator_set_decay(BuddyAllocator* a, long decay_ms);
+// Purge every dirty free block now, whatever its age. Returns the bytes purged
+size_t BuddyAllocator_purge(BuddyAllocator* a);
+
+// Deferred coalescing: up to max_blocks released blocks per level wait unmerged in a
+// LIFO quick list and serve the next requests of their level. A full list merges its
+// older half, a request no free block can serve merges every list. 0 (the default)
+// merges at once. Batch releases always merge
+void BuddyAllocator_set_quick_lists(BuddyAllocator* a, uint max_blocks);
+// Merge the blocks of every quick list, returns how many there were
+int BuddyAllocator_flush_quick_lists(BuddyAllocator* a);
 
 // Debug methods
 int BuddyAllocator_print_state(BuddyAllocator* a);
 
 // Callable methods
 
-// Create a new BuddyAllocator
-inline BuddyAllocator* BuddyAllocator_create(BuddyAllocator* a, size_t memory_size, int num_levels) {       
-    if (!BuddyAllocator_init((Allocator*)a, memory_size, num_levels)) {
+// Create a new BuddyAllocator, arena and nodes on 2 MiB pages when pages is ARENA_PAGES_HUGE and the system has them
+inline BuddyAllocator* BuddyAllocator_create_with_pages(BuddyAllocator* a, size_t memory_size, int num_levels, ArenaPages pages) {
+    if (!BuddyAllocator_init((Allocator*)a, memory_size, num_levels, pages)) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to initialize BuddyAllocator!\n" RESET);
         #endif
@@ -61,6 +102,11 @@ inline BuddyAllocator* BuddyAllocator_create(BuddyAllocator* a, size_t memory_si
     return a;
 }
 
+// Create a new BuddyAllocator
+inline BuddyAllocator* BuddyAllocator_create(BuddyAllocator* a, size_t memory_size, int num_levels) {       
+    return BuddyAllocator_create_with_pages(a, memory_size, num_levels, ARENA_PAGES_BASE);
+}
+
 // Destroy BuddyAllocator
 inline int BuddyAllocator_destroy(BuddyAllocator* a) {
     if (((Allocator*)a)->dest((Allocator*)a) != 0) {
@@ -96,5 +142,32 @@ inline int BuddyAllocator_free(BuddyAllocator* a, void* ptr) {
     return 0;
 }
 
+// Allocate n blocks of sizes[i] bytes, returns how many were allocated
+inline int BuddyAllocator_malloc_batch(BuddyAllocator* a, size_t n, const size_t* sizes, void** out) {
+    return ((Allocator*)a)->malloc_batch((Allocator*)a, n, sizes, out);
+}
 
+// Release n blocks (ptrs is sorted by address), returns how many were released
+inline int BuddyAllocator_free_batch(BuddyAllocator* a, size_t n, void** ptrs) {
+    return ((Allocator*)a)->free_batch((Allocator*)a, n, ptrs);
+}
+
+// Resize the block at ptr, in place when the buddies allow it
+inline void* BuddyAllocator_realloc(BuddyAllocator* a, void* ptr, size_t size) {
+    return ((Allocator*)a)->realloc((Allocator*)a, ptr, size);
+}
+
+// Bytes usable at ptr: the block size minus the header
+inline size_t BuddyAllocator_usable_size(BuddyAllocator* a, void* ptr) {
+    return ((Allocator*)a)->usable_size((Allocator*)a, ptr);
+}
+
+// Allocate a block aligned to alignment, released with BuddyAllocator_free
+inline void* BuddyAllocator_memalign(BuddyAllocator* a, size_t alignment, size_t size) {
+    return Allocator_memalign((Allocator*)a, alignment, size);
+}
 
+// Allocate nmemb * size zeroed bytes
+inline void* BuddyAllocator_calloc(BuddyAllocator* a, size_t nmemb, size_t size) {
+    return Allocator_calloc((Allocator*)a, nmemb, size);
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <variable_block_allocator.h>
+#include <buddy_allocator.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define CONCURRENT_BUDDY_MAX_SUBTREES 16
+
+// A top-level subtree: a BuddyAllocator of its own, on its own cache lines
+typedef struct {
+    pthread_mutex_t lock; // Protects buddy
+    BuddyAllocator buddy;
+} __attribute__((aligned(64))) ConcurrentBuddySubtree;
+
+// Thread-safe BuddyAllocator: the arena is split into num_subtrees top-level
+// subtrees, each behind its own lock. Every thread has a home subtree, so
+// threads working in different subtrees do not serialize on each other.
+// A request the home subtree cannot serve tries the others; a release locks
+// the subtree holding the block. The largest block is a whole subtree
+typedef struct ConcurrentBuddyAllocator {
+    VariableBlockAllocator base; // Counters refreshed by ConcurrentBuddyAllocator_update_stats
+    ConcurrentBuddySubtree subtrees[CONCURRENT_BUDDY_MAX_SUBTREES];
+    char* subtree_start[CONCURRENT_BUDDY_MAX_SUBTREES]; // Arena of each subtree, to find it from a pointer
+    uint num_subtrees; // A power of two
+    size_t subtree_size;
+    size_t memory_size;
+} ConcurrentBuddyAllocator;
+
+// Core allocator interface
+void* ConcurrentBuddyAllocator_init(Allocator* alloc, ...);
+void* ConcurrentBuddyAllocator_cleanup(Allocator* alloc, ...);
+void* ConcurrentBuddyAllocator_reserve(Allocator* alloc, ...);
+void* ConcurrentBuddyAllocator_release(Allocator* alloc, ...);
+void* ConcurrentBuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+size_t ConcurrentBuddyAllocator_block_usable_size(Allocator* alloc, void* ptr);
+void* ConcurrentBuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* ConcurrentBuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
+
+// Sum the counters of the subtrees into base (locks each subtree in turn)
+void ConcurrentBuddyAllocator_update_stats(ConcurrentBuddyAllocator* a);
+
+// Debug methods
+int ConcurrentBuddyAllocator_print_state(ConcurrentBuddyAllocator* a);
+
+// Callable methods
+
+// Create a new ConcurrentBuddyAllocator: memory_size and num_levels as for a BuddyAllocator,
+// num_subtrees (a power of two up to CONCURRENT_BUDDY_MAX_SUBTREES) independent top-level subtrees
+inline ConcurrentBuddyAllocator* ConcurrentBuddyAllocator_create(ConcurrentBuddyAllocator* a, size_t memory_size,
+                                                                 int num_levels, int num_subtrees) {
+    if (!ConcurrentBuddyAllocator_init((Allocator*)a, memory_size, num_levels, num_subtrees)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize ConcurrentBuddyAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy ConcurrentBuddyAllocator (no thread may use it afterwards)
+inline int ConcurrentBuddyAllocator_destroy(ConcurrentBuddyAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy concurrent buddy allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from ConcurrentBuddyAllocator
+inline void* ConcurrentBuddyAllocator_malloc(ConcurrentBuddyAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to ConcurrentBuddyAllocator
+inline int ConcurrentBuddyAllocator_free(ConcurrentBuddyAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Resize a block, in place when its subtree allows it
+inline void* ConcurrentBuddyAllocator_realloc(ConcurrentBuddyAllocator* a, void* ptr, size_t size) {
+    return ((Allocator*)a)->realloc((Allocator*)a, ptr, size);
+}
+
+// Usable bytes of a block
+inline size_t ConcurrentBuddyAllocator_usable_size(ConcurrentBuddyAllocator* a, void* ptr) {
+    return ((Allocator*)a)->usable_size((Allocator*)a, ptr);
+}
+
+// Allocate a block aligned to alignment, released with ConcurrentBuddyAllocator_free
+inline void* ConcurrentBuddyAllocator_memalign(ConcurrentBuddyAllocator* a, size_t alignment, size_t size) {
+    return Allocator_memalign((Allocator*)a, alignment, size);
+}
+
+// Allocate nmemb * size zeroed bytes
+inline void* ConcurrentBuddyAllocator_calloc(ConcurrentBuddyAllocator* a, size_t nmemb, size_t size) {
+    return Allocator_calloc((Allocator*)a, nmemb, size);
+}
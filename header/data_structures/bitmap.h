@@ -17,4 +17,6 @@ void bitmap_clear(Bitmap *bitmap, int index);
 bool bitmap_test(Bitmap *bitmap, int index);
 int bitmap_find_first_set(Bitmap *bitmap);
 int bitmap_find_first_zero(Bitmap *bitmap);
+int bitmap_find_zero_from(Bitmap *bitmap, int start);
+int bitmap_find_zero_in_range(Bitmap *bitmap, int start, int end);
 int bitmap_print(Bitmap *bitmap);
\ No newline at end of file
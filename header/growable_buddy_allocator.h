@@ -0,0 +1,109 @@
+#pragma once
+#include <variable_block_allocator.h>
+#include <bitmap_buddy_allocator.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define GROWABLE_BUDDY_MAX_SUPERBLOCKS 32
+
+// A root superblock: a BitmapBuddyAllocator of its own, and a summary of it
+// so that superblocks can be chosen without searching them
+typedef struct {
+    BitmapBuddyAllocator buddy;
+    size_t max_free; // Upper bound on its largest free block: lowered when a request fails, reset by releases
+} GrowableSuperblock;
+
+// BitmapBuddyAllocator that grows: it starts with one superblock of superblock_size
+// bytes and maps another one, of the same size, when none of the mapped ones can
+// serve a request. Requests go to the fullest superblock that may hold them, so
+// the emptier ones can drain. A superblock left empty is unmapped, except one,
+// kept as a spare so that a heap at the edge of a superblock does not map and
+// unmap at every request. The largest block is a whole superblock
+typedef struct GrowableBuddyAllocator {
+    VariableBlockAllocator base; // Counters of the mapped superblocks
+    GrowableSuperblock superblocks[GROWABLE_BUDDY_MAX_SUPERBLOCKS]; // The first num_superblocks are mapped
+    uint num_superblocks;
+    uint max_superblocks;
+    size_t superblock_size;
+    int num_levels; // Of each superblock
+    size_t grown; // Superblocks mapped after the first one
+    size_t shrunk; // Superblocks unmapped because they were empty
+} GrowableBuddyAllocator;
+
+// Core allocator interface
+void* GrowableBuddyAllocator_init(Allocator* alloc, ...);
+void* GrowableBuddyAllocator_cleanup(Allocator* alloc, ...);
+void* GrowableBuddyAllocator_reserve(Allocator* alloc, ...);
+void* GrowableBuddyAllocator_release(Allocator* alloc, ...);
+void* GrowableBuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+size_t GrowableBuddyAllocator_block_usable_size(Allocator* alloc, void* ptr);
+void* GrowableBuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* GrowableBuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
+
+// Debug methods
+int GrowableBuddyAllocator_print_state(GrowableBuddyAllocator* a);
+
+// Callable methods
+
+// Create a new GrowableBuddyAllocator: superblocks of superblock_size bytes and num_levels
+// levels as for a BitmapBuddyAllocator, up to max_superblocks (GROWABLE_BUDDY_MAX_SUPERBLOCKS) of them
+inline GrowableBuddyAllocator* GrowableBuddyAllocator_create(GrowableBuddyAllocator* a, size_t superblock_size,
+                                                             int num_levels, int max_superblocks) {
+    if (!GrowableBuddyAllocator_init((Allocator*)a, superblock_size, num_levels, max_superblocks)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize GrowableBuddyAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy GrowableBuddyAllocator
+inline int GrowableBuddyAllocator_destroy(GrowableBuddyAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy growable buddy allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from GrowableBuddyAllocator
+inline void* GrowableBuddyAllocator_malloc(GrowableBuddyAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to GrowableBuddyAllocator
+inline int GrowableBuddyAllocator_free(GrowableBuddyAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Resize a block, in place when its superblock allows it
+inline void* GrowableBuddyAllocator_realloc(GrowableBuddyAllocator* a, void* ptr, size_t size) {
+    return ((Allocator*)a)->realloc((Allocator*)a, ptr, size);
+}
+
+// Usable bytes of a block
+inline size_t GrowableBuddyAllocator_usable_size(GrowableBuddyAllocator* a, void* ptr) {
+    return ((Allocator*)a)->usable_size((Allocator*)a, ptr);
+}
+
+// Allocate a block aligned to alignment, released with GrowableBuddyAllocator_free
+inline void* GrowableBuddyAllocator_memalign(GrowableBuddyAllocator* a, size_t alignment, size_t size) {
+    return Allocator_memalign((Allocator*)a, alignment, size);
+}
+
+// Allocate nmemb * size zeroed bytes
+inline void* GrowableBuddyAllocator_calloc(GrowableBuddyAllocator* a, size_t nmemb, size_t size) {
+    return Allocator_calloc((Allocator*)a, nmemb, size);
+}
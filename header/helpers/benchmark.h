@@ -13,6 +13,11 @@
 #include <slab_allocator.h>
 #include <buddy_allocator.h>
 #include <bitmap_buddy_allocator.h>
+#include <size_class_allocator.h>
+#include <implicit_buddy_allocator.h>
+#include <tree_buddy_allocator.h>
+#include <pseudo_allocator.h>
+#include <tlsf_allocator.h>
 
 #include <helpers/parse.h>
 
@@ -25,6 +30,11 @@ union GeneralAllocator {
   SlabAllocator slab;
   BuddyAllocator buddy;
   BitmapBuddyAllocator bitmap;
+  SizeClassAllocator size_class;
+  ImplicitBuddyAllocator implicit;
+  TreeBuddyAllocator tree;
+  PseudoAllocator pseudo;
+  TlsfAllocator tlsf;
 };
 
 int benchmark();
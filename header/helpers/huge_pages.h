@@ -0,0 +1,30 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+// Pages asked for an arena
+typedef enum {
+    ARENA_PAGES_BASE, // Base pages
+    ARENA_PAGES_HUGE, // 2 MiB pages when the system has them, base pages otherwise
+} ArenaPages;
+
+// Pages an arena got
+typedef enum {
+    ARENA_BACKING_BASE,
+    ARENA_BACKING_THP, // 2 MiB aligned mapping with MADV_HUGEPAGE: transparent huge pages as they are faulted in
+    ARENA_BACKING_HUGETLB, // MAP_HUGETLB from the hugetlbfs pool, reserved at mmap
+} ArenaBacking;
+
+// Map size bytes of zeroed private anonymous memory. With ARENA_PAGES_HUGE (and
+// at least HUGE_PAGE_SIZE bytes) the hugetlbfs pool is tried first, then transparent
+// huge pages, then base pages. Returns NULL if nothing can be mapped
+void* map_arena(size_t size, ArenaPages pages, ArenaBacking* backing);
+// Unmap a map_arena mapping of size bytes
+int unmap_arena(void* ptr, size_t size, ArenaBacking backing);
+const char* arena_backing_name(ArenaBacking backing);
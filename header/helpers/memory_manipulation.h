@@ -2,7 +2,15 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define ZERO_MADVISE_MIN (1024 * 1024) // Refaulting a page costs several memsets of it: only ranges this large, often used sparsely
 
 void fill_memory_pattern(void* ptr, size_t size, unsigned char pattern);
 int verify_memory_pattern(void* ptr, size_t size, unsigned char pattern);
-int print_memory_pattern(void* ptr, size_t size);
\ No newline at end of file
+int print_memory_pattern(void* ptr, size_t size);
+// Zero size bytes at ptr. The whole pages of large ranges are dropped with
+// MADV_DONTNEED instead, only valid inside private anonymous mappings
+void zero_memory(void* ptr, size_t size);
@@ -11,6 +11,11 @@ enum AllocatorType {
   SLAB_ALLOCATOR,
   BUDDY_ALLOCATOR,
   BITMAP_BUDDY_ALLOCATOR,
+  SIZE_CLASS_ALLOCATOR,
+  IMPLICIT_BUDDY_ALLOCATOR,
+  TREE_BUDDY_ALLOCATOR,
+  PSEUDO_ALLOCATOR,
+  TLSF_ALLOCATOR,
 };
 
 enum RequestType {
@@ -36,6 +41,12 @@ union AllocatorParameterData {
     size_t memory_size;
     size_t max_levels;
   } buddy;
+  struct {
+    size_t memory_size;
+  } size_class;
+  struct {
+    size_t memory_size;
+  } tlsf;
 };
 
 struct RequestResult {
@@ -0,0 +1,9 @@
+#pragma once
+#include <time.h>
+
+// Monotonic wall clock in seconds
+static inline double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <variable_block_allocator.h>
+#include <assert.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define IMPLICIT_BUDDY_MAX_LEVELS 32
+#define IMPLICIT_BUDDY_NIL UINT32_MAX // End of a free list
+#define IMPLICIT_BUDDY_ORDER_MASK 0x3F // Low bits of a state byte: block order
+#define IMPLICIT_BUDDY_ALLOCATED 0x40 // State byte of the first minimum block of an allocated block
+#define IMPLICIT_BUDDY_FREE 0x80 // State byte of the first minimum block of a free block
+
+// Links of a free block, stored in the block itself
+typedef struct {
+    uint32_t next;
+    uint32_t prev;
+} ImplicitBuddyLinks;
+
+// Buddy allocator without per-block objects or headers. A block of order k
+// spans 2^k minimum blocks and starts at a minimum block index that is a
+// multiple of 2^k, so its buddy is at index ^ (1 << k)
+typedef struct {
+    VariableBlockAllocator base;
+    char* memory_start; // Start of the arena (page aligned)
+    size_t memory_size; // Usable arena size: min_block_size << (num_levels - 1)
+    size_t min_block_size; // Power of two
+    uint min_block_shift; // log2(min_block_size)
+    uint num_levels; // Number of levels in the system, the root has order num_levels - 1
+    uint32_t num_blocks; // Number of minimum blocks
+    uint8_t* state; // One byte per minimum block, only set on the first block of each block
+    uint32_t* requested_size; // Requested size, indexed like state
+    uint32_t free_heads[IMPLICIT_BUDDY_MAX_LEVELS]; // Free list heads by order
+    uint32_t free_order_mask; // Bit k set when the free list of order k is not empty
+    size_t mapping_size; // Arena plus side arrays, one mapping
+    size_t metadata_size; // Bytes spent on the side arrays
+} ImplicitBuddyAllocator;
+
+// Core allocator interface
+void* ImplicitBuddyAllocator_init(Allocator* alloc, ...);
+void* ImplicitBuddyAllocator_cleanup(Allocator* alloc, ...);
+void* ImplicitBuddyAllocator_reserve(Allocator* alloc, ...);
+void* ImplicitBuddyAllocator_release(Allocator* alloc, ...);
+
+// Debug methods
+int ImplicitBuddyAllocator_print_state(ImplicitBuddyAllocator* a);
+
+// Callable methods
+
+// Create a new ImplicitBuddyAllocator, num_levels counts the splits below the root like BuddyAllocator
+inline ImplicitBuddyAllocator* ImplicitBuddyAllocator_create(ImplicitBuddyAllocator* a, size_t memory_size, int num_levels) {
+    if (!ImplicitBuddyAllocator_init((Allocator*)a, memory_size, num_levels)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize ImplicitBuddyAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy ImplicitBuddyAllocator
+inline int ImplicitBuddyAllocator_destroy(ImplicitBuddyAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy implicit buddy allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from ImplicitBuddyAllocator
+inline void* ImplicitBuddyAllocator_malloc(ImplicitBuddyAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to ImplicitBuddyAllocator
+inline int ImplicitBuddyAllocator_free(ImplicitBuddyAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
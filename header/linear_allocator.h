@@ -0,0 +1,137 @@
+#pragma once
+#include <allocator.h>
+#include <helpers/huge_pages.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define LINEAR_ALIGNMENT 16 // Of every block, as malloc
+#define LINEAR_SCRATCH_CHUNK_SIZE ((size_t)256 << 10) // Chunks of the thread-local scratch arenas
+
+// Header at the start of every chunk, the blocks follow it
+typedef struct LinearChunk {
+    struct LinearChunk* prev; // Older chunk
+    size_t size; // Of the mapping, header included
+    char* top; // End of the blocks, kept when a newer chunk takes over
+    char* clean; // From here on the chunk was never handed out, so it is still zeroed
+    ArenaBacking backing;
+} LinearChunk;
+
+#define LINEAR_HEADER_SIZE ((sizeof(LinearChunk) + LINEAR_ALIGNMENT - 1) & ~(size_t)(LINEAR_ALIGNMENT - 1))
+
+// Forward declaration
+typedef struct LinearAllocator LinearAllocator;
+
+// A point of a LinearAllocator to rewind to: everything allocated after it is released at once
+typedef struct {
+    LinearAllocator* allocator;
+    LinearChunk* chunk;
+    char* top;
+} LinearMark;
+
+// LinearAllocator structure (extends Allocator). Blocks are bumped out of mmap'd chunks
+// with no metadata of their own: they are released together by LinearAllocator_reset_to
+// (or LinearAllocator_reset), free only gives back the last block
+struct LinearAllocator {
+    Allocator base;
+    LinearChunk* current; // Newest chunk, the older ones through prev
+    char* top; // Next free byte of current
+    char* end; // End of current
+    char* last; // Last block, the only one that can be released or resized in place
+    LinearChunk* spare; // Chunk of chunk_size dropped by a reset, kept for the next one
+    size_t chunk_size;
+    size_t mapped; // Bytes of the chunks, spare included
+};
+
+// Core allocator interface
+void* LinearAllocator_init(Allocator* alloc, ...);
+void* LinearAllocator_cleanup(Allocator* alloc, ...);
+void* LinearAllocator_reserve(Allocator* alloc, ...);
+void* LinearAllocator_release(Allocator* alloc, ...);
+void* LinearAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+void* LinearAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* LinearAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
+
+// Checkpoints
+LinearMark LinearAllocator_mark(LinearAllocator* a);
+// Release every block allocated after mark. -1 if the mark is not of this allocator
+// or was already released by an earlier reset
+int LinearAllocator_reset_to(LinearAllocator* a, LinearMark mark);
+// Release every block
+int LinearAllocator_reset(LinearAllocator* a);
+
+// Scratch arena of the calling thread, created at the first use and destroyed when the thread exits
+LinearAllocator* LinearAllocator_scratch(void);
+
+// Debug methods
+int LinearAllocator_print_state(LinearAllocator* a);
+
+// Callable methods
+
+// Create a new LinearAllocator with chunks of chunk_size bytes (rounded up to the page size).
+// Larger blocks get a chunk of their own
+inline LinearAllocator* LinearAllocator_create(LinearAllocator* a, size_t chunk_size) {
+    if (!LinearAllocator_init((Allocator*)a, chunk_size)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize LinearAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy LinearAllocator
+inline int LinearAllocator_destroy(LinearAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy linear allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from LinearAllocator
+inline void* LinearAllocator_malloc(LinearAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release a block: the last one is given back, the others stay until a reset
+inline int LinearAllocator_free(LinearAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Resize a block, in place when it is the last one
+inline void* LinearAllocator_realloc(LinearAllocator* a, void* ptr, size_t size) {
+    return ((Allocator*)a)->realloc((Allocator*)a, ptr, size);
+}
+
+// Allocate a block aligned to alignment
+inline void* LinearAllocator_memalign(LinearAllocator* a, size_t alignment, size_t size) {
+    return Allocator_memalign((Allocator*)a, alignment, size);
+}
+
+// Allocate nmemb * size zeroed bytes
+inline void* LinearAllocator_calloc(LinearAllocator* a, size_t nmemb, size_t size) {
+    return Allocator_calloc((Allocator*)a, nmemb, size);
+}
+
+static inline void LinearAllocator_scope_exit(LinearMark* mark) {
+    LinearAllocator_reset_to(mark->allocator, *mark);
+}
+
+// Mark of the thread's scratch arena, rewound when the scope of name ends:
+//     LINEAR_SCRATCH_SCOPE(scope);
+//     char* buffer = LinearAllocator_malloc(scope.allocator, size);
+#define LINEAR_SCRATCH_SCOPE(name) \
+    LinearMark name __attribute__((cleanup(LinearAllocator_scope_exit))) = LinearAllocator_mark(LinearAllocator_scratch())
@@ -0,0 +1,91 @@
+#pragma once
+#include <allocator.h>
+#include <slab_allocator.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define MAGAZINE_SIZE 32 // Object pointers (rounds) per magazine
+#define MAGAZINE_MAX_THREADS 64 // Threads with a private cache, others use the depot directly
+
+// Forward declaration
+typedef struct MagazineAllocator MagazineAllocator;
+
+// LIFO stack of object pointers
+typedef struct Magazine {
+    struct Magazine* next; // Link in the depot's full or empty stack
+    uint rounds;
+    void* round[MAGAZINE_SIZE];
+} Magazine;
+
+// Per-thread state, reached through pthread_getspecific
+typedef struct {
+    MagazineAllocator* owner;
+    Magazine* loaded;
+    Magazine* previous;
+} MagazineThreadCache;
+
+// MagazineAllocator structure (extends Allocator)
+// Thread-safe front end for a SlabAllocator: the common path only touches
+// the calling thread's magazines, the depot lock is taken to swap magazines
+struct MagazineAllocator {
+    Allocator base;
+    SlabAllocator slab; // Backing objects
+    SlabAllocator magazine_pool; // Storage for Magazine structs
+    SlabAllocator cache_pool; // Storage for MagazineThreadCache structs
+    pthread_key_t key; // Per-thread MagazineThreadCache
+    pthread_mutex_t depot_lock; // Protects everything below and the three slabs
+    uint64_t* in_use; // One bit per object, set while it is out of the depot and the slab: catches double frees
+    size_t in_use_size; // Bytes mapped for in_use
+    Magazine* full; // Depot stack of full magazines
+    Magazine* empty; // Depot stack of empty magazines
+    uint num_full;
+    uint num_empty;
+};
+
+// Core allocator interface
+void *MagazineAllocator_init(Allocator* alloc, ...);
+void *MagazineAllocator_cleanup(Allocator* alloc, ...);
+void *MagazineAllocator_reserve(Allocator* alloc, ...);
+void *MagazineAllocator_release(Allocator* alloc, ...);
+int MagazineAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs);
+
+// Return the calling thread's magazines to the depot
+// (done automatically at thread exit)
+void MagazineAllocator_thread_flush(MagazineAllocator* a);
+
+// Debug methods
+void MagazineAllocator_print_state(MagazineAllocator* a);
+
+// Callable methods
+
+// Create a new MagazineAllocator over num_objects objects of object_size bytes
+inline MagazineAllocator* MagazineAllocator_create(MagazineAllocator* a, size_t object_size, size_t num_objects) {
+    if (!MagazineAllocator_init((Allocator*)a, object_size, num_objects)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize MagazineAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+// Destroy a MagazineAllocator (no thread may use it afterwards)
+inline int MagazineAllocator_destroy(MagazineAllocator* a) {
+    void* result = ((Allocator*)a)->dest((Allocator*)a);
+    if (!result) return -1;
+    return 0;
+}
+// Allocate an object
+inline void* MagazineAllocator_malloc(MagazineAllocator* a) {
+    return ((Allocator*)a)->malloc((Allocator*)a);
+}
+// Free an object
+inline int MagazineAllocator_free(MagazineAllocator* a, void* ptr) {
+    void* r = ((Allocator*)a)->free((Allocator*)a, ptr);
+    if (r == NULL)
+        return -1;
+    return 0;
+}
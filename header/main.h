@@ -15,10 +15,32 @@
 // #include <test/test_allocator.h>
 #include <slab_allocator.h>
 #include <test/test_slab_allocator.h>
+#include <slab_cache.h>
+#include <test/test_slab_cache.h>
+#include <magazine_allocator.h>
+#include <test/test_magazine_allocator.h>
+#include <size_class_allocator.h>
+#include <test/test_size_class_allocator.h>
 #include <buddy_allocator.h>
 #include <test/test_buddy_allocator.h>
 #include <bitmap_buddy_allocator.h>
 #include <test/test_bitmap_buddy_allocator.h>
+#include <implicit_buddy_allocator.h>
+#include <test/test_implicit_buddy_allocator.h>
+#include <tree_buddy_allocator.h>
+#include <test/test_tree_buddy_allocator.h>
+#include <pseudo_allocator.h>
+#include <test/test_pseudo_allocator.h>
+#include <concurrent_buddy_allocator.h>
+#include <test/test_concurrent_buddy_allocator.h>
+#include <multi_arena_allocator.h>
+#include <test/test_multi_arena_allocator.h>
+#include <growable_buddy_allocator.h>
+#include <test/test_growable_buddy_allocator.h>
+#include <linear_allocator.h>
+#include <test/test_linear_allocator.h>
+#include <tlsf_allocator.h>
+#include <test/test_tlsf_allocator.h>
 
 #include <helpers/freeform.h>
 #include <helpers/benchmark.h>
\ No newline at end of file
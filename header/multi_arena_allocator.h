@@ -0,0 +1,120 @@
+#pragma once
+#include <variable_block_allocator.h>
+#include <bitmap_buddy_allocator.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define MULTI_ARENA_MAX_ARENAS 16
+
+// An arena: a BitmapBuddyAllocator behind a lock, and the blocks other threads
+// released into it, waiting on a lock-free stack (linked through the blocks themselves)
+typedef struct {
+    pthread_mutex_t lock; // Protects buddy and remote_drained
+    BitmapBuddyAllocator buddy;
+    size_t remote_drained; // Blocks taken off the remote stack and released
+    // Written by the releasing threads: a cache line of their own
+    void* remote_head __attribute__((aligned(64))); // Last block pushed, NULL when empty
+    size_t remote_frees; // Blocks ever pushed
+} __attribute__((aligned(64))) MultiArena;
+
+// Thread-safe front end over num_arenas BitmapBuddyAllocator arenas. Every thread
+// has a home arena (round-robin on its first request) and allocates there; a
+// request the home arena cannot serve tries the others. Releasing a block of
+// the home arena takes its lock, releasing one of another arena only pushes it
+// on that arena's remote stack without any lock: the arena releases the stacked
+// blocks the next time a thread allocates from it, so a pipeline that allocates
+// in one thread and releases in another does not fight over the lock.
+// Remote releases are only checked against the arena bounds
+typedef struct MultiArenaAllocator {
+    VariableBlockAllocator base; // Counters refreshed by MultiArenaAllocator_update_stats
+    MultiArena arenas[MULTI_ARENA_MAX_ARENAS];
+    uint num_arenas;
+    size_t arena_size; // Memory of each arena
+    size_t remote_frees; // Blocks released from outside their home arena, refreshed by update_stats
+    size_t remote_pending; // Of those, blocks still waiting on a remote stack, refreshed by update_stats
+} MultiArenaAllocator;
+
+// Core allocator interface
+void* MultiArenaAllocator_init(Allocator* alloc, ...);
+void* MultiArenaAllocator_cleanup(Allocator* alloc, ...);
+void* MultiArenaAllocator_reserve(Allocator* alloc, ...);
+void* MultiArenaAllocator_release(Allocator* alloc, ...);
+void* MultiArenaAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+size_t MultiArenaAllocator_block_usable_size(Allocator* alloc, void* ptr);
+void* MultiArenaAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* MultiArenaAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
+
+// Release the remote stacks of every arena, e.g. once the threads owning them are gone
+void MultiArenaAllocator_collect(MultiArenaAllocator* a);
+
+// Sum the counters of the arenas into base (locks each arena in turn, stacked blocks count as used)
+void MultiArenaAllocator_update_stats(MultiArenaAllocator* a);
+
+// Debug methods
+int MultiArenaAllocator_print_state(MultiArenaAllocator* a);
+
+// Callable methods
+
+// Create a new MultiArenaAllocator: num_arenas (up to MULTI_ARENA_MAX_ARENAS) arenas,
+// each a BitmapBuddyAllocator of arena_size bytes and num_levels levels
+inline MultiArenaAllocator* MultiArenaAllocator_create(MultiArenaAllocator* a, size_t arena_size,
+                                                       int num_levels, int num_arenas) {
+    if (!MultiArenaAllocator_init((Allocator*)a, arena_size, num_levels, num_arenas)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize MultiArenaAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy MultiArenaAllocator (no thread may use it afterwards)
+inline int MultiArenaAllocator_destroy(MultiArenaAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy multi arena allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from MultiArenaAllocator
+inline void* MultiArenaAllocator_malloc(MultiArenaAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to MultiArenaAllocator, from any thread
+inline int MultiArenaAllocator_free(MultiArenaAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Resize a block, in place when its arena allows it
+inline void* MultiArenaAllocator_realloc(MultiArenaAllocator* a, void* ptr, size_t size) {
+    return ((Allocator*)a)->realloc((Allocator*)a, ptr, size);
+}
+
+// Usable bytes of a block
+inline size_t MultiArenaAllocator_usable_size(MultiArenaAllocator* a, void* ptr) {
+    return ((Allocator*)a)->usable_size((Allocator*)a, ptr);
+}
+
+// Allocate a block aligned to alignment, released with MultiArenaAllocator_free
+inline void* MultiArenaAllocator_memalign(MultiArenaAllocator* a, size_t alignment, size_t size) {
+    return Allocator_memalign((Allocator*)a, alignment, size);
+}
+
+// Allocate nmemb * size zeroed bytes
+inline void* MultiArenaAllocator_calloc(MultiArenaAllocator* a, size_t nmemb, size_t size) {
+    return Allocator_calloc((Allocator*)a, nmemb, size);
+}
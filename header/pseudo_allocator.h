@@ -0,0 +1,128 @@
+#pragma once
+#include <variable_block_allocator.h>
+#include <bitmap_buddy_allocator.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define PSEUDO_BUDDY_MEMORY (1 << 20) // Memory of the small allocator used by pseudo_malloc
+#define PSEUDO_BUDDY_LEVELS 15 // 32B minimum blocks in 1 MiB
+#define PSEUDO_CACHE_BUCKETS 16 // Bucket i: mappings of [2^i, 2^(i+1)) pages
+#define PSEUDO_CACHE_SLOTS 4 // Regions kept per bucket
+#define PSEUDO_CACHE_MAX_BYTES (64 << 20) // Default limit of the cached regions
+#define PSEUDO_ALIGNMENT 16 // Alignment of every block, as malloc's
+
+// Header in front of a large block, 16 bytes so the block keeps malloc's alignment.
+// It is in the first page of the mapping, at its start unless the block is aligned
+typedef struct {
+    size_t mapping_size; // Whole mapping, a multiple of the page size
+    size_t size; // Requested size
+} PseudoMapping;
+
+#define PSEUDO_MAPPING_SIZE sizeof(PseudoMapping)
+
+typedef struct {
+    char* start;
+    size_t size;
+} PseudoRegion;
+
+// Front end of the assignment: requests under a quarter of a page go to a
+// BitmapBuddyAllocator, larger ones (and small ones it cannot serve) get their
+// own mapping. Released mappings are kept in a cache bucketed by size, so that
+// large buffers allocated and released in a loop do not pay mmap and munmap
+typedef struct {
+    VariableBlockAllocator base;
+    BitmapBuddyAllocator small; // Requests below small_limit
+    size_t small_limit; // A quarter of the page size
+    size_t page_size;
+    PseudoRegion cache[PSEUDO_CACHE_BUCKETS][PSEUDO_CACHE_SLOTS]; // Released mappings, start NULL when empty
+    uint8_t cache_victim[PSEUDO_CACHE_BUCKETS]; // Next slot to evict when a bucket is full
+    size_t cached_bytes; // Bytes held in the cache
+    size_t cache_max_bytes; // 0 disables the cache
+    size_t large_fragmentation; // Unused bytes of the live mappings
+    size_t cache_hits;
+    size_t cache_misses;
+} PseudoAllocator;
+
+// Core allocator interface
+void* PseudoAllocator_init(Allocator* alloc, ...);
+void* PseudoAllocator_cleanup(Allocator* alloc, ...);
+void* PseudoAllocator_reserve(Allocator* alloc, ...);
+void* PseudoAllocator_release(Allocator* alloc, ...);
+size_t PseudoAllocator_block_usable_size(Allocator* alloc, void* ptr);
+void* PseudoAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+void* PseudoAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* PseudoAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
+
+// Debug methods
+int PseudoAllocator_print_state(PseudoAllocator* a);
+
+// Process-wide PseudoAllocator with PSEUDO_BUDDY_MEMORY bytes of small memory,
+// created on first use (not thread safe)
+void* pseudo_malloc(size_t size);
+void pseudo_free(void* ptr);
+
+// Callable methods
+
+// Create a new PseudoAllocator, memory_size and num_levels are those of the small BitmapBuddyAllocator
+inline PseudoAllocator* PseudoAllocator_create(PseudoAllocator* a, size_t memory_size, int num_levels) {
+    if (!PseudoAllocator_init((Allocator*)a, memory_size, num_levels)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize PseudoAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy PseudoAllocator, the cached mappings are released too
+inline int PseudoAllocator_destroy(PseudoAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy pseudo allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from PseudoAllocator
+inline void* PseudoAllocator_malloc(PseudoAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to PseudoAllocator
+inline int PseudoAllocator_free(PseudoAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Usable bytes of a block
+inline size_t PseudoAllocator_usable_size(PseudoAllocator* a, void* ptr) {
+    return ((Allocator*)a)->usable_size((Allocator*)a, ptr);
+}
+
+// Resize a block, NULL when it cannot (ptr is still valid then)
+inline void* PseudoAllocator_realloc(PseudoAllocator* a, void* ptr, size_t size) {
+    return ((Allocator*)a)->realloc((Allocator*)a, ptr, size);
+}
+
+// Allocate a block aligned to alignment, released with PseudoAllocator_free
+inline void* PseudoAllocator_memalign(PseudoAllocator* a, size_t alignment, size_t size) {
+    return ((Allocator*)a)->memalign((Allocator*)a, alignment, size);
+}
+
+// Allocate nmemb * size zeroed bytes
+inline void* PseudoAllocator_calloc(PseudoAllocator* a, size_t nmemb, size_t size) {
+    return ((Allocator*)a)->calloc((Allocator*)a, nmemb, size);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <variable_block_allocator.h>
+#include <slab_allocator.h>
+#include <assert.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define SIZE_CLASS_MIN 16
+#define SIZE_CLASS_MAX 2048
+#define SIZE_CLASS_COUNT 47 // 8-byte steps up to 128, then 8 classes per power of two (12.5%)
+#define SIZE_CLASS_LOOKUP_SIZE (SIZE_CLASS_MAX / 8 + 1) // One entry per 8 bytes of request size
+
+typedef struct {
+    VariableBlockAllocator base;
+    size_t memory_size; // Memory budget, split evenly between the classes
+    size_t class_size[SIZE_CLASS_COUNT];
+    SlabAllocator classes[SIZE_CLASS_COUNT]; // One pool per size class
+    uint8_t lookup[SIZE_CLASS_LOOKUP_SIZE]; // (size + 7) / 8 -> class index
+    uint8_t by_address[SIZE_CLASS_COUNT]; // Class indices sorted by pool address, for release
+    uint16_t* requested_size[SIZE_CLASS_COUNT]; // Per-slot requested size (slots have no header)
+    size_t requested_size_bytes; // Size of the mapping behind requested_size
+} SizeClassAllocator;
+
+// Core allocator interface
+void* SizeClassAllocator_init(Allocator* alloc, ...);
+void* SizeClassAllocator_cleanup(Allocator* alloc, ...);
+void* SizeClassAllocator_reserve(Allocator* alloc, ...);
+void* SizeClassAllocator_release(Allocator* alloc, ...);
+
+// Debug methods
+int SizeClassAllocator_print_state(SizeClassAllocator* a);
+
+// Class index serving a request of size bytes (-1 if too large)
+static inline int SizeClassAllocator_class_of(SizeClassAllocator* a, size_t size) {
+    if (size == 0 || size > SIZE_CLASS_MAX) return -1;
+    return a->lookup[(size + 7) >> 3];
+}
+
+// Callable methods
+
+// Create a new SizeClassAllocator
+inline SizeClassAllocator* SizeClassAllocator_create(SizeClassAllocator* a, size_t memory_size) {
+    if (!SizeClassAllocator_init((Allocator*)a, memory_size)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize SizeClassAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy SizeClassAllocator
+inline int SizeClassAllocator_destroy(SizeClassAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy size class allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from SizeClassAllocator
+inline void* SizeClassAllocator_malloc(SizeClassAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to SizeClassAllocator
+inline int SizeClassAllocator_free(SizeClassAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <allocator.h>
 #include <data_structures/double_linked_list.h>
+#include <data_structures/bitmap.h>
+#include <helpers/huge_pages.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -15,6 +17,16 @@ typedef struct {
     bool in_free_list;
 } SlabNode;
 
+// Slab layouts
+typedef enum {
+    SLAB_MODE_LIST,     // SlabNode header in front of every slot, free slots in a DoubleLinkedList
+    SLAB_MODE_EMBEDDED, // No header, free slots linked by a 4-byte slot index stored in the free payload,
+                        // one occupancy bit per slot in front of the slots to catch double frees
+    SLAB_MODE_BITMAP,   // No header, one occupancy bit per slot
+} SlabMode;
+
+#define SLAB_EMBEDDED_NIL UINT32_MAX // End of the embedded free list
+
 // Forward declaration
 typedef struct SlabAllocator SlabAllocator;
 
@@ -25,9 +37,17 @@ struct SlabAllocator {
     size_t memory_size;
     size_t slab_size;   
     size_t user_size;
+    size_t alignment; // Every payload is aligned to this (0: no extra alignment)
     uint num_slabs;
-    DoubleLinkedList* free_list;   
-    uint free_list_size;
+    SlabMode mode;
+    ArenaBacking backing; // Pages behind memory_start
+    char* slabs_start; // First slot (after the free list header in SLAB_MODE_LIST)
+    DoubleLinkedList* free_list; // Only used in SLAB_MODE_LIST
+    uint32_t free_head; // Only used in SLAB_MODE_EMBEDDED
+    uint32_t bump_index; // LIST and EMBEDDED: slots from here on were never handed out
+    Bitmap slot_bitmap; // BITMAP and EMBEDDED, bit set = slot in use
+    uint bitmap_hint; // Next-fit starting point for the bitmap search
+    uint free_list_size; // Free slots, including the never used ones past bump_index
 };
 
 // Core allocator interface
@@ -35,6 +55,8 @@ void *SlabAllocator_init(Allocator* alloc, ...);
 void *SlabAllocator_cleanup(Allocator* alloc, ...);
 void *SlabAllocator_reserve(Allocator* alloc, ...);  
 void *SlabAllocator_release(Allocator* alloc, ...);    
+int SlabAllocator_reserve_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out);
+int SlabAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs);
 
 // Debug methods
 void SlabAllocator_print_state(SlabAllocator* a);
@@ -43,10 +65,12 @@ void print_slab_info(SlabAllocator* a, uint slab_index);
 
 // Callable methods
 
-// Create a new SlabAllocator
-inline SlabAllocator* SlabAllocator_create(SlabAllocator* a, size_t slab_size, size_t n_slabs) {
+// Create a new SlabAllocator whose payloads are aligned to alignment (a power of two up to the page size),
+// on 2 MiB pages when pages is ARENA_PAGES_HUGE and the system has them
+inline SlabAllocator* SlabAllocator_create_with_pages(SlabAllocator* a, size_t slab_size, size_t n_slabs, SlabMode mode,
+                                                      size_t alignment, ArenaPages pages) {
     // memset(a, 0, sizeof(SlabAllocator));
-    if (!SlabAllocator_init((Allocator*)a, slab_size, n_slabs)) {
+    if (!SlabAllocator_init((Allocator*)a, slab_size, n_slabs, mode, alignment, pages)) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to initialize SlabAllocator!\n" RESET);
         #endif
@@ -54,6 +78,18 @@ inline SlabAllocator* SlabAllocator_create(SlabAllocator* a, size_t slab_size, s
     }
     return a;
 }
+// Create a new SlabAllocator whose payloads are aligned to alignment (a power of two up to the page size)
+inline SlabAllocator* SlabAllocator_create_aligned(SlabAllocator* a, size_t slab_size, size_t n_slabs, SlabMode mode, size_t alignment) {
+    return SlabAllocator_create_with_pages(a, slab_size, n_slabs, mode, alignment, ARENA_PAGES_BASE);
+}
+// Create a new SlabAllocator with the given slot layout
+inline SlabAllocator* SlabAllocator_create_with_mode(SlabAllocator* a, size_t slab_size, size_t n_slabs, SlabMode mode) {
+    return SlabAllocator_create_aligned(a, slab_size, n_slabs, mode, 0);
+}
+// Create a new SlabAllocator
+inline SlabAllocator* SlabAllocator_create(SlabAllocator* a, size_t slab_size, size_t n_slabs) {
+    return SlabAllocator_create_with_mode(a, slab_size, n_slabs, SLAB_MODE_LIST);
+}
 // Destroy a SlabAllocator
 inline int SlabAllocator_destroy(SlabAllocator* a) {    
     void* result = ((Allocator*)a)->dest((Allocator*)a);
@@ -70,4 +106,12 @@ inline int SlabAllocator_free(SlabAllocator* a, void* ptr) {
     if(r == NULL)
         return -1;
     return 0;
-}
\ No newline at end of file
+}
+// Allocate n slabs, returns how many were allocated
+inline int SlabAllocator_malloc_batch(SlabAllocator* a, size_t n, void** out) {
+    return ((Allocator*)a)->malloc_batch((Allocator*)a, n, NULL, out);
+}
+// Free n slabs, returns how many were released
+inline int SlabAllocator_free_batch(SlabAllocator* a, size_t n, void** ptrs) {
+    return ((Allocator*)a)->free_batch((Allocator*)a, n, ptrs);
+}
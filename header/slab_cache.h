@@ -0,0 +1,100 @@
+#pragma once
+#include <allocator.h>
+#include <data_structures/double_linked_list.h>
+#include <data_structures/bitmap.h>
+
+#include <stdlib.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define SLAB_CACHE_NIL UINT32_MAX // End of a chunk's free list
+
+// Forward declaration
+typedef struct SlabCache SlabCache;
+
+// Header at the start of every chunk (chunks are aligned to chunk_size)
+typedef struct {
+    Node node; // Link in the full, partial or empty list
+    char* slots_start;
+    uint32_t free_head; // Embedded free list (slot index stored in the free payload)
+    uint32_t num_free;
+    uint32_t bump_index; // Slots from here on were never handed out
+    Bitmap slot_bitmap; // Bit set = slot handed out, the words sit between the header and the slots
+} SlabChunk;
+
+#define SLAB_CHUNK_HEADER_SIZE ((sizeof(SlabChunk) + 15) & ~(size_t)15)
+
+// SlabCache structure (extends Allocator)
+struct SlabCache {
+    Allocator base;
+    size_t user_size;
+    size_t slot_size;
+    size_t chunk_size; // Power of two, at least one page
+    size_t alignment; // Every object is aligned to this (at least 4 bytes)
+    size_t slots_offset; // First slot of an uncolored chunk, after the header
+    size_t color_step; // Distance between two colors, a multiple of the cache line and the alignment
+    uint num_colors; // Slot offsets that fit in the slack at the end of a chunk
+    uint next_color; // Color of the next mapped chunk
+    uint objects_per_chunk;
+    uint max_empty_chunks; // Empty chunks kept mapped before returning them to the OS
+    uint num_chunks;
+    SlabChunk** chunks; // Every mapped chunk sorted by address, release looks ptr up here before touching it
+    uint chunks_capacity;
+    size_t num_allocated;
+    DoubleLinkedList full; // Chunks with no free slot
+    DoubleLinkedList partial; // Chunks with some free slots, allocation starts here
+    DoubleLinkedList empty; // Chunks with every slot free
+};
+
+// Core allocator interface
+void *SlabCache_init(Allocator* alloc, ...);
+void *SlabCache_cleanup(Allocator* alloc, ...);
+void *SlabCache_reserve(Allocator* alloc, ...);
+void *SlabCache_release(Allocator* alloc, ...);
+int SlabCache_release_batch(Allocator* alloc, size_t n, void** ptrs);
+
+// Unmap every empty chunk, returns the number of chunks released
+uint SlabCache_shrink(SlabCache* cache);
+
+// Debug methods
+void SlabCache_print_state(SlabCache* cache);
+
+// Callable methods
+
+// Create a new SlabCache with aligned objects (a power of two up to the page size),
+// coloring offsets the slots of successive chunks by a cache line
+inline SlabCache* SlabCache_create_aligned(SlabCache* cache, size_t object_size, size_t objects_per_chunk, size_t max_empty_chunks, size_t alignment, bool coloring) {
+    if (!SlabCache_init((Allocator*)cache, object_size, objects_per_chunk, max_empty_chunks, alignment, (int)coloring)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize SlabCache!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return cache;
+}
+// Create a new SlabCache
+inline SlabCache* SlabCache_create(SlabCache* cache, size_t object_size, size_t objects_per_chunk, size_t max_empty_chunks) {
+    return SlabCache_create_aligned(cache, object_size, objects_per_chunk, max_empty_chunks, 0, true);
+}
+// Destroy a SlabCache
+inline int SlabCache_destroy(SlabCache* cache) {
+    void* result = ((Allocator*)cache)->dest((Allocator*)cache);
+    if (!result) return -1;
+    return 0;
+}
+// Allocate an object
+inline void* SlabCache_malloc(SlabCache* cache) {
+    return ((Allocator*)cache)->malloc((Allocator*)cache);
+}
+// Free an object
+inline int SlabCache_free(SlabCache* cache, void* ptr) {
+    void* r = ((Allocator*)cache)->free((Allocator*)cache, ptr);
+    if (r == NULL)
+        return -1;
+    return 0;
+}
@@ -10,6 +10,10 @@ int test_bitmap_set_clear_test();
 
 int test_bitmap_find_first();
 
+int test_bitmap_find_zero_from();
+
+int test_bitmap_find_zero_in_range();
+
 int test_bitmap_print();
 
 int test_bitmap();
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+#include <concurrent_buddy_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <helpers/memory_manipulation.h>
+
+int test_concurrent_buddy_allocator();
@@ -0,0 +1,9 @@
+#pragma once
+#include <implicit_buddy_allocator.h>
+#include <buddy_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <helpers/memory_manipulation.h>
+
+int test_implicit_buddy_allocator();
@@ -0,0 +1,9 @@
+#pragma once
+#include <linear_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <helpers/memory_manipulation.h>
+
+int test_linear_allocator();
@@ -0,0 +1,9 @@
+#pragma once
+#include <magazine_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <helpers/memory_manipulation.h>
+
+int test_magazine_allocator();
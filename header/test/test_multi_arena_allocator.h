@@ -0,0 +1,10 @@
+#pragma once
+#include <multi_arena_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <helpers/memory_manipulation.h>
+
+int test_multi_arena_allocator();
@@ -0,0 +1,8 @@
+#pragma once
+#include <pseudo_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <helpers/memory_manipulation.h>
+
+int test_pseudo_allocator();
@@ -0,0 +1,8 @@
+#pragma once
+#include <size_class_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <helpers/memory_manipulation.h>
+
+int test_size_class_allocator();
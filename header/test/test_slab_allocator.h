@@ -3,6 +3,8 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <helpers/memory_manipulation.h>
 #ifdef TIME
 #include <helpers/time.h>
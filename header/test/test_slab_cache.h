@@ -0,0 +1,8 @@
+#pragma once
+#include <slab_cache.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <helpers/memory_manipulation.h>
+
+int test_slab_cache();
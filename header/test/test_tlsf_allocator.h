@@ -0,0 +1,8 @@
+#pragma once
+#include <tlsf_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <helpers/memory_manipulation.h>
+
+int test_tlsf_allocator();
@@ -0,0 +1,8 @@
+#pragma once
+#include <tree_buddy_allocator.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <helpers/memory_manipulation.h>
+
+int test_tree_buddy_allocator();
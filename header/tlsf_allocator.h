@@ -0,0 +1,122 @@
+#pragma once
+#include <variable_block_allocator.h>
+#include <helpers/huge_pages.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define TLSF_ALIGNMENT 16 // Of every block and of every size
+#define TLSF_SL_LOG2 4
+#define TLSF_SL_COUNT (1 << TLSF_SL_LOG2) // Second level lists per first level
+#define TLSF_FL_SHIFT (TLSF_SL_LOG2 + 4) // Blocks under 1 << TLSF_FL_SHIFT bytes are all in first level 0, TLSF_ALIGNMENT apart
+#define TLSF_FL_MAX 36 // Largest block under 1 << TLSF_FL_MAX bytes
+#define TLSF_FL_COUNT (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+#define TLSF_MAX_MEMORY ((size_t)UINT32_MAX * TLSF_ALIGNMENT) // Block sizes are kept in TLSF_ALIGNMENT units in the tags
+
+#define TLSF_BLOCK_FREE 1
+#define TLSF_PREV_FREE 2
+
+// Header of every block (the boundary tag), the payload follows it
+typedef struct TlsfBlock {
+    size_t size; // Whole block, header included, a multiple of TLSF_ALIGNMENT. Low bits: TLSF_BLOCK_FREE, TLSF_PREV_FREE
+    uint32_t prev_units; // Size of the previous block in TLSF_ALIGNMENT units, to merge with it
+    uint32_t slack; // Used blocks: bytes of the block past the request, header included
+    struct TlsfBlock* next_free; // Free blocks only, in the payload: the list of their size class
+    struct TlsfBlock* prev_free;
+} TlsfBlock;
+
+#define TLSF_HEADER_SIZE offsetof(TlsfBlock, next_free)
+#define TLSF_MIN_BLOCK sizeof(TlsfBlock) // A free block holds its list links
+
+// Two-level segregated fit: free blocks are in TLSF_FL_COUNT first level classes (powers of two)
+// of TLSF_SL_COUNT second level lists each (linear in between), with one bitmap per level.
+// malloc takes the head of the first non-empty list whose blocks are all large enough and
+// splits it, free merges the block with its free neighbours through the boundary tags:
+// both are O(1), with no search and no loop over the levels
+typedef struct {
+    VariableBlockAllocator base;
+    char* memory_start; // Managed memory area, the end sentinel included
+    size_t memory_size;
+    size_t mapping_size;
+    ArenaBacking backing;
+    char* high_water; // End of the highest byte ever written, the arena above is still zero
+    uint32_t fl_bitmap; // Bit set: a list of the first level class is not empty
+    uint32_t sl_bitmap[TLSF_FL_COUNT]; // Bit set: the list is not empty
+    TlsfBlock* free_lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} TlsfAllocator;
+
+// Core allocator interface
+void* TlsfAllocator_init(Allocator* alloc, ...);
+void* TlsfAllocator_cleanup(Allocator* alloc, ...);
+void* TlsfAllocator_reserve(Allocator* alloc, ...);
+void* TlsfAllocator_release(Allocator* alloc, ...);
+void* TlsfAllocator_reallocate(Allocator* alloc, void* ptr, size_t size);
+size_t TlsfAllocator_block_usable_size(Allocator* alloc, void* ptr);
+void* TlsfAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size);
+void* TlsfAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size);
+
+// Debug methods
+int TlsfAllocator_print_state(TlsfAllocator* a);
+
+// Callable methods
+
+// Create a new TlsfAllocator managing memory_size bytes (up to TLSF_MAX_MEMORY)
+inline TlsfAllocator* TlsfAllocator_create(TlsfAllocator* a, size_t memory_size) {
+    if (!TlsfAllocator_init((Allocator*)a, memory_size)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize TlsfAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy TlsfAllocator
+inline int TlsfAllocator_destroy(TlsfAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy TLSF allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from TlsfAllocator
+inline void* TlsfAllocator_malloc(TlsfAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to TlsfAllocator
+inline int TlsfAllocator_free(TlsfAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Resize a block, in place when the next block is free or the block shrinks
+inline void* TlsfAllocator_realloc(TlsfAllocator* a, void* ptr, size_t size) {
+    return ((Allocator*)a)->realloc((Allocator*)a, ptr, size);
+}
+
+// Usable bytes of a block
+inline size_t TlsfAllocator_usable_size(TlsfAllocator* a, void* ptr) {
+    return ((Allocator*)a)->usable_size((Allocator*)a, ptr);
+}
+
+// Allocate a block aligned to alignment
+inline void* TlsfAllocator_memalign(TlsfAllocator* a, size_t alignment, size_t size) {
+    return Allocator_memalign((Allocator*)a, alignment, size);
+}
+
+// Allocate nmemb * size zeroed bytes
+inline void* TlsfAllocator_calloc(TlsfAllocator* a, size_t nmemb, size_t size) {
+    return Allocator_calloc((Allocator*)a, nmemb, size);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <variable_block_allocator.h>
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define TREE_BUDDY_MAX_LEVELS 28 // One byte per node: 2^(levels+1) - 1 bytes of tree
+
+typedef struct {
+    int node_idx;
+    int size;
+} TreeBuddyMetadata;
+
+#define TREE_BUDDY_METADATA_SIZE sizeof(TreeBuddyMetadata)  // Metadata size for each allocation, like BitmapBuddyAllocator
+
+// Same blocks and headers as BitmapBuddyAllocator, but each node of the tree
+// stores the largest free order in its subtree plus one (0: nothing free), so
+// reserve walks down and release walks up without touching the descendants
+typedef struct {
+    VariableBlockAllocator base;
+    char* memory_start; // Managed memory area
+    size_t memory_size; // Size of managed memory
+    uint num_levels; // Levels below the root, minimum blocks have order 0 at level num_levels
+    size_t min_block_size; // Minimum allocation size
+    uint8_t* longest; // Per node: largest free order in the subtree + 1, heap ordered
+    size_t num_nodes; // 2^(num_levels + 1) - 1
+    size_t mapping_size; // Arena plus tree, one mapping
+} TreeBuddyAllocator;
+
+// Core allocator interface
+void* TreeBuddyAllocator_init(Allocator* alloc, ...);
+void* TreeBuddyAllocator_cleanup(Allocator* alloc, ...);
+void* TreeBuddyAllocator_reserve(Allocator* alloc, ...);
+void* TreeBuddyAllocator_release(Allocator* alloc, ...);
+
+// Debug methods
+int TreeBuddyAllocator_print_state(TreeBuddyAllocator* a);
+
+// Callable methods
+
+// Create a new TreeBuddyAllocator, num_levels counts the splits below the root like BitmapBuddyAllocator
+inline TreeBuddyAllocator* TreeBuddyAllocator_create(TreeBuddyAllocator* a, size_t memory_size, int num_levels) {
+    if (!TreeBuddyAllocator_init((Allocator*)a, memory_size, num_levels)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to initialize TreeBuddyAllocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return a;
+}
+
+// Destroy TreeBuddyAllocator
+inline int TreeBuddyAllocator_destroy(TreeBuddyAllocator* a) {
+    if (((Allocator*)a)->dest((Allocator*)a) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to destroy tree buddy allocator\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
+
+// Allocate memory from TreeBuddyAllocator
+inline void* TreeBuddyAllocator_malloc(TreeBuddyAllocator* a, size_t size) {
+    return ((Allocator*)a)->malloc((Allocator*)a, size);
+}
+
+// Release memory back to TreeBuddyAllocator
+inline int TreeBuddyAllocator_free(TreeBuddyAllocator* a, void* ptr) {
+    if (((Allocator*)a)->free((Allocator*)a, ptr) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to release block\n" RESET);
+        #endif
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <allocator.h>
+#include <string.h>
+
+#define SORT_INSERTION_MAX 64 // Batches up to this size skip qsort's indirect compares
+
+static int compare_addresses(const void* x, const void* y) {
+    uintptr_t a = (uintptr_t)*(void* const*)x;
+    uintptr_t b = (uintptr_t)*(void* const*)y;
+    return (a > b) - (a < b);
+}
+
+void Allocator_sort_addresses(void** ptrs, size_t n) {
+    if (n > SORT_INSERTION_MAX) {
+        qsort(ptrs, n, sizeof(void*), compare_addresses);
+        return;
+    }
+    for (size_t i = 1; i < n; i++) {
+        void* p = ptrs[i];
+        size_t j = i;
+        while (j > 0 && (uintptr_t)ptrs[j - 1] > (uintptr_t)p) {
+            ptrs[j] = ptrs[j - 1];
+            j--;
+        }
+        ptrs[j] = p;
+    }
+}
+
+int Allocator_malloc_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out) {
+    if (!alloc || !out) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or output array in malloc_batch\n" RESET);
+        #endif
+        return 0;
+    }
+    if (alloc->malloc_batch) return alloc->malloc_batch(alloc, n, sizes, out);
+
+    int allocated = 0;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = sizes ? alloc->malloc(alloc, sizes[i]) : alloc->malloc(alloc);
+        if (out[i]) allocated++;
+    }
+    return allocated;
+}
+
+int Allocator_free_batch(Allocator* alloc, size_t n, void** ptrs) {
+    if (!alloc || !ptrs) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer array in free_batch\n" RESET);
+        #endif
+        return 0;
+    }
+    if (alloc->free_batch) return alloc->free_batch(alloc, n, ptrs);
+
+    // Same failure convention as the trace runner: (void*)-1. Allocators that
+    // report failures as NULL provide their own free_batch
+    int released = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!ptrs[i]) continue;
+        if (alloc->free(alloc, ptrs[i]) == (void*)-1) {
+            ptrs[i] = NULL;
+            continue;
+        }
+        released++;
+    }
+    return released;
+}
+
+void* Allocator_realloc(Allocator* alloc, void* ptr, size_t size) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator in realloc\n" RESET);
+        #endif
+        return NULL;
+    }
+    if (alloc->realloc) return alloc->realloc(alloc, ptr, size);
+
+    if (!ptr) return alloc->malloc(alloc, size);
+    if (size == 0) {
+        alloc->free(alloc, ptr);
+        return NULL;
+    }
+    // Without a usable size there is no way to know how much to copy
+    size_t old_size = Allocator_usable_size(alloc, ptr);
+    if (old_size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: realloc not supported by this allocator\n" RESET);
+        #endif
+        return NULL;
+    }
+    if (size <= old_size) return ptr;
+    void* new_ptr = alloc->malloc(alloc, size);
+    if (!new_ptr) return NULL;
+    memcpy(new_ptr, ptr, old_size);
+    alloc->free(alloc, ptr);
+    return new_ptr;
+}
+
+size_t Allocator_usable_size(Allocator* alloc, void* ptr) {
+    if (!alloc || !ptr || !alloc->usable_size) return 0;
+    return alloc->usable_size(alloc, ptr);
+}
+
+void* Allocator_memalign(Allocator* alloc, size_t alignment, size_t size) {
+    if (!alloc || alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or alignment not a power of two in memalign\n" RESET);
+        #endif
+        return NULL;
+    }
+    if (!alloc->memalign) {
+        #ifdef DEBUG
+        printf(RED "ERROR: memalign not supported by this allocator\n" RESET);
+        #endif
+        return NULL;
+    }
+    return alloc->memalign(alloc, alignment, size);
+}
+
+void* Allocator_calloc(Allocator* alloc, size_t nmemb, size_t size) {
+    size_t total;
+    if (!alloc || __builtin_mul_overflow(nmemb, size, &total)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or size overflow in calloc\n" RESET);
+        #endif
+        return NULL;
+    }
+    if (alloc->calloc) return alloc->calloc(alloc, nmemb, size);
+
+    void* ptr = alloc->malloc(alloc, total);
+    if (ptr) memset(ptr, 0, total);
+    return ptr;
+}
@@ -0,0 +1,78 @@
+// Batch entry points against one variadic call per object
+// Usage: ./bin/bench_batch [batch_size]
+#include <slab_allocator.h>
+#include <buddy_allocator.h>
+#include <bitmap_buddy_allocator.h>
+#include <helpers/timing.h>
+
+#define ROUNDS 200000
+#define MAX_BATCH 256
+#define NODE_SIZE 48
+
+static void shuffle(void** ptrs, int n, uint64_t* state) {
+    for (int i = n - 1; i > 0; i--) {
+        *state ^= *state << 13; *state ^= *state >> 7; *state ^= *state << 17;
+        int j = (int)(*state % (uint64_t)(i + 1));
+        void* tmp = ptrs[i]; ptrs[i] = ptrs[j]; ptrs[j] = tmp;
+    }
+}
+
+// Allocate and release batch objects per round, returns ns per object (alloc + free)
+static double run(Allocator* alloc, int batch, const size_t* sizes, bool batched) {
+    void* ptrs[MAX_BATCH];
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    double start = now_seconds();
+    for (int r = 0; r < ROUNDS; r++) {
+        if (batched) {
+            Allocator_malloc_batch(alloc, batch, sizes, ptrs);
+        } else {
+            for (int i = 0; i < batch; i++) {
+                ptrs[i] = sizes ? alloc->malloc(alloc, sizes[i]) : alloc->malloc(alloc);
+            }
+        }
+        // Handlers release their nodes in no particular order
+        shuffle(ptrs, batch, &state);
+        if (batched) {
+            Allocator_free_batch(alloc, batch, ptrs);
+        } else {
+            for (int i = 0; i < batch; i++) alloc->free(alloc, ptrs[i]);
+        }
+    }
+    double elapsed = now_seconds() - start;
+    return elapsed * 1e9 / ((double)ROUNDS * batch);
+}
+
+int main(int argc, char* argv[]) {
+    int batch = (argc > 1) ? atoi(argv[1]) : 32;
+    if (batch < 1 || batch > MAX_BATCH) batch = 32;
+
+    size_t sizes[MAX_BATCH];
+    for (int i = 0; i < batch; i++) sizes[i] = NODE_SIZE + (size_t)(i % 4) * 40;
+
+    printf("Batch of %d objects, %d rounds (shuffle cost included in both columns)\n", batch, ROUNDS);
+    printf("%-24s %14s %14s\n", "allocator", "per call ns", "batch ns");
+
+    SlabAllocator slab;
+    SlabAllocator_create_with_mode(&slab, NODE_SIZE, MAX_BATCH, SLAB_MODE_EMBEDDED);
+    printf("%-24s %14.2f %14.2f\n", "slab (embedded)",
+           run((Allocator*)&slab, batch, NULL, false), run((Allocator*)&slab, batch, NULL, true));
+    SlabAllocator_destroy(&slab);
+
+    SlabAllocator_create_with_mode(&slab, NODE_SIZE, MAX_BATCH, SLAB_MODE_BITMAP);
+    printf("%-24s %14.2f %14.2f\n", "slab (bitmap)",
+           run((Allocator*)&slab, batch, NULL, false), run((Allocator*)&slab, batch, NULL, true));
+    SlabAllocator_destroy(&slab);
+
+    BuddyAllocator buddy;
+    BuddyAllocator_create(&buddy, 1 << 20, 12);
+    printf("%-24s %14.2f %14.2f\n", "buddy",
+           run((Allocator*)&buddy, batch, sizes, false), run((Allocator*)&buddy, batch, sizes, true));
+    BuddyAllocator_destroy(&buddy);
+
+    BitmapBuddyAllocator bitmap_buddy;
+    BitmapBuddyAllocator_create(&bitmap_buddy, 1 << 20, 11);
+    printf("%-24s %14.2f %14.2f\n", "bitmap buddy",
+           run((Allocator*)&bitmap_buddy, batch, sizes, false), run((Allocator*)&bitmap_buddy, batch, sizes, true));
+    BitmapBuddyAllocator_destroy(&bitmap_buddy);
+    return 0;
+}
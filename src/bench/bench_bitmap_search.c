@@ -0,0 +1,62 @@
+// Free block search of BitmapBuddyAllocator in a nearly full arena
+// Usage: ./bin/bench_bitmap_search [levels]
+#include <bitmap_buddy_allocator.h>
+#include <helpers/timing.h>
+
+#define ROUNDS 20000
+
+// The search as reserve did it before: one bitmap_test per block
+static int find_zero_per_bit(Bitmap* bitmap, int start, int end) {
+    for (int j = start; j < end; j++) {
+        if (!bitmap_test(bitmap, j)) return j;
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    int levels = (argc > 1) ? atoi(argv[1]) : 16;
+    if (levels < 8 || levels > 20) levels = 16;
+
+    BitmapBuddyAllocator buddy;
+    if (!BitmapBuddyAllocator_create(&buddy, (size_t)64 << levels, levels)) return 1;
+    // Minimum blocks live on the last level
+    int first = (1 << (buddy.num_levels - 1)) - 1;
+    int last = (1 << buddy.num_levels) - 1;
+    size_t small = buddy.min_block_size - BITMAP_METADATA_SIZE;
+
+    // Fill the arena with minimum blocks, then open a hole in the last one
+    int n = last - first;
+    void** ptrs = malloc(n * sizeof(void*));
+    int filled = 0;
+    while (filled < n && (ptrs[filled] = BitmapBuddyAllocator_malloc(&buddy, small))) filled++;
+    if (filled == 0) return 1;
+    BitmapBuddyAllocator_free(&buddy, ptrs[--filled]);
+
+    printf("%d minimum blocks of %zu bytes, %d in use, %d rounds\n", n, buddy.min_block_size, filled, ROUNDS);
+    #if defined(__x86_64__) || defined(__i386__)
+    printf("Vector path: %s\n", __builtin_cpu_supports("avx2") ? "AVX2" : "SSE2");
+    #endif
+    printf("%-28s %14s\n", "search", "ns per call");
+
+    volatile int sink = 0;
+    double start = now_seconds();
+    for (int r = 0; r < ROUNDS; r++) sink += find_zero_per_bit(&buddy.bitmap, first, last);
+    printf("%-28s %14.2f\n", "per bit", (now_seconds() - start) * 1e9 / ROUNDS);
+
+    start = now_seconds();
+    for (int r = 0; r < ROUNDS; r++) sink += bitmap_find_zero_in_range(&buddy.bitmap, first, last);
+    printf("%-28s %14.2f\n", "word/vector", (now_seconds() - start) * 1e9 / ROUNDS);
+
+    // End to end: the allocation lands on the only free block
+    start = now_seconds();
+    for (int r = 0; r < ROUNDS; r++) {
+        void* p = BitmapBuddyAllocator_malloc(&buddy, small);
+        BitmapBuddyAllocator_free(&buddy, p);
+    }
+    printf("%-28s %14.2f\n", "reserve + release", (now_seconds() - start) * 1e9 / ROUNDS);
+
+    for (int i = 0; i < filled; i++) BitmapBuddyAllocator_free(&buddy, ptrs[i]);
+    free(ptrs);
+    BitmapBuddyAllocator_destroy(&buddy);
+    return sink == 0;
+}
@@ -0,0 +1,59 @@
+// Zeroed buffers: native calloc (high-water mark, madvise) against malloc and memset
+// Usage: ./bin/bench_calloc [block_size]
+#include <buddy_allocator.h>
+#include <bitmap_buddy_allocator.h>
+#include <helpers/timing.h>
+#include <string.h>
+
+#define ARENA_SIZE ((size_t)1 << 26)
+#define ARENA_LEVELS 14
+
+// calloc the whole arena in blocks, then write one byte per page as the caller would.
+// Returns ns per block
+static double fill(Allocator* alloc, void** blocks, size_t count, size_t block_size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    double start = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        char* block = Allocator_calloc(alloc, 1, block_size);
+        for (size_t off = 0; off < block_size; off += page_size) block[off] = 1;
+        blocks[i] = block;
+    }
+    double elapsed = now_seconds() - start;
+    for (size_t i = 0; i < count; i++) alloc->free(alloc, blocks[i]);
+    return elapsed * 1e9 / count;
+}
+
+// First pass on fresh pages, second on dirty ones
+static void report(const char* name, Allocator* alloc, bool native, size_t block_size) {
+    size_t count = ARENA_SIZE / 2 / block_size;
+    void** blocks = malloc(count * sizeof(void*));
+    CallocFunc calloc_func = alloc->calloc;
+    if (!native) alloc->calloc = NULL;
+    double fresh = fill(alloc, blocks, count, block_size);
+    double dirty = fill(alloc, blocks, count, block_size);
+    alloc->calloc = calloc_func;
+    printf("%-14s %-8s %16.0f %16.0f\n", name, native ? "native" : "memset", fresh, dirty);
+    free(blocks);
+}
+
+int main(int argc, char* argv[]) {
+    size_t block_size = (argc > 1) ? strtoul(argv[1], NULL, 10) : 262144;
+    if (block_size < 64 || block_size > ARENA_SIZE / 4) block_size = 262144;
+
+    printf("%zu blocks of %zu bytes, ns per calloc (one write per page included)\n",
+           ARENA_SIZE / 2 / block_size, block_size);
+    printf("%-14s %-8s %16s %16s\n", "allocator", "zeroing", "fresh ns", "dirty ns");
+
+    for (int native = 1; native >= 0; native--) {
+        BuddyAllocator buddy;
+        BuddyAllocator_create(&buddy, ARENA_SIZE, ARENA_LEVELS);
+        report("buddy", (Allocator*)&buddy, native, block_size);
+        BuddyAllocator_destroy(&buddy);
+
+        BitmapBuddyAllocator bitmap;
+        BitmapBuddyAllocator_create(&bitmap, ARENA_SIZE, ARENA_LEVELS);
+        report("bitmap buddy", (Allocator*)&bitmap, native, block_size);
+        BitmapBuddyAllocator_destroy(&bitmap);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Contention: ConcurrentBuddyAllocator (a lock per top-level subtree) against
+// a BuddyAllocator behind one global mutex, on 1 to max_threads threads
+// Usage: ./bin/bench_concurrent_buddy [max_threads] [subtrees]
+#include <concurrent_buddy_allocator.h>
+#include <helpers/timing.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define MEMORY_SIZE ((size_t)1 << 26)
+#define NUM_LEVELS 20 // 64B min blocks
+#define OPS_PER_THREAD 500000 // Allocations (and frees) per thread
+#define BATCH 16 // Blocks live at once per thread
+
+enum Variant { GLOBAL_MUTEX, SUBTREE_LOCKS };
+
+struct Shared {
+    enum Variant variant;
+    BuddyAllocator buddy;
+    pthread_mutex_t lock;
+    ConcurrentBuddyAllocator concurrent;
+    pthread_barrier_t start;
+};
+
+static inline void* bench_alloc(struct Shared* s, size_t size) {
+    if (s->variant == SUBTREE_LOCKS) return ConcurrentBuddyAllocator_malloc(&s->concurrent, size);
+    pthread_mutex_lock(&s->lock);
+    void* p = BuddyAllocator_malloc(&s->buddy, size);
+    pthread_mutex_unlock(&s->lock);
+    return p;
+}
+
+static inline void bench_free(struct Shared* s, void* p) {
+    if (s->variant == SUBTREE_LOCKS) {
+        ConcurrentBuddyAllocator_free(&s->concurrent, p);
+        return;
+    }
+    pthread_mutex_lock(&s->lock);
+    BuddyAllocator_free(&s->buddy, p);
+    pthread_mutex_unlock(&s->lock);
+}
+
+// Each thread keeps BATCH blocks live and replaces the oldest one at every step,
+// so the trees stay split and the time goes to the allocator and its locks
+static void* worker(void* arg) {
+    struct Shared* s = (struct Shared*)arg;
+    void* ptrs[BATCH];
+    for (int i = 0; i < BATCH; i++) ptrs[i] = bench_alloc(s, 32 + (size_t)i * 61);
+    pthread_barrier_wait(&s->start);
+    for (int done = 0; done < OPS_PER_THREAD; done++) {
+        int slot = done % BATCH;
+        bench_free(s, ptrs[slot]);
+        ptrs[slot] = bench_alloc(s, 32 + (size_t)((done * 37) % 1000));
+        *(volatile char*)ptrs[slot] = (char)done; // Touch the block
+    }
+    for (int i = 0; i < BATCH; i++) bench_free(s, ptrs[i]);
+    return NULL;
+}
+
+// Returns millions of alloc+free pairs per second
+static double run(enum Variant variant, int n_threads, int subtrees) {
+    struct Shared s;
+    s.variant = variant;
+    if (variant == SUBTREE_LOCKS) {
+        ConcurrentBuddyAllocator_create(&s.concurrent, MEMORY_SIZE, NUM_LEVELS, subtrees);
+    } else {
+        BuddyAllocator_create(&s.buddy, MEMORY_SIZE, NUM_LEVELS);
+        pthread_mutex_init(&s.lock, NULL);
+    }
+    pthread_barrier_init(&s.start, NULL, n_threads + 1);
+
+    pthread_t threads[n_threads];
+    for (int i = 0; i < n_threads; i++) {
+        pthread_create(&threads[i], NULL, worker, &s);
+    }
+    double start = now_seconds();
+    pthread_barrier_wait(&s.start);
+    for (int i = 0; i < n_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    pthread_barrier_destroy(&s.start);
+    if (variant == SUBTREE_LOCKS) {
+        ConcurrentBuddyAllocator_destroy(&s.concurrent);
+    } else {
+        pthread_mutex_destroy(&s.lock);
+        BuddyAllocator_destroy(&s.buddy);
+    }
+    return (double)n_threads * OPS_PER_THREAD / elapsed / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = (argc > 1) ? atoi(argv[1]) : 16;
+    int subtrees = (argc > 2) ? atoi(argv[2]) : CONCURRENT_BUDDY_MAX_SUBTREES;
+    if (max_threads < 1) max_threads = 1;
+    if (subtrees < 1 || subtrees > CONCURRENT_BUDDY_MAX_SUBTREES || (subtrees & (subtrees - 1)) != 0) {
+        subtrees = CONCURRENT_BUDDY_MAX_SUBTREES;
+    }
+
+    printf("Buddy contention, %d ops per thread, %d live blocks per thread, %d subtrees, %ld cores\n",
+           OPS_PER_THREAD, BATCH, subtrees, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%8s %16s %10s %16s %10s\n", "threads", "mutex Mops/s", "scaling", "subtree Mops/s", "scaling");
+    double mutex_base = 0, subtree_base = 0;
+    for (int t = 1; t <= max_threads; t *= 2) {
+        double mutex = run(GLOBAL_MUTEX, t, subtrees);
+        double subtree = run(SUBTREE_LOCKS, t, subtrees);
+        if (t == 1) {
+            mutex_base = mutex;
+            subtree_base = subtree;
+        }
+        printf("%8d %16.2f %9.2fx %16.2f %9.2fx\n", t,
+               mutex, mutex / mutex_base, subtree, subtree / subtree_base);
+        if (t < max_threads && t * 2 > max_threads) t = max_threads / 2; // Always end on max_threads
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// A heap that peaks and then drops, on a BitmapBuddyAllocator sized to the peak and on
+// a GrowableBuddyAllocator that maps superblocks as it goes. The live set grows to the
+// peak, the oldest blocks are released down to a tenth of it, then the small heap churns.
+// Reports the mapped and resident memory after each phase and the time per operation
+// Usage: ./bin/bench_growable [peak_mib]
+#include <bitmap_buddy_allocator.h>
+#include <growable_buddy_allocator.h>
+#include <helpers/timing.h>
+#include <unistd.h>
+
+#define SUPERBLOCK_SIZE ((size_t)1 << 22)
+#define NUM_LEVELS 14 // 512B min blocks in a superblock
+#define MAX_BLOCK 16384
+#define CHURN_OPS 2000000
+
+enum Kind { FIXED, GROWABLE };
+static const char* kind_names[] = {"BitmapBuddyAllocator", "GrowableBuddyAllocator"};
+
+union Arena {
+    BitmapBuddyAllocator bitmap;
+    GrowableBuddyAllocator growable;
+};
+
+// Resident bytes of the process
+static size_t resident_bytes(void) {
+    long pages = 0, resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(statm);
+    return (size_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+static inline size_t mapped_bytes(enum Kind kind, union Arena* u) {
+    return kind == FIXED ? u->bitmap.memory_size : u->growable.num_superblocks * SUPERBLOCK_SIZE;
+}
+
+static inline uint64_t next_random(uint64_t* x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static void run(enum Kind kind, size_t peak) {
+    union Arena u;
+    Allocator* a = (Allocator*)&u;
+    size_t base = resident_bytes();
+    // The fixed arena must hold the peak up front: the next power of two, with room for fragmentation
+    size_t fixed_size = SUPERBLOCK_SIZE;
+    while (fixed_size < 2 * peak) fixed_size <<= 1;
+    if (kind == FIXED) {
+        BitmapBuddyAllocator_create(&u.bitmap, fixed_size, NUM_LEVELS + __builtin_ctzl(fixed_size / SUPERBLOCK_SIZE));
+    } else {
+        GrowableBuddyAllocator_create(&u.growable, SUPERBLOCK_SIZE, NUM_LEVELS, GROWABLE_BUDDY_MAX_SUPERBLOCKS);
+    }
+
+    size_t max_blocks = peak / 64;
+    char** blocks = malloc(max_blocks * sizeof(char*));
+    size_t n_blocks = 0, live = 0, ops = 0, failed = 0;
+    uint64_t x = 88172645463325252ULL;
+
+    // Grow to the peak
+    double start = now_seconds();
+    while (live < peak && n_blocks < max_blocks) {
+        size_t size = 64 + next_random(&x) % MAX_BLOCK;
+        char* p = a->malloc(a, size);
+        ops++;
+        if (!p) {
+            failed++;
+            break;
+        }
+        memset(p, 1, size);
+        blocks[n_blocks++] = p;
+        live += a->usable_size(a, p);
+    }
+    size_t peak_mapped = mapped_bytes(kind, &u), peak_resident = resident_bytes() - base;
+
+    // Drop the oldest nine tenths
+    size_t drop = n_blocks - n_blocks / 10;
+    for (size_t i = 0; i < drop; i++) {
+        a->free(a, blocks[i]);
+        ops++;
+    }
+    memmove(blocks, blocks + drop, (n_blocks - drop) * sizeof(char*));
+    n_blocks -= drop;
+    size_t drop_mapped = mapped_bytes(kind, &u), drop_resident = resident_bytes() - base;
+
+    // Churn: replace random blocks of the small heap
+    for (int i = 0; i < CHURN_OPS; i++) {
+        size_t j = next_random(&x) % n_blocks;
+        a->free(a, blocks[j]);
+        size_t size = 64 + next_random(&x) % MAX_BLOCK;
+        char* p = a->malloc(a, size);
+        ops += 2;
+        if (!p) {
+            failed++;
+            blocks[j] = blocks[--n_blocks];
+            continue;
+        }
+        *p = 1;
+        blocks[j] = p;
+    }
+    double elapsed = now_seconds() - start;
+    size_t churn_mapped = mapped_bytes(kind, &u), churn_resident = resident_bytes() - base;
+
+    printf("%24s %9.0f/%-6.0f %9.0f/%-6.0f %9.0f/%-6.0f %8.1f %7zu\n", kind_names[kind],
+           peak_mapped / 1048576.0, peak_resident / 1048576.0, drop_mapped / 1048576.0, drop_resident / 1048576.0,
+           churn_mapped / 1048576.0, churn_resident / 1048576.0, elapsed * 1e9 / ops, failed);
+
+    for (size_t i = 0; i < n_blocks; i++) a->free(a, blocks[i]);
+    free(blocks);
+    a->dest(a);
+}
+
+int main(int argc, char* argv[]) {
+    size_t peak_mib = (argc > 1) ? (size_t)atol(argv[1]) : 48;
+    if (peak_mib == 0 || peak_mib > GROWABLE_BUDDY_MAX_SUPERBLOCKS * (SUPERBLOCK_SIZE >> 20) / 2) peak_mib = 48;
+    size_t peak = peak_mib << 20;
+
+    printf("Live set up to %zu MiB of blocks up to %d bytes, then a tenth of it churning, %zu MiB superblocks\n",
+           peak_mib, MAX_BLOCK, SUPERBLOCK_SIZE >> 20);
+    printf("%24s %16s %16s %16s %8s %7s\n", "allocator", "peak map/res MiB", "drop map/res MiB",
+           "churn map/res MiB", "ns/op", "failed");
+    run(FIXED, peak);
+    run(GROWABLE, peak);
+    return 0;
+}
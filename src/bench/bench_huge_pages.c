@@ -0,0 +1,105 @@
+// Random accesses over many small blocks of a large BitmapBuddyAllocator arena,
+// on base pages and on huge pages. Reports the time per access and the dTLB load
+// misses (perf_event_open, "n/a" when the kernel or the machine has no such counter)
+// Usage: ./bin/bench_huge_pages [arena_mib]
+#include <bitmap_buddy_allocator.h>
+#include <helpers/timing.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#define MIN_BLOCK 256
+#define BLOCK_SIZE 200
+#define ACCESSES 20000000
+
+static volatile uint64_t sink; // Keeps the reads
+
+// Counter of the dTLB load misses of this thread in user space, -1 if unavailable
+static int open_dtlb_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Anonymous memory of the process on transparent huge pages
+static size_t anon_huge_bytes(void) {
+    char line[256];
+    size_t kib = 0;
+    FILE* f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f) return 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "AnonHugePages: %zu kB", &kib) == 1) break;
+    }
+    fclose(f);
+    return kib * 1024;
+}
+
+static void run(ArenaPages pages, size_t memory_size) {
+    BitmapBuddyAllocator buddy;
+    if (!BitmapBuddyAllocator_create_with_pages(&buddy, memory_size, __builtin_ctzl(memory_size / MIN_BLOCK), pages)) {
+        printf("Failed to create a %zu MiB arena\n", memory_size >> 20);
+        return;
+    }
+    size_t huge_before = anon_huge_bytes();
+
+    // Fill the arena with small blocks and touch them all
+    size_t max_blocks = memory_size / MIN_BLOCK;
+    char** blocks = malloc(max_blocks * sizeof(char*));
+    size_t n_blocks = 0;
+    while (n_blocks < max_blocks && (blocks[n_blocks] = BitmapBuddyAllocator_malloc(&buddy, BLOCK_SIZE)) != NULL) {
+        memset(blocks[n_blocks], (int)n_blocks, BLOCK_SIZE);
+        n_blocks++;
+    }
+    size_t huge = anon_huge_bytes() - huge_before;
+
+    // Random reads: almost every one lands on another page
+    int counter = open_dtlb_counter();
+    uint64_t misses = 0;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    uint64_t x = 88172645463325252ULL, sum = 0;
+    double start = now_seconds();
+    for (int i = 0; i < ACCESSES; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += blocks[x % n_blocks][x % BLOCK_SIZE];
+    }
+    double elapsed = now_seconds() - start;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &misses, sizeof(misses)) != sizeof(misses)) misses = 0;
+        close(counter);
+    }
+
+    char misses_text[32] = "n/a";
+    if (counter >= 0) snprintf(misses_text, sizeof(misses_text), "%.3f", (double)misses / ACCESSES);
+    sink = sum;
+    printf("%24s %10zu %12.1f %12.2f %14s\n", arena_backing_name(buddy.backing), n_blocks,
+           huge / 1048576.0, elapsed * 1e9 / ACCESSES, misses_text);
+
+    for (size_t i = 0; i < n_blocks; i++) BitmapBuddyAllocator_free(&buddy, blocks[i]);
+    free(blocks);
+    BitmapBuddyAllocator_destroy(&buddy);
+}
+
+int main(int argc, char* argv[]) {
+    size_t arena_mib = (argc > 1) ? (size_t)atol(argv[1]) : 256;
+    if (arena_mib < 4 || (arena_mib & (arena_mib - 1)) != 0) arena_mib = 256; // A power of two
+    size_t memory_size = arena_mib << 20;
+
+    printf("Random reads over a %zu MiB arena of %d byte blocks\n", arena_mib, BLOCK_SIZE);
+    printf("%24s %10s %12s %12s %14s\n", "pages", "blocks", "THP MiB", "ns/access", "dTLB miss/acc");
+    run(ARENA_PAGES_BASE, memory_size);
+    run(ARENA_PAGES_HUGE, memory_size);
+    return 0;
+}
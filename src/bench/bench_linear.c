@@ -0,0 +1,93 @@
+// Per-request allocations that all die together at the end of the request: a
+// LinearAllocator rewound to a mark, the thread's scratch arena in a scope, a
+// BitmapBuddyAllocator and the system malloc releasing every block
+// Usage: ./bin/bench_linear [objects_per_request]
+#include <linear_allocator.h>
+#include <bitmap_buddy_allocator.h>
+#include <helpers/timing.h>
+
+#define REQUESTS 200000
+#define MAX_OBJECTS 1024
+#define MAX_SIZE 512
+
+enum Kind { LINEAR, SCRATCH, BITMAP_BUDDY, SYSTEM };
+static const char* kind_names[] = {"LinearAllocator", "scratch scope", "BitmapBuddyAllocator", "system malloc"};
+
+static size_t sizes[MAX_OBJECTS];
+
+static inline void touch(char* p, size_t size) {
+    p[0] = 1;
+    p[size - 1] = 1;
+}
+
+// One request on the scratch arena of the thread
+static void scratch_request(int objects) {
+    LINEAR_SCRATCH_SCOPE(scope);
+    for (int j = 0; j < objects; j++) {
+        char* p = LinearAllocator_malloc(scope.allocator, sizes[j]);
+        touch(p, sizes[j]);
+    }
+}
+
+// Returns nanoseconds per object, allocation and release
+static double run(enum Kind kind, int objects) {
+    static void* blocks[MAX_OBJECTS];
+    LinearAllocator linear;
+    BitmapBuddyAllocator buddy;
+    LinearAllocator_create(&linear, (size_t)1 << 20);
+    BitmapBuddyAllocator_create(&buddy, (size_t)1 << 24, 16);
+
+    double start = now_seconds();
+    for (int r = 0; r < REQUESTS; r++) {
+        switch (kind) {
+        case LINEAR: {
+            LinearMark mark = LinearAllocator_mark(&linear);
+            for (int j = 0; j < objects; j++) {
+                char* p = LinearAllocator_malloc(&linear, sizes[j]);
+                touch(p, sizes[j]);
+            }
+            LinearAllocator_reset_to(&linear, mark);
+            break;
+        }
+        case SCRATCH:
+            scratch_request(objects);
+            break;
+        case BITMAP_BUDDY:
+            for (int j = 0; j < objects; j++) {
+                blocks[j] = BitmapBuddyAllocator_malloc(&buddy, sizes[j]);
+                touch(blocks[j], sizes[j]);
+            }
+            for (int j = 0; j < objects; j++) BitmapBuddyAllocator_free(&buddy, blocks[j]);
+            break;
+        case SYSTEM:
+            for (int j = 0; j < objects; j++) {
+                blocks[j] = malloc(sizes[j]);
+                touch(blocks[j], sizes[j]);
+            }
+            for (int j = 0; j < objects; j++) free(blocks[j]);
+            break;
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    LinearAllocator_destroy(&linear);
+    BitmapBuddyAllocator_destroy(&buddy);
+    return elapsed * 1e9 / ((double)REQUESTS * objects);
+}
+
+int main(int argc, char* argv[]) {
+    int objects = (argc > 1) ? atoi(argv[1]) : 64;
+    if (objects <= 0 || objects > MAX_OBJECTS) objects = 64;
+    uint64_t x = 88172645463325252ULL;
+    for (int i = 0; i < MAX_OBJECTS; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sizes[i] = 16 + x % (MAX_SIZE - 16);
+    }
+
+    printf("%d requests of %d objects of 16 to %d bytes, released together\n", REQUESTS, objects, MAX_SIZE);
+    printf("%22s %14s\n", "allocator", "ns/object");
+    for (int k = LINEAR; k <= SYSTEM; k++) printf("%22s %14.1f\n", kind_names[k], run(k, objects));
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Scaling of the magazine layer against a SlabAllocator behind one global mutex
+// Usage: ./bin/bench_magazine [max_threads]
+#include <magazine_allocator.h>
+#include <helpers/timing.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define OBJECT_SIZE 64
+#define OPS_PER_THREAD 2000000 // Allocations (and frees) per thread
+#define BATCH 16 // Objects live at once per thread
+
+enum Variant { GLOBAL_MUTEX, MAGAZINE };
+
+struct Shared {
+    enum Variant variant;
+    SlabAllocator slab;
+    pthread_mutex_t lock;
+    MagazineAllocator magazine;
+    pthread_barrier_t start;
+};
+
+static inline void* bench_alloc(struct Shared* s) {
+    if (s->variant == MAGAZINE) return MagazineAllocator_malloc(&s->magazine);
+    pthread_mutex_lock(&s->lock);
+    void* p = SlabAllocator_malloc(&s->slab);
+    pthread_mutex_unlock(&s->lock);
+    return p;
+}
+
+static inline void bench_free(struct Shared* s, void* p) {
+    if (s->variant == MAGAZINE) {
+        MagazineAllocator_free(&s->magazine, p);
+        return;
+    }
+    pthread_mutex_lock(&s->lock);
+    SlabAllocator_free(&s->slab, p);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void* worker(void* arg) {
+    struct Shared* s = (struct Shared*)arg;
+    void* ptrs[BATCH];
+    pthread_barrier_wait(&s->start);
+    for (int done = 0; done < OPS_PER_THREAD; done += BATCH) {
+        for (int i = 0; i < BATCH; i++) {
+            ptrs[i] = bench_alloc(s);
+            *(volatile char*)ptrs[i] = (char)i; // Touch the object
+        }
+        for (int i = 0; i < BATCH; i++) {
+            bench_free(s, ptrs[i]);
+        }
+    }
+    if (s->variant == MAGAZINE) MagazineAllocator_thread_flush(&s->magazine);
+    return NULL;
+}
+
+// Returns millions of alloc+free pairs per second
+static double run(enum Variant variant, int n_threads) {
+    struct Shared s;
+    size_t n_objects = (size_t)n_threads * (BATCH + 2 * MAGAZINE_SIZE) + 1024;
+    s.variant = variant;
+    if (variant == MAGAZINE) {
+        MagazineAllocator_create(&s.magazine, OBJECT_SIZE, n_objects);
+    } else {
+        SlabAllocator_create_with_mode(&s.slab, OBJECT_SIZE, n_objects, SLAB_MODE_EMBEDDED);
+        pthread_mutex_init(&s.lock, NULL);
+    }
+    pthread_barrier_init(&s.start, NULL, n_threads + 1);
+
+    pthread_t threads[n_threads];
+    for (int i = 0; i < n_threads; i++) {
+        pthread_create(&threads[i], NULL, worker, &s);
+    }
+    double start = now_seconds();
+    pthread_barrier_wait(&s.start);
+    for (int i = 0; i < n_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    pthread_barrier_destroy(&s.start);
+    if (variant == MAGAZINE) {
+        MagazineAllocator_destroy(&s.magazine);
+    } else {
+        pthread_mutex_destroy(&s.lock);
+        SlabAllocator_destroy(&s.slab);
+    }
+    return (double)n_threads * OPS_PER_THREAD / elapsed / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = (argc > 1) ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (max_threads < 1) max_threads = 1;
+
+    printf("Magazine layer scaling, %d ops per thread, %d live objects per thread\n",
+           OPS_PER_THREAD, BATCH);
+    printf("%8s %16s %10s %16s %10s\n", "threads", "mutex Mops/s", "scaling", "magazine Mops/s", "scaling");
+    double mutex_base = 0, magazine_base = 0;
+    for (int t = 1; t <= max_threads; t *= 2) {
+        double mutex = run(GLOBAL_MUTEX, t);
+        double magazine = run(MAGAZINE, t);
+        if (t == 1) {
+            mutex_base = mutex;
+            magazine_base = magazine;
+        }
+        printf("%8d %16.2f %9.2fx %16.2f %9.2fx\n", t,
+               mutex, mutex / mutex_base, magazine, magazine / magazine_base);
+        if (t < max_threads && t * 2 > max_threads) t = max_threads / 2; // Always end on max_threads
+    }
+    return 0;
+}
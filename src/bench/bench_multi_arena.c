@@ -0,0 +1,139 @@
+// Producer/consumer pipelines: every block is allocated by a producer thread and
+// released by its consumer. MultiArenaAllocator (remote releases on a lock-free
+// stack) against a BitmapBuddyAllocator behind one global mutex, on 1 to max_pairs pairs
+// Usage: ./bin/bench_multi_arena [max_pairs] [arenas]
+#include <multi_arena_allocator.h>
+#include <helpers/timing.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define ARENA_SIZE ((size_t)1 << 24)
+#define NUM_LEVELS 18 // 64B min blocks
+#define ITEMS_PER_PAIR 500000 // Blocks passed from each producer to its consumer
+#define RING_SIZE 256 // Blocks in flight per pair, a power of two
+
+enum Variant { GLOBAL_MUTEX, MULTI_ARENA };
+
+struct Shared {
+    enum Variant variant;
+    BitmapBuddyAllocator buddy;
+    pthread_mutex_t lock;
+    MultiArenaAllocator multi;
+    pthread_barrier_t start;
+};
+
+// Single producer, single consumer ring
+struct Pipe {
+    struct Shared* shared;
+    void* slots[RING_SIZE];
+    size_t head __attribute__((aligned(64))); // Only the producer stores it
+    size_t tail __attribute__((aligned(64))); // Only the consumer stores it
+};
+
+static inline void* bench_alloc(struct Shared* s, size_t size) {
+    if (s->variant == MULTI_ARENA) return MultiArenaAllocator_malloc(&s->multi, size);
+    pthread_mutex_lock(&s->lock);
+    void* p = BitmapBuddyAllocator_malloc(&s->buddy, size);
+    pthread_mutex_unlock(&s->lock);
+    return p;
+}
+
+static inline void bench_free(struct Shared* s, void* p) {
+    if (s->variant == MULTI_ARENA) {
+        MultiArenaAllocator_free(&s->multi, p);
+        return;
+    }
+    pthread_mutex_lock(&s->lock);
+    BitmapBuddyAllocator_free(&s->buddy, p);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void* producer(void* arg) {
+    struct Pipe* pipe = (struct Pipe*)arg;
+    pthread_barrier_wait(&pipe->shared->start);
+    for (int i = 0; i < ITEMS_PER_PAIR; i++) {
+        char* p = bench_alloc(pipe->shared, 32 + (size_t)((i * 37) % 1000));
+        *(volatile char*)p = (char)i; // Touch the block
+        while (pipe->head - __atomic_load_n(&pipe->tail, __ATOMIC_ACQUIRE) == RING_SIZE) sched_yield();
+        pipe->slots[pipe->head % RING_SIZE] = p;
+        __atomic_store_n(&pipe->head, pipe->head + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg) {
+    struct Pipe* pipe = (struct Pipe*)arg;
+    pthread_barrier_wait(&pipe->shared->start);
+    for (int i = 0; i < ITEMS_PER_PAIR; i++) {
+        while (__atomic_load_n(&pipe->head, __ATOMIC_ACQUIRE) == pipe->tail) sched_yield();
+        void* p = pipe->slots[pipe->tail % RING_SIZE];
+        __atomic_store_n(&pipe->tail, pipe->tail + 1, __ATOMIC_RELEASE);
+        bench_free(pipe->shared, p);
+    }
+    return NULL;
+}
+
+// Returns millions of blocks passed per second
+static double run(enum Variant variant, int n_pairs, int arenas) {
+    struct Shared s;
+    s.variant = variant;
+    if (variant == MULTI_ARENA) {
+        MultiArenaAllocator_create(&s.multi, ARENA_SIZE, NUM_LEVELS, arenas);
+    } else {
+        // As much memory as all the arenas together
+        BitmapBuddyAllocator_create(&s.buddy, ARENA_SIZE * arenas, NUM_LEVELS + __builtin_ctz(arenas));
+        pthread_mutex_init(&s.lock, NULL);
+    }
+    pthread_barrier_init(&s.start, NULL, 2 * n_pairs + 1);
+
+    struct Pipe* pipes = calloc(n_pairs, sizeof(struct Pipe));
+    pthread_t threads[2 * n_pairs];
+    for (int i = 0; i < n_pairs; i++) {
+        pipes[i].shared = &s;
+        pthread_create(&threads[2 * i], NULL, producer, &pipes[i]);
+        pthread_create(&threads[2 * i + 1], NULL, consumer, &pipes[i]);
+    }
+    double start = now_seconds();
+    pthread_barrier_wait(&s.start);
+    for (int i = 0; i < 2 * n_pairs; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    free(pipes);
+    pthread_barrier_destroy(&s.start);
+    if (variant == MULTI_ARENA) {
+        MultiArenaAllocator_destroy(&s.multi);
+    } else {
+        pthread_mutex_destroy(&s.lock);
+        BitmapBuddyAllocator_destroy(&s.buddy);
+    }
+    return (double)n_pairs * ITEMS_PER_PAIR / elapsed / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int max_pairs = (argc > 1) ? atoi(argv[1]) : 8;
+    int arenas = (argc > 2) ? atoi(argv[2]) : MULTI_ARENA_MAX_ARENAS;
+    if (max_pairs < 1) max_pairs = 1;
+    if (arenas < 1 || arenas > MULTI_ARENA_MAX_ARENAS || (arenas & (arenas - 1)) != 0) {
+        arenas = MULTI_ARENA_MAX_ARENAS; // A power of two, so the mutex variant gets the same memory
+    }
+
+    printf("Producer/consumer pipelines, %d blocks per pair, %d in flight per pair, %d arenas, %ld cores\n",
+           ITEMS_PER_PAIR, RING_SIZE, arenas, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%8s %16s %10s %16s %10s\n", "pairs", "mutex Mblk/s", "scaling", "arenas Mblk/s", "scaling");
+    double mutex_base = 0, multi_base = 0;
+    for (int p = 1; p <= max_pairs; p *= 2) {
+        double mutex = run(GLOBAL_MUTEX, p, arenas);
+        double multi = run(MULTI_ARENA, p, arenas);
+        if (p == 1) {
+            mutex_base = mutex;
+            multi_base = multi;
+        }
+        printf("%8d %16.2f %9.2fx %16.2f %9.2fx\n", p,
+               mutex, mutex / mutex_base, multi, multi / multi_base);
+        if (p < max_pairs && p * 2 > max_pairs) p = max_pairs / 2; // Always end on max_pairs
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+// Large buffers allocated and released in a loop: region cache against plain mmap/munmap
+// Usage: ./bin/bench_pseudo [size]
+#include <pseudo_allocator.h>
+#include <helpers/timing.h>
+#include <string.h>
+
+#define ROUNDS 20000
+#define LIVE 4 // Buffers alive at the same time
+
+// Returns ns per malloc/free pair, each buffer is written once per page
+static double run(PseudoAllocator* a, size_t size) {
+    void* live[LIVE] = {0};
+    double start = now_seconds();
+    for (int r = 0; r < ROUNDS; r++) {
+        int i = r % LIVE;
+        if (live[i]) PseudoAllocator_free(a, live[i]);
+        char* buf = PseudoAllocator_malloc(a, size + (size_t)(r % 7) * 64); // Sizes vary a little
+        for (size_t off = 0; off < size; off += a->page_size) buf[off] = (char)r;
+        live[i] = buf;
+    }
+    for (int i = 0; i < LIVE; i++) PseudoAllocator_free(a, live[i]);
+    return (now_seconds() - start) * 1e9 / ROUNDS;
+}
+
+int main(int argc, char* argv[]) {
+    size_t size = (argc > 1) ? strtoul(argv[1], NULL, 10) : 65536;
+    if (size < 1024 || size > (1 << 26)) size = 65536;
+
+    printf("%d rounds of %zu byte buffers, %d alive\n", ROUNDS, size, LIVE);
+    printf("%-14s %12s %10s %10s\n", "region cache", "ns/round", "hits", "misses");
+    for (int cached = 0; cached <= 1; cached++) {
+        PseudoAllocator a;
+        PseudoAllocator_create(&a, PSEUDO_BUDDY_MEMORY, PSEUDO_BUDDY_LEVELS);
+        if (!cached) a.cache_max_bytes = 0;
+        double ns = run(&a, size);
+        printf("%-14s %12.0f %10zu %10zu\n", cached ? "on" : "off", ns, a.cache_hits, a.cache_misses);
+        PseudoAllocator_destroy(&a);
+    }
+    return 0;
+}
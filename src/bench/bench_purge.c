@@ -0,0 +1,86 @@
+// Resident memory of a BuddyAllocator after a spike: a burst of large blocks is
+// allocated and released, then the heap idles with small requests only.
+// Without purging the spike stays resident, with decay it goes back to the kernel
+// once decay_ms has passed, BuddyAllocator_purge returns it at once.
+// Usage: ./bin/bench_purge [decay_ms]
+#include <buddy_allocator.h>
+#include <helpers/timing.h>
+#include <unistd.h>
+
+#define MEMORY_SIZE ((size_t)1 << 28)
+#define NUM_LEVELS 18 // 1 KiB min blocks
+#define SPIKE_BLOCKS 1500 // Blocks of 4 KiB to 256 KiB, about 100 MiB in total
+#define IDLE_SECONDS 0.5
+
+enum Mode { NEVER, DECAY, PURGE };
+static const char* mode_names[] = {"never", "decay", "purge"};
+
+// Resident bytes of the process
+static size_t resident_bytes(void) {
+    long pages = 0, resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(statm);
+    return (size_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+// Allocate and touch the spike, returns the seconds it took
+static double spike(BuddyAllocator* buddy, char** blocks) {
+    double start = now_seconds();
+    for (int i = 0; i < SPIKE_BLOCKS; i++) {
+        size_t size = ((size_t)4096 << (i % 7)) - BUDDY_METADATA_SIZE;
+        blocks[i] = BuddyAllocator_malloc(buddy, size);
+        if (blocks[i]) memset(blocks[i], i, size);
+    }
+    return now_seconds() - start;
+}
+
+static void release(BuddyAllocator* buddy, char** blocks) {
+    for (int i = 0; i < SPIKE_BLOCKS; i++) {
+        if (blocks[i]) BuddyAllocator_free(buddy, blocks[i]);
+    }
+}
+
+static void run(enum Mode mode, long decay_ms) {
+    static char* blocks[SPIKE_BLOCKS];
+    BuddyAllocator buddy;
+    size_t base = resident_bytes();
+    BuddyAllocator_create(&buddy, MEMORY_SIZE, NUM_LEVELS);
+    BuddyAllocator_set_decay(&buddy, mode == DECAY ? decay_ms : -1);
+
+    spike(&buddy, blocks);
+    size_t peak = resident_bytes() - base;
+    release(&buddy, blocks);
+    size_t released = resident_bytes() - base;
+
+    // Idle: small requests only, they drive the decay
+    if (mode == PURGE) BuddyAllocator_purge(&buddy);
+    double idle_end = now_seconds() + IDLE_SECONDS;
+    while (now_seconds() < idle_end) {
+        void* p = BuddyAllocator_malloc(&buddy, 64);
+        *(volatile char*)p = 1;
+        BuddyAllocator_free(&buddy, p);
+    }
+    size_t idle = resident_bytes() - base;
+
+    // The next spike faults the purged pages back in
+    double again = spike(&buddy, blocks);
+    release(&buddy, blocks);
+    size_t purged = buddy.purged_bytes;
+    BuddyAllocator_destroy(&buddy);
+
+    printf("%8s %12.1f %12.1f %12.1f %14.2f %12.1f\n", mode_names[mode], peak / 1048576.0,
+           released / 1048576.0, idle / 1048576.0, again * 1000, purged / 1048576.0);
+}
+
+int main(int argc, char* argv[]) {
+    long decay_ms = (argc > 1) ? atol(argv[1]) : 100;
+    if (decay_ms < 0) decay_ms = 0;
+    printf("Spike of %d blocks, then %.1f s of small requests, decay %ld ms\n", SPIKE_BLOCKS, IDLE_SECONDS, decay_ms);
+    printf("%8s %12s %12s %12s %14s %12s\n", "purging", "peak MiB", "freed MiB", "idle MiB", "respike ms", "purged MiB");
+    run(NEVER, decay_ms);
+    run(DECAY, decay_ms);
+    run(PURGE, decay_ms);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Eager against deferred coalescing (quick lists) in BuddyAllocator and BitmapBuddyAllocator.
+// Ping-pong: one block of a fixed size allocated and released over and over, eager
+// coalescing merges it up to the largest free block and splits it back down every time.
+// Bursts: a batch of blocks of the same size allocated, then released in order
+// Usage: ./bin/bench_quick_lists [block_size] [quick_blocks]
+#include <buddy_allocator.h>
+#include <bitmap_buddy_allocator.h>
+#include <helpers/timing.h>
+
+#define MEMORY_SIZE ((size_t)1 << 24)
+#define NUM_LEVELS 16 // 256B min blocks
+#define PING_PONG_ROUNDS 2000000
+#define BURST_SIZE 48
+#define BURST_ROUNDS 40000
+
+enum Kind { BUDDY, BITMAP_BUDDY };
+static const char* kind_names[] = {"BuddyAllocator", "BitmapBuddyAllocator"};
+
+union Arena {
+    BuddyAllocator buddy;
+    BitmapBuddyAllocator bitmap;
+};
+
+// Returns nanoseconds per malloc/free pair
+static double ping_pong(Allocator* a, size_t size) {
+    double start = now_seconds();
+    for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+        void* p = a->malloc(a, size);
+        *(volatile char*)p = (char)i;
+        a->free(a, p);
+    }
+    return (now_seconds() - start) * 1e9 / PING_PONG_ROUNDS;
+}
+
+static double bursts(Allocator* a, size_t size) {
+    void* blocks[BURST_SIZE];
+    double start = now_seconds();
+    for (int r = 0; r < BURST_ROUNDS; r++) {
+        for (int i = 0; i < BURST_SIZE; i++) blocks[i] = a->malloc(a, size);
+        for (int i = 0; i < BURST_SIZE; i++) a->free(a, blocks[i]);
+    }
+    return (now_seconds() - start) * 1e9 / ((double)BURST_ROUNDS * BURST_SIZE);
+}
+
+static void run(enum Kind kind, size_t size, uint quick_blocks) {
+    double results[2][2];
+    for (int deferred = 0; deferred < 2; deferred++) {
+        union Arena u;
+        Allocator* a = (Allocator*)&u;
+        if (kind == BUDDY) {
+            BuddyAllocator_create(&u.buddy, MEMORY_SIZE, NUM_LEVELS);
+            BuddyAllocator_set_decay(&u.buddy, -1);
+            BuddyAllocator_set_quick_lists(&u.buddy, deferred ? quick_blocks : 0);
+        } else {
+            BitmapBuddyAllocator_create(&u.bitmap, MEMORY_SIZE, NUM_LEVELS);
+            BitmapBuddyAllocator_set_quick_lists(&u.bitmap, deferred ? quick_blocks : 0);
+        }
+        // One live block far away, so the arena is split from the root down
+        void* live = a->malloc(a, size);
+        results[deferred][0] = ping_pong(a, size);
+        results[deferred][1] = bursts(a, size);
+        a->free(a, live);
+        a->dest(a);
+    }
+    printf("%22s %14.1f %14.1f %9.2fx %14.1f %14.1f %9.2fx\n", kind_names[kind],
+           results[0][0], results[1][0], results[0][0] / results[1][0],
+           results[0][1], results[1][1], results[0][1] / results[1][1]);
+}
+
+int main(int argc, char* argv[]) {
+    size_t size = (argc > 1) ? (size_t)atol(argv[1]) : 200;
+    uint quick_blocks = (argc > 2) ? (uint)atoi(argv[2]) : 64;
+    if (size == 0 || size > MEMORY_SIZE / 4) size = 200;
+    if (quick_blocks == 0) quick_blocks = 64;
+
+    printf("Blocks of %zu bytes, quick lists of up to %u blocks, ns per malloc/free pair\n", size, quick_blocks);
+    printf("%22s %14s %14s %10s %14s %14s %10s\n", "allocator", "ping eager", "ping quick", "speedup",
+           "burst eager", "burst quick", "speedup");
+    run(BUDDY, size, quick_blocks);
+    run(BITMAP_BUDDY, size, quick_blocks);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Growing buffers: realloc in place against malloc, copy and free
+// Usage: ./bin/bench_realloc [max_size]
+#include <buddy_allocator.h>
+#include <bitmap_buddy_allocator.h>
+#include <helpers/timing.h>
+#include <string.h>
+
+#define ROUNDS 20000
+#define START_SIZE 24
+
+static size_t in_place;
+static size_t grows;
+
+// Grow one buffer 1.5x at a time up to max_size, returns ns per round
+static double run(Allocator* alloc, size_t max_size, bool use_realloc) {
+    in_place = grows = 0;
+    double start = now_seconds();
+    for (int r = 0; r < ROUNDS; r++) {
+        size_t size = START_SIZE;
+        char* buf = alloc->malloc(alloc, size);
+        memset(buf, 1, size);
+        while (size < max_size) {
+            size_t new_size = size + size / 2;
+            char* grown;
+            if (use_realloc) {
+                grown = Allocator_realloc(alloc, buf, new_size);
+            } else {
+                grown = alloc->malloc(alloc, new_size);
+                memcpy(grown, buf, size);
+                alloc->free(alloc, buf);
+            }
+            in_place += (grown == buf);
+            grows++;
+            buf = grown;
+            memset(buf + size, 1, new_size - size);
+            size = new_size;
+        }
+        alloc->free(alloc, buf);
+    }
+    return (now_seconds() - start) * 1e9 / ROUNDS;
+}
+
+static void report(const char* name, Allocator* alloc, size_t max_size) {
+    double copy = run(alloc, max_size, false);
+    double realloc_ns = run(alloc, max_size, true);
+    printf("%-14s %16.2f %16.2f %13.1f%%\n", name, copy, realloc_ns, 100.0 * in_place / grows);
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_size = (argc > 1) ? strtoul(argv[1], NULL, 10) : 32768;
+    if (max_size < START_SIZE || max_size > (1 << 20)) max_size = 32768;
+
+    printf("Buffer grown 1.5x from %d to %zu bytes, %d rounds\n", START_SIZE, max_size, ROUNDS);
+    printf("%-14s %16s %16s %14s\n", "allocator", "copy ns", "realloc ns", "in place");
+
+    BuddyAllocator buddy;
+    BuddyAllocator_create(&buddy, 1 << 22, 16);
+    void* pinned = BuddyAllocator_malloc(&buddy, 1); // The buffer does not start at the root
+    report("buddy", (Allocator*)&buddy, max_size);
+    BuddyAllocator_free(&buddy, pinned);
+    BuddyAllocator_destroy(&buddy);
+
+    BitmapBuddyAllocator bitmap;
+    BitmapBuddyAllocator_create(&bitmap, 1 << 22, 16);
+    pinned = BitmapBuddyAllocator_malloc(&bitmap, 1);
+    report("bitmap buddy", (Allocator*)&bitmap, max_size);
+    BitmapBuddyAllocator_free(&bitmap, pinned);
+    BitmapBuddyAllocator_destroy(&bitmap);
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Effect of slot alignment and chunk coloring on object-touching workloads
+// Usage: ./bin/bench_slab_alignment [threads]
+#include <slab_allocator.h>
+#include <slab_cache.h>
+#include <helpers/timing.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define NUM_OBJECTS (1 << 18) // 16MB of 64-byte slots, larger than the last level cache
+#define OBJECT_SIZE 48
+#define PASSES 8
+#define COLOR_OBJECT_SIZE 320 // Leaves 4 colors of slack in a 4KB chunk
+#define COLOR_CHUNKS 32 // Hot objects, one per chunk
+#define COLOR_ROUNDS 200000
+#define COUNTER_INCREMENTS 50000000
+
+// Random order defeats the hardware prefetcher
+static void shuffle(uint32_t* order, size_t n) {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < n; i++) order[i] = (uint32_t)i;
+    for (size_t i = n - 1; i > 0; i--) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        size_t j = state % (i + 1);
+        uint32_t tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+    }
+}
+
+// Touch every byte of every object in random order, returns ns per object
+static double touch_objects(SlabMode mode, size_t alignment, double* straddling) {
+    SlabAllocator slab;
+    if (!SlabAllocator_create_aligned(&slab, OBJECT_SIZE, NUM_OBJECTS, mode, alignment)) return -1;
+    char** objects = malloc(NUM_OBJECTS * sizeof(char*));
+    uint32_t* order = malloc(NUM_OBJECTS * sizeof(uint32_t));
+    size_t crossing = 0;
+    for (size_t i = 0; i < NUM_OBJECTS; i++) {
+        objects[i] = SlabAllocator_malloc(&slab);
+        memset(objects[i], (int)i, OBJECT_SIZE);
+        uintptr_t start = (uintptr_t)objects[i];
+        crossing += (start / CACHE_LINE_SIZE) != ((start + OBJECT_SIZE - 1) / CACHE_LINE_SIZE);
+    }
+    *straddling = 100.0 * crossing / NUM_OBJECTS;
+    shuffle(order, NUM_OBJECTS);
+
+    uint64_t sum = 0;
+    double start = now_seconds();
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (size_t i = 0; i < NUM_OBJECTS; i++) {
+            uint64_t* o = (uint64_t*)objects[order[i]];
+            for (size_t w = 0; w < OBJECT_SIZE / sizeof(uint64_t); w++) {
+                sum += o[w];
+                o[w] = sum;
+            }
+        }
+    }
+    double elapsed = now_seconds() - start;
+    if (sum == 42) printf(" "); // Keep the loop
+
+    free(order);
+    free(objects);
+    SlabAllocator_destroy(&slab);
+    return elapsed * 1e9 / ((double)PASSES * NUM_OBJECTS);
+}
+
+// Repeatedly touch the first object of hot_chunks chunks, returns ns per touch
+static double touch_chunk_heads(bool coloring, int hot_chunks, uint* num_colors) {
+    SlabCache cache;
+    if (!SlabCache_create_aligned(&cache, COLOR_OBJECT_SIZE, 1, 0, CACHE_LINE_SIZE, coloring)) return -1;
+    *num_colors = cache.num_colors;
+    size_t n = (size_t)hot_chunks * cache.objects_per_chunk;
+    char** objects = malloc(n * sizeof(char*));
+    volatile uint64_t* heads[COLOR_CHUNKS * 2];
+    for (size_t i = 0; i < n; i++) {
+        objects[i] = SlabCache_malloc(&cache);
+        memset(objects[i], 0, COLOR_OBJECT_SIZE);
+    }
+    for (int c = 0; c < hot_chunks; c++) {
+        heads[c] = (volatile uint64_t*)objects[(size_t)c * cache.objects_per_chunk];
+    }
+
+    double start = now_seconds();
+    for (int r = 0; r < COLOR_ROUNDS; r++) {
+        for (int c = 0; c < hot_chunks; c++) {
+            heads[c][0]++;
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    for (size_t i = 0; i < n; i++) SlabCache_free(&cache, objects[i]);
+    free(objects);
+    SlabCache_destroy(&cache);
+    return elapsed * 1e9 / ((double)COLOR_ROUNDS * hot_chunks);
+}
+
+struct CounterArgs {
+    volatile uint64_t* counter;
+    pthread_barrier_t* start;
+};
+
+static void* increment(void* arg) {
+    struct CounterArgs* args = (struct CounterArgs*)arg;
+    pthread_barrier_wait(args->start);
+    for (int i = 0; i < COUNTER_INCREMENTS; i++) {
+        (*args->counter)++;
+    }
+    return NULL;
+}
+
+// One counter per thread, allocated back to back from the same slab, returns seconds
+static double false_sharing(size_t alignment, int n_threads) {
+    SlabAllocator slab;
+    if (!SlabAllocator_create_aligned(&slab, sizeof(uint64_t), n_threads, SLAB_MODE_EMBEDDED, alignment)) return -1;
+    pthread_t threads[n_threads];
+    struct CounterArgs args[n_threads];
+    pthread_barrier_t start_barrier;
+    pthread_barrier_init(&start_barrier, NULL, n_threads + 1);
+    for (int t = 0; t < n_threads; t++) {
+        args[t].counter = SlabAllocator_malloc(&slab);
+        *args[t].counter = 0;
+        args[t].start = &start_barrier;
+        pthread_create(&threads[t], NULL, increment, &args[t]);
+    }
+    double start = now_seconds();
+    pthread_barrier_wait(&start_barrier);
+    for (int t = 0; t < n_threads; t++) pthread_join(threads[t], NULL);
+    double elapsed = now_seconds() - start;
+    pthread_barrier_destroy(&start_barrier);
+    SlabAllocator_destroy(&slab);
+    return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    int n_threads = (argc > 1) ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_threads < 2) n_threads = 2;
+
+    printf("Object touching: %d objects of %d bytes, %d passes in random order\n",
+           NUM_OBJECTS, OBJECT_SIZE, PASSES);
+    printf("%-28s %10s %14s\n", "layout", "ns/object", "straddling %");
+    struct { const char* name; SlabMode mode; size_t alignment; } layouts[] = {
+        {"list (header, 72B slots)", SLAB_MODE_LIST, 0},
+        {"embedded packed (48B)", SLAB_MODE_EMBEDDED, 0},
+        {"embedded aligned 64 (64B)", SLAB_MODE_EMBEDDED, CACHE_LINE_SIZE},
+    };
+    for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+        double straddling = 0;
+        double ns = touch_objects(layouts[i].mode, layouts[i].alignment, &straddling);
+        printf("%-28s %10.2f %13.1f%%\n", layouts[i].name, ns, straddling);
+    }
+
+    printf("\nChunk coloring: first object of N chunks touched %d times\n", COLOR_ROUNDS);
+    printf("%8s %16s %16s\n", "chunks", "uncolored ns", "colored ns");
+    uint colors = 1;
+    for (int hot = 8; hot <= COLOR_CHUNKS * 2; hot *= 2) {
+        uint unused;
+        double plain = touch_chunk_heads(false, hot, &unused);
+        double colored = touch_chunk_heads(true, hot, &colors);
+        printf("%8d %16.2f %16.2f\n", hot, plain, colored);
+    }
+    printf("(%u colors)\n", colors);
+
+    printf("\nFalse sharing: %d threads, %d increments each on adjacent counters\n",
+           n_threads, COUNTER_INCREMENTS);
+    double packed = false_sharing(0, n_threads);
+    double aligned = false_sharing(CACHE_LINE_SIZE, n_threads);
+    printf("%-28s %10.3f s\n", "packed (8B slots)", packed);
+    printf("%-28s %10.3f s\n", "aligned 64 (64B slots)", aligned);
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+        printf("Only one CPU online: threads do not run concurrently, no false sharing to observe\n");
+    }
+    return 0;
+}
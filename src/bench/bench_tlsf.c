@@ -0,0 +1,165 @@
+// TlsfAllocator against BuddyAllocator on the same requests: the .alloc traces given on
+// the command line (their memory size and levels), then a synthetic workload with the
+// sizes of benchmark_generator.py, a power of two +- 25%. Reports the failed requests,
+// the internal fragmentation (share of the occupied memory, averaged after every request,
+// and its peak) and the time per request, average and worst, on the second pass
+// Usage: ./bin/bench_tlsf [trace.alloc ...]
+#include <buddy_allocator.h>
+#include <tlsf_allocator.h>
+#include <helpers/timing.h>
+
+#define MAX_POINTERS 65536
+#define SYNTHETIC_MEMORY ((size_t)1 << 24)
+#define SYNTHETIC_LEVELS 17 // 256B min blocks
+#define SYNTHETIC_LIVE 3000
+#define SYNTHETIC_REQUESTS 400000
+
+typedef struct {
+    bool allocate;
+    int index;
+    size_t size;
+} Request;
+
+typedef struct {
+    size_t failed;
+    double waste; // Average internal fragmentation over occupied memory
+    size_t peak_fragmentation;
+    double average_ns;
+    double worst_ns;
+} Result;
+
+union Arena {
+    BuddyAllocator buddy;
+    TlsfAllocator tlsf;
+};
+
+// Requests of a trace, NULL if it cannot be read
+static Request* load_trace(const char* path, size_t* n, size_t* memory_size, int* levels) {
+    FILE* f = fopen(path, "r");
+    if (!f) return NULL;
+    size_t capacity = 1024;
+    Request* requests = malloc(capacity * sizeof(Request));
+    char line[256];
+    *n = 0;
+    *levels = 0;
+    while (fgets(line, sizeof(line), f)) {
+        Request r = {false, 0, 0};
+        if (line[0] == 'p') {
+            sscanf(line, "p,%zu,%d", memory_size, levels);
+            continue;
+        }
+        if (sscanf(line, "a,%d,%zu", &r.index, &r.size) == 2) {
+            r.allocate = true;
+        } else if (sscanf(line, "f,%d", &r.index) != 1) {
+            continue;
+        }
+        if (r.index < 0 || r.index >= MAX_POINTERS) continue;
+        if (*n == capacity) requests = realloc(requests, (capacity *= 2) * sizeof(Request));
+        requests[(*n)++] = r;
+    }
+    fclose(f);
+    return requests;
+}
+
+static Request* synthetic(size_t* n) {
+    static bool live[SYNTHETIC_LIVE];
+    Request* requests = malloc(SYNTHETIC_REQUESTS * sizeof(Request));
+    uint64_t x = 88172645463325252ULL;
+    for (*n = 0; *n < SYNTHETIC_REQUESTS; (*n)++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        int i = x % SYNTHETIC_LIVE;
+        size_t base = (size_t)64 << ((x >> 20) % 8); // 64 to 8192 bytes
+        requests[*n] = (Request){!live[i], i, base + (x >> 32) % (base / 2 + 1) - base / 4};
+        live[i] = !live[i];
+    }
+    for (int i = 0; i < SYNTHETIC_LIVE; i++) {
+        if (live[i]) requests = realloc(requests, (*n + 1) * sizeof(Request)), requests[(*n)++] = (Request){false, i, 0};
+    }
+    return requests;
+}
+
+static Result replay(Allocator* a, const Request* requests, size_t n) {
+    static void* pointers[MAX_POINTERS];
+    static size_t sizes[MAX_POINTERS];
+    VariableBlockAllocator* counters = (VariableBlockAllocator*)a;
+    Result result = {0, 0, 0, 0, 0};
+    size_t live = 0, samples = 0;
+    double total = 0;
+    memset(pointers, 0, sizeof(pointers));
+    for (size_t i = 0; i < n; i++) {
+        const Request* r = &requests[i];
+        double start = now_seconds();
+        if (r->allocate && !pointers[r->index]) {
+            pointers[r->index] = a->malloc(a, r->size);
+            if (pointers[r->index]) {
+                sizes[r->index] = r->size;
+                live += r->size;
+            } else {
+                result.failed++;
+            }
+        } else if (!r->allocate && pointers[r->index]) {
+            a->free(a, pointers[r->index]);
+            pointers[r->index] = NULL;
+            live -= sizes[r->index];
+        }
+        double elapsed = (now_seconds() - start) * 1e9;
+        total += elapsed;
+        if (elapsed > result.worst_ns) result.worst_ns = elapsed;
+        if (live > 0) {
+            result.waste += (double)counters->internal_fragmentation / (live + counters->internal_fragmentation);
+            samples++;
+        }
+        if (counters->internal_fragmentation > result.peak_fragmentation) {
+            result.peak_fragmentation = counters->internal_fragmentation;
+        }
+    }
+    for (int i = 0; i < MAX_POINTERS; i++) {
+        if (pointers[i]) a->free(a, pointers[i]);
+    }
+    result.waste = samples ? result.waste * 100 / samples : 0;
+    result.average_ns = total / n;
+    return result;
+}
+
+static void compare(const char* name, const Request* requests, size_t n, size_t memory_size, int levels) {
+    union Arena u;
+    Result results[2];
+    printf("%s: %zu requests, %zu bytes\n", name, n, memory_size);
+    for (int tlsf = 0; tlsf < 2; tlsf++) {
+        if (tlsf ? !TlsfAllocator_create(&u.tlsf, memory_size) : !BuddyAllocator_create(&u.buddy, memory_size, levels)) {
+            printf("Failed to create the allocator\n");
+            return;
+        }
+        replay((Allocator*)&u, requests, n); // The first pass faults the pages in
+        results[tlsf] = replay((Allocator*)&u, requests, n);
+        ((Allocator*)&u)->dest((Allocator*)&u);
+    }
+    for (int tlsf = 0; tlsf < 2; tlsf++) {
+        printf("%18s %8zu %10.1f %12zu %10.1f %10.0f\n", tlsf ? "TlsfAllocator" : "BuddyAllocator", results[tlsf].failed,
+               results[tlsf].waste, results[tlsf].peak_fragmentation, results[tlsf].average_ns, results[tlsf].worst_ns);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    printf("%18s %8s %10s %12s %10s %10s\n", "allocator", "failed", "waste %", "peak frag B", "avg ns", "worst ns");
+    for (int i = 1; i < argc; i++) {
+        size_t n, memory_size = 0;
+        int levels;
+        Request* requests = load_trace(argv[i], &n, &memory_size, &levels);
+        if (!requests || memory_size == 0 || levels <= 0) {
+            printf("%s: not a buddy trace\n", argv[i]);
+            free(requests);
+            continue;
+        }
+        compare(argv[i], requests, n, memory_size, levels);
+        free(requests);
+    }
+
+    size_t n;
+    Request* requests = synthetic(&n);
+    compare("power of two +- 25%", requests, n, SYNTHETIC_MEMORY, SYNTHETIC_LEVELS);
+    free(requests);
+    return 0;
+}
@@ -0,0 +1,41 @@
+// Reserve + release latency of BitmapBuddyAllocator and TreeBuddyAllocator by block size
+// Usage: ./bin/bench_tree_buddy [levels]
+#include <bitmap_buddy_allocator.h>
+#include <tree_buddy_allocator.h>
+#include <helpers/timing.h>
+
+#define ROUNDS 2000
+
+// ns per reserve + release of one block of size bytes (header included)
+static double run(Allocator* alloc, size_t size) {
+    double start = now_seconds();
+    for (int r = 0; r < ROUNDS; r++) {
+        void* p = alloc->malloc(alloc, size);
+        if (!p) return -1;
+        alloc->free(alloc, p);
+    }
+    return (now_seconds() - start) * 1e9 / ROUNDS;
+}
+
+int main(int argc, char* argv[]) {
+    int levels = (argc > 1) ? atoi(argv[1]) : 16;
+    if (levels < 4 || levels > 20) levels = 16;
+    size_t memory_size = (size_t)64 << levels;
+
+    BitmapBuddyAllocator bitmap;
+    TreeBuddyAllocator tree;
+    if (!BitmapBuddyAllocator_create(&bitmap, memory_size, levels)) return 1;
+    if (!TreeBuddyAllocator_create(&tree, memory_size, levels)) return 1;
+
+    printf("%zu bytes, %d levels, %d rounds\n", memory_size, levels, ROUNDS);
+    printf("%-14s %16s %16s\n", "block", "bitmap ns", "tree ns");
+    for (size_t block = 64; block <= memory_size; block <<= 2) {
+        size_t size = block - BITMAP_METADATA_SIZE;
+        printf("%-14zu %16.2f %16.2f\n", block,
+               run((Allocator*)&bitmap, size), run((Allocator*)&tree, size));
+    }
+
+    BitmapBuddyAllocator_destroy(&bitmap);
+    TreeBuddyAllocator_destroy(&tree);
+    return 0;
+}
@@ -1,14 +1,24 @@
 #include "bitmap_buddy_allocator.h"
+#include <helpers/memory_manipulation.h>
+#include <helpers/timing.h>
 #include <stdio.h>
 #include <assert.h>
 #include <math.h>
 #include <stdarg.h>
 #include <sys/mman.h>
 
+extern BitmapBuddyAllocator* BitmapBuddyAllocator_create_with_pages(BitmapBuddyAllocator* alloc, size_t memory_size,
+                                                                    int num_levels, ArenaPages pages);
 extern BitmapBuddyAllocator* BitmapBuddyAllocator_create(BitmapBuddyAllocator* buddy, size_t memory_size, int num_levels);
 extern int BitmapBuddyAllocator_destroy(BitmapBuddyAllocator* buddy);
 extern void* BitmapBuddyAllocator_malloc(BitmapBuddyAllocator* buddy, size_t size);
 extern int BitmapBuddyAllocator_free(BitmapBuddyAllocator* buddy, void* ptr);
+extern int BitmapBuddyAllocator_malloc_batch(BitmapBuddyAllocator* buddy, size_t n, const size_t* sizes, void** out);
+extern int BitmapBuddyAllocator_free_batch(BitmapBuddyAllocator* buddy, size_t n, void** ptrs);
+extern void* BitmapBuddyAllocator_realloc(BitmapBuddyAllocator* buddy, void* ptr, size_t size);
+extern size_t BitmapBuddyAllocator_usable_size(BitmapBuddyAllocator* buddy, void* ptr);
+extern void* BitmapBuddyAllocator_memalign(BitmapBuddyAllocator* buddy, size_t alignment, size_t size);
+extern void* BitmapBuddyAllocator_calloc(BitmapBuddyAllocator* buddy, size_t nmemb, size_t size);
 
 void print_user_pointer(int bitmap_idx, int num_levels, BitmapBuddyAllocator* buddy) {
     int level = (int)floor(log2(bitmap_idx + 1));
@@ -25,8 +35,11 @@ void print_user_pointer(int bitmap_idx, int num_levels, BitmapBuddyAllocator* bu
     printf("User pointer for bitmap index %d (level %d of %d): %p\n", bitmap_idx, level, num_levels, (void*)user_ptr);
 }
 
+#define QUICK_LISTED -2 // Metadata size of a block waiting in a quick list
+#define BITMAP_BUDDY_BATCH_WINDOW 64 // Released indices kept at once by a batch release
+
 static int levelIdx(size_t idx) {
-    return (int)floor(log2(idx+1));
+    return 63 - __builtin_clzll(idx + 1); // floor(log2(idx + 1))
 }
 
 static int buddyIdx(int idx) {
@@ -49,6 +62,183 @@ static int firstIdx(int level) {
 }
 
 
+// Metadata of the block at ptr (inside the arena). Aligned blocks start on a
+// minimum block boundary and keep it in aligned_meta, the others in a header
+static inline BitmapBuddyMetadata* metadata_of(BitmapBuddyAllocator* buddy, void* ptr) {
+    size_t offset = (char*)ptr - buddy->memory_start;
+    if (offset % buddy->min_block_size == 0) return &buddy->aligned_meta[offset / buddy->min_block_size];
+    if (offset < BITMAP_METADATA_SIZE) return NULL;
+    return (BitmapBuddyMetadata*)((char*)ptr - BITMAP_METADATA_SIZE);
+}
+
+// Metadata of an allocated block, NULL if ptr is not one
+static BitmapBuddyMetadata* allocated_meta(BitmapBuddyAllocator* buddy, void* ptr) {
+    if ((char*)ptr < buddy->memory_start || (char*)ptr >= buddy->memory_start + buddy->memory_size) {
+        return NULL;
+    }
+    BitmapBuddyMetadata* meta = metadata_of(buddy, ptr);
+    if (!meta) return NULL;
+    int idx = meta->bitmap_idx;
+    if (idx < 0 || idx >= firstIdx(buddy->num_levels + 1) || !bitmap_test(&buddy->bitmap, idx)) return NULL;
+    if (meta->size == QUICK_LISTED) return NULL;
+    int level = levelIdx(idx);
+    size_t full_block_size = buddy->min_block_size << (buddy->num_levels - level);
+    char* block_start = buddy->memory_start + (idx - firstIdx(level)) * full_block_size;
+    bool headerless = (char*)meta + BITMAP_METADATA_SIZE != (char*)ptr;
+    if (block_start + (headerless ? 0 : BITMAP_METADATA_SIZE) != (char*)ptr) return NULL;
+    return meta;
+}
+
+// Raise the high-water mark to the end of a block being handed out
+static inline void mark_dirty(BitmapBuddyAllocator* buddy, char* block_start, size_t block_size) {
+    if (block_start + block_size > buddy->high_water) buddy->high_water = block_start + block_size;
+}
+
+static inline size_t block_size_of(BitmapBuddyAllocator* buddy, int level) {
+    return buddy->min_block_size << (buddy->num_levels - level);
+}
+
+static inline char* block_start_of(BitmapBuddyAllocator* buddy, int idx) {
+    int level = levelIdx(idx);
+    return buddy->memory_start + (size_t)(idx - firstIdx(level)) * block_size_of(buddy, level);
+}
+
+// Give the whole pages of a free range back to the kernel: they come back as zero pages.
+// Only runs of pages not already clean are advised, pages above the high-water mark
+// were never touched and are left alone
+static size_t purge_range(BitmapBuddyAllocator* buddy, char* range_start, char* range_end) {
+    if (buddy->backing == ARENA_BACKING_HUGETLB) return 0; // Pool pages only go back with the mapping
+    uintptr_t page_mask = buddy->page_size - 1;
+    char* start = (char*)(((uintptr_t)range_start + page_mask) & ~page_mask);
+    char* end = (char*)((uintptr_t)range_end & ~page_mask);
+    char* touched_end = (char*)(((uintptr_t)buddy->high_water + page_mask) & ~page_mask);
+    bool reaches_high_water = end >= touched_end;
+    if (reaches_high_water) end = touched_end;
+    if (start >= end) return 0;
+
+    size_t last = (end - buddy->memory_start) / buddy->page_size;
+    size_t page = (start - buddy->memory_start) / buddy->page_size;
+    size_t purged = 0;
+    while (page < last) {
+        if (page % 32 == 0 && page + 32 <= last && buddy->clean_pages.bits[page / 32] == ~0u) {
+            page += 32;
+            continue;
+        }
+        if (bitmap_test(&buddy->clean_pages, page)) {
+            page++;
+            continue;
+        }
+        size_t run = page;
+        while (page < last && !bitmap_test(&buddy->clean_pages, page)) page++;
+        if (madvise(buddy->memory_start + run * buddy->page_size, (page - run) * buddy->page_size, MADV_DONTNEED) != 0) {
+            reaches_high_water = false;
+            break;
+        }
+        for (size_t i = run; i < page; i++) bitmap_set(&buddy->clean_pages, i);
+        purged += (page - run) * buddy->page_size;
+    }
+    // Nothing above the range was touched: the mark comes down to its first purged page
+    if (reaches_high_water && start < buddy->high_water) buddy->high_water = start;
+    buddy->purged_bytes += purged;
+    return purged;
+}
+
+// Purge the free nodes of purge_level marked in dirty_old (in dirty_new too with all),
+// one range per run of adjacent nodes. Marks of nodes in use are dropped, their next
+// release marks them again. Without all, dirty_new becomes the old generation
+static size_t purge_dirty_nodes(BitmapBuddyAllocator* buddy, bool all) {
+    if (buddy->purge_level < 0) return 0;
+    size_t node_size = block_size_of(buddy, buddy->purge_level);
+    int first = firstIdx(buddy->purge_level);
+    char* run_start = NULL;
+    char* run_end = NULL;
+    size_t purged = 0;
+    for (int w = 0; w < buddy->dirty_old.num_words; w++) {
+        uint word = buddy->dirty_old.bits[w] | (all ? buddy->dirty_new.bits[w] : 0);
+        buddy->dirty_old.bits[w] = 0;
+        if (all) buddy->dirty_new.bits[w] = 0;
+        for (; word; word &= word - 1) {
+            int node = w * 32 + __builtin_ctz(word);
+            if (bitmap_test(&buddy->bitmap, first + node)) continue;
+            char* start = buddy->memory_start + (size_t)node * node_size;
+            if (start != run_end) {
+                if (run_start) purged += purge_range(buddy, run_start, run_end);
+                run_start = start;
+            }
+            run_end = start + node_size;
+        }
+    }
+    if (run_start) purged += purge_range(buddy, run_start, run_end);
+    if (!all) {
+        Bitmap emptied = buddy->dirty_old;
+        buddy->dirty_old = buddy->dirty_new;
+        buddy->dirty_new = emptied;
+    }
+    return purged;
+}
+
+// Decay pass: purge the free nodes released before the previous pass, then wait decay_ms.
+// A page is purged once it has been dirty for one to two periods
+static void decay(BitmapBuddyAllocator* buddy, double now) {
+    buddy->decay_ticks = 0;
+    if (now < buddy->next_decay) return;
+    buddy->next_decay = now + buddy->decay_ms / 1000.0;
+    purge_dirty_nodes(buddy, false);
+}
+
+// Top of the free block that contains the released block at idx
+static int free_top(BitmapBuddyAllocator* buddy, int idx) {
+    while (idx != 0 && !bitmap_test(&buddy->bitmap, parentIdx(idx))) idx = parentIdx(idx);
+    return idx;
+}
+
+// The block at idx was just released, and merged into the free block at top: its pages
+// are dirty and its nodes of purge_level join the new generation. A node already in the
+// old one stays there, so steady small traffic cannot keep postponing the purge of the
+// node that contains it. Without decay a free block of a page or more is purged at once
+// by check_purge, and is not marked
+static void note_dirty(BitmapBuddyAllocator* buddy, int idx, int top) {
+    int level = levelIdx(idx);
+    size_t block_size = block_size_of(buddy, level);
+    char* block_start = block_start_of(buddy, idx);
+    if (buddy->purged_bytes > 0) { // Nothing was ever purged otherwise
+        size_t first = (block_start - buddy->memory_start) / buddy->page_size;
+        size_t last = (block_start + block_size - 1 - buddy->memory_start) / buddy->page_size;
+        for (size_t page = first; page <= last; page++) bitmap_clear(&buddy->clean_pages, page);
+    }
+    if (buddy->purge_level < 0) return;
+    if (buddy->decay_ms == 0 && block_size_of(buddy, levelIdx(top)) >= buddy->page_size) return;
+
+    int offset = idx - firstIdx(level);
+    if (level >= buddy->purge_level) {
+        bitmap_set(&buddy->dirty_new, offset >> (level - buddy->purge_level));
+    } else {
+        int count = 1 << (buddy->purge_level - level);
+        for (int node = offset * count; node < (offset + 1) * count; node++) bitmap_set(&buddy->dirty_new, node);
+    }
+}
+
+// Purge or decay check for the free block at top, once its released blocks are noted.
+// Checks run when it spans a page, or every few small releases
+static void check_purge(BitmapBuddyAllocator* buddy, int top) {
+    if (buddy->purge_level < 0 || buddy->decay_ms < 0) return;
+    size_t top_size = block_size_of(buddy, levelIdx(top));
+    if (buddy->decay_ms == 0) {
+        if (top_size < buddy->page_size) return;
+        char* top_start = block_start_of(buddy, top);
+        purge_range(buddy, top_start, top_start + top_size);
+    } else if (top_size >= buddy->page_size || ++buddy->decay_ticks >= BITMAP_BUDDY_DECAY_TICKS) {
+        decay(buddy, now_seconds());
+    }
+}
+
+// The block at idx was just released and merged, and its header cleared
+static void note_released(BitmapBuddyAllocator* buddy, int idx) {
+    int top = free_top(buddy, idx);
+    note_dirty(buddy, idx, top);
+    check_purge(buddy, top);
+}
+
 static void update_parents(Bitmap* bitmap, int bit, int value) {
     
     if (value) {
@@ -82,6 +272,7 @@ void* BitmapBuddyAllocator_init(Allocator* alloc, ...) {
     BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
     size_t memory_size = va_arg(args, size_t);
     int num_levels = va_arg(args, int);
+    ArenaPages pages = (ArenaPages)va_arg(args, int);
     va_end(args);
     
     // Validate parameters
@@ -92,46 +283,71 @@ void* BitmapBuddyAllocator_init(Allocator* alloc, ...) {
         return NULL;
     }
     
+    // Initialize buddy allocator properties
+    size_t min_block_size = memory_size >> num_levels;
+    while (min_block_size < (BITMAP_METADATA_SIZE + 1) && num_levels > 0) {
+        num_levels--;
+        min_block_size = memory_size >> num_levels;
+    }
+    buddy->num_levels = num_levels;
+    buddy->min_block_size = min_block_size;
+    #ifdef DEBUG
+    printf("num_levels: %d\n", num_levels);
+    printf("min_block_size: %zu\n", min_block_size);
+    #endif
+
     // Calculate bitmap memory requirements
     int num_bits = (1 << (num_levels + 1)) - 1;
     size_t bitmap_size = ((num_bits + 31) / 32) * sizeof(uint32_t);
+    // Metadata of aligned blocks, one slot per minimum block (untouched pages cost nothing)
+    size_t aligned_meta_size = (memory_size / min_block_size) * BITMAP_METADATA_SIZE;
+    // Clean pages, and the two generations of dirty nodes at the deepest level of blocks of a page or more
+    buddy->page_size = sysconf(_SC_PAGESIZE);
+    int purge_level = num_levels;
+    while (purge_level >= 0 && (min_block_size << (num_levels - purge_level)) < buddy->page_size) purge_level--;
+    buddy->purge_level = purge_level;
+    int num_pages = (memory_size + buddy->page_size - 1) / buddy->page_size;
+    size_t clean_pages_size = ((num_pages + 31) / 32) * sizeof(uint);
+    size_t dirty_size = purge_level < 0 ? 0 : (((1 << purge_level) + 31) / 32) * sizeof(uint);
     
-    // Allocate memory for both buddy system and bitmap
-    size_t combined_size = memory_size + bitmap_size;
-    char* combined_memory = mmap(NULL, combined_size, PROT_READ | PROT_WRITE, 
-                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (combined_memory == MAP_FAILED) {
+    // Allocate memory for the buddy system, the bitmap, the aligned metadata and the page state
+    size_t bitmap_offset = (memory_size + 7) & ~(size_t)7;
+    buddy->mapping_size = bitmap_offset + bitmap_size + aligned_meta_size + clean_pages_size + 2 * dirty_size;
+    char* combined_memory = map_arena(buddy->mapping_size, pages, &buddy->backing);
+    if (!combined_memory) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to allocate memory\n" RESET);
         #endif
         return NULL;
     }
     
-    // Split the allocated memory into buddy memory and bitmap memory
+    // Split the allocated memory into buddy memory, bitmap memory and aligned metadata
     buddy->memory_start = combined_memory;
     buddy->memory_size = memory_size;
-    void* bitmap_memory = combined_memory + memory_size;
+    buddy->high_water = combined_memory;
+    memset(buddy->quick_lists, 0, sizeof(buddy->quick_lists));
+    memset(buddy->quick_counts, 0, sizeof(buddy->quick_counts));
+    buddy->quick_limit = 0;
+    void* bitmap_memory = combined_memory + bitmap_offset;
+    buddy->aligned_meta = (BitmapBuddyMetadata*)((char*)bitmap_memory + bitmap_size);
+    char* page_state = (char*)buddy->aligned_meta + aligned_meta_size;
+    bitmap_create(&buddy->clean_pages, num_pages, page_state);
+    if (purge_level >= 0) {
+        bitmap_create(&buddy->dirty_old, 1 << purge_level, page_state + clean_pages_size);
+        bitmap_create(&buddy->dirty_new, 1 << purge_level, page_state + clean_pages_size + dirty_size);
+    }
+    buddy->decay_ms = BITMAP_BUDDY_DEFAULT_DECAY_MS;
+    buddy->next_decay = 0;
+    buddy->decay_ticks = 0;
+    buddy->purged_bytes = 0;
 
     // Initialize fields of VariableBlockAllocator
     ((VariableBlockAllocator *) alloc)->internal_fragmentation = 0;
     ((VariableBlockAllocator *) alloc)->sparse_free_memory = memory_size;
     
-    // Initialize buddy allocator properties
-    size_t min_block_size = memory_size >> num_levels;
-    while (min_block_size < (BITMAP_METADATA_SIZE + 1) && num_levels > 0) {
-        num_levels--;
-        min_block_size = memory_size >> num_levels;
-    }
-    buddy->num_levels = num_levels;
-    buddy->min_block_size = min_block_size;
-    #ifdef DEBUG
-    printf("num_levels: %d\n", num_levels);
-    printf("min_block_size: %zu\n", min_block_size);
-    #endif
-    
     // Initialize bitmap
     if (!bitmap_create(&buddy->bitmap, num_bits, bitmap_memory)) {
-        munmap(combined_memory, combined_size);
+        unmap_arena(combined_memory, buddy->mapping_size, buddy->backing);
         #ifdef DEBUG
         printf(RED "ERROR: Failed to create bitmap\n" RESET);
         #endif
@@ -145,12 +361,21 @@ void* BitmapBuddyAllocator_init(Allocator* alloc, ...) {
     BitmapBuddyMetadata* meta = (BitmapBuddyMetadata*)buddy->memory_start;
     meta->bitmap_idx = -1;
     meta->size = -1;
+    // The other aligned slots stay zeroed: {0, 0} is the root, whose start is this one
+    buddy->aligned_meta[0].bitmap_idx = -1;
+    buddy->aligned_meta[0].size = -1;
     
     // Set up function pointers
     alloc->init = BitmapBuddyAllocator_init;
     alloc->dest = BitmapBuddyAllocator_cleanup;
     alloc->malloc = BitmapBuddyAllocator_reserve;
     alloc->free = BitmapBuddyAllocator_release;
+    alloc->malloc_batch = BitmapBuddyAllocator_reserve_batch;
+    alloc->free_batch = BitmapBuddyAllocator_release_batch;
+    alloc->realloc = BitmapBuddyAllocator_reallocate;
+    alloc->usable_size = BitmapBuddyAllocator_block_usable_size;
+    alloc->memalign = BitmapBuddyAllocator_reserve_aligned;
+    alloc->calloc = BitmapBuddyAllocator_callocate;
     
     return buddy;
 }
@@ -165,25 +390,102 @@ void* BitmapBuddyAllocator_cleanup(Allocator* alloc, ...) {
     }
     
     if (buddy->memory_start) {
-        // Calculate total allocated size (buddy memory + bitmap)
-        int num_bits = (1 << (buddy->num_levels + 1)) - 1;
-        size_t bitmap_size = ((num_bits + 31) / 32) * sizeof(uint32_t);
-        size_t memory_size = buddy->memory_size + bitmap_size;
-        
-        munmap(buddy->memory_start, memory_size);
+        // Buddy memory, bitmap and aligned metadata are one mapping
+        unmap_arena(buddy->memory_start, buddy->mapping_size, buddy->backing);
         buddy->memory_start = NULL;
     }
     
     return NULL;
 }
 
-void* BitmapBuddyAllocator_reserve(Allocator* alloc, ...) {
-    va_list args;
-    va_start(args, alloc);
-    size_t size = va_arg(args, size_t);
-    va_end(args);
+static void merge(Bitmap* bitmap, int idx);
 
-    BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
+// Clear a block and merge it with its free buddies
+static inline void release_idx(BitmapBuddyAllocator* buddy, int idx) {
+    update_children(&buddy->bitmap, idx, RELEASED);
+    merge(&buddy->bitmap, idx);
+    note_released(buddy, idx);
+}
+
+// Deferred coalescing: a released block keeps its bits reserved and waits in the
+// quick list of its level, marked by its metadata and linked through the word after it
+
+static inline char** quick_link(char* block_start) {
+    return (char**)(block_start + BITMAP_METADATA_SIZE);
+}
+
+// Merge a chain of quick list blocks, returns how many there were
+static int flush_chain(BitmapBuddyAllocator* buddy, char* block_start) {
+    int flushed = 0;
+    while (block_start) {
+        BitmapBuddyMetadata* meta = (BitmapBuddyMetadata*)block_start;
+        char* next = *quick_link(block_start);
+        int idx = meta->bitmap_idx;
+        meta->bitmap_idx = -1;
+        meta->size = -1;
+        release_idx(buddy, idx);
+        block_start = next;
+        flushed++;
+    }
+    return flushed;
+}
+
+// Put a released block on its quick list, false if it must be merged at once.
+// A full list keeps its newest half and merges the rest
+static bool quick_push(BitmapBuddyAllocator* buddy, int idx, int level, size_t full_block_size) {
+    if (buddy->quick_limit == 0 || full_block_size < BITMAP_METADATA_SIZE + sizeof(char*)) return false;
+    if (buddy->quick_counts[level] >= buddy->quick_limit) {
+        uint keep = buddy->quick_limit / 2;
+        char** cut = &buddy->quick_lists[level];
+        for (uint i = 0; i < keep; i++) cut = quick_link(*cut);
+        flush_chain(buddy, *cut);
+        *cut = NULL;
+        buddy->quick_counts[level] = keep;
+    }
+    char* block_start = buddy->memory_start + (size_t)(idx - firstIdx(level)) * full_block_size;
+    BitmapBuddyMetadata* meta = (BitmapBuddyMetadata*)block_start;
+    meta->bitmap_idx = idx;
+    meta->size = QUICK_LISTED;
+    *quick_link(block_start) = buddy->quick_lists[level];
+    buddy->quick_lists[level] = block_start;
+    buddy->quick_counts[level]++;
+    return true;
+}
+
+// Newest quick list block of a level, NULL if there is none. Its bits are still reserved
+static inline char* quick_pop(BitmapBuddyAllocator* buddy, int level) {
+    char* block_start = buddy->quick_lists[level];
+    if (!block_start) return NULL;
+    buddy->quick_lists[level] = *quick_link(block_start);
+    buddy->quick_counts[level]--;
+    return block_start;
+}
+
+int BitmapBuddyAllocator_flush_quick_lists(BitmapBuddyAllocator* buddy) {
+    int flushed = 0;
+    for (uint level = 0; level <= buddy->num_levels; level++) {
+        flushed += flush_chain(buddy, buddy->quick_lists[level]);
+        buddy->quick_lists[level] = NULL;
+        buddy->quick_counts[level] = 0;
+    }
+    return flushed;
+}
+
+void BitmapBuddyAllocator_set_quick_lists(BitmapBuddyAllocator* buddy, uint max_blocks) {
+    BitmapBuddyAllocator_flush_quick_lists(buddy);
+    buddy->quick_limit = max_blocks;
+}
+
+// Free block at a level, merging the quick lists when there is none
+static int find_free_block(BitmapBuddyAllocator* buddy, int level) {
+    int idx = bitmap_find_zero_in_range(&buddy->bitmap, firstIdx(level), firstIdx(level + 1));
+    if (idx == -1 && BitmapBuddyAllocator_flush_quick_lists(buddy) > 0) {
+        idx = bitmap_find_zero_in_range(&buddy->bitmap, firstIdx(level), firstIdx(level + 1));
+    }
+    return idx;
+}
+
+static void* bitmap_buddy_reserve(BitmapBuddyAllocator* buddy, size_t size) {
     size_t memory_size = size + BITMAP_METADATA_SIZE;
     if (!buddy || size == 0 || memory_size > (size_t)buddy->memory_size) {
         #ifdef DEBUG
@@ -205,36 +507,37 @@ void* BitmapBuddyAllocator_reserve(Allocator* alloc, ...) {
         }
     }
 
-    // Cerca un blocco libero al livello scelto
-    int freeidx = -1;
-    for (int j = firstIdx(level_new_block); j < firstIdx(level_new_block + 1); j++) {
-        if (!bitmap_test(&buddy->bitmap, j)) {
-            freeidx = j;
-            break;
+    // Un blocco rilasciato e non ancora fuso ha i bit già riservati
+    size_t usable_block_size = block_size - BITMAP_METADATA_SIZE;
+    size_t full_block_size = usable_block_size + BITMAP_METADATA_SIZE;
+    int freeidx;
+    char* block_start = quick_pop(buddy, level_new_block);
+    if (block_start) {
+        freeidx = ((BitmapBuddyMetadata*)block_start)->bitmap_idx;
+    } else {
+        // Cerca un blocco libero al livello scelto, una parola (o un vettore di parole) alla volta
+        freeidx = find_free_block(buddy, level_new_block);
+        if (freeidx == -1) {
+            #ifdef DEBUG
+            printf(RED "ERROR: No free blocks at any level\n");
+            #endif
+            return NULL;
         }
-    }
-
-    if (freeidx == -1) {
+        // When printing/debugging, show both block and usable size
         #ifdef DEBUG
-        printf(RED "ERROR: No free blocks at any level\n");
+        printf("Found free block at bitmap index %d (level %d) of size %zu (usable %zu)\n",
+               freeidx, level_new_block, block_size, usable_block_size);
         #endif
-        return NULL;
-    }
-    // When printing/debugging, show both block and usable size
-    size_t usable_block_size = block_size - BITMAP_METADATA_SIZE;
-    #ifdef DEBUG
-    printf("Found free block at bitmap index %d (level %d) of size %zu (usable %zu)\n",
-           freeidx, level_new_block, block_size, usable_block_size);
-    #endif
 
-    // Setta il blocco e i suoi antenati/discendenti come allocati
-    update_parents(&buddy->bitmap, freeidx, RESERVED);
-    update_children(&buddy->bitmap, freeidx, RESERVED);
+        // Setta il blocco e i suoi antenati/discendenti come allocati
+        update_parents(&buddy->bitmap, freeidx, RESERVED);
+        update_children(&buddy->bitmap, freeidx, RESERVED);
 
-    // Calcola l'indirizzo e salva i metadati
-    int user_idx = freeidx - firstIdx(level_new_block);
-    size_t full_block_size = usable_block_size + BITMAP_METADATA_SIZE;
-    char* block_start = buddy->memory_start + user_idx * full_block_size;
+        // Calcola l'indirizzo
+        int user_idx = freeidx - firstIdx(level_new_block);
+        block_start = buddy->memory_start + user_idx * full_block_size;
+    }
+    // Salva i metadati
     BitmapBuddyMetadata* meta = (BitmapBuddyMetadata*)block_start;
     meta->bitmap_idx = freeidx;
     meta->size = size;
@@ -242,6 +545,7 @@ void* BitmapBuddyAllocator_reserve(Allocator* alloc, ...) {
     size_t internal_fragmentation = full_block_size - size;
     ((VariableBlockAllocator *) buddy)->internal_fragmentation += internal_fragmentation;
     ((VariableBlockAllocator *) buddy)->sparse_free_memory -= full_block_size;
+    mark_dirty(buddy, block_start, full_block_size);
 
     // Restituisce il puntatore all'area payload (dopo i metadati)
     #ifdef DEBUG
@@ -252,6 +556,14 @@ void* BitmapBuddyAllocator_reserve(Allocator* alloc, ...) {
     return (void*)(block_start + BITMAP_METADATA_SIZE);
 }
 
+void* BitmapBuddyAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    return bitmap_buddy_reserve((BitmapBuddyAllocator*)alloc, size);
+}
+
 static void merge(Bitmap* bitmap, int idx) {
     if (idx == 0) return; // root, nothing to merge up
     int buddy_idx = buddyIdx(idx);
@@ -293,34 +605,58 @@ void* BitmapBuddyAllocator_release(Allocator* alloc, ...) {
         return (void*)-1;
     }
 
-    char* char_ptr = (char*)ptr;
-    BitmapBuddyMetadata* meta = (BitmapBuddyMetadata*)(char_ptr - BITMAP_METADATA_SIZE);
+    if ((char*)ptr < buddy->memory_start || (char*)ptr >= buddy->memory_start + buddy->memory_size) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Pointer outside managed memory!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    BitmapBuddyMetadata* meta = metadata_of(buddy, ptr);
+    if (!meta) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid pointer to free!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
     int idx_to_free = meta->bitmap_idx;
     #ifdef DEBUG
     printf("Freeing block at metadata bitmap index %d\n", idx_to_free);
     #endif
     int size = meta->size;
-    int level = levelIdx(idx_to_free);
-    int full_block_size = buddy->min_block_size << (buddy->num_levels - level);
 
     // Controlla se già libero (double free)
     if (idx_to_free == -1) {
         #ifdef DEBUG
         printf(RED "ERROR: Double free!\n" RESET);
-        printf("\t tried to free block number %d at level %d with size %d\n", idx_to_free, level, size);
+        printf("\t tried to free block number %d with size %d\n", idx_to_free, size);
+        #endif
+        return (void*)-1;
+    }
+    if (size == QUICK_LISTED) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Double free of a block in a quick list!\n" RESET);
         #endif
         return (void*)-1;
     }
+    // aligned_meta starts zeroed, and {0, 0} looks like the root: the block must map back to ptr
+    if (allocated_meta(buddy, ptr) != meta) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid pointer to free!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    int level = levelIdx(idx_to_free);
+    int full_block_size = buddy->min_block_size << (buddy->num_levels - level);
     
     ((VariableBlockAllocator *) buddy)->internal_fragmentation -= (full_block_size - size);
     ((VariableBlockAllocator *) buddy)->sparse_free_memory += full_block_size;
-    // Libera i discendenti e tenta il merge
-    update_children(&buddy->bitmap, idx_to_free, RELEASED);
-    merge(&buddy->bitmap, idx_to_free);
     
     // put metadata to 0
     meta->bitmap_idx = -1; // Clear metadata
     meta->size = -1;       // Clear size
+
+    // Libera i discendenti e tenta il merge, o lo rimanda
+    if (!quick_push(buddy, idx_to_free, level, full_block_size)) release_idx(buddy, idx_to_free);
     #ifdef DEBUG
     printf("After free:\n");
     // print_bitmap_status(buddy);
@@ -330,6 +666,265 @@ void* BitmapBuddyAllocator_release(Allocator* alloc, ...) {
     return (void*)0;
 }
 
+int BitmapBuddyAllocator_reserve_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out) {
+    BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
+    if (!sizes) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL sizes in batch reserve\n" RESET);
+        #endif
+        return 0;
+    }
+    int allocated = 0;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = bitmap_buddy_reserve(buddy, sizes[i]);
+        if (out[i]) allocated++;
+    }
+    return allocated;
+}
+
+// Upward merge for a batch: a clear parent was already merged from the buddy's side
+static void merge_until_merged(Bitmap* bitmap, int idx) {
+    while (idx != 0) {
+        int parent = parentIdx(idx);
+        if (!bitmap_test(bitmap, parent) || bitmap_test(bitmap, buddyIdx(idx))) return;
+        bitmap_clear(bitmap, parent);
+        idx = parent;
+    }
+}
+
+// Clear every block first, then merge upwards: each ancestor is cleared once. Purges
+// come last, when no header is left to read or write: a window of indices at a time
+int BitmapBuddyAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs) {
+    BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
+    Allocator_sort_addresses(ptrs, n);
+
+    int released = 0;
+    int idxs[BITMAP_BUDDY_BATCH_WINDOW];
+    for (size_t base = 0; base < n; base += BITMAP_BUDDY_BATCH_WINDOW) {
+        size_t count = n - base < BITMAP_BUDDY_BATCH_WINDOW ? n - base : BITMAP_BUDDY_BATCH_WINDOW;
+        void** window = ptrs + base;
+        for (size_t i = 0; i < count; i++) {
+            idxs[i] = -1;
+            if (!window[i]) continue;
+            // A clear bit means the block was already released earlier in this batch
+            BitmapBuddyMetadata* meta = allocated_meta(buddy, window[i]);
+            if (!meta) {
+                #ifdef DEBUG
+                printf(RED "ERROR: Double free or invalid pointer in batch!\n" RESET);
+                #endif
+                window[i] = NULL;
+                continue;
+            }
+            int idx = meta->bitmap_idx;
+            int full_block_size = buddy->min_block_size << (buddy->num_levels - levelIdx(idx));
+            ((VariableBlockAllocator *) buddy)->internal_fragmentation -= (full_block_size - meta->size);
+            ((VariableBlockAllocator *) buddy)->sparse_free_memory += full_block_size;
+            update_children(&buddy->bitmap, idx, RELEASED);
+            meta->bitmap_idx = -1;
+            meta->size = -1;
+            idxs[i] = idx;
+            released++;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (idxs[i] >= 0) merge_until_merged(&buddy->bitmap, idxs[i]);
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (idxs[i] >= 0) note_dirty(buddy, idxs[i], free_top(buddy, idxs[i]));
+        }
+        // Sorted blocks: the free blocks around them come in order, each checked once
+        char* merged_end = NULL;
+        for (size_t i = 0; i < count; i++) {
+            if (idxs[i] < 0 || block_start_of(buddy, idxs[i]) < merged_end) continue;
+            int top = free_top(buddy, idxs[i]);
+            merged_end = block_start_of(buddy, top) + block_size_of(buddy, levelIdx(top));
+            check_purge(buddy, top);
+        }
+    }
+    return released;
+}
+
+// Usable bytes of an allocated block: aligned blocks have no header
+static inline size_t usable_size_of(BitmapBuddyAllocator* buddy, BitmapBuddyMetadata* meta, void* ptr) {
+    size_t full_block_size = buddy->min_block_size << (buddy->num_levels - levelIdx(meta->bitmap_idx));
+    return (char*)meta + BITMAP_METADATA_SIZE == (char*)ptr ? full_block_size - BITMAP_METADATA_SIZE : full_block_size;
+}
+
+// Resize in place: shrinking releases the right halves, growing takes free
+// right buddies up the tree. Falls back to reserve, copy and release
+void* BitmapBuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
+    if (!buddy) return NULL;
+    if (!ptr) return bitmap_buddy_reserve(buddy, size);
+    if (size == 0) {
+        BitmapBuddyAllocator_release(alloc, ptr);
+        return NULL;
+    }
+    BitmapBuddyMetadata* meta = allocated_meta(buddy, ptr);
+    if (!meta) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid pointer in realloc\n" RESET);
+        #endif
+        return NULL;
+    }
+    size_t memory_size = size + BITMAP_METADATA_SIZE;
+    if (memory_size > buddy->memory_size) return NULL;
+
+    int idx = meta->bitmap_idx;
+    int level = levelIdx(idx);
+    size_t full_block_size = buddy->min_block_size << (buddy->num_levels - level);
+
+    // Growing: every block on the way up must be a left child (odd index) with a clear buddy.
+    // Aligned blocks keep their place only while the request fits
+    int top = idx;
+    size_t reachable = full_block_size;
+    bool aligned = (char*)meta + BITMAP_METADATA_SIZE != (char*)ptr;
+    if (aligned && size <= full_block_size) {
+        ((VariableBlockAllocator *) buddy)->internal_fragmentation += meta->size - (int)size;
+        meta->size = size;
+        return ptr;
+    }
+    while (!aligned && reachable < memory_size && top % 2 == 1 && !bitmap_test(&buddy->bitmap, top + 1)) {
+        top = parentIdx(top);
+        reachable *= 2;
+    }
+    if (aligned || reachable < memory_size) {
+        void* new_ptr = bitmap_buddy_reserve(buddy, size);
+        if (!new_ptr) return NULL;
+        memcpy(new_ptr, ptr, usable_size_of(buddy, meta, ptr));
+        BitmapBuddyAllocator_release(alloc, ptr);
+        return new_ptr;
+    }
+
+    VariableBlockAllocator* base = (VariableBlockAllocator*)alloc;
+    base->internal_fragmentation -= full_block_size - meta->size;
+    base->sparse_free_memory += full_block_size;
+    for (; idx != top; idx = parentIdx(idx)) {
+        update_children(&buddy->bitmap, idx + 1, RESERVED);
+        full_block_size *= 2;
+    }
+    level = levelIdx(idx);
+
+    // Shrinking: keep the left half while it still fits
+    while (level < (int)buddy->num_levels && full_block_size / 2 >= memory_size) {
+        update_children(&buddy->bitmap, 2 * idx + 2, RELEASED);
+        note_released(buddy, 2 * idx + 2);
+        idx = 2 * idx + 1;
+        level++;
+        full_block_size /= 2;
+    }
+
+    meta->bitmap_idx = idx;
+    meta->size = size;
+    base->internal_fragmentation += full_block_size - size;
+    base->sparse_free_memory -= full_block_size;
+    mark_dirty(buddy, (char*)meta, full_block_size);
+    return ptr;
+}
+
+size_t BitmapBuddyAllocator_block_usable_size(Allocator* alloc, void* ptr) {
+    BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
+    BitmapBuddyMetadata* meta = allocated_meta(buddy, ptr);
+    return meta ? usable_size_of(buddy, meta, ptr) : 0;
+}
+
+// Blocks are aligned to their size, so a block at least as large as the alignment
+// is aligned too. Its metadata goes to aligned_meta and the whole block is usable
+void* BitmapBuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
+    if (!buddy || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in memalign!\n" RESET);
+        #endif
+        return NULL;
+    }
+    size_t needed = size > alignment ? size : alignment;
+    int level = buddy->num_levels;
+    size_t block_size = buddy->min_block_size;
+    while (block_size < needed && level > 0) {
+        block_size *= 2;
+        level--;
+    }
+    if (block_size < needed || (block_size & (alignment - 1)) != 0 ||
+        ((uintptr_t)buddy->memory_start & (alignment - 1)) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: No block of %zu bytes aligned to %zu\n" RESET, size, alignment);
+        #endif
+        return NULL;
+    }
+
+    int freeidx;
+    char* block_start = quick_pop(buddy, level);
+    if (block_start) {
+        freeidx = ((BitmapBuddyMetadata*)block_start)->bitmap_idx;
+    } else {
+        freeidx = find_free_block(buddy, level);
+        if (freeidx == -1) {
+            #ifdef DEBUG
+            printf(RED "ERROR: No free blocks at any level\n" RESET);
+            #endif
+            return NULL;
+        }
+        update_parents(&buddy->bitmap, freeidx, RESERVED);
+        update_children(&buddy->bitmap, freeidx, RESERVED);
+        block_start = buddy->memory_start + (size_t)(freeidx - firstIdx(level)) * block_size;
+    }
+    BitmapBuddyMetadata* meta = &buddy->aligned_meta[(block_start - buddy->memory_start) / buddy->min_block_size];
+    meta->bitmap_idx = freeidx;
+    meta->size = size;
+    ((VariableBlockAllocator *) buddy)->internal_fragmentation += block_size - size;
+    ((VariableBlockAllocator *) buddy)->sparse_free_memory -= block_size;
+    mark_dirty(buddy, block_start, block_size);
+    return block_start;
+}
+
+// Zero [start, end) except the pages purged since their last release, one run of dirty pages at a time
+static void zero_dirty_pages(BitmapBuddyAllocator* buddy, char* start, char* end) {
+    if (buddy->purged_bytes == 0) {
+        zero_memory(start, end - start);
+        return;
+    }
+    char* run = NULL;
+    for (char* p = start; p < end;) {
+        size_t page = (p - buddy->memory_start) / buddy->page_size;
+        char* page_end = buddy->memory_start + (page + 1) * buddy->page_size;
+        bool clean = bitmap_test(&buddy->clean_pages, page);
+        if (!clean && !run) run = p;
+        if (clean && run) {
+            zero_memory(run, p - run);
+            run = NULL;
+        }
+        p = page_end < end ? page_end : end;
+    }
+    if (run) zero_memory(run, end - run);
+}
+
+// The arena above the high-water mark was never handed out and is still zero
+// from mmap, and so are the purged pages: only the rest of the block is cleared
+void* BitmapBuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    BitmapBuddyAllocator* buddy = (BitmapBuddyAllocator*)alloc;
+    size_t total;
+    if (!buddy || __builtin_mul_overflow(nmemb, size, &total)) return NULL;
+    char* high_water = buddy->high_water;
+    char* ptr = bitmap_buddy_reserve(buddy, total);
+    if (ptr && ptr < high_water) {
+        char* dirty_end = ptr + total < high_water ? ptr + total : high_water;
+        zero_dirty_pages(buddy, ptr, dirty_end);
+    }
+    return ptr;
+}
+
+void BitmapBuddyAllocator_set_decay(BitmapBuddyAllocator* buddy, long decay_ms) {
+    buddy->decay_ms = decay_ms < 0 ? -1 : decay_ms;
+    buddy->next_decay = 0;
+    if (buddy->decay_ms == 0) BitmapBuddyAllocator_purge(buddy);
+}
+
+size_t BitmapBuddyAllocator_purge(BitmapBuddyAllocator* buddy) {
+    BitmapBuddyAllocator_flush_quick_lists(buddy);
+    return purge_dirty_nodes(buddy, true);
+}
+
 int BitmapBuddyAllocator_print_state(BitmapBuddyAllocator* buddy) {
     if (!buddy) {
         #ifdef DEBUG
@@ -342,6 +937,13 @@ int BitmapBuddyAllocator_print_state(BitmapBuddyAllocator* buddy) {
     printf("  Memory Size: %zu bytes\n", buddy->memory_size);
     printf("  Number of Levels: %d\n", buddy->num_levels);
     printf("  Minimum Bucket Size: %zu bytes\n", buddy->min_block_size);
+    printf("  Pages: %s\n", arena_backing_name(buddy->backing));
+    printf("  Purged: %zu bytes (decay %ld ms)\n", buddy->purged_bytes, buddy->decay_ms);
+    if (buddy->quick_limit > 0) {
+        printf("  Quick lists (up to %u blocks):", buddy->quick_limit);
+        for (uint level = 0; level <= buddy->num_levels; level++) printf(" %u", buddy->quick_counts[level]);
+        printf("\n");
+    }
     
     print_bitmap_status(buddy);
     
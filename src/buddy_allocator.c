@@ -1,9 +1,47 @@
 #include <buddy_allocator.h>
+#include <helpers/memory_manipulation.h>
+#include <helpers/timing.h>
 
+extern inline BuddyAllocator* BuddyAllocator_create_with_pages(BuddyAllocator* a, size_t memory_size, int num_levels, ArenaPages pages);
 extern inline BuddyAllocator* BuddyAllocator_create(BuddyAllocator* alloc, size_t memory_size, int num_levels);
 extern inline int BuddyAllocator_destroy(BuddyAllocator* alloc);
 extern inline void* BuddyAllocator_malloc(BuddyAllocator* alloc, size_t size);
 extern inline int BuddyAllocator_free(BuddyAllocator* alloc, void* ptr);
+extern inline int BuddyAllocator_malloc_batch(BuddyAllocator* a, size_t n, const size_t* sizes, void** out);
+extern inline int BuddyAllocator_free_batch(BuddyAllocator* a, size_t n, void** ptrs);
+extern inline void* BuddyAllocator_realloc(BuddyAllocator* a, void* ptr, size_t size);
+extern inline size_t BuddyAllocator_usable_size(BuddyAllocator* a, void* ptr);
+extern inline void* BuddyAllocator_memalign(BuddyAllocator* a, size_t alignment, size_t size);
+extern inline void* BuddyAllocator_calloc(BuddyAllocator* a, size_t nmemb, size_t size);
+
+// Free list updates keep free_level_mask in sync
+
+static inline void free_list_push(BuddyAllocator* a, BuddyNode* node) {
+    list_push_front(a->free_lists[node->level], (Node*)&node->node);
+    a->free_level_mask |= 1u << node->level;
+}
+
+static inline BuddyNode* free_list_pop(BuddyAllocator* a, uint level) {
+    BuddyNode* node = (BuddyNode*)list_pop_front(a->free_lists[level]);
+    if (a->free_lists[level]->size == 0) a->free_level_mask &= ~(1u << level);
+    return node;
+}
+
+static inline void free_list_detach(BuddyAllocator* a, BuddyNode* node) {
+    list_detach(a->free_lists[node->level], (Node*)&node->node);
+    if (a->free_lists[node->level]->size == 0) a->free_level_mask &= ~(1u << node->level);
+}
+
+// Deepest level whose blocks hold adjusted_size bytes, -1 if none does.
+// memory_size >> level >= adjusted_size, from two leading zero counts
+static inline int level_for_size(BuddyAllocator* a, size_t adjusted_size) {
+    if (adjusted_size > a->memory_size) return -1;
+    int ceil_order = (adjusted_size > 1) ? 64 - __builtin_clzll(adjusted_size - 1) : 0;
+    int level = (int)a->memory_order - ceil_order;
+    if (level < 0) level = 0;
+    if ((a->memory_size >> (level + 1)) >= adjusted_size) level++;
+    return (level < (int)a->num_levels - 1) ? level : (int)a->num_levels - 1;
+}
 
 static struct Buddies BuddyAllocator_divide_block(BuddyAllocator* a, BuddyNode* parent) {
     struct Buddies buddies = {NULL, NULL};
@@ -32,14 +70,17 @@ static struct Buddies BuddyAllocator_divide_block(BuddyAllocator* a, BuddyNode*
     buddies.left_buddy->size = child_size;
     buddies.left_buddy->data = parent->data;
     buddies.left_buddy->is_free = false;
+    buddies.left_buddy->in_quick_list = false;
     buddies.left_buddy->parent = parent;
     buddies.left_buddy->buddy = buddies.right_buddy;
 
     buddies.right_buddy->size = child_size;
     buddies.right_buddy->data = parent->data + child_size;
     buddies.right_buddy->is_free = true;
+    buddies.right_buddy->in_quick_list = false;
     buddies.right_buddy->parent = parent;
     buddies.right_buddy->buddy = buddies.left_buddy;
+    buddies.right_buddy->dirty_since = parent->dirty_since;
 
     int child_level = parent->level + 1;
     buddies.left_buddy->level = child_level;
@@ -51,6 +92,13 @@ static struct Buddies BuddyAllocator_divide_block(BuddyAllocator* a, BuddyNode*
 }
 
 
+// Oldest of two dirty_since stamps, 0 (clean) only if both are
+static inline double older_dirty(double x, double y) {
+    if (x == 0) return y;
+    if (y == 0) return x;
+    return x < y ? x : y;
+}
+
 static BuddyNode* BuddyAllocator_merge_blocks(BuddyAllocator* a, BuddyNode* left, BuddyNode* right) {
     if (!a || !left || !right) {
         printf(RED "ERROR: Null parameters to merge_blocks\n" RESET);
@@ -79,10 +127,11 @@ static BuddyNode* BuddyAllocator_merge_blocks(BuddyAllocator* a, BuddyNode* left
     }
 
     parent->is_free = true;
+    parent->dirty_since = older_dirty(left->dirty_since, right->dirty_since);
     
     // Remove children from free lists
-    list_detach(a->free_lists[left->level], (Node*)&left->node);
-    list_detach(a->free_lists[right->level], (Node*)&right->node);
+    free_list_detach(a, left);
+    free_list_detach(a, right);
 
     // Free child nodes
     SlabAllocator_free(&(a->node_allocator), left);
@@ -97,6 +146,7 @@ void* BuddyAllocator_init(Allocator* alloc, ...) {
     BuddyAllocator* buddy = (BuddyAllocator*)alloc;
     size_t memory_size = va_arg(args, size_t);
     int num_levels = va_arg(args, int) + 1; // +1 for the root level
+    ArenaPages pages = (ArenaPages)va_arg(args, int);
     va_end(args);
     if (!alloc || memory_size <= 0 || num_levels <= 1 || num_levels >= BUDDY_MAX_LEVELS) {
         #ifdef DEBUG
@@ -123,31 +173,47 @@ void* BuddyAllocator_init(Allocator* alloc, ...) {
     }
     buddy->num_levels = num_levels;
     buddy->min_block_size = min_block_size;
+    buddy->memory_order = 63 - __builtin_clzll(memory_size);
+    buddy->free_level_mask = 0;
     
     
     size_t free_lists_size = sizeof(DoubleLinkedList*) * num_levels;
+    size_t aligned_nodes_size = sizeof(BuddyNode*) * (memory_size / min_block_size + 1);
+    buddy->page_size = sysconf(_SC_PAGESIZE);
+    int num_pages = (memory_size + buddy->page_size - 1) / buddy->page_size;
+    size_t clean_pages_size = ((num_pages + 31) / 32) * sizeof(uint);
     
-    // Initialize memory
-    void* mmap_ptr = mmap(NULL, memory_size + free_lists_size, PROT_READ | PROT_WRITE, 
-                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (mmap_ptr == MAP_FAILED) {
+    // Initialize memory: the arena first so that blocks keep the page alignment,
+    // then the free lists, the aligned nodes and the clean pages (untouched pages cost nothing)
+    size_t lists_offset = (memory_size + 7) & ~(size_t)7;
+    buddy->mapping_size = lists_offset + free_lists_size + aligned_nodes_size + clean_pages_size;
+    void* mmap_ptr = map_arena(buddy->mapping_size, pages, &buddy->backing);
+    if (!mmap_ptr) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to allocate memory in init!\n" RESET);
         perror("mmap failed");
         #endif
         return NULL;
     }
-    buddy->total_memory_size = memory_size + free_lists_size;
+    buddy->total_memory_size = buddy->mapping_size;
 
-    // Place free_lists at the start of the mmap'd region
-    buddy->free_lists = (DoubleLinkedList**)mmap_ptr;
-    memset(buddy->free_lists, 0, free_lists_size);
-    
-    buddy->memory_start = (void*)((char*)mmap_ptr + free_lists_size);
+    buddy->memory_start = mmap_ptr;
     buddy->memory_size = memory_size;
+    buddy->high_water = mmap_ptr;
+    buddy->free_lists = (DoubleLinkedList**)((char*)mmap_ptr + lists_offset);
+    buddy->aligned_nodes = (BuddyNode**)((char*)buddy->free_lists + free_lists_size);
+    bitmap_create(&buddy->clean_pages, num_pages, (char*)buddy->aligned_nodes + aligned_nodes_size);
+    buddy->decay_ms = BUDDY_DEFAULT_DECAY_MS;
+    buddy->next_decay = 0;
+    buddy->clock = now_seconds();
+    buddy->decay_ticks = 0;
+    buddy->purged_bytes = 0;
+    memset(buddy->quick_lists, 0, sizeof(buddy->quick_lists));
+    memset(buddy->quick_counts, 0, sizeof(buddy->quick_counts));
+    buddy->quick_limit = 0;
 
     // Initialize list allocator
-    SlabAllocator* list_allocator = SlabAllocator_create(&(buddy->list_allocator), sizeof(DoubleLinkedList), num_levels);
+    SlabAllocator* list_allocator = SlabAllocator_create_with_mode(&(buddy->list_allocator), sizeof(DoubleLinkedList), num_levels, SLAB_MODE_EMBEDDED);
     if (!list_allocator) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to create list allocator!\n" RESET);
@@ -168,8 +234,8 @@ void* BuddyAllocator_init(Allocator* alloc, ...) {
         list_create(buddy->free_lists[i]);
     }
 
-    // Initialize node allocator
-    SlabAllocator* slab = SlabAllocator_create(&(buddy->node_allocator), sizeof(BuddyNode), max_nodes);
+    // Initialize node allocator (nodes are internal, no need for a per-slot header)
+    SlabAllocator* slab = SlabAllocator_create_with_pages(&(buddy->node_allocator), sizeof(BuddyNode), max_nodes, SLAB_MODE_EMBEDDED, 0, pages);
     if (!slab) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to create slab allocator!\n" RESET);
@@ -195,17 +261,25 @@ void* BuddyAllocator_init(Allocator* alloc, ...) {
     first_node->data = buddy->memory_start;
     first_node->level = 0;
     first_node->is_free = 1;
+    first_node->in_quick_list = false;
     first_node->buddy = NULL;
     first_node->parent = NULL;
+    first_node->dirty_since = 0;
     
     // Add to free list
-    list_push_front(buddy->free_lists[0], (Node*)&first_node->node);
+    free_list_push(buddy, first_node);
 
     // Initialize function pointers
     alloc->init = BuddyAllocator_init;
     alloc->dest = BuddyAllocator_cleanup;
     alloc->malloc = BuddyAllocator_reserve;
     alloc->free = BuddyAllocator_release;
+    alloc->malloc_batch = BuddyAllocator_reserve_batch;
+    alloc->free_batch = BuddyAllocator_release_batch;
+    alloc->realloc = BuddyAllocator_reallocate;
+    alloc->usable_size = BuddyAllocator_block_usable_size;
+    alloc->memalign = BuddyAllocator_reserve_aligned;
+    alloc->calloc = BuddyAllocator_callocate;
     return buddy;
 }
 
@@ -225,9 +299,7 @@ void* BuddyAllocator_cleanup(Allocator* alloc, ...) {
         return (void*)-1;
     }
 
-    void* mmap_ptr = (void*)buddy->free_lists;
-
-    if (munmap(mmap_ptr, buddy->memory_size) != 0) {
+    if (unmap_arena(buddy->memory_start, buddy->mapping_size, buddy->backing) != 0) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to unmap memory in destructor\n" RESET);
         #endif
@@ -251,12 +323,159 @@ void* BuddyAllocator_cleanup(Allocator* alloc, ...) {
     return (void*)0;
 }
 
-void* BuddyAllocator_reserve(Allocator* alloc, ...) {
-    va_list args;
-    va_start(args, alloc);
-    BuddyAllocator* buddy = (BuddyAllocator*)alloc;
-    size_t size = va_arg(args, size_t);
-    va_end(args);
+// Node of the block at ptr (inside the arena). Aligned blocks are found in
+// aligned_nodes by minimum block index, the others have a header
+static inline BuddyNode* node_of(BuddyAllocator* a, void* ptr) {
+    size_t offset = (char*)ptr - (char*)a->memory_start;
+    BuddyNode* aligned = a->aligned_nodes[offset / a->min_block_size];
+    if (aligned && aligned->data == (char*)ptr) return aligned;
+    if (offset < BUDDY_METADATA_SIZE) return NULL;
+    return *((BuddyNode**)((char*)ptr - BUDDY_METADATA_SIZE));
+}
+
+// Drop the aligned_nodes entry of a released block (no-op for blocks with a header)
+static inline void forget_aligned(BuddyAllocator* a, void* ptr) {
+    BuddyNode** slot = &a->aligned_nodes[((char*)ptr - (char*)a->memory_start) / a->min_block_size];
+    if (*slot && (*slot)->data == (char*)ptr) *slot = NULL;
+}
+
+// Raise the high-water mark to the end of a block being handed out
+static inline void mark_dirty(BuddyAllocator* a, BuddyNode* node) {
+    if (node->data + node->size > a->high_water) a->high_water = node->data + node->size;
+}
+
+// A released range is dirty: its pages are no longer known to be zero
+static inline void forget_clean_pages(BuddyAllocator* a, char* start, size_t size) {
+    if (a->purged_bytes == 0) return; // Nothing was ever purged
+    size_t first = (start - (char*)a->memory_start) / a->page_size;
+    size_t last = (start + size - 1 - (char*)a->memory_start) / a->page_size;
+    for (size_t page = first; page <= last; page++) bitmap_clear(&a->clean_pages, page);
+}
+
+// Give the whole pages of a free block back to the kernel: they come back as zero pages.
+// Only runs of pages not already clean are advised, pages above the high-water mark
+// were never touched and are left alone
+static size_t purge_block(BuddyAllocator* a, BuddyNode* node) {
+    node->dirty_since = 0;
+    if (a->backing == ARENA_BACKING_HUGETLB) return 0; // Pool pages only go back with the mapping
+    uintptr_t page_mask = a->page_size - 1;
+    char* start = (char*)(((uintptr_t)node->data + page_mask) & ~page_mask);
+    char* end = (char*)((uintptr_t)(node->data + node->size) & ~page_mask);
+    char* touched_end = (char*)(((uintptr_t)a->high_water + page_mask) & ~page_mask);
+    bool reaches_high_water = end >= touched_end;
+    if (reaches_high_water) end = touched_end;
+    if (start >= end) return 0;
+
+    size_t last = (end - (char*)a->memory_start) / a->page_size;
+    size_t page = (start - (char*)a->memory_start) / a->page_size;
+    size_t purged = 0;
+    while (page < last) {
+        if (page % 32 == 0 && page + 32 <= last && a->clean_pages.bits[page / 32] == ~0u) {
+            page += 32;
+            continue;
+        }
+        if (bitmap_test(&a->clean_pages, page)) {
+            page++;
+            continue;
+        }
+        size_t run = page;
+        while (page < last && !bitmap_test(&a->clean_pages, page)) page++;
+        if (madvise((char*)a->memory_start + run * a->page_size, (page - run) * a->page_size, MADV_DONTNEED) != 0) {
+            reaches_high_water = false;
+            break;
+        }
+        for (size_t i = run; i < page; i++) bitmap_set(&a->clean_pages, i);
+        purged += (page - run) * a->page_size;
+    }
+    // Nothing above the block was touched: the mark comes down to its first purged page
+    if (reaches_high_water && start < a->high_water) a->high_water = start;
+    a->purged_bytes += purged;
+    return purged;
+}
+
+// Purge the free blocks of at least a page dirtied before limit (every dirty one with HUGE_VAL)
+static size_t purge_dirty_blocks(BuddyAllocator* a, double limit) {
+    size_t purged = 0;
+    for (uint level = 0; level < a->num_levels && (a->memory_size >> level) >= a->page_size; level++) {
+        for (Node* current = a->free_lists[level]->head; current; current = current->next) {
+            BuddyNode* node = (BuddyNode*)current;
+            if (node->dirty_since != 0 && node->dirty_since <= limit) purged += purge_block(a, node);
+        }
+    }
+    return purged;
+}
+
+// Decay pass: purge what has been dirty for decay_ms, then wait an eighth of it for the next one
+static void decay(BuddyAllocator* a, double now) {
+    a->clock = now;
+    a->decay_ticks = 0;
+    if (now < a->next_decay) return;
+    a->next_decay = now + a->decay_ms / 8000.0;
+    purge_dirty_blocks(a, now - a->decay_ms / 1000.0);
+}
+
+// A block was just released, and merged: unless it already holds older dirty pages
+// its decay starts now. Blocks smaller than a page cannot be purged, the last
+// clock reading is enough for them until they merge
+static void note_dirty(BuddyAllocator* a, BuddyNode* node) {
+    if (node->size < a->page_size) {
+        if (node->dirty_since == 0) node->dirty_since = a->clock;
+        return;
+    }
+    double now = now_seconds();
+    a->clock = now;
+    if (node->dirty_since == 0) node->dirty_since = now;
+    if (a->decay_ms == 0) {
+        purge_block(a, node);
+    } else if (a->decay_ms > 0) {
+        decay(a, now);
+    }
+}
+
+// Newest quick list block of a level, NULL if there is none. It is still reserved
+static inline BuddyNode* quick_pop(BuddyAllocator* a, uint level) {
+    BuddyNode* node = (BuddyNode*)a->quick_lists[level];
+    if (!node) return NULL;
+    a->quick_lists[level] = node->node.next;
+    a->quick_counts[level]--;
+    node->in_quick_list = false;
+    return node;
+}
+
+// Take a free block of the given level out of the free lists, splitting a larger one if needed
+static BuddyNode* reserve_block(BuddyAllocator* buddy, int level) {
+    // Nearest level at or above the target with a free block: highest set bit of the mask below level + 1
+    uint32_t candidates = buddy->free_level_mask & (((uint32_t)2 << level) - 1);
+    // Nothing free at or above the level: merge the quick lists and look again
+    if (!candidates && BuddyAllocator_flush_quick_lists(buddy) > 0) {
+        candidates = buddy->free_level_mask & (((uint32_t)2 << level) - 1);
+    }
+    if (!candidates) return NULL;
+    uint current_level = 31 - __builtin_clz(candidates);
+    BuddyNode* free_block = free_list_pop(buddy, current_level);
+
+    // Split block to desired level
+    while (current_level < (uint)level) {
+        struct Buddies buddies = BuddyAllocator_divide_block(buddy, free_block);
+        if (buddies.left_buddy == NULL || buddies.right_buddy == NULL) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to split block!\n" RESET);
+            #endif
+            free_list_push(buddy, free_block);
+            return NULL;
+        }
+        list_push_back(buddy->free_lists[current_level + 1], (Node*)&buddies.right_buddy->node);
+        buddy->free_level_mask |= 1u << (current_level + 1);
+        free_block = buddies.left_buddy;
+        current_level++;
+    }
+    mark_dirty(buddy, free_block);
+    return free_block;
+}
+
+// Allocate a block of at least size usable bytes
+static void* buddy_reserve(BuddyAllocator* buddy, size_t size) {
+    Allocator* alloc = (Allocator*)buddy;
     if (!alloc || size <= 0) {
         #ifdef DEBUG
         printf(RED "ERROR: NULL allocator or invalid size in alloc!\n" RESET);
@@ -276,15 +495,8 @@ void* BuddyAllocator_reserve(Allocator* alloc, ...) {
         return NULL;
     }
     
-    // Calculate the appropriate level for the requested adjusted_size
-    size_t block_size = buddy->memory_size;
-    uint level = 0;
-    while (level < buddy->num_levels - 1 && block_size / 2 >= adjusted_size) {
-        block_size /= 2;
-        level++;
-    }
-    
-    if (block_size < adjusted_size) {
+    int level = level_for_size(buddy, adjusted_size);
+    if (level < 0) {
         #ifdef DEBUG
         printf(RED "ERROR: Requested adjusted_size too large (req: %zu, max: %zu)\n" RESET, 
                adjusted_size, buddy->memory_size);
@@ -292,48 +504,8 @@ void* BuddyAllocator_reserve(Allocator* alloc, ...) {
         return NULL;
     }
 
-    
-    if (level >= buddy->num_levels) {
-        #ifdef DEBUG
-        printf(RED "ERROR: Invalid level %d (max %d)\n" RESET, level, buddy->num_levels-1);
-        #endif
-        return NULL;
-    }
-    
-    if (!buddy->free_lists[level]) {
-        #ifdef DEBUG
-        printf(RED "ERROR: No free list at level %d\n" RESET, level);
-        #endif
-        return NULL;
-    }
-
-    BuddyNode* free_block = (BuddyNode*) list_pop_front(buddy->free_lists[level]);    
-    uint current_level = level;
-    
-    // Search larger blocks if needed
-    while (!free_block && current_level > 0) {
-        current_level--;
-        free_block = (BuddyNode*) list_pop_front(buddy->free_lists[current_level]);
-        if (free_block) {            
-            // Split block to desired level
-            while (current_level < level) {
-                struct Buddies buddies = BuddyAllocator_divide_block(buddy, free_block);
-                if (buddies.left_buddy == NULL || buddies.right_buddy == NULL) {
-                    #ifdef DEBUG
-                    printf(RED "ERROR: Failed to split block!\n" RESET);
-                    #endif
-                    if (free_block) list_push_front(buddy->free_lists[current_level], (Node*)free_block);
-                    return NULL;
-                }
-                
-                list_push_back(buddy->free_lists[current_level + 1], (Node *) buddies.right_buddy);
-                free_block = buddies.left_buddy;
-                current_level++;
-            }
-            break;
-        }
-    }
-    
+    BuddyNode* free_block = quick_pop(buddy, level);
+    if (!free_block) free_block = reserve_block(buddy, level);
     if (!free_block) {
         #ifdef DEBUG
         printf(RED "ERROR: No free blocks available at any level\n" RESET);
@@ -368,17 +540,23 @@ void* BuddyAllocator_reserve(Allocator* alloc, ...) {
     return user_ptr;
 }
 
-void *BuddyAllocator_release(Allocator* alloc, ...) {
+void* BuddyAllocator_reserve(Allocator* alloc, ...) {
     va_list args;
     va_start(args, alloc);
-    BuddyAllocator* a = (BuddyAllocator*)alloc;
-    void* ptr = va_arg(args, void*);
+    size_t size = va_arg(args, size_t);
     va_end(args);
+    return buddy_reserve((BuddyAllocator*)alloc, size);
+}
+
+// Node of the allocated block at ptr, with the counters updated for its release.
+// NULL if ptr is not an allocated block
+static BuddyNode* released_node(BuddyAllocator* a, void* ptr) {
+    Allocator* alloc = (Allocator*)a;
     if(!a || !ptr) {
         #ifdef DEBUG
         printf(RED "ERROR: NULL allocator or pointer in release\n" RESET);
         #endif
-        return (void*)-1;
+        return NULL;
     }
     // Verify pointer is within allocator's memory range
     if ((char*)ptr < (char*)a->memory_start || 
@@ -386,37 +564,36 @@ void *BuddyAllocator_release(Allocator* alloc, ...) {
         #ifdef DEBUG
         printf(RED "ERROR: Pointer outside allocator memory range!\n" RESET);
         #endif
-        return (void*)-1;
+        return NULL;
     }
 
-    BuddyNode* node = *((BuddyNode**)((char*)ptr - BUDDY_METADATA_SIZE));
-    if(node->is_free) {
+    BuddyNode* node = node_of(a, ptr);
+    if(node && (node->is_free || node->in_quick_list)) {
         #ifdef DEBUG
         printf(RED "ERROR: Attempting to release an already free block\n" RESET);
         #endif
-        return (void*)-1;
+        return NULL;
     }
     if (!node || !node->data) {
         if (node) printf("Node data: %p\n", (void*)node->data);
-        return (void*)-1;
+        return NULL;
     }
 
     if ((char*)node->data < (char*)a->memory_start || 
         (char*)node->data >= (char*)a->memory_start + a->memory_size) {
         printf(RED "ERROR: Node outside allocator memory range!\n" RESET);
-        return (void*)-1;
+        return NULL;
     }
     
     if (node->level >= a->num_levels) {
         printf(RED "ERROR: Invalid level %d (max %d)\n" RESET, 
                node->level, a->num_levels-1);
-        return (void*)-1;
+        return NULL;
     }
     if (!a->free_lists[node->level]) {
         printf(RED "ERROR: Free list at level %d is NULL!\n" RESET, node->level);
-        return (void*)-1;
+        return NULL;
     }    
-    node->is_free = 1;
     
     size_t internal_fragmentation = node->size - node->requested_size;
     ((VariableBlockAllocator *) alloc)->internal_fragmentation -= internal_fragmentation;
@@ -427,10 +604,26 @@ void *BuddyAllocator_release(Allocator* alloc, ...) {
     //        node->level, a->memory_size / (1 << node->level));
     // printf("Total internal frag is %zu bytes\n", 
     //        ((VariableBlockAllocator *) alloc)->internal_fragmentation);
+    return node;
+}
 
-    list_push_front(a->free_lists[node->level], (Node*)&node->node);
+// Mark a released block as free and put it in its free list, without merging
+static inline void free_node(BuddyAllocator* a, BuddyNode* node) {
+    node->is_free = 1;
+    node->dirty_since = 0; // Stamped once merged
+    forget_clean_pages(a, node->data, node->size);
+    free_list_push(a, node);
+}
 
-    // Try to merge with buddy if possible
+// Mark the block of ptr as free and put it in its free list, without merging
+static BuddyNode* buddy_release_block(BuddyAllocator* a, void* ptr) {
+    BuddyNode* node = released_node(a, ptr);
+    if (node) free_node(a, node);
+    return node;
+}
+
+// Merge a free block with its buddy as long as possible, returns the resulting block
+static BuddyNode* buddy_coalesce(BuddyAllocator* a, BuddyNode* node) {
     while (node->parent && node->buddy && node->buddy->is_free) {
         BuddyNode* buddy = node->buddy;
         
@@ -445,18 +638,335 @@ void *BuddyAllocator_release(Allocator* alloc, ...) {
         }
         
         
-        list_push_front(a->free_lists[node->level], (Node*)&node->node);
+        free_list_push(a, node);
+    }
+    note_dirty(a, node);
+    return node;
+}
+
+// Deferred coalescing: a released block stays reserved for its buddy and waits in
+// the quick list of its level, where the next request of that level finds it
+
+// Merge a chain of quick list blocks, returns how many there were
+static int flush_chain(BuddyAllocator* a, Node* chain) {
+    int flushed = 0;
+    while (chain) {
+        BuddyNode* node = (BuddyNode*)chain;
+        chain = chain->next;
+        node->in_quick_list = false;
+        free_node(a, node);
+        buddy_coalesce(a, node);
+        flushed++;
+    }
+    return flushed;
+}
+
+// Put a released block on its quick list, false if it must be merged at once.
+// A full list keeps its newest half and merges the rest
+static bool quick_push(BuddyAllocator* a, BuddyNode* node) {
+    if (a->quick_limit == 0) return false;
+    uint level = node->level;
+    if (a->quick_counts[level] >= a->quick_limit) {
+        uint keep = a->quick_limit / 2;
+        Node** cut = &a->quick_lists[level];
+        for (uint i = 0; i < keep; i++) cut = &(*cut)->next;
+        Node* chain = *cut;
+        *cut = NULL;
+        a->quick_counts[level] = keep;
+        flush_chain(a, chain);
+    }
+    node->in_quick_list = true;
+    forget_clean_pages(a, node->data, node->size);
+    node->node.next = a->quick_lists[level];
+    a->quick_lists[level] = &node->node;
+    a->quick_counts[level]++;
+    return true;
+}
+
+int BuddyAllocator_flush_quick_lists(BuddyAllocator* a) {
+    int flushed = 0;
+    for (uint level = 0; level < a->num_levels; level++) {
+        Node* chain = a->quick_lists[level];
+        a->quick_lists[level] = NULL;
+        a->quick_counts[level] = 0;
+        flushed += flush_chain(a, chain);
+    }
+    return flushed;
+}
+
+void BuddyAllocator_set_quick_lists(BuddyAllocator* a, uint max_blocks) {
+    BuddyAllocator_flush_quick_lists(a);
+    a->quick_limit = max_blocks;
+}
+
+void *BuddyAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    BuddyAllocator* a = (BuddyAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+
+    BuddyNode* node = released_node(a, ptr);
+    if (!node) return (void*)-1;
+    forget_aligned(a, ptr);
+    if (quick_push(a, node)) return (void*)0;
+    free_node(a, node);
+    node = buddy_coalesce(a, node);
+    // Small releases still move the decay on from time to time
+    if (a->decay_ms > 0 && node->size < a->page_size && ++a->decay_ticks >= BUDDY_DECAY_TICKS) {
+        decay(a, now_seconds());
     }
-    
     return (void*)0;
 }
 
+int BuddyAllocator_reserve_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out) {
+    BuddyAllocator* a = (BuddyAllocator*)alloc;
+    if (!sizes) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL sizes in batch reserve\n" RESET);
+        #endif
+        return 0;
+    }
+    int allocated = 0;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = buddy_reserve(a, sizes[i]);
+        if (out[i]) allocated++;
+    }
+    return allocated;
+}
+
+// Free every block first, then merge in address order: a subtree whose blocks
+// are all in the batch is coalesced by a single upward walk
+int BuddyAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs) {
+    BuddyAllocator* a = (BuddyAllocator*)alloc;
+    Allocator_sort_addresses(ptrs, n);
+
+    int released = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!ptrs[i]) continue;
+        if (!buddy_release_block(a, ptrs[i])) {
+            ptrs[i] = NULL; // Invalid or double free, skipped below
+            continue;
+        }
+        released++;
+    }
+
+    // A merge frees the child nodes, so later blocks inside an already merged
+    // range are recognized by address only and their nodes are never read
+    char* merged_end = NULL;
+    for (size_t i = 0; i < n; i++) {
+        if (!ptrs[i]) continue;
+        if ((char*)ptrs[i] < merged_end) {
+            // No block starts inside a free range: an aligned_nodes entry here is stale
+            a->aligned_nodes[((char*)ptrs[i] - (char*)a->memory_start) / a->min_block_size] = NULL;
+            continue;
+        }
+        BuddyNode* node = node_of(a, ptrs[i]);
+        forget_aligned(a, ptrs[i]);
+        node = buddy_coalesce(a, node);
+        merged_end = node->data + node->size;
+    }
+    return released;
+}
+
+// Node of an allocated block, NULL if ptr is not one
+static BuddyNode* allocated_node(BuddyAllocator* a, void* ptr) {
+    if ((char*)ptr < (char*)a->memory_start ||
+        (char*)ptr >= (char*)a->memory_start + a->memory_size) {
+        return NULL;
+    }
+    BuddyNode* node = node_of(a, ptr);
+    if (!node || node->is_free || node->in_quick_list) return NULL;
+    if (node->data != (char*)ptr && node->data + BUDDY_METADATA_SIZE != (char*)ptr) return NULL;
+    return node;
+}
+
+// Usable bytes of an allocated block: aligned blocks have no header
+static inline size_t usable_size_of(BuddyNode* node, void* ptr) {
+    return node->data == (char*)ptr ? node->size : node->size - BUDDY_METADATA_SIZE;
+}
+
+// Resize in place: shrinking gives the right halves back, growing absorbs free
+// right buddies up the tree. Falls back to malloc, copy and free
+void* BuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    BuddyAllocator* a = (BuddyAllocator*)alloc;
+    if (!a) return NULL;
+    if (!ptr) return buddy_reserve(a, size);
+    if (size == 0) {
+        BuddyAllocator_release(alloc, ptr);
+        return NULL;
+    }
+    BuddyNode* node = allocated_node(a, ptr);
+    if (!node) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid pointer in realloc\n" RESET);
+        #endif
+        return NULL;
+    }
+    size_t adjusted_size = (size + BUDDY_METADATA_SIZE + 7) & ~(size_t)7;
+    if (adjusted_size > a->memory_size) return NULL;
+
+    // Growing: every block on the way up must be a left child with a whole free buddy.
+    // Aligned blocks keep their place only while the request fits
+    size_t reachable = node->size;
+    BuddyNode* top = node;
+    bool aligned = node->data == (char*)ptr;
+    if (aligned && size <= node->size) {
+        ((VariableBlockAllocator *) alloc)->internal_fragmentation += node->requested_size - size;
+        node->requested_size = size;
+        return ptr;
+    }
+    while (!aligned && reachable < adjusted_size && top->parent && top->data == top->parent->data && top->buddy->is_free) {
+        top = top->parent;
+        reachable *= 2;
+    }
+    if (aligned || reachable < adjusted_size) {
+        void* new_ptr = buddy_reserve(a, size);
+        if (!new_ptr) return NULL;
+        memcpy(new_ptr, ptr, usable_size_of(node, ptr));
+        BuddyAllocator_release(alloc, ptr);
+        return new_ptr;
+    }
+
+    VariableBlockAllocator* base = (VariableBlockAllocator*)alloc;
+    base->internal_fragmentation -= node->size - node->requested_size;
+    base->sparse_free_memory += node->size;
+    while (node != top) {
+        BuddyNode* parent = node->parent;
+        free_list_detach(a, node->buddy);
+        SlabAllocator_free(&a->node_allocator, node->buddy);
+        SlabAllocator_free(&a->node_allocator, node);
+        node = parent;
+    }
+
+    // Shrinking: keep the left half while it still fits, the right half goes back free
+    while (node->level < a->num_levels - 1 && node->size / 2 >= adjusted_size) {
+        struct Buddies buddies = BuddyAllocator_divide_block(a, node);
+        if (!buddies.left_buddy) break; // Out of nodes: keep the larger block
+        free_list_push(a, buddies.right_buddy);
+        forget_clean_pages(a, buddies.right_buddy->data, buddies.right_buddy->size);
+        buddies.right_buddy->dirty_since = 0;
+        note_dirty(a, buddies.right_buddy);
+        node = buddies.left_buddy;
+    }
+
+    node->is_free = false;
+    node->requested_size = adjusted_size;
+    base->internal_fragmentation += node->size - node->requested_size;
+    base->sparse_free_memory -= node->size;
+    mark_dirty(a, node);
+    *((BuddyNode**)node->data) = node;
+    return node->data + BUDDY_METADATA_SIZE;
+}
+
+size_t BuddyAllocator_block_usable_size(Allocator* alloc, void* ptr) {
+    BuddyNode* node = allocated_node((BuddyAllocator*)alloc, ptr);
+    return node ? usable_size_of(node, ptr) : 0;
+}
+
+// Blocks are aligned to their size, so a block at least as large as the alignment
+// is aligned too. The node goes to aligned_nodes and the whole block is usable
+void* BuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    BuddyAllocator* a = (BuddyAllocator*)alloc;
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in memalign!\n" RESET);
+        #endif
+        return NULL;
+    }
+    int level = level_for_size(a, size > alignment ? size : alignment);
+    if (level < 0 || ((a->memory_size >> level) & (alignment - 1)) != 0 ||
+        ((uintptr_t)a->memory_start & (alignment - 1)) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: No block of %zu bytes aligned to %zu\n" RESET, size, alignment);
+        #endif
+        return NULL;
+    }
+
+    BuddyNode* node = quick_pop(a, level);
+    if (!node) node = reserve_block(a, level);
+    if (!node) {
+        #ifdef DEBUG
+        printf(RED "ERROR: No free blocks available at any level\n" RESET);
+        #endif
+        return NULL;
+    }
+    // Only an arena whose size is not a power of two can give an unaligned block
+    if (((uintptr_t)node->data & (alignment - 1)) != 0) {
+        node->is_free = true;
+        free_list_push(a, node);
+        buddy_coalesce(a, node);
+        return NULL;
+    }
+
+    node->is_free = false;
+    node->requested_size = size;
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation += node->size - size;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory -= node->size;
+    a->aligned_nodes[(node->data - (char*)a->memory_start) / a->min_block_size] = node;
+    return node->data;
+}
+
+// Zero [start, end) except the pages purged since their last release, one run of dirty pages at a time
+static void zero_dirty_pages(BuddyAllocator* a, char* start, char* end) {
+    if (a->purged_bytes == 0) {
+        zero_memory(start, end - start);
+        return;
+    }
+    char* run = NULL;
+    for (char* p = start; p < end;) {
+        size_t page = (p - (char*)a->memory_start) / a->page_size;
+        char* page_end = (char*)a->memory_start + (page + 1) * a->page_size;
+        bool clean = bitmap_test(&a->clean_pages, page);
+        if (!clean && !run) run = p;
+        if (clean && run) {
+            zero_memory(run, p - run);
+            run = NULL;
+        }
+        p = page_end < end ? page_end : end;
+    }
+    if (run) zero_memory(run, end - run);
+}
+
+// The arena above the high-water mark was never handed out and is still zero
+// from mmap, and so are the purged pages: only the rest of the block is cleared
+void* BuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    BuddyAllocator* a = (BuddyAllocator*)alloc;
+    size_t total;
+    if (!a || __builtin_mul_overflow(nmemb, size, &total)) return NULL;
+    char* high_water = a->high_water;
+    char* ptr = buddy_reserve(a, total);
+    if (ptr && ptr < high_water) {
+        char* dirty_end = ptr + total < high_water ? ptr + total : high_water;
+        zero_dirty_pages(a, ptr, dirty_end);
+    }
+    return ptr;
+}
+
+void BuddyAllocator_set_decay(BuddyAllocator* a, long decay_ms) {
+    a->decay_ms = decay_ms < 0 ? -1 : decay_ms;
+    a->next_decay = 0;
+    if (a->decay_ms == 0) purge_dirty_blocks(a, HUGE_VAL);
+}
+
+size_t BuddyAllocator_purge(BuddyAllocator* a) {
+    BuddyAllocator_flush_quick_lists(a);
+    return purge_dirty_blocks(a, HUGE_VAL);
+}
+
 int BuddyAllocator_print_state(BuddyAllocator* a) {
     printf("Buddy Allocator state:\n");
     printf("\tTotal size: %zu bytes\n", a->memory_size);
     printf("\tNumber of levels: %d\n", a->num_levels);
     printf("\tMin block size: %zu bytes\n", a->min_block_size);
     printf("\tMemory start: %p\n", a->memory_start);
+    printf("\tPages: %s\n", arena_backing_name(a->backing));
+    printf("\tPurged: %zu bytes (decay %ld ms)\n", a->purged_bytes, a->decay_ms);
+    if (a->quick_limit > 0) {
+        printf("\tQuick lists (up to %u blocks):", a->quick_limit);
+        for (uint i = 0; i < a->num_levels; i++) printf(" %u", a->quick_counts[i]);
+        printf("\n");
+    }
     SlabAllocator_print_state(&a->node_allocator);
     printf("\tFree lists:\n");
     for (uint i = 0; i < a->num_levels; i++) {
@@ -0,0 +1,249 @@
+#include <concurrent_buddy_allocator.h>
+
+extern inline ConcurrentBuddyAllocator* ConcurrentBuddyAllocator_create(ConcurrentBuddyAllocator* a, size_t memory_size,
+                                                                        int num_levels, int num_subtrees);
+extern inline int ConcurrentBuddyAllocator_destroy(ConcurrentBuddyAllocator* a);
+extern inline void* ConcurrentBuddyAllocator_malloc(ConcurrentBuddyAllocator* a, size_t size);
+extern inline int ConcurrentBuddyAllocator_free(ConcurrentBuddyAllocator* a, void* ptr);
+extern inline void* ConcurrentBuddyAllocator_realloc(ConcurrentBuddyAllocator* a, void* ptr, size_t size);
+extern inline size_t ConcurrentBuddyAllocator_usable_size(ConcurrentBuddyAllocator* a, void* ptr);
+extern inline void* ConcurrentBuddyAllocator_memalign(ConcurrentBuddyAllocator* a, size_t alignment, size_t size);
+extern inline void* ConcurrentBuddyAllocator_calloc(ConcurrentBuddyAllocator* a, size_t nmemb, size_t size);
+
+// Threads are numbered on their first request, the home subtree is the number modulo num_subtrees
+static uint next_thread = 0;
+static __thread uint thread_number = UINT32_MAX;
+
+static inline uint home_subtree(ConcurrentBuddyAllocator* a) {
+    if (thread_number == UINT32_MAX) thread_number = __atomic_fetch_add(&next_thread, 1, __ATOMIC_RELAXED);
+    return thread_number & (a->num_subtrees - 1);
+}
+
+// Subtree holding ptr, NULL if ptr is outside the arena
+static inline ConcurrentBuddySubtree* subtree_of(ConcurrentBuddyAllocator* a, void* ptr) {
+    for (uint i = 0; i < a->num_subtrees; i++) {
+        if ((char*)ptr >= a->subtree_start[i] && (char*)ptr < a->subtree_start[i] + a->subtree_size) {
+            return &a->subtrees[i];
+        }
+    }
+    return NULL;
+}
+
+typedef void* (*SubtreeReserve)(BuddyAllocator* buddy, size_t alignment, size_t size);
+
+static void* subtree_malloc(BuddyAllocator* buddy, size_t alignment, size_t size) {
+    (void)alignment;
+    return BuddyAllocator_reserve((Allocator*)buddy, size);
+}
+
+static void* subtree_memalign(BuddyAllocator* buddy, size_t alignment, size_t size) {
+    return BuddyAllocator_reserve_aligned((Allocator*)buddy, alignment, size);
+}
+
+static void* subtree_calloc(BuddyAllocator* buddy, size_t alignment, size_t size) {
+    (void)alignment;
+    return BuddyAllocator_callocate((Allocator*)buddy, 1, size);
+}
+
+// The home subtree first, moving on from busy subtrees instead of waiting for them.
+// Only when none of the free ones can serve the request every lock is waited for
+static void* reserve_in_subtrees(ConcurrentBuddyAllocator* a, SubtreeReserve reserve, size_t alignment, size_t size) {
+    uint home = home_subtree(a);
+    uint mask = a->num_subtrees - 1;
+    for (uint i = 0; i < a->num_subtrees; i++) {
+        ConcurrentBuddySubtree* subtree = &a->subtrees[(home + i) & mask];
+        if (pthread_mutex_trylock(&subtree->lock) != 0) continue;
+        void* ptr = reserve(&subtree->buddy, alignment, size);
+        pthread_mutex_unlock(&subtree->lock);
+        if (ptr) return ptr;
+    }
+    for (uint i = 0; i < a->num_subtrees; i++) {
+        ConcurrentBuddySubtree* subtree = &a->subtrees[(home + i) & mask];
+        pthread_mutex_lock(&subtree->lock);
+        void* ptr = reserve(&subtree->buddy, alignment, size);
+        pthread_mutex_unlock(&subtree->lock);
+        if (ptr) return ptr;
+    }
+    return NULL;
+}
+
+void* ConcurrentBuddyAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    size_t memory_size = va_arg(args, size_t);
+    int num_levels = va_arg(args, int);
+    int num_subtrees = va_arg(args, int);
+    va_end(args);
+    if (!alloc || num_subtrees <= 0 || num_subtrees > CONCURRENT_BUDDY_MAX_SUBTREES ||
+        (num_subtrees & (num_subtrees - 1)) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid allocator or number of subtrees (%d)\n" RESET, num_subtrees);
+        #endif
+        return NULL;
+    }
+    // Subtrees start subtree_order levels down: the minimum block does not change
+    int subtree_order = __builtin_ctz(num_subtrees);
+    if (num_levels <= subtree_order) {
+        #ifdef DEBUG
+        printf(RED "ERROR: %d levels cannot hold %d subtrees\n" RESET, num_levels, num_subtrees);
+        #endif
+        return NULL;
+    }
+
+    a->num_subtrees = num_subtrees;
+    a->subtree_size = memory_size >> subtree_order;
+    a->memory_size = a->subtree_size * num_subtrees;
+    for (int i = 0; i < num_subtrees; i++) {
+        ConcurrentBuddySubtree* subtree = &a->subtrees[i];
+        if (!BuddyAllocator_create(&subtree->buddy, a->subtree_size, num_levels - subtree_order)) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to create subtree %d\n" RESET, i);
+            #endif
+            while (--i >= 0) {
+                BuddyAllocator_destroy(&a->subtrees[i].buddy);
+                pthread_mutex_destroy(&a->subtrees[i].lock);
+            }
+            return NULL;
+        }
+        pthread_mutex_init(&subtree->lock, NULL);
+        a->subtree_start[i] = subtree->buddy.memory_start;
+    }
+
+    alloc->init = ConcurrentBuddyAllocator_init;
+    alloc->dest = ConcurrentBuddyAllocator_cleanup;
+    alloc->malloc = ConcurrentBuddyAllocator_reserve;
+    alloc->free = ConcurrentBuddyAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = ConcurrentBuddyAllocator_reallocate;
+    alloc->usable_size = ConcurrentBuddyAllocator_block_usable_size;
+    alloc->memalign = ConcurrentBuddyAllocator_reserve_aligned;
+    alloc->calloc = ConcurrentBuddyAllocator_callocate;
+    ConcurrentBuddyAllocator_update_stats(a);
+    return a;
+}
+
+void* ConcurrentBuddyAllocator_cleanup(Allocator* alloc, ...) {
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    if (!a || a->num_subtrees == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or no subtrees in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    int result = 0;
+    for (uint i = 0; i < a->num_subtrees; i++) {
+        if (BuddyAllocator_destroy(&a->subtrees[i].buddy) != 0) result = -1;
+        pthread_mutex_destroy(&a->subtrees[i].lock);
+    }
+    a->num_subtrees = 0;
+    return (void*)(intptr_t)result;
+}
+
+void* ConcurrentBuddyAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in reserve!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return reserve_in_subtrees(a, subtree_malloc, 0, size);
+}
+
+void* ConcurrentBuddyAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    ConcurrentBuddySubtree* subtree = (a && ptr) ? subtree_of(a, ptr) : NULL;
+    if (!subtree) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer outside managed memory in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    pthread_mutex_lock(&subtree->lock);
+    int result = BuddyAllocator_free(&subtree->buddy, ptr);
+    pthread_mutex_unlock(&subtree->lock);
+    return (void*)(intptr_t)result;
+}
+
+// In place (or inside the same subtree) when the subtree allows it, otherwise
+// the block moves to whichever subtree can take it
+void* ConcurrentBuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    if (!a) return NULL;
+    if (!ptr) return size ? reserve_in_subtrees(a, subtree_malloc, 0, size) : NULL;
+    if (size == 0) {
+        ConcurrentBuddyAllocator_release(alloc, ptr);
+        return NULL;
+    }
+    ConcurrentBuddySubtree* subtree = subtree_of(a, ptr);
+    if (!subtree) return NULL;
+
+    pthread_mutex_lock(&subtree->lock);
+    size_t old_size = BuddyAllocator_block_usable_size((Allocator*)&subtree->buddy, ptr);
+    void* result = old_size ? BuddyAllocator_reallocate((Allocator*)&subtree->buddy, ptr, size) : NULL;
+    pthread_mutex_unlock(&subtree->lock);
+    if (result || !old_size) return result;
+
+    result = reserve_in_subtrees(a, subtree_malloc, 0, size);
+    if (!result) return NULL;
+    memcpy(result, ptr, old_size < size ? old_size : size);
+    ConcurrentBuddyAllocator_release(alloc, ptr);
+    return result;
+}
+
+size_t ConcurrentBuddyAllocator_block_usable_size(Allocator* alloc, void* ptr) {
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    ConcurrentBuddySubtree* subtree = (a && ptr) ? subtree_of(a, ptr) : NULL;
+    if (!subtree) return 0;
+    pthread_mutex_lock(&subtree->lock);
+    size_t size = BuddyAllocator_block_usable_size((Allocator*)&subtree->buddy, ptr);
+    pthread_mutex_unlock(&subtree->lock);
+    return size;
+}
+
+void* ConcurrentBuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    if (!a || size == 0) return NULL;
+    return reserve_in_subtrees(a, subtree_memalign, alignment, size);
+}
+
+void* ConcurrentBuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    ConcurrentBuddyAllocator* a = (ConcurrentBuddyAllocator*)alloc;
+    size_t total;
+    if (!a || __builtin_mul_overflow(nmemb, size, &total) || total == 0) return NULL;
+    return reserve_in_subtrees(a, subtree_calloc, 0, total);
+}
+
+void ConcurrentBuddyAllocator_update_stats(ConcurrentBuddyAllocator* a) {
+    size_t internal_fragmentation = 0, sparse_free_memory = 0;
+    for (uint i = 0; i < a->num_subtrees; i++) {
+        pthread_mutex_lock(&a->subtrees[i].lock);
+        internal_fragmentation += ((VariableBlockAllocator*)&a->subtrees[i].buddy)->internal_fragmentation;
+        sparse_free_memory += ((VariableBlockAllocator*)&a->subtrees[i].buddy)->sparse_free_memory;
+        pthread_mutex_unlock(&a->subtrees[i].lock);
+    }
+    ((VariableBlockAllocator*)a)->internal_fragmentation = internal_fragmentation;
+    ((VariableBlockAllocator*)a)->sparse_free_memory = sparse_free_memory;
+}
+
+int ConcurrentBuddyAllocator_print_state(ConcurrentBuddyAllocator* a) {
+    ConcurrentBuddyAllocator_update_stats(a);
+    printf("Concurrent Buddy Allocator state:\n");
+    printf("\tMemory size: %zu bytes in %u subtrees of %zu bytes\n", a->memory_size, a->num_subtrees, a->subtree_size);
+    printf("\tInternal fragmentation: %zu bytes\n", ((VariableBlockAllocator*)a)->internal_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator*)a)->sparse_free_memory);
+    for (uint i = 0; i < a->num_subtrees; i++) {
+        printf("\tSubtree %u: %zu bytes free\n", i, ((VariableBlockAllocator*)&a->subtrees[i].buddy)->sparse_free_memory);
+    }
+    return 0;
+}
@@ -1,4 +1,11 @@
 #include "bitmap.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITMAP_HAS_SIMD 1
+#endif
+
+#define BITMAP_FULL_WORD 0xFFFFFFFFu
+#define BITMAP_SIMD_MIN_WORDS 16 // Shorter runs are not worth the vector setup
 
 // Create a new bitmap with 'num_bits' capacity
 Bitmap* bitmap_create(Bitmap *bitmap, int num_bits, void *bits) {
@@ -82,19 +89,70 @@ int bitmap_find_first_set(Bitmap *bitmap) {
 // Find index of first zero bit (returns -1 if none)
 int bitmap_find_first_zero(Bitmap *bitmap) {
     if (!bitmap) return -1;
-    
-    for (int i = 0; i < bitmap->num_words; i++) {
-        // Check if there are any zeros in this word
-        if (bitmap->bits[i] != 0xFFFFFFFF) {
-            for (int j = 0; j < 32; j++) {
-                int bit_idx = i * 32 + j;
-                if (bit_idx >= bitmap->num_bits) break;
-                if (!bitmap_test(bitmap, bit_idx)) 
-                    return bit_idx;
-            }
-        }
+    return bitmap_find_zero_in_range(bitmap, 0, bitmap->num_bits);
+}
+
+// Find index of first zero bit at or after 'start' (returns -1 if none)
+int bitmap_find_zero_from(Bitmap *bitmap, int start) {
+    if (!bitmap) return -1;
+    return bitmap_find_zero_in_range(bitmap, start, bitmap->num_bits);
+}
+
+#ifdef BITMAP_HAS_SIMD
+// 8 words per compare, returns the first word in [from, to) that is not full, or to
+__attribute__((target("avx2")))
+static int skip_full_words_avx2(const uint *bits, int from, int to) {
+    const __m256i full = _mm256_set1_epi32(-1);
+    for (; from + 8 <= to; from += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(bits + from));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, full)));
+        if (mask != 0xFF) return from + __builtin_ctz(~mask);
     }
-    return -1;
+    while (from < to && bits[from] == BITMAP_FULL_WORD) from++;
+    return from;
+}
+
+// SSE2 is part of x86-64, 4 words per compare
+static int skip_full_words_sse2(const uint *bits, int from, int to) {
+    const __m128i full = _mm_set1_epi32(-1);
+    for (; from + 4 <= to; from += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(bits + from));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, full)));
+        if (mask != 0xF) return from + __builtin_ctz(~mask);
+    }
+    while (from < to && bits[from] == BITMAP_FULL_WORD) from++;
+    return from;
+}
+#endif
+
+static int skip_full_words(const uint *bits, int from, int to) {
+    #ifdef BITMAP_HAS_SIMD
+    if (to - from >= BITMAP_SIMD_MIN_WORDS) {
+        return __builtin_cpu_supports("avx2") ? skip_full_words_avx2(bits, from, to)
+                                              : skip_full_words_sse2(bits, from, to);
+    }
+    #endif
+    while (from < to && bits[from] == BITMAP_FULL_WORD) from++;
+    return from;
+}
+
+// Find index of first zero bit in [start, end) (returns -1 if none)
+// Works a word at a time: full words are skipped, the bit is found with ctz
+int bitmap_find_zero_in_range(Bitmap *bitmap, int start, int end) {
+    if (!bitmap || start < 0 || end > bitmap->num_bits || start >= end) return -1;
+
+    int word_idx = start / 32;
+    int last_word = (end - 1) / 32;
+    // Treat the bits before 'start' as set
+    uint word = bitmap->bits[word_idx] | ((1u << (start % 32)) - 1);
+    if (word == BITMAP_FULL_WORD) {
+        word_idx = skip_full_words(bitmap->bits, word_idx + 1, last_word + 1);
+        if (word_idx > last_word) return -1;
+        word = bitmap->bits[word_idx];
+    }
+    int bit_idx = word_idx * 32 + __builtin_ctz(~word);
+    // Bits past 'end' (and the padding past num_bits) are not reported
+    return bit_idx < end ? bit_idx : -1;
 }
 
 // Print bitmap info for debugging
@@ -0,0 +1,281 @@
+#include <growable_buddy_allocator.h>
+
+extern inline GrowableBuddyAllocator* GrowableBuddyAllocator_create(GrowableBuddyAllocator* a, size_t superblock_size,
+                                                                    int num_levels, int max_superblocks);
+extern inline int GrowableBuddyAllocator_destroy(GrowableBuddyAllocator* a);
+extern inline void* GrowableBuddyAllocator_malloc(GrowableBuddyAllocator* a, size_t size);
+extern inline int GrowableBuddyAllocator_free(GrowableBuddyAllocator* a, void* ptr);
+extern inline void* GrowableBuddyAllocator_realloc(GrowableBuddyAllocator* a, void* ptr, size_t size);
+extern inline size_t GrowableBuddyAllocator_usable_size(GrowableBuddyAllocator* a, void* ptr);
+extern inline void* GrowableBuddyAllocator_memalign(GrowableBuddyAllocator* a, size_t alignment, size_t size);
+extern inline void* GrowableBuddyAllocator_calloc(GrowableBuddyAllocator* a, size_t nmemb, size_t size);
+
+static inline size_t free_memory_of(GrowableSuperblock* sb) {
+    return ((VariableBlockAllocator*)&sb->buddy)->sparse_free_memory;
+}
+
+// Superblock holding ptr, -1 if ptr is outside every superblock
+static inline int superblock_of(GrowableBuddyAllocator* a, void* ptr) {
+    for (uint i = 0; i < a->num_superblocks; i++) {
+        char* start = a->superblocks[i].buddy.memory_start;
+        if ((char*)ptr >= start && (char*)ptr < start + a->superblock_size) return i;
+    }
+    return -1;
+}
+
+// The counters of the allocator follow the superblocks: add what an operation changed in one of them
+static inline void account(GrowableBuddyAllocator* a, GrowableSuperblock* sb, size_t fragmentation, size_t free_memory) {
+    VariableBlockAllocator* base = (VariableBlockAllocator*)a;
+    base->internal_fragmentation += ((VariableBlockAllocator*)&sb->buddy)->internal_fragmentation - fragmentation;
+    base->sparse_free_memory += free_memory_of(sb) - free_memory;
+}
+
+// Map one more superblock, NULL when there are max_superblocks already or mmap fails
+static GrowableSuperblock* grow(GrowableBuddyAllocator* a) {
+    if (a->num_superblocks == a->max_superblocks) return NULL;
+    GrowableSuperblock* sb = &a->superblocks[a->num_superblocks];
+    if (!BitmapBuddyAllocator_create(&sb->buddy, a->superblock_size, a->num_levels)) return NULL;
+    sb->max_free = a->superblock_size;
+    if (a->num_superblocks > 0) a->grown++;
+    a->num_superblocks++;
+    ((VariableBlockAllocator*)a)->sparse_free_memory += a->superblock_size;
+    return sb;
+}
+
+// Unmap a superblock left empty, unless it is the only empty one: that one stays as the spare.
+// The last superblock takes its place
+static void shrink_if_empty(GrowableBuddyAllocator* a, uint index) {
+    if (free_memory_of(&a->superblocks[index]) != a->superblock_size) return;
+    uint spare = 0;
+    while (spare < a->num_superblocks && (spare == index || free_memory_of(&a->superblocks[spare]) != a->superblock_size)) {
+        spare++;
+    }
+    if (spare == a->num_superblocks) return;
+    BitmapBuddyAllocator_destroy(&a->superblocks[index].buddy);
+    ((VariableBlockAllocator*)a)->sparse_free_memory -= a->superblock_size;
+    a->superblocks[index] = a->superblocks[--a->num_superblocks];
+    a->shrunk++;
+}
+
+typedef void* (*SuperblockReserve)(BitmapBuddyAllocator* buddy, size_t alignment, size_t size);
+
+static void* superblock_malloc(BitmapBuddyAllocator* buddy, size_t alignment, size_t size) {
+    (void)alignment;
+    return BitmapBuddyAllocator_reserve((Allocator*)buddy, size);
+}
+
+static void* superblock_memalign(BitmapBuddyAllocator* buddy, size_t alignment, size_t size) {
+    return BitmapBuddyAllocator_reserve_aligned((Allocator*)buddy, alignment, size);
+}
+
+static void* superblock_calloc(BitmapBuddyAllocator* buddy, size_t alignment, size_t size) {
+    (void)alignment;
+    return BitmapBuddyAllocator_callocate((Allocator*)buddy, 1, size);
+}
+
+// Reserve in one superblock. A failed request without alignment proves that the
+// superblock has no free block of need bytes
+static void* reserve_in(GrowableBuddyAllocator* a, GrowableSuperblock* sb, SuperblockReserve reserve,
+                        size_t alignment, size_t size, size_t need) {
+    size_t fragmentation = ((VariableBlockAllocator*)&sb->buddy)->internal_fragmentation;
+    size_t free_memory = free_memory_of(sb);
+    void* ptr = reserve(&sb->buddy, alignment, size);
+    if (ptr) {
+        account(a, sb, fragmentation, free_memory);
+    } else if (alignment == 0 && need <= sb->max_free) {
+        sb->max_free = need - 1;
+    }
+    return ptr;
+}
+
+// Fullest first among the superblocks whose summary allows a block of need bytes,
+// each tried once. When none of them can serve the request another superblock is mapped
+static void* reserve_in_superblocks(GrowableBuddyAllocator* a, SuperblockReserve reserve,
+                                    size_t alignment, size_t size, size_t need) {
+    if (need > a->superblock_size) return NULL;
+    uint32_t tried = 0;
+    for (;;) {
+        int best = -1;
+        for (uint i = 0; i < a->num_superblocks; i++) {
+            GrowableSuperblock* sb = &a->superblocks[i];
+            if (((tried >> i) & 1) || sb->max_free < need || free_memory_of(sb) < need) continue;
+            if (best < 0 || free_memory_of(sb) < free_memory_of(&a->superblocks[best])) best = i;
+        }
+        if (best < 0) break;
+        tried |= 1u << best;
+        void* ptr = reserve_in(a, &a->superblocks[best], reserve, alignment, size, need);
+        if (ptr) return ptr;
+    }
+    GrowableSuperblock* sb = grow(a);
+    if (!sb) {
+        #ifdef DEBUG
+        printf(RED "ERROR: No superblock can serve %zu bytes and no more can be mapped\n" RESET, size);
+        #endif
+        return NULL;
+    }
+    return reserve_in(a, sb, reserve, alignment, size, need);
+}
+
+void* GrowableBuddyAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    size_t superblock_size = va_arg(args, size_t);
+    int num_levels = va_arg(args, int);
+    int max_superblocks = va_arg(args, int);
+    va_end(args);
+    if (!alloc || max_superblocks <= 0 || max_superblocks > GROWABLE_BUDDY_MAX_SUPERBLOCKS) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid allocator or number of superblocks (%d)\n" RESET, max_superblocks);
+        #endif
+        return NULL;
+    }
+
+    a->num_superblocks = 0;
+    a->max_superblocks = max_superblocks;
+    a->superblock_size = superblock_size;
+    a->num_levels = num_levels;
+    a->grown = 0;
+    a->shrunk = 0;
+    ((VariableBlockAllocator*)a)->internal_fragmentation = 0;
+    ((VariableBlockAllocator*)a)->sparse_free_memory = 0;
+    // The first superblock is mapped now, so that invalid sizes fail here
+    if (!grow(a)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to create the first superblock\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    alloc->init = GrowableBuddyAllocator_init;
+    alloc->dest = GrowableBuddyAllocator_cleanup;
+    alloc->malloc = GrowableBuddyAllocator_reserve;
+    alloc->free = GrowableBuddyAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = GrowableBuddyAllocator_reallocate;
+    alloc->usable_size = GrowableBuddyAllocator_block_usable_size;
+    alloc->memalign = GrowableBuddyAllocator_reserve_aligned;
+    alloc->calloc = GrowableBuddyAllocator_callocate;
+    return a;
+}
+
+void* GrowableBuddyAllocator_cleanup(Allocator* alloc, ...) {
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    if (!a || a->num_superblocks == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or no superblocks in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    int result = 0;
+    for (uint i = 0; i < a->num_superblocks; i++) {
+        if (BitmapBuddyAllocator_destroy(&a->superblocks[i].buddy) != 0) result = -1;
+    }
+    a->num_superblocks = 0;
+    return (void*)(intptr_t)result;
+}
+
+void* GrowableBuddyAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in reserve!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return reserve_in_superblocks(a, superblock_malloc, 0, size, size + BITMAP_METADATA_SIZE);
+}
+
+void* GrowableBuddyAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    int index = (a && ptr) ? superblock_of(a, ptr) : -1;
+    if (index < 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer outside managed memory in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    GrowableSuperblock* sb = &a->superblocks[index];
+    size_t fragmentation = ((VariableBlockAllocator*)&sb->buddy)->internal_fragmentation;
+    size_t free_memory = free_memory_of(sb);
+    if (BitmapBuddyAllocator_release((Allocator*)&sb->buddy, ptr) != 0) return (void*)-1;
+    account(a, sb, fragmentation, free_memory);
+    sb->max_free = a->superblock_size; // The released block may have merged into anything
+    shrink_if_empty(a, index);
+    return (void*)0;
+}
+
+// In place (or inside the same superblock) when the superblock allows it, otherwise
+// the block moves to the fullest superblock that can take it
+void* GrowableBuddyAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    if (!a) return NULL;
+    if (!ptr) return size ? reserve_in_superblocks(a, superblock_malloc, 0, size, size + BITMAP_METADATA_SIZE) : NULL;
+    if (size == 0) {
+        GrowableBuddyAllocator_release(alloc, ptr);
+        return NULL;
+    }
+    int index = superblock_of(a, ptr);
+    if (index < 0) return NULL;
+    GrowableSuperblock* sb = &a->superblocks[index];
+    size_t old_size = BitmapBuddyAllocator_block_usable_size((Allocator*)&sb->buddy, ptr);
+    if (!old_size) return NULL;
+
+    size_t fragmentation = ((VariableBlockAllocator*)&sb->buddy)->internal_fragmentation;
+    size_t free_memory = free_memory_of(sb);
+    void* result = BitmapBuddyAllocator_reallocate((Allocator*)&sb->buddy, ptr, size);
+    if (result) {
+        account(a, sb, fragmentation, free_memory);
+        sb->max_free = a->superblock_size;
+        return result;
+    }
+
+    result = reserve_in_superblocks(a, superblock_malloc, 0, size, size + BITMAP_METADATA_SIZE);
+    if (!result) return NULL;
+    memcpy(result, ptr, old_size < size ? old_size : size);
+    GrowableBuddyAllocator_release(alloc, ptr);
+    return result;
+}
+
+size_t GrowableBuddyAllocator_block_usable_size(Allocator* alloc, void* ptr) {
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    int index = (a && ptr) ? superblock_of(a, ptr) : -1;
+    if (index < 0) return 0;
+    return BitmapBuddyAllocator_block_usable_size((Allocator*)&a->superblocks[index].buddy, ptr);
+}
+
+void* GrowableBuddyAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    if (!a || size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    return reserve_in_superblocks(a, superblock_memalign, alignment, size, size > alignment ? size : alignment);
+}
+
+void* GrowableBuddyAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    GrowableBuddyAllocator* a = (GrowableBuddyAllocator*)alloc;
+    size_t total;
+    if (!a || __builtin_mul_overflow(nmemb, size, &total) || total == 0) return NULL;
+    return reserve_in_superblocks(a, superblock_calloc, 0, total, total + BITMAP_METADATA_SIZE);
+}
+
+int GrowableBuddyAllocator_print_state(GrowableBuddyAllocator* a) {
+    printf("Growable Buddy Allocator state:\n");
+    printf("\tSuperblocks: %u of %zu bytes mapped (up to %u), %zu mapped later, %zu unmapped\n",
+           a->num_superblocks, a->superblock_size, a->max_superblocks, a->grown, a->shrunk);
+    printf("\tInternal fragmentation: %zu bytes\n", ((VariableBlockAllocator*)a)->internal_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator*)a)->sparse_free_memory);
+    for (uint i = 0; i < a->num_superblocks; i++) {
+        printf("\tSuperblock %u at %p: %zu bytes free, largest free block below %zu bytes\n", i,
+               (void*)a->superblocks[i].buddy.memory_start, free_memory_of(&a->superblocks[i]),
+               a->superblocks[i].max_free + 1);
+    }
+    return 0;
+}
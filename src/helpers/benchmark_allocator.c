@@ -261,6 +261,86 @@ int Allocator_benchmark_initialize(const char *file_name) {
             printf("Actual BITMAP_BUDDY_ALLOCATOR info: memory_size=%zu, num_levels=%u, min_block_size=%zu\n",
                    bitmap->memory_size, bitmap->num_levels, bitmap->min_block_size);
             break;
+        case SIZE_CLASS_ALLOCATOR:
+            printf("Running SIZE_CLASS_ALLOCATOR benchmark...\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                        config.max_log_size - config.log_offset,
+                        "# type=SIZE_CLASS_ALLOCATOR\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                                        config.max_log_size - config.log_offset,
+                                        "# memory_size=%zu\n",
+                                        params.size_class.memory_size);
+            SizeClassAllocator_create((SizeClassAllocator *)&allocator, params.size_class.memory_size);
+            config.allocator = (Allocator*) &allocator;
+            // Print actual info
+            SizeClassAllocator *size_class = (SizeClassAllocator *)&allocator;
+            printf("Actual SIZE_CLASS_ALLOCATOR info: memory_size=%zu, num_classes=%d, max_size=%d\n",
+                   size_class->memory_size, SIZE_CLASS_COUNT, SIZE_CLASS_MAX);
+            break;
+        case IMPLICIT_BUDDY_ALLOCATOR:
+            printf("Running IMPLICIT_BUDDY_ALLOCATOR benchmark...\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                        config.max_log_size - config.log_offset,
+                        "# type=IMPLICIT_BUDDY_ALLOCATOR\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                                        config.max_log_size - config.log_offset,
+                                        "# memory_size=%zu,max_levels=%zu\n",
+                                        params.buddy.memory_size, params.buddy.max_levels);
+            ImplicitBuddyAllocator_create((ImplicitBuddyAllocator *)&allocator, params.buddy.memory_size, params.buddy.max_levels);
+            config.allocator = (Allocator*) &allocator;
+            // Print actual info
+            ImplicitBuddyAllocator *implicit = (ImplicitBuddyAllocator *)&allocator;
+            printf("Actual IMPLICIT_BUDDY_ALLOCATOR info: memory_size=%zu, num_levels=%u, min_block_size=%zu, metadata_size=%zu\n",
+                   implicit->memory_size, implicit->num_levels, implicit->min_block_size, implicit->metadata_size);
+            break;
+        case TREE_BUDDY_ALLOCATOR:
+            printf("Running TREE_BUDDY_ALLOCATOR benchmark...\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                        config.max_log_size - config.log_offset,
+                        "# type=TREE_BUDDY_ALLOCATOR\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                                        config.max_log_size - config.log_offset,
+                                        "# memory_size=%zu,max_levels=%zu\n",
+                                        params.buddy.memory_size, params.buddy.max_levels);
+            TreeBuddyAllocator_create((TreeBuddyAllocator *)&allocator, params.buddy.memory_size, params.buddy.max_levels);
+            config.allocator = (Allocator*) &allocator;
+            // Print actual info
+            TreeBuddyAllocator *tree = (TreeBuddyAllocator *)&allocator;
+            printf("Actual TREE_BUDDY_ALLOCATOR info: memory_size=%zu, num_levels=%u, min_block_size=%zu\n",
+                   tree->memory_size, tree->num_levels, tree->min_block_size);
+            break;
+        case PSEUDO_ALLOCATOR:
+            printf("Running PSEUDO_ALLOCATOR benchmark...\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                        config.max_log_size - config.log_offset,
+                        "# type=PSEUDO_ALLOCATOR\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                                        config.max_log_size - config.log_offset,
+                                        "# memory_size=%zu,max_levels=%zu\n",
+                                        params.buddy.memory_size, params.buddy.max_levels);
+            PseudoAllocator_create((PseudoAllocator *)&allocator, params.buddy.memory_size, params.buddy.max_levels);
+            config.allocator = (Allocator*) &allocator;
+            // Print actual info
+            PseudoAllocator *pseudo = (PseudoAllocator *)&allocator;
+            printf("Actual PSEUDO_ALLOCATOR info: memory_size=%zu, num_levels=%u, small_limit=%zu\n",
+                   pseudo->small.memory_size, pseudo->small.num_levels, pseudo->small_limit);
+            break;
+        case TLSF_ALLOCATOR:
+            printf("Running TLSF_ALLOCATOR benchmark...\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                        config.max_log_size - config.log_offset,
+                        "# type=TLSF_ALLOCATOR\n");
+            config.log_offset += snprintf((char *)config.log_data + config.log_offset,
+                                        config.max_log_size - config.log_offset,
+                                        "# memory_size=%zu\n",
+                                        params.tlsf.memory_size);
+            TlsfAllocator_create((TlsfAllocator *)&allocator, params.tlsf.memory_size);
+            config.allocator = (Allocator*) &allocator;
+            // Print actual info
+            TlsfAllocator *tlsf = (TlsfAllocator *)&allocator;
+            printf("Actual TLSF_ALLOCATOR info: memory_size=%zu, min_block_size=%zu, second_level_lists=%d\n",
+                   tlsf->memory_size, TLSF_MIN_BLOCK, TLSF_SL_COUNT);
+            break;
         default:
             fprintf(stderr, "Unknown allocator type: %d\n", type);
             fclose(file);
@@ -288,6 +368,27 @@ int Allocator_benchmark_initialize(const char *file_name) {
             BitmapBuddyAllocator* bitmap = (BitmapBuddyAllocator *) config.allocator;
             n_pointers = 1 << (bitmap->num_levels - 1);
             break;
+        case SIZE_CLASS_ALLOCATOR:
+            // One pointer per slot over all the classes
+            SizeClassAllocator* size_class = (SizeClassAllocator *) config.allocator;
+            for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+                n_pointers += size_class->classes[i].num_slabs;
+            }
+            break;
+        case IMPLICIT_BUDDY_ALLOCATOR:
+            n_pointers = ((ImplicitBuddyAllocator *) config.allocator)->num_blocks;
+            break;
+        case TREE_BUDDY_ALLOCATOR:
+            n_pointers = (size_t)1 << ((TreeBuddyAllocator *) config.allocator)->num_levels;
+            break;
+        case PSEUDO_ALLOCATOR:
+            // Large requests do not use the buddy: at least as many as it has blocks
+            n_pointers = (size_t)1 << ((PseudoAllocator *) config.allocator)->small.num_levels;
+            break;
+        case TLSF_ALLOCATOR:
+            // As many as the smallest blocks that fit
+            n_pointers = ((TlsfAllocator *) config.allocator)->memory_size / TLSF_MIN_BLOCK;
+            break;
         default:
             fprintf(stderr, "Unknown allocator type: %d\n", type);
             result = -1;
@@ -381,6 +482,21 @@ int Allocator_benchmark_initialize(const char *file_name) {
         case BITMAP_BUDDY_ALLOCATOR:
             BitmapBuddyAllocator_print_state((BitmapBuddyAllocator *)config.allocator);
             break;
+        case SIZE_CLASS_ALLOCATOR:
+            SizeClassAllocator_print_state((SizeClassAllocator *)config.allocator);
+            break;
+        case IMPLICIT_BUDDY_ALLOCATOR:
+            ImplicitBuddyAllocator_print_state((ImplicitBuddyAllocator *)config.allocator);
+            break;
+        case TREE_BUDDY_ALLOCATOR:
+            TreeBuddyAllocator_print_state((TreeBuddyAllocator *)config.allocator);
+            break;
+        case PSEUDO_ALLOCATOR:
+            PseudoAllocator_print_state((PseudoAllocator *)config.allocator);
+            break;
+        case TLSF_ALLOCATOR:
+            TlsfAllocator_print_state((TlsfAllocator *)config.allocator);
+            break;
         default:
             fprintf(stderr, RED "Unknown allocator type: %d\n" RESET, type);
     }
@@ -0,0 +1,78 @@
+#include <helpers/huge_pages.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+
+static inline size_t round_up(size_t size, size_t unit) {
+    return (size + unit - 1) & ~(unit - 1);
+}
+
+// madvise(MADV_HUGEPAGE) succeeds even when transparent huge pages are turned off
+static int thp_enabled(void) {
+    static int enabled = -1;
+    if (enabled < 0) {
+        char mode[64] = "";
+        FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+        if (f) {
+            if (!fgets(mode, sizeof(mode), f)) mode[0] = '\0';
+            fclose(f);
+        }
+        enabled = mode[0] != '\0' && !strstr(mode, "[never]");
+    }
+    return enabled;
+}
+
+// Map with 2 MiB of slack and trim it, so that the arena starts on a huge page boundary
+static void* map_thp(size_t size) {
+    size_t mapped = round_up(size, sysconf(_SC_PAGESIZE));
+    size_t padded = mapped + HUGE_PAGE_SIZE;
+    char* raw = mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char* aligned = (char*)round_up((uintptr_t)raw, HUGE_PAGE_SIZE);
+    if (aligned > raw) munmap(raw, aligned - raw);
+    if (raw + padded > aligned + mapped) munmap(aligned + mapped, raw + padded - (aligned + mapped));
+    if (madvise(aligned, mapped, MADV_HUGEPAGE) != 0) {
+        munmap(aligned, mapped);
+        return NULL;
+    }
+    return aligned;
+}
+
+void* map_arena(size_t size, ArenaPages pages, ArenaBacking* backing) {
+    if (pages == ARENA_PAGES_HUGE && size >= HUGE_PAGE_SIZE) {
+        // The pool pages are reserved here: mmap fails at once if the pool is short
+        void* ptr = mmap(NULL, round_up(size, HUGE_PAGE_SIZE), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            *backing = ARENA_BACKING_HUGETLB;
+            return ptr;
+        }
+        ptr = thp_enabled() ? map_thp(size) : NULL;
+        if (ptr) {
+            *backing = ARENA_BACKING_THP;
+            return ptr;
+        }
+        #ifdef DEBUG
+        printf("No huge pages for a %zu bytes arena, using base pages\n", size);
+        #endif
+    }
+    *backing = ARENA_BACKING_BASE;
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+int unmap_arena(void* ptr, size_t size, ArenaBacking backing) {
+    // hugetlbfs mappings are unmapped in whole huge pages
+    if (backing == ARENA_BACKING_HUGETLB) size = round_up(size, HUGE_PAGE_SIZE);
+    return munmap(ptr, size);
+}
+
+const char* arena_backing_name(ArenaBacking backing) {
+    switch (backing) {
+        case ARENA_BACKING_THP: return "transparent huge pages";
+        case ARENA_BACKING_HUGETLB: return "hugetlbfs";
+        default: return "base pages";
+    }
+}
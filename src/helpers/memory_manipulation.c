@@ -5,6 +5,22 @@ void fill_memory_pattern(void* ptr, size_t size, unsigned char pattern) {
     memset(ptr, pattern, size);
 }
 
+void zero_memory(void* ptr, size_t size) {
+    if (size >= ZERO_MADVISE_MIN) {
+        uintptr_t page_size = sysconf(_SC_PAGESIZE);
+        uintptr_t start = (uintptr_t)ptr;
+        uintptr_t first_page = (start + page_size - 1) & ~(page_size - 1);
+        uintptr_t last_page = (start + size) & ~(page_size - 1);
+        // The next touch maps fresh zero pages, only the partial pages at the ends are written
+        if (madvise((void*)first_page, last_page - first_page, MADV_DONTNEED) == 0) {
+            memset(ptr, 0, first_page - start);
+            memset((void*)last_page, 0, start + size - last_page);
+            return;
+        }
+    }
+    memset(ptr, 0, size);
+}
+
 // Helper function to verify memory pattern
 int verify_memory_pattern(void* ptr, size_t size, unsigned char pattern) {
     unsigned char* bytes = (unsigned char*)ptr;
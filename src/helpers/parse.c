@@ -40,6 +40,16 @@ enum AllocatorType parse_allocator_create(FILE *file) {
     type = BUDDY_ALLOCATOR;
   } else if (strcmp(token, "bitmap") == 0) {
     type = BITMAP_BUDDY_ALLOCATOR;
+  } else if (strcmp(token, "sizeclass") == 0) {
+    type = SIZE_CLASS_ALLOCATOR;
+  } else if (strcmp(token, "implicit") == 0) {
+    type = IMPLICIT_BUDDY_ALLOCATOR;
+  } else if (strcmp(token, "tree") == 0) {
+    type = TREE_BUDDY_ALLOCATOR;
+  } else if (strcmp(token, "pseudo") == 0) {
+    type = PSEUDO_ALLOCATOR;
+  } else if (strcmp(token, "tlsf") == 0) {
+    type = TLSF_ALLOCATOR;
   } else {
     #ifdef DEBUG
     fprintf(stderr, RED "Unknown allocator type: '%s'\n" RESET, token);
@@ -83,7 +93,9 @@ union AllocatorParameterData parse_allocator_create_parameters(FILE *file, struc
     }
     data.slab.n_slabs = strtoul(token, NULL, 10);
     
-  } else if (config->type == BUDDY_ALLOCATOR || config->type == BITMAP_BUDDY_ALLOCATOR) {
+  } else if (config->type == BUDDY_ALLOCATOR || config->type == BITMAP_BUDDY_ALLOCATOR ||
+             config->type == IMPLICIT_BUDDY_ALLOCATOR || config->type == TREE_BUDDY_ALLOCATOR ||
+             config->type == PSEUDO_ALLOCATOR) {
     // Parse buddy allocator parameters
     token = strtok(NULL, ",");
     if (!token) {
@@ -103,6 +115,26 @@ union AllocatorParameterData parse_allocator_create_parameters(FILE *file, struc
     }
     data.buddy.max_levels = strtoul(token, NULL, 10);
     
+  } else if (config->type == SIZE_CLASS_ALLOCATOR) {
+    token = strtok(NULL, ",");
+    if (!token) {
+      #ifdef DEBUG
+      fprintf(stderr, RED "No memory size specified for size class allocator\n" RESET);
+      #endif
+      return data;
+    }
+    data.size_class.memory_size = strtoul(token, NULL, 10);
+
+  } else if (config->type == TLSF_ALLOCATOR) {
+    token = strtok(NULL, ",");
+    if (!token) {
+      #ifdef DEBUG
+      fprintf(stderr, RED "No memory size specified for TLSF allocator\n" RESET);
+      #endif
+      return data;
+    }
+    data.tlsf.memory_size = strtoul(token, NULL, 10);
+
   } else {
     #ifdef DEBUG
     fprintf(stderr, RED "Unknown allocator type for parameters: %d\n" RESET, config->type);
@@ -0,0 +1,230 @@
+#include <implicit_buddy_allocator.h>
+
+extern inline ImplicitBuddyAllocator* ImplicitBuddyAllocator_create(ImplicitBuddyAllocator* a, size_t memory_size, int num_levels);
+extern inline int ImplicitBuddyAllocator_destroy(ImplicitBuddyAllocator* a);
+extern inline void* ImplicitBuddyAllocator_malloc(ImplicitBuddyAllocator* a, size_t size);
+extern inline int ImplicitBuddyAllocator_free(ImplicitBuddyAllocator* a, void* ptr);
+
+static inline ImplicitBuddyLinks* links_of(ImplicitBuddyAllocator* a, uint32_t index) {
+    return (ImplicitBuddyLinks*)(a->memory_start + ((size_t)index << a->min_block_shift));
+}
+
+// Free lists are doubly linked through the free blocks, so a buddy is unlinked in O(1)
+
+static inline void free_list_push(ImplicitBuddyAllocator* a, uint order, uint32_t index) {
+    ImplicitBuddyLinks* links = links_of(a, index);
+    links->prev = IMPLICIT_BUDDY_NIL;
+    links->next = a->free_heads[order];
+    if (links->next != IMPLICIT_BUDDY_NIL) links_of(a, links->next)->prev = index;
+    a->free_heads[order] = index;
+    a->free_order_mask |= 1u << order;
+    a->state[index] = IMPLICIT_BUDDY_FREE | order;
+}
+
+static inline void free_list_remove(ImplicitBuddyAllocator* a, uint order, uint32_t index) {
+    ImplicitBuddyLinks* links = links_of(a, index);
+    if (links->prev != IMPLICIT_BUDDY_NIL) {
+        links_of(a, links->prev)->next = links->next;
+    } else {
+        a->free_heads[order] = links->next;
+        if (links->next == IMPLICIT_BUDDY_NIL) a->free_order_mask &= ~(1u << order);
+    }
+    if (links->next != IMPLICIT_BUDDY_NIL) links_of(a, links->next)->prev = links->prev;
+}
+
+void* ImplicitBuddyAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    ImplicitBuddyAllocator* a = (ImplicitBuddyAllocator*)alloc;
+    size_t memory_size = va_arg(args, size_t);
+    int num_levels = va_arg(args, int) + 1; // +1 for the root level
+    va_end(args);
+    // Requested sizes are stored in 32 bits
+    if (!alloc || memory_size < sizeof(ImplicitBuddyLinks) || memory_size > UINT32_MAX ||
+        num_levels <= 1 || num_levels >= IMPLICIT_BUDDY_MAX_LEVELS) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid parameters in create!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    // Power of two minimum block, large enough for the free list links
+    size_t min_block_size = memory_size >> (num_levels - 1);
+    while (min_block_size < sizeof(ImplicitBuddyLinks) && num_levels > 1) {
+        num_levels--;
+        min_block_size = memory_size >> (num_levels - 1);
+    }
+    a->min_block_shift = 63 - __builtin_clzll(min_block_size);
+    a->min_block_size = (size_t)1 << a->min_block_shift;
+    a->num_levels = num_levels;
+    a->num_blocks = (uint32_t)1 << (num_levels - 1);
+    a->memory_size = a->min_block_size << (num_levels - 1);
+
+    // Arena first so blocks keep the page alignment, then state bytes and requested sizes
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t arena_size = (a->memory_size + page_size - 1) & ~(page_size - 1);
+    a->metadata_size = (size_t)a->num_blocks * (sizeof(uint8_t) + sizeof(uint32_t));
+    a->mapping_size = (arena_size + a->metadata_size + page_size - 1) & ~(page_size - 1);
+    char* mapping = mmap(NULL, a->mapping_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to allocate memory in init!\n" RESET);
+        #endif
+        return NULL;
+    }
+    a->memory_start = mapping;
+    a->requested_size = (uint32_t*)(mapping + arena_size);
+    a->state = (uint8_t*)(a->requested_size + a->num_blocks);
+
+    for (int i = 0; i < IMPLICIT_BUDDY_MAX_LEVELS; i++) a->free_heads[i] = IMPLICIT_BUDDY_NIL;
+    a->free_order_mask = 0;
+    free_list_push(a, num_levels - 1, 0);
+
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation = 0;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory = a->memory_size;
+
+    alloc->init = ImplicitBuddyAllocator_init;
+    alloc->dest = ImplicitBuddyAllocator_cleanup;
+    alloc->malloc = ImplicitBuddyAllocator_reserve;
+    alloc->free = ImplicitBuddyAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = NULL;
+    alloc->usable_size = NULL;
+    alloc->memalign = NULL;
+    alloc->calloc = NULL;
+    return a;
+}
+
+void* ImplicitBuddyAllocator_cleanup(Allocator* alloc, ...) {
+    ImplicitBuddyAllocator* a = (ImplicitBuddyAllocator*)alloc;
+    if (!a || !a->memory_start) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or memory in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    if (munmap(a->memory_start, a->mapping_size) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to unmap memory in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    a->memory_start = NULL;
+    return (void*)0;
+}
+
+void* ImplicitBuddyAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    ImplicitBuddyAllocator* a = (ImplicitBuddyAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0 || size > a->memory_size) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size (%zu) in reserve!\n" RESET, size);
+        #endif
+        return NULL;
+    }
+
+    // Smallest order holding size bytes: ceil(log2(minimum blocks needed))
+    size_t units = (size - 1) >> a->min_block_shift;
+    uint order = units ? 64 - __builtin_clzll(units) : 0;
+
+    // Smallest non-empty order at or above it
+    uint32_t candidates = a->free_order_mask & ~((1u << order) - 1);
+    if (!candidates) {
+        #ifdef DEBUG
+        printf(RED "ERROR: No free blocks available at any level\n" RESET);
+        #endif
+        if (size < ((VariableBlockAllocator *) alloc)->sparse_free_memory) {
+            printf("\t EXTERNAL FRAGMENTATION: request of %zu bytes and %zu bytes of sparse free memory available.\n",
+                   size, ((VariableBlockAllocator *) alloc)->sparse_free_memory);
+        }
+        return NULL;
+    }
+    uint current = __builtin_ctz(candidates);
+    uint32_t index = a->free_heads[current];
+    free_list_remove(a, current, index);
+
+    // Split, the upper halves go back to the free lists
+    while (current > order) {
+        current--;
+        free_list_push(a, current, index + ((uint32_t)1 << current));
+    }
+
+    size_t block_size = a->min_block_size << order;
+    a->state[index] = IMPLICIT_BUDDY_ALLOCATED | order;
+    a->requested_size[index] = (uint32_t)size;
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation += block_size - size;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory -= block_size;
+    return links_of(a, index);
+}
+
+void* ImplicitBuddyAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    ImplicitBuddyAllocator* a = (ImplicitBuddyAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    if (!a || !ptr) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+
+    size_t offset = (char*)ptr - a->memory_start;
+    if ((char*)ptr < a->memory_start || offset >= a->memory_size ||
+        (offset & (a->min_block_size - 1)) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Pointer is not the start of a block!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    uint32_t index = (uint32_t)(offset >> a->min_block_shift);
+    uint8_t state = a->state[index];
+    if (!(state & IMPLICIT_BUDDY_ALLOCATED)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Attempting to release a free or invalid block\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+
+    uint order = state & IMPLICIT_BUDDY_ORDER_MASK;
+    size_t block_size = a->min_block_size << order;
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation -= block_size - a->requested_size[index];
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory += block_size;
+    a->state[index] = 0;
+
+    // Merge while the buddy is a free block of the same order
+    while (order < a->num_levels - 1) {
+        uint32_t buddy = index ^ ((uint32_t)1 << order);
+        if (a->state[buddy] != (IMPLICIT_BUDDY_FREE | order)) break;
+        free_list_remove(a, order, buddy);
+        a->state[buddy] = 0;
+        index &= buddy;
+        order++;
+    }
+    free_list_push(a, order, index);
+    return (void*)0;
+}
+
+int ImplicitBuddyAllocator_print_state(ImplicitBuddyAllocator* a) {
+    printf("Implicit Buddy Allocator state:\n");
+    printf("\tTotal size: %zu bytes\n", a->memory_size);
+    printf("\tNumber of levels: %u\n", a->num_levels);
+    printf("\tMin block size: %zu bytes\n", a->min_block_size);
+    printf("\tMetadata: %zu bytes\n", a->metadata_size);
+    printf("\tInternal fragmentation: %zu bytes\n", ((VariableBlockAllocator *) a)->internal_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator *) a)->sparse_free_memory);
+    printf("\tFree blocks:\n");
+    for (uint level = 0; level < a->num_levels; level++) {
+        uint order = a->num_levels - 1 - level;
+        int count = 0;
+        for (uint32_t i = a->free_heads[order]; i != IMPLICIT_BUDDY_NIL; i = links_of(a, i)->next) count++;
+        printf("\tLevel %u (block size %zu): %d free\n", level, a->min_block_size << order, count);
+    }
+    return 0;
+}
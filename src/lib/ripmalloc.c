@@ -0,0 +1,192 @@
+// malloc, free, calloc, realloc and the aligned variants on a process-wide
+// PseudoAllocator, so that real programs can be run on it through LD_PRELOAD.
+// Build: make lib
+// Usage: LD_PRELOAD=./bin/libripmalloc.so <program>
+//        RIPMALLOC_STATS=1 prints the allocator state on stderr at exit
+// One mutex guards the allocator: it measures the allocator, not its scalability
+#include <pseudo_allocator.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define RIPMALLOC_MEMORY (16 << 20) // Small memory of the process-wide allocator
+#define RIPMALLOC_LEVELS 19 // 32B minimum blocks in 16 MiB
+#define RIPMALLOC_BOOTSTRAP_SIZE (64 * 1024) // Served while the allocator is being created
+#define EXPORT __attribute__((visibility("default")))
+
+static PseudoAllocator allocator;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static bool ready = false; // Read and written with the lock held
+static bool creating = false; // Set while create runs, a malloc then cannot take the lock
+
+// Bump allocator for requests made while creating: never released, still zero when handed out
+static char bootstrap[RIPMALLOC_BOOTSTRAP_SIZE] __attribute__((aligned(PSEUDO_ALIGNMENT)));
+static size_t bootstrap_used = 0;
+
+static void* bootstrap_reserve(size_t alignment, size_t size) {
+    if (size > RIPMALLOC_BOOTSTRAP_SIZE || alignment > RIPMALLOC_BOOTSTRAP_SIZE) return NULL;
+    size_t needed = (size + alignment + PSEUDO_ALIGNMENT - 1) & ~(size_t)(PSEUDO_ALIGNMENT - 1);
+    size_t offset = __atomic_fetch_add(&bootstrap_used, needed, __ATOMIC_RELAXED);
+    if (offset + needed > RIPMALLOC_BOOTSTRAP_SIZE) return NULL;
+    return (void*)(((uintptr_t)(bootstrap + offset) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+static inline bool in_bootstrap(void* ptr) {
+    return (char*)ptr >= bootstrap && (char*)ptr < bootstrap + RIPMALLOC_BOOTSTRAP_SIZE;
+}
+
+static inline bool is_creating(void) {
+    return __atomic_load_n(&creating, __ATOMIC_ACQUIRE);
+}
+
+// Create the allocator on first use, with the lock held
+static bool ensure_ready(void) {
+    if (ready) return true;
+    __atomic_store_n(&creating, true, __ATOMIC_RELEASE);
+    ready = PseudoAllocator_create(&allocator, RIPMALLOC_MEMORY, RIPMALLOC_LEVELS) != NULL;
+    __atomic_store_n(&creating, false, __ATOMIC_RELEASE);
+    return ready;
+}
+
+// Only the forking thread survives in the child: the lock must not be held by another one
+static void before_fork(void) {
+    pthread_mutex_lock(&lock);
+}
+
+static void after_fork(void) {
+    pthread_mutex_unlock(&lock);
+}
+
+static void after_fork_child(void) {
+    pthread_mutex_init(&lock, NULL);
+}
+
+__attribute__((constructor)) static void ripmalloc_init(void) {
+    pthread_atfork(before_fork, after_fork, after_fork_child);
+}
+
+// Counters are copied under the lock and printed after it: fprintf may allocate
+__attribute__((destructor)) static void ripmalloc_fini(void) {
+    const char* stats = getenv("RIPMALLOC_STATS");
+    if (!stats || !*stats || *stats == '0') return;
+    pthread_mutex_lock(&lock);
+    bool was_ready = ready;
+    PseudoAllocator snapshot = allocator;
+    pthread_mutex_unlock(&lock);
+    if (!was_ready) return;
+    fprintf(stderr, "ripmalloc: %zu bytes of internal fragmentation (%zu in mappings), %zu bytes free\n",
+            ((VariableBlockAllocator*)&snapshot)->internal_fragmentation, snapshot.large_fragmentation,
+            ((VariableBlockAllocator*)&snapshot)->sparse_free_memory);
+    fprintf(stderr, "ripmalloc: region cache %zu bytes, %zu hits, %zu misses\n",
+            snapshot.cached_bytes, snapshot.cache_hits, snapshot.cache_misses);
+}
+
+// malloc(0) and calloc with a zero size return a unique block as glibc does
+static void* reserve(size_t alignment, size_t size) {
+    if (size == 0) size = 1;
+    if (is_creating()) return bootstrap_reserve(alignment, size);
+    void* ptr = NULL;
+    pthread_mutex_lock(&lock);
+    if (ensure_ready()) {
+        ptr = alignment > PSEUDO_ALIGNMENT ? PseudoAllocator_memalign(&allocator, alignment, size)
+                                           : PseudoAllocator_malloc(&allocator, size);
+    }
+    pthread_mutex_unlock(&lock);
+    if (!ptr) errno = ENOMEM;
+    return ptr;
+}
+
+static inline bool is_power_of_two(size_t x) {
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+EXPORT void* malloc(size_t size) {
+    return reserve(PSEUDO_ALIGNMENT, size);
+}
+
+EXPORT void free(void* ptr) {
+    if (!ptr || in_bootstrap(ptr)) return;
+    pthread_mutex_lock(&lock);
+    if (ready) PseudoAllocator_free(&allocator, ptr);
+    pthread_mutex_unlock(&lock);
+}
+
+EXPORT void* calloc(size_t nmemb, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(nmemb, size, &total)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (total == 0) total = 1;
+    if (is_creating()) return bootstrap_reserve(PSEUDO_ALIGNMENT, total);
+    void* ptr = NULL;
+    pthread_mutex_lock(&lock);
+    if (ensure_ready()) ptr = PseudoAllocator_calloc(&allocator, 1, total);
+    pthread_mutex_unlock(&lock);
+    if (!ptr) errno = ENOMEM;
+    return ptr;
+}
+
+EXPORT void* realloc(void* ptr, size_t size) {
+    if (!ptr) return malloc(size);
+    if (in_bootstrap(ptr)) {
+        // Bootstrap blocks have no size: copy up to the end of the buffer
+        void* moved = malloc(size);
+        size_t available = bootstrap + RIPMALLOC_BOOTSTRAP_SIZE - (char*)ptr;
+        if (moved) memcpy(moved, ptr, size < available ? size : available);
+        return moved;
+    }
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+    void* result = NULL;
+    pthread_mutex_lock(&lock);
+    if (ready) result = PseudoAllocator_realloc(&allocator, ptr, size);
+    pthread_mutex_unlock(&lock);
+    if (!result) errno = ENOMEM;
+    return result;
+}
+
+EXPORT int posix_memalign(void** memptr, size_t alignment, size_t size) {
+    if (!is_power_of_two(alignment) || alignment % sizeof(void*) != 0) return EINVAL;
+    void* ptr = reserve(alignment, size);
+    if (!ptr) return ENOMEM;
+    *memptr = ptr;
+    return 0;
+}
+
+EXPORT void* aligned_alloc(size_t alignment, size_t size) {
+    if (!is_power_of_two(alignment)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return reserve(alignment, size);
+}
+
+EXPORT void* memalign(size_t alignment, size_t size) {
+    return aligned_alloc(alignment, size);
+}
+
+EXPORT void* valloc(size_t size) {
+    return reserve(sysconf(_SC_PAGESIZE), size);
+}
+
+EXPORT void* pvalloc(size_t size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    if (size > SIZE_MAX - page_size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return reserve(page_size, (size + page_size - 1) & ~(page_size - 1));
+}
+
+EXPORT size_t malloc_usable_size(void* ptr) {
+    if (!ptr) return 0;
+    if (in_bootstrap(ptr)) return bootstrap + RIPMALLOC_BOOTSTRAP_SIZE - (char*)ptr;
+    size_t size = 0;
+    pthread_mutex_lock(&lock);
+    if (ready) size = PseudoAllocator_usable_size(&allocator, ptr);
+    pthread_mutex_unlock(&lock);
+    return size;
+}
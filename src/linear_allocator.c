@@ -0,0 +1,307 @@
+#include <linear_allocator.h>
+
+extern inline LinearAllocator* LinearAllocator_create(LinearAllocator* a, size_t chunk_size);
+extern inline int LinearAllocator_destroy(LinearAllocator* a);
+extern inline void* LinearAllocator_malloc(LinearAllocator* a, size_t size);
+extern inline int LinearAllocator_free(LinearAllocator* a, void* ptr);
+extern inline void* LinearAllocator_realloc(LinearAllocator* a, void* ptr, size_t size);
+extern inline void* LinearAllocator_memalign(LinearAllocator* a, size_t alignment, size_t size);
+extern inline void* LinearAllocator_calloc(LinearAllocator* a, size_t nmemb, size_t size);
+
+static inline char* chunk_start(LinearChunk* c) {
+    return (char*)c + LINEAR_HEADER_SIZE;
+}
+
+static inline char* chunk_end(LinearChunk* c) {
+    return (char*)c + c->size;
+}
+
+// End of the blocks of a chunk
+static inline char* chunk_top(LinearAllocator* a, LinearChunk* c) {
+    return c == a->current ? a->top : c->top;
+}
+
+// Move the top of the current chunk down, remembering how far the chunk was handed out
+static inline void lower_top(LinearAllocator* a, char* top) {
+    if (a->top > a->current->clean) a->current->clean = a->top;
+    a->top = top;
+}
+
+// Chunk holding the block at ptr, NULL if ptr is not a block of a
+static LinearChunk* chunk_of(LinearAllocator* a, void* ptr) {
+    for (LinearChunk* c = a->current; c; c = c->prev) {
+        if ((char*)ptr >= chunk_start(c) && (char*)ptr < chunk_top(a, c)) return c;
+    }
+    return NULL;
+}
+
+static void unmap_chunk(LinearAllocator* a, LinearChunk* c) {
+    a->mapped -= c->size;
+    unmap_arena(c, c->size, c->backing);
+}
+
+// Make the current chunk one that can hold size bytes aligned to alignment:
+// the spare if it is large enough, a new mapping otherwise
+static bool push_chunk(LinearAllocator* a, size_t size, size_t alignment) {
+    size_t padding = alignment > LINEAR_ALIGNMENT ? alignment : 0;
+    if (size > SIZE_MAX / 2 - padding) return false;
+    size_t needed = LINEAR_HEADER_SIZE + padding + size;
+    LinearChunk* c;
+    if (a->spare && needed <= a->spare->size) {
+        c = a->spare;
+        a->spare = NULL;
+    } else {
+        size_t chunk_size = a->chunk_size;
+        if (needed > chunk_size) chunk_size = (needed + PAGESIZE - 1) / PAGESIZE * PAGESIZE;
+        ArenaBacking backing;
+        c = map_arena(chunk_size, ARENA_PAGES_BASE, &backing);
+        if (!c) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to map a chunk of %zu bytes\n" RESET, chunk_size);
+            #endif
+            return false;
+        }
+        c->size = chunk_size;
+        c->clean = chunk_start(c);
+        c->backing = backing;
+        a->mapped += chunk_size;
+    }
+    if (a->current) {
+        a->current->top = a->top;
+        if (a->top > a->current->clean) a->current->clean = a->top;
+    }
+    c->prev = a->current;
+    a->current = c;
+    a->top = chunk_start(c);
+    a->end = chunk_end(c);
+    return true;
+}
+
+static inline void* bump(LinearAllocator* a, size_t alignment, size_t size) {
+    uintptr_t block = ((uintptr_t)a->top + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (block > (uintptr_t)a->end || size > (uintptr_t)a->end - block) {
+        if (!push_chunk(a, size, alignment)) return NULL;
+        block = ((uintptr_t)a->top + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    a->top = (char*)block + size;
+    a->last = (char*)block;
+    return (void*)block;
+}
+
+void* LinearAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    LinearAllocator* a = (LinearAllocator*)alloc;
+    size_t chunk_size = va_arg(args, size_t);
+    va_end(args);
+    if (!alloc || chunk_size == 0 || chunk_size > SIZE_MAX / 2) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid allocator or chunk size (%zu)\n" RESET, chunk_size);
+        #endif
+        return NULL;
+    }
+
+    a->current = NULL;
+    a->top = NULL;
+    a->end = NULL;
+    a->last = NULL;
+    a->spare = NULL;
+    a->chunk_size = (chunk_size + PAGESIZE - 1) / PAGESIZE * PAGESIZE;
+    a->mapped = 0;
+    if (!push_chunk(a, 0, LINEAR_ALIGNMENT)) return NULL;
+
+    alloc->init = LinearAllocator_init;
+    alloc->dest = LinearAllocator_cleanup;
+    alloc->malloc = LinearAllocator_reserve;
+    alloc->free = LinearAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = LinearAllocator_reallocate;
+    alloc->usable_size = NULL; // No per-block metadata
+    alloc->memalign = LinearAllocator_reserve_aligned;
+    alloc->calloc = LinearAllocator_callocate;
+    return a;
+}
+
+void* LinearAllocator_cleanup(Allocator* alloc, ...) {
+    LinearAllocator* a = (LinearAllocator*)alloc;
+    if (!a || !a->current) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or no chunks in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    while (a->current) {
+        LinearChunk* prev = a->current->prev;
+        unmap_chunk(a, a->current);
+        a->current = prev;
+    }
+    if (a->spare) unmap_chunk(a, a->spare);
+    a->spare = NULL;
+    a->top = a->end = a->last = NULL;
+    return (void*)0;
+}
+
+void* LinearAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    LinearAllocator* a = (LinearAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in reserve!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return bump(a, LINEAR_ALIGNMENT, size);
+}
+
+// Only the last block goes back, any other block of the allocator is left to the next reset
+void* LinearAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    LinearAllocator* a = (LinearAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    if (!a || !ptr) return (void*)-1;
+    if (ptr == a->last) {
+        lower_top(a, a->last);
+        a->last = NULL;
+        return (void*)0;
+    }
+    if (!chunk_of(a, ptr)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Pointer outside the blocks of the allocator in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    return (void*)0;
+}
+
+// The last block grows or shrinks in place while its chunk allows it. Blocks have no size:
+// a moved block copies what lies between it and the top of its chunk, up to size bytes
+void* LinearAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    LinearAllocator* a = (LinearAllocator*)alloc;
+    if (!a) return NULL;
+    if (!ptr) return size ? bump(a, LINEAR_ALIGNMENT, size) : NULL;
+    if (size == 0) {
+        LinearAllocator_release(alloc, ptr);
+        return NULL;
+    }
+
+    size_t old_size;
+    if (ptr == a->last) {
+        if (size <= (size_t)(a->end - a->last)) {
+            if (a->last + size < a->top) {
+                lower_top(a, a->last + size);
+            } else {
+                a->top = a->last + size;
+            }
+            return ptr;
+        }
+        old_size = a->top - a->last;
+    } else {
+        LinearChunk* c = chunk_of(a, ptr);
+        if (!c) return NULL;
+        old_size = chunk_top(a, c) - (char*)ptr;
+    }
+    void* result = bump(a, LINEAR_ALIGNMENT, size);
+    if (!result) return NULL;
+    memcpy(result, ptr, old_size < size ? old_size : size);
+    return result;
+}
+
+void* LinearAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    LinearAllocator* a = (LinearAllocator*)alloc;
+    if (!a || size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    return bump(a, alignment < LINEAR_ALIGNMENT ? LINEAR_ALIGNMENT : alignment, size);
+}
+
+// Chunks come zeroed from mmap: only the part of the block below the clean mark is cleared
+void* LinearAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    LinearAllocator* a = (LinearAllocator*)alloc;
+    size_t total;
+    if (!a || __builtin_mul_overflow(nmemb, size, &total) || total == 0) return NULL;
+    char* block = bump(a, LINEAR_ALIGNMENT, total);
+    if (!block) return NULL;
+    char* clean = a->current->clean;
+    if (clean > block) memset(block, 0, (size_t)(clean - block) < total ? (size_t)(clean - block) : total);
+    return block;
+}
+
+LinearMark LinearAllocator_mark(LinearAllocator* a) {
+    LinearMark mark = {a, a ? a->current : NULL, a ? a->top : NULL};
+    return mark;
+}
+
+int LinearAllocator_reset_to(LinearAllocator* a, LinearMark mark) {
+    if (!a || mark.allocator != a) return -1;
+    LinearChunk* c = a->current;
+    while (c && c != mark.chunk) c = c->prev;
+    if (!c || mark.top < chunk_start(c) || mark.top > chunk_top(a, c)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Mark already released by an earlier reset\n" RESET);
+        #endif
+        return -1;
+    }
+
+    // Chunks newer than the mark go, one of them is kept as the spare
+    while (a->current != mark.chunk) {
+        LinearChunk* dropped = a->current;
+        if (a->top > dropped->clean) dropped->clean = a->top;
+        a->current = dropped->prev;
+        a->top = a->current->top;
+        if (!a->spare && dropped->size == a->chunk_size) {
+            a->spare = dropped;
+        } else {
+            unmap_chunk(a, dropped);
+        }
+    }
+    a->end = chunk_end(a->current);
+    lower_top(a, mark.top);
+    a->last = NULL;
+    return 0;
+}
+
+int LinearAllocator_reset(LinearAllocator* a) {
+    if (!a || !a->current) return -1;
+    LinearChunk* first = a->current;
+    while (first->prev) first = first->prev;
+    LinearMark mark = {a, first, chunk_start(first)};
+    return LinearAllocator_reset_to(a, mark);
+}
+
+static pthread_key_t scratch_key;
+static pthread_once_t scratch_once = PTHREAD_ONCE_INIT;
+static __thread LinearAllocator scratch;
+static __thread bool scratch_ready;
+
+static void scratch_destroy(void* arg) {
+    LinearAllocator_destroy((LinearAllocator*)arg);
+    scratch_ready = false;
+}
+
+static void scratch_key_create(void) {
+    pthread_key_create(&scratch_key, scratch_destroy);
+}
+
+LinearAllocator* LinearAllocator_scratch(void) {
+    if (!scratch_ready) {
+        pthread_once(&scratch_once, scratch_key_create);
+        if (!LinearAllocator_create(&scratch, LINEAR_SCRATCH_CHUNK_SIZE)) return NULL;
+        pthread_setspecific(scratch_key, &scratch);
+        scratch_ready = true;
+    }
+    return &scratch;
+}
+
+int LinearAllocator_print_state(LinearAllocator* a) {
+    printf("Linear Allocator state:\n");
+    printf("\tChunk size: %zu bytes, %zu bytes mapped%s\n", a->chunk_size, a->mapped, a->spare ? " (with a spare chunk)" : "");
+    for (LinearChunk* c = a->current; c; c = c->prev) {
+        printf("\tChunk at %p: %zu of %zu bytes used (%s pages)\n", (void*)c, (size_t)(chunk_top(a, c) - chunk_start(c)),
+               c->size - LINEAR_HEADER_SIZE, arena_backing_name(c->backing));
+    }
+    return 0;
+}
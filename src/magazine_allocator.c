@@ -0,0 +1,365 @@
+#include "magazine_allocator.h"
+
+extern inline MagazineAllocator* MagazineAllocator_create(MagazineAllocator* a, size_t object_size, size_t num_objects);
+extern inline int MagazineAllocator_destroy(MagazineAllocator* a);
+extern inline void* MagazineAllocator_malloc(MagazineAllocator* a);
+extern inline int MagazineAllocator_free(MagazineAllocator* a, void* ptr);
+
+// Index of the object at ptr, -1 if ptr is not the start of an object of the slab
+static long object_index(MagazineAllocator* a, void* ptr) {
+    if ((char*)ptr < a->slab.slabs_start) return -1;
+    size_t offset = (char*)ptr - a->slab.slabs_start;
+    if (offset % a->slab.slab_size != 0 || offset / a->slab.slab_size >= a->slab.num_slabs) return -1;
+    return (long)(offset / a->slab.slab_size);
+}
+
+// Depot helpers, called with depot_lock held
+
+// An object leaves the depot or the slab for a thread
+static inline void mark_taken(MagazineAllocator* a, void* ptr) {
+    long index = object_index(a, ptr);
+    a->in_use[index / 64] |= (uint64_t)1 << (index % 64);
+}
+
+// An object comes back to the depot or the slab, false if it already was there (a double free)
+static inline bool mark_returned(MagazineAllocator* a, void* ptr) {
+    long index = object_index(a, ptr);
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    if (!(a->in_use[index / 64] & bit)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Double free of a cached object, dropped!\n" RESET);
+        #endif
+        return false;
+    }
+    a->in_use[index / 64] &= ~bit;
+    return true;
+}
+
+static Magazine* depot_get_empty(MagazineAllocator* a) {
+    Magazine* m = a->empty;
+    if (m) {
+        a->empty = m->next;
+        a->num_empty--;
+        return m;
+    }
+    m = SlabAllocator_malloc(&a->magazine_pool);
+    if (m) m->rounds = 0;
+    return m;
+}
+
+static void depot_put(MagazineAllocator* a, Magazine* m) {
+    if (!m) return;
+    // Double frees are dropped here, one copy of the object stays
+    uint kept = 0;
+    for (uint i = 0; i < m->rounds; i++) {
+        if (mark_returned(a, m->round[i])) m->round[kept++] = m->round[i];
+    }
+    m->rounds = kept;
+    if (m->rounds == MAGAZINE_SIZE) {
+        m->next = a->full;
+        a->full = m;
+        a->num_full++;
+        return;
+    }
+    // Partially filled magazines go back to the slab, the depot only holds full or empty ones
+    while (m->rounds > 0) {
+        SlabAllocator_free(&a->slab, m->round[--m->rounds]);
+    }
+    m->next = a->empty;
+    a->empty = m;
+    a->num_empty++;
+}
+
+// Find (or create) the calling thread's cache
+static MagazineThreadCache* thread_cache(MagazineAllocator* a) {
+    MagazineThreadCache* cache = pthread_getspecific(a->key);
+    if (cache) return cache;
+
+    pthread_mutex_lock(&a->depot_lock);
+    cache = SlabAllocator_malloc(&a->cache_pool);
+    if (cache) {
+        cache->owner = a;
+        cache->loaded = depot_get_empty(a);
+        cache->previous = depot_get_empty(a);
+        if (!cache->loaded || !cache->previous) {
+            depot_put(a, cache->loaded);
+            depot_put(a, cache->previous);
+            SlabAllocator_free(&a->cache_pool, cache);
+            cache = NULL;
+        }
+    }
+    pthread_mutex_unlock(&a->depot_lock);
+
+    // Too many threads: this one goes through the depot lock every time
+    if (cache) pthread_setspecific(a->key, cache);
+    return cache;
+}
+
+static void thread_cache_release(MagazineThreadCache* cache) {
+    MagazineAllocator* a = cache->owner;
+    pthread_mutex_lock(&a->depot_lock);
+    depot_put(a, cache->loaded);
+    depot_put(a, cache->previous);
+    SlabAllocator_free(&a->cache_pool, cache);
+    pthread_mutex_unlock(&a->depot_lock);
+}
+
+// pthread key destructor, runs at thread exit
+static void thread_cache_destructor(void* value) {
+    if (value) thread_cache_release((MagazineThreadCache*)value);
+}
+
+void MagazineAllocator_thread_flush(MagazineAllocator* a) {
+    if (!a) return;
+    MagazineThreadCache* cache = pthread_getspecific(a->key);
+    if (!cache) return;
+    pthread_setspecific(a->key, NULL);
+    thread_cache_release(cache);
+}
+
+// Initialize MagazineAllocator
+void *MagazineAllocator_init(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to MagazineAllocator_init\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    MagazineAllocator* a = (MagazineAllocator*)alloc;
+    va_list args;
+    va_start(args, alloc);
+
+    // Parse variadic args (object_size, num_objects)
+    size_t object_size = va_arg(args, size_t);
+    size_t num_objects = va_arg(args, size_t);
+    va_end(args);
+
+    if (object_size == 0 || num_objects == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to create: invalid parameters!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    if (!SlabAllocator_create_with_mode(&a->slab, object_size, num_objects, SLAB_MODE_EMBEDDED)) {
+        return NULL;
+    }
+    // Enough magazines for every object plus two per thread cache and the depot's spares
+    size_t num_magazines = num_objects / MAGAZINE_SIZE + 2 * MAGAZINE_MAX_THREADS + 2;
+    if (!SlabAllocator_create_with_mode(&a->magazine_pool, sizeof(Magazine), num_magazines, SLAB_MODE_EMBEDDED)) {
+        SlabAllocator_destroy(&a->slab);
+        return NULL;
+    }
+    if (!SlabAllocator_create_with_mode(&a->cache_pool, sizeof(MagazineThreadCache), MAGAZINE_MAX_THREADS, SLAB_MODE_EMBEDDED)) {
+        SlabAllocator_destroy(&a->magazine_pool);
+        SlabAllocator_destroy(&a->slab);
+        return NULL;
+    }
+    // Fresh mmap memory is zeroed: every object is in the slab
+    a->in_use_size = (a->slab.num_slabs + 63) / 64 * sizeof(uint64_t);
+    a->in_use = mmap(NULL, a->in_use_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (a->in_use == MAP_FAILED) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to map the in use bitmap!\n" RESET);
+        #endif
+        SlabAllocator_destroy(&a->cache_pool);
+        SlabAllocator_destroy(&a->magazine_pool);
+        SlabAllocator_destroy(&a->slab);
+        return NULL;
+    }
+    if (pthread_key_create(&a->key, thread_cache_destructor) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to create thread cache key!\n" RESET);
+        #endif
+        munmap(a->in_use, a->in_use_size);
+        SlabAllocator_destroy(&a->cache_pool);
+        SlabAllocator_destroy(&a->magazine_pool);
+        SlabAllocator_destroy(&a->slab);
+        return NULL;
+    }
+    pthread_mutex_init(&a->depot_lock, NULL);
+    a->full = NULL;
+    a->empty = NULL;
+    a->num_full = 0;
+    a->num_empty = 0;
+
+    // Setup interface methods
+    alloc->init = MagazineAllocator_init;
+    alloc->dest = MagazineAllocator_cleanup;
+    alloc->malloc = MagazineAllocator_reserve;
+    alloc->free = MagazineAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = MagazineAllocator_release_batch;
+    alloc->realloc = NULL;
+    alloc->usable_size = NULL;
+    alloc->memalign = NULL;
+    alloc->calloc = NULL;
+    return (void*)1;
+}
+
+// Clean up MagazineAllocator
+void *MagazineAllocator_cleanup(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to MagazineAllocator_cleanup\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    MagazineAllocator* a = (MagazineAllocator*)alloc;
+    // Deleting the key first stops the destructor from touching unmapped caches
+    pthread_key_delete(a->key);
+    pthread_mutex_destroy(&a->depot_lock);
+    munmap(a->in_use, a->in_use_size);
+    SlabAllocator_destroy(&a->cache_pool);
+    SlabAllocator_destroy(&a->magazine_pool);
+    SlabAllocator_destroy(&a->slab);
+    return (void*)1;
+}
+
+// Allocate an object
+void *MagazineAllocator_reserve(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to MagazineAllocator_reserve\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    MagazineAllocator* a = (MagazineAllocator*)alloc;
+    MagazineThreadCache* cache = thread_cache(a);
+    void* ptr = NULL;
+    if (!cache) {
+        pthread_mutex_lock(&a->depot_lock);
+        ptr = SlabAllocator_malloc(&a->slab);
+        if (ptr) mark_taken(a, ptr);
+        pthread_mutex_unlock(&a->depot_lock);
+        return ptr;
+    }
+
+    // Fast path: no shared state
+    if (cache->loaded->rounds > 0) {
+        return cache->loaded->round[--cache->loaded->rounds];
+    }
+    if (cache->previous->rounds > 0) {
+        Magazine* tmp = cache->loaded;
+        cache->loaded = cache->previous;
+        cache->previous = tmp;
+        return cache->loaded->round[--cache->loaded->rounds];
+    }
+
+    // Both magazines are empty: trade one for a full magazine from the depot
+    pthread_mutex_lock(&a->depot_lock);
+    if (a->full) {
+        Magazine* m = a->full;
+        a->full = m->next;
+        a->num_full--;
+        for (uint i = 0; i < m->rounds; i++) mark_taken(a, m->round[i]);
+        depot_put(a, cache->previous);
+        cache->previous = cache->loaded;
+        cache->loaded = m;
+    } else {
+        // Depot is empty too: refill from the slab
+        while (cache->loaded->rounds < MAGAZINE_SIZE / 2) {
+            void* obj = SlabAllocator_malloc(&a->slab);
+            if (!obj) break;
+            mark_taken(a, obj);
+            cache->loaded->round[cache->loaded->rounds++] = obj;
+        }
+    }
+    if (cache->loaded->rounds > 0) {
+        ptr = cache->loaded->round[--cache->loaded->rounds];
+    }
+    pthread_mutex_unlock(&a->depot_lock);
+
+    #ifdef DEBUG
+    if (!ptr) printf(RED "ERROR: Failed to allocate: out of memory!\n" RESET);
+    #endif
+    return ptr;
+}
+
+// Free an object
+void *MagazineAllocator_release(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to MagazineAllocator_release\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    MagazineAllocator* a = (MagazineAllocator*)alloc;
+    va_list args;
+    va_start(args, alloc);
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+
+    // Objects sit in magazines before they reach the slab: the slot is checked here, as the
+    // slab would. Double frees are caught once the object gets to the depot or the slab
+    if (object_index(a, ptr) < 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to free: pointer is not the start of an object!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    MagazineThreadCache* cache = thread_cache(a);
+    if (!cache) {
+        pthread_mutex_lock(&a->depot_lock);
+        void* r = mark_returned(a, ptr) ? SlabAllocator_release((Allocator*)&a->slab, ptr) : NULL;
+        pthread_mutex_unlock(&a->depot_lock);
+        return r;
+    }
+
+    // Fast path: no shared state
+    if (cache->loaded->rounds < MAGAZINE_SIZE) {
+        cache->loaded->round[cache->loaded->rounds++] = ptr;
+        return (void*)1;
+    }
+    if (cache->previous->rounds == 0) {
+        Magazine* tmp = cache->loaded;
+        cache->loaded = cache->previous;
+        cache->previous = tmp;
+        cache->loaded->round[cache->loaded->rounds++] = ptr;
+        return (void*)1;
+    }
+
+    // Both magazines are full: hand one to the depot for an empty one
+    void* r = (void*)1;
+    pthread_mutex_lock(&a->depot_lock);
+    Magazine* m = depot_get_empty(a);
+    if (m) {
+        depot_put(a, cache->previous);
+        cache->previous = cache->loaded;
+        cache->loaded = m;
+        cache->loaded->round[cache->loaded->rounds++] = ptr;
+    } else {
+        r = mark_returned(a, ptr) ? SlabAllocator_release((Allocator*)&a->slab, ptr) : NULL;
+    }
+    pthread_mutex_unlock(&a->depot_lock);
+    return r;
+}
+
+// Release reports failures as NULL, which the generic fallback cannot see
+int MagazineAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs) {
+    int released = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!ptrs[i]) continue;
+        if (!MagazineAllocator_release(alloc, ptrs[i])) {
+            ptrs[i] = NULL;
+            continue;
+        }
+        released++;
+    }
+    return released;
+}
+
+void MagazineAllocator_print_state(MagazineAllocator* a) {
+    printf("\tMagazineAllocator Info:\n");
+    printf("\tMagazine Size: %d rounds\n", MAGAZINE_SIZE);
+    pthread_mutex_lock(&a->depot_lock);
+    printf("\tDepot: %u full, %u empty magazines\n", a->num_full, a->num_empty);
+    printf("\tObjects in slab: %u/%u used (including cached in magazines)\n",
+           a->slab.num_slabs - a->slab.free_list_size, a->slab.num_slabs);
+    pthread_mutex_unlock(&a->depot_lock);
+}
@@ -11,10 +11,32 @@ int main(int argc, char* argv[]) {
   line
   test_slab_allocator();
   line
+  test_slab_cache();
+  line
+  test_magazine_allocator();
+  line
+  test_size_class_allocator();
+  line
   test_buddy_allocator();
   line
   test_bitmap_buddy_allocator();
   line
+  test_implicit_buddy_allocator();
+  line
+  test_tree_buddy_allocator();
+  line
+  test_pseudo_allocator();
+  line
+  test_concurrent_buddy_allocator();
+  line
+  test_multi_arena_allocator();
+  line
+  test_growable_buddy_allocator();
+  line
+  test_linear_allocator();
+  line
+  test_tlsf_allocator();
+  line
   benchmark();
   if(argc>1) {
     printf("Program arguments (%d):\n", argc);
@@ -0,0 +1,292 @@
+#include <multi_arena_allocator.h>
+
+extern inline MultiArenaAllocator* MultiArenaAllocator_create(MultiArenaAllocator* a, size_t arena_size,
+                                                              int num_levels, int num_arenas);
+extern inline int MultiArenaAllocator_destroy(MultiArenaAllocator* a);
+extern inline void* MultiArenaAllocator_malloc(MultiArenaAllocator* a, size_t size);
+extern inline int MultiArenaAllocator_free(MultiArenaAllocator* a, void* ptr);
+extern inline void* MultiArenaAllocator_realloc(MultiArenaAllocator* a, void* ptr, size_t size);
+extern inline size_t MultiArenaAllocator_usable_size(MultiArenaAllocator* a, void* ptr);
+extern inline void* MultiArenaAllocator_memalign(MultiArenaAllocator* a, size_t alignment, size_t size);
+extern inline void* MultiArenaAllocator_calloc(MultiArenaAllocator* a, size_t nmemb, size_t size);
+
+// Threads are numbered on their first request, the home arena is the number modulo num_arenas
+static uint next_thread = 0;
+static __thread uint thread_number = UINT32_MAX;
+
+static inline uint home_arena(MultiArenaAllocator* a) {
+    if (thread_number == UINT32_MAX) thread_number = __atomic_fetch_add(&next_thread, 1, __ATOMIC_RELAXED);
+    return thread_number % a->num_arenas;
+}
+
+// Index of the arena holding ptr, -1 if ptr is outside every arena
+static inline int arena_of(MultiArenaAllocator* a, void* ptr) {
+    for (uint i = 0; i < a->num_arenas; i++) {
+        BitmapBuddyAllocator* buddy = &a->arenas[i].buddy;
+        if ((char*)ptr >= buddy->memory_start && (char*)ptr < buddy->memory_start + buddy->memory_size) return i;
+    }
+    return -1;
+}
+
+// Push a block released by a thread of another arena: its first word links it to the previous one.
+// Counted before it is pushed, so remote_frees never falls behind remote_drained
+static inline void push_remote(MultiArena* arena, void* ptr) {
+    __atomic_fetch_add(&arena->remote_frees, 1, __ATOMIC_RELAXED);
+    void* head = __atomic_load_n(&arena->remote_head, __ATOMIC_RELAXED);
+    do {
+        *(void**)ptr = head;
+    } while (!__atomic_compare_exchange_n(&arena->remote_head, &head, ptr, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+// Release every stacked block, with the arena lock held. The whole stack is taken
+// at once, so blocks pushed meanwhile simply wait for the next drain
+static void drain_remote(MultiArena* arena) {
+    if (!__atomic_load_n(&arena->remote_head, __ATOMIC_RELAXED)) return;
+    void* block = __atomic_exchange_n(&arena->remote_head, NULL, __ATOMIC_ACQUIRE);
+    while (block) {
+        void* next = *(void**)block;
+        BitmapBuddyAllocator_release((Allocator*)&arena->buddy, block);
+        arena->remote_drained++;
+        block = next;
+    }
+}
+
+typedef void* (*ArenaReserve)(BitmapBuddyAllocator* buddy, size_t alignment, size_t size);
+
+static void* arena_malloc(BitmapBuddyAllocator* buddy, size_t alignment, size_t size) {
+    (void)alignment;
+    return BitmapBuddyAllocator_reserve((Allocator*)buddy, size);
+}
+
+static void* arena_memalign(BitmapBuddyAllocator* buddy, size_t alignment, size_t size) {
+    return BitmapBuddyAllocator_reserve_aligned((Allocator*)buddy, alignment, size);
+}
+
+static void* arena_calloc(BitmapBuddyAllocator* buddy, size_t alignment, size_t size) {
+    (void)alignment;
+    return BitmapBuddyAllocator_callocate((Allocator*)buddy, 1, size);
+}
+
+static inline void* reserve_locked(MultiArena* arena, ArenaReserve reserve, size_t alignment, size_t size) {
+    drain_remote(arena);
+    void* ptr = reserve(&arena->buddy, alignment, size);
+    pthread_mutex_unlock(&arena->lock);
+    return ptr;
+}
+
+// The home arena first, moving on from busy arenas instead of waiting for them.
+// Only when none of the free ones can serve the request every lock is waited for
+static void* reserve_in_arenas(MultiArenaAllocator* a, ArenaReserve reserve, size_t alignment, size_t size) {
+    uint home = home_arena(a);
+    for (uint i = 0; i < a->num_arenas; i++) {
+        MultiArena* arena = &a->arenas[(home + i) % a->num_arenas];
+        if (pthread_mutex_trylock(&arena->lock) != 0) continue;
+        void* ptr = reserve_locked(arena, reserve, alignment, size);
+        if (ptr) return ptr;
+    }
+    for (uint i = 0; i < a->num_arenas; i++) {
+        MultiArena* arena = &a->arenas[(home + i) % a->num_arenas];
+        pthread_mutex_lock(&arena->lock);
+        void* ptr = reserve_locked(arena, reserve, alignment, size);
+        if (ptr) return ptr;
+    }
+    return NULL;
+}
+
+void* MultiArenaAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    size_t arena_size = va_arg(args, size_t);
+    int num_levels = va_arg(args, int);
+    int num_arenas = va_arg(args, int);
+    va_end(args);
+    if (!alloc || num_arenas <= 0 || num_arenas > MULTI_ARENA_MAX_ARENAS) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid allocator or number of arenas (%d)\n" RESET, num_arenas);
+        #endif
+        return NULL;
+    }
+    // A stacked block holds the link to the next one
+    while (num_levels > 0 && (arena_size >> num_levels) < BITMAP_METADATA_SIZE + sizeof(void*)) num_levels--;
+
+    a->num_arenas = num_arenas;
+    a->arena_size = arena_size;
+    for (int i = 0; i < num_arenas; i++) {
+        MultiArena* arena = &a->arenas[i];
+        if (!BitmapBuddyAllocator_create(&arena->buddy, arena_size, num_levels)) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to create arena %d\n" RESET, i);
+            #endif
+            while (--i >= 0) {
+                BitmapBuddyAllocator_destroy(&a->arenas[i].buddy);
+                pthread_mutex_destroy(&a->arenas[i].lock);
+            }
+            a->num_arenas = 0;
+            return NULL;
+        }
+        pthread_mutex_init(&arena->lock, NULL);
+        arena->remote_head = NULL;
+        arena->remote_frees = 0;
+        arena->remote_drained = 0;
+    }
+
+    alloc->init = MultiArenaAllocator_init;
+    alloc->dest = MultiArenaAllocator_cleanup;
+    alloc->malloc = MultiArenaAllocator_reserve;
+    alloc->free = MultiArenaAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = MultiArenaAllocator_reallocate;
+    alloc->usable_size = MultiArenaAllocator_block_usable_size;
+    alloc->memalign = MultiArenaAllocator_reserve_aligned;
+    alloc->calloc = MultiArenaAllocator_callocate;
+    MultiArenaAllocator_update_stats(a);
+    return a;
+}
+
+void* MultiArenaAllocator_cleanup(Allocator* alloc, ...) {
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    if (!a || a->num_arenas == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or no arenas in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    // Stacked blocks go away with their arena
+    int result = 0;
+    for (uint i = 0; i < a->num_arenas; i++) {
+        if (BitmapBuddyAllocator_destroy(&a->arenas[i].buddy) != 0) result = -1;
+        pthread_mutex_destroy(&a->arenas[i].lock);
+    }
+    a->num_arenas = 0;
+    return (void*)(intptr_t)result;
+}
+
+void* MultiArenaAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in reserve!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return reserve_in_arenas(a, arena_malloc, 0, size);
+}
+
+void* MultiArenaAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    int index = (a && ptr) ? arena_of(a, ptr) : -1;
+    if (index < 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer outside managed memory in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    MultiArena* arena = &a->arenas[index];
+    if ((uint)index != home_arena(a)) {
+        push_remote(arena, ptr);
+        return (void*)0;
+    }
+    pthread_mutex_lock(&arena->lock);
+    void* result = BitmapBuddyAllocator_release((Allocator*)&arena->buddy, ptr);
+    pthread_mutex_unlock(&arena->lock);
+    return result;
+}
+
+// In place (or inside the same arena) when the arena allows it, otherwise
+// the block moves to whichever arena can take it
+void* MultiArenaAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    if (!a) return NULL;
+    if (!ptr) return size ? reserve_in_arenas(a, arena_malloc, 0, size) : NULL;
+    if (size == 0) {
+        MultiArenaAllocator_release(alloc, ptr);
+        return NULL;
+    }
+    int index = arena_of(a, ptr);
+    if (index < 0) return NULL;
+
+    MultiArena* arena = &a->arenas[index];
+    pthread_mutex_lock(&arena->lock);
+    drain_remote(arena); // Stacked neighbours may let the block grow in place
+    size_t old_size = BitmapBuddyAllocator_block_usable_size((Allocator*)&arena->buddy, ptr);
+    void* result = old_size ? BitmapBuddyAllocator_reallocate((Allocator*)&arena->buddy, ptr, size) : NULL;
+    pthread_mutex_unlock(&arena->lock);
+    if (result || !old_size) return result;
+
+    result = reserve_in_arenas(a, arena_malloc, 0, size);
+    if (!result) return NULL;
+    memcpy(result, ptr, old_size < size ? old_size : size);
+    MultiArenaAllocator_release(alloc, ptr);
+    return result;
+}
+
+size_t MultiArenaAllocator_block_usable_size(Allocator* alloc, void* ptr) {
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    int index = (a && ptr) ? arena_of(a, ptr) : -1;
+    if (index < 0) return 0;
+    pthread_mutex_lock(&a->arenas[index].lock);
+    size_t size = BitmapBuddyAllocator_block_usable_size((Allocator*)&a->arenas[index].buddy, ptr);
+    pthread_mutex_unlock(&a->arenas[index].lock);
+    return size;
+}
+
+void* MultiArenaAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    if (!a || size == 0) return NULL;
+    return reserve_in_arenas(a, arena_memalign, alignment, size);
+}
+
+void* MultiArenaAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    MultiArenaAllocator* a = (MultiArenaAllocator*)alloc;
+    size_t total;
+    if (!a || __builtin_mul_overflow(nmemb, size, &total) || total == 0) return NULL;
+    return reserve_in_arenas(a, arena_calloc, 0, total);
+}
+
+void MultiArenaAllocator_collect(MultiArenaAllocator* a) {
+    for (uint i = 0; i < a->num_arenas; i++) {
+        pthread_mutex_lock(&a->arenas[i].lock);
+        drain_remote(&a->arenas[i]);
+        pthread_mutex_unlock(&a->arenas[i].lock);
+    }
+}
+
+void MultiArenaAllocator_update_stats(MultiArenaAllocator* a) {
+    size_t internal_fragmentation = 0, sparse_free_memory = 0, remote_frees = 0, remote_drained = 0;
+    for (uint i = 0; i < a->num_arenas; i++) {
+        MultiArena* arena = &a->arenas[i];
+        pthread_mutex_lock(&arena->lock);
+        internal_fragmentation += ((VariableBlockAllocator*)&arena->buddy)->internal_fragmentation;
+        sparse_free_memory += ((VariableBlockAllocator*)&arena->buddy)->sparse_free_memory;
+        remote_drained += arena->remote_drained;
+        remote_frees += __atomic_load_n(&arena->remote_frees, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&arena->lock);
+    }
+    ((VariableBlockAllocator*)a)->internal_fragmentation = internal_fragmentation;
+    ((VariableBlockAllocator*)a)->sparse_free_memory = sparse_free_memory;
+    a->remote_frees = remote_frees;
+    a->remote_pending = remote_frees - remote_drained;
+}
+
+int MultiArenaAllocator_print_state(MultiArenaAllocator* a) {
+    MultiArenaAllocator_update_stats(a);
+    printf("Multi Arena Allocator state:\n");
+    printf("\t%u arenas of %zu bytes\n", a->num_arenas, a->arena_size);
+    printf("\tInternal fragmentation: %zu bytes\n", ((VariableBlockAllocator*)a)->internal_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator*)a)->sparse_free_memory);
+    printf("\tRemote frees: %zu, %zu still stacked\n", a->remote_frees, a->remote_pending);
+    for (uint i = 0; i < a->num_arenas; i++) {
+        printf("\tArena %u: %zu bytes free\n", i, ((VariableBlockAllocator*)&a->arenas[i].buddy)->sparse_free_memory);
+    }
+    return 0;
+}
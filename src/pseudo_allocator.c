@@ -0,0 +1,417 @@
+#include <pseudo_allocator.h>
+#include <helpers/memory_manipulation.h>
+
+extern inline PseudoAllocator* PseudoAllocator_create(PseudoAllocator* a, size_t memory_size, int num_levels);
+extern inline int PseudoAllocator_destroy(PseudoAllocator* a);
+extern inline void* PseudoAllocator_malloc(PseudoAllocator* a, size_t size);
+extern inline int PseudoAllocator_free(PseudoAllocator* a, void* ptr);
+extern inline size_t PseudoAllocator_usable_size(PseudoAllocator* a, void* ptr);
+extern inline void* PseudoAllocator_realloc(PseudoAllocator* a, void* ptr, size_t size);
+extern inline void* PseudoAllocator_memalign(PseudoAllocator* a, size_t alignment, size_t size);
+extern inline void* PseudoAllocator_calloc(PseudoAllocator* a, size_t nmemb, size_t size);
+
+static PseudoAllocator pseudo_default;
+static bool pseudo_default_ready = false;
+
+// Small blocks count with the buddy, the cached mappings as free memory
+static inline void update_stats(PseudoAllocator* a) {
+    VariableBlockAllocator* small = (VariableBlockAllocator*)&a->small;
+    ((VariableBlockAllocator *) a)->internal_fragmentation = small->internal_fragmentation + a->large_fragmentation;
+    ((VariableBlockAllocator *) a)->sparse_free_memory = small->sparse_free_memory + a->cached_bytes;
+}
+
+static inline bool is_small(PseudoAllocator* a, void* ptr) {
+    return (char*)ptr >= a->small.memory_start && (char*)ptr < a->small.memory_start + a->small.memory_size;
+}
+
+// Bucket of a mapping: floor(log2(pages))
+static inline uint bucket_of(PseudoAllocator* a, size_t mapping_size) {
+    return 63 - __builtin_clzll(mapping_size / a->page_size);
+}
+
+// Smallest cached mapping of at least size bytes from the bucket of size, NULL on a miss
+static PseudoRegion cache_take(PseudoAllocator* a, size_t size) {
+    PseudoRegion region = {NULL, 0};
+    uint bucket = bucket_of(a, size);
+    if (bucket >= PSEUDO_CACHE_BUCKETS) return region;
+    int best = -1;
+    for (int i = 0; i < PSEUDO_CACHE_SLOTS; i++) {
+        PseudoRegion* slot = &a->cache[bucket][i];
+        if (slot->start && slot->size >= size && (best < 0 || slot->size < a->cache[bucket][best].size)) {
+            best = i;
+        }
+    }
+    if (best < 0) return region;
+    region = a->cache[bucket][best];
+    a->cache[bucket][best].start = NULL;
+    a->cached_bytes -= region.size;
+    return region;
+}
+
+// Keep a released mapping for reuse, evicting the oldest of a full bucket.
+// Mappings that do not fit in the cache are unmapped
+static void cache_put(PseudoAllocator* a, char* start, size_t size) {
+    uint bucket = bucket_of(a, size);
+    if (bucket >= PSEUDO_CACHE_BUCKETS || a->cached_bytes + size > a->cache_max_bytes) {
+        munmap(start, size);
+        return;
+    }
+    int slot = -1;
+    for (int i = 0; i < PSEUDO_CACHE_SLOTS && slot < 0; i++) {
+        if (!a->cache[bucket][i].start) slot = i;
+    }
+    if (slot < 0) {
+        slot = a->cache_victim[bucket];
+        a->cache_victim[bucket] = (slot + 1) % PSEUDO_CACHE_SLOTS;
+        munmap(a->cache[bucket][slot].start, a->cache[bucket][slot].size);
+        a->cached_bytes -= a->cache[bucket][slot].size;
+    }
+    a->cache[bucket][slot].start = start;
+    a->cache[bucket][slot].size = size;
+    a->cached_bytes += size;
+}
+
+// Mappings start on a page and the header sits in their first page, right before the block
+static inline char* mapping_start(PseudoAllocator* a, void* ptr) {
+    return (char*)(((uintptr_t)ptr - PSEUDO_MAPPING_SIZE) & ~(a->page_size - 1));
+}
+
+// Smallest multiple of the page size holding size bytes, 0 on overflow
+static inline size_t round_to_pages(PseudoAllocator* a, size_t size) {
+    size_t rounded;
+    if (__builtin_add_overflow(size, a->page_size - 1, &rounded)) return 0;
+    return rounded & ~(a->page_size - 1);
+}
+
+static inline void* place_block(PseudoAllocator* a, char* start, size_t mapping_size, size_t offset, size_t size) {
+    PseudoMapping* header = (PseudoMapping*)(start + offset - PSEUDO_MAPPING_SIZE);
+    header->mapping_size = mapping_size;
+    header->size = size;
+    a->large_fragmentation += mapping_size - size;
+    return start + offset;
+}
+
+// A mapping of its own, from the cache when possible. The block starts offset bytes
+// into the mapping (at least the header, at most a page). Cached regions are dirty:
+// zero clears the block, fresh ones are already zero
+static void* large_reserve(PseudoAllocator* a, size_t size, size_t offset, bool zero) {
+    size_t mapping_size = size + offset < size ? 0 : round_to_pages(a, size + offset);
+    if (!mapping_size) return NULL;
+
+    PseudoRegion region = cache_take(a, mapping_size);
+    if (region.start) {
+        a->cache_hits++;
+    } else {
+        a->cache_misses++;
+        region.start = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region.start == MAP_FAILED) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to map %zu bytes\n" RESET, mapping_size);
+            #endif
+            return NULL;
+        }
+        region.size = mapping_size;
+        zero = false;
+    }
+    if (zero) zero_memory(region.start + offset, size);
+    return place_block(a, region.start, region.size, offset, size);
+}
+
+// Alignments above the page size: map alignment bytes more and trim the mapping
+// so that the block starts one page into it. Never served from the cache
+static void* large_reserve_aligned(PseudoAllocator* a, size_t alignment, size_t size) {
+    size_t mapping_size = size + a->page_size < size ? 0 : round_to_pages(a, size + a->page_size);
+    size_t total;
+    if (!mapping_size || __builtin_add_overflow(mapping_size, alignment, &total)) return NULL;
+    char* raw = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to map %zu bytes\n" RESET, total);
+        #endif
+        return NULL;
+    }
+    a->cache_misses++;
+    char* ptr = (char*)(((uintptr_t)raw + a->page_size + alignment - 1) & ~(alignment - 1));
+    char* start = ptr - a->page_size;
+    if (start > raw) munmap(raw, start - raw);
+    if (raw + total > start + mapping_size) munmap(start + mapping_size, raw + total - (start + mapping_size));
+    return place_block(a, start, mapping_size, a->page_size, size);
+}
+
+// Header of a live mapping, NULL if ptr is not one. Blocks start at the header
+// size or at their alignment into the mapping, a power of two either way
+static PseudoMapping* mapping_of(PseudoAllocator* a, void* ptr) {
+    size_t offset = (char*)ptr - mapping_start(a, ptr);
+    if (offset < PSEUDO_MAPPING_SIZE || (offset & (offset - 1)) != 0) return NULL;
+    PseudoMapping* header = (PseudoMapping*)((char*)ptr - PSEUDO_MAPPING_SIZE);
+    if (header->mapping_size == 0 || (header->mapping_size & (a->page_size - 1)) != 0 ||
+        header->size > header->mapping_size - offset) {
+        return NULL;
+    }
+    return header;
+}
+
+// Resize a mapping in place or with mremap, which moves the pages instead of copying them.
+// Shrinking by at least half unmaps the tail
+static void* large_resize(PseudoAllocator* a, void* ptr, PseudoMapping* header, size_t size) {
+    char* start = mapping_start(a, ptr);
+    size_t offset = (char*)ptr - start;
+    size_t mapping_size = header->mapping_size;
+    size_t needed = size + offset < size ? 0 : round_to_pages(a, size + offset);
+    if (!needed) return NULL;
+    if (needed <= mapping_size) {
+        if (needed <= mapping_size / 2 && munmap(start + needed, mapping_size - needed) == 0) {
+            a->large_fragmentation -= mapping_size - needed;
+            header->mapping_size = needed;
+        }
+        a->large_fragmentation += header->size - size;
+        header->size = size;
+        return ptr;
+    }
+    size_t old_size = header->size; // The header moves with the pages
+    char* moved = mremap(start, mapping_size, needed, MREMAP_MAYMOVE);
+    if (moved == MAP_FAILED) return NULL;
+    a->large_fragmentation -= mapping_size - old_size;
+    return place_block(a, moved, needed, offset, size);
+}
+
+void* PseudoAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    size_t memory_size = va_arg(args, size_t);
+    int num_levels = va_arg(args, int);
+    va_end(args);
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator in init!\n" RESET);
+        #endif
+        return NULL;
+    }
+    if (!BitmapBuddyAllocator_create(&a->small, memory_size, num_levels)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to create the small allocator!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    a->page_size = sysconf(_SC_PAGESIZE);
+    a->small_limit = a->page_size / 4;
+    memset(a->cache, 0, sizeof(a->cache));
+    memset(a->cache_victim, 0, sizeof(a->cache_victim));
+    a->cached_bytes = 0;
+    a->cache_max_bytes = PSEUDO_CACHE_MAX_BYTES;
+    a->large_fragmentation = 0;
+    a->cache_hits = 0;
+    a->cache_misses = 0;
+    update_stats(a);
+
+    alloc->init = PseudoAllocator_init;
+    alloc->dest = PseudoAllocator_cleanup;
+    alloc->malloc = PseudoAllocator_reserve;
+    alloc->free = PseudoAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = PseudoAllocator_reallocate;
+    alloc->usable_size = PseudoAllocator_block_usable_size;
+    alloc->memalign = PseudoAllocator_reserve_aligned;
+    alloc->calloc = PseudoAllocator_callocate;
+    return a;
+}
+
+void* PseudoAllocator_cleanup(Allocator* alloc, ...) {
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    if (!a || !a->small.memory_start) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or memory in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    for (int bucket = 0; bucket < PSEUDO_CACHE_BUCKETS; bucket++) {
+        for (int i = 0; i < PSEUDO_CACHE_SLOTS; i++) {
+            PseudoRegion* slot = &a->cache[bucket][i];
+            if (slot->start) munmap(slot->start, slot->size);
+            slot->start = NULL;
+        }
+    }
+    a->cached_bytes = 0;
+    BitmapBuddyAllocator_destroy(&a->small);
+    return (void*)0;
+}
+
+void* PseudoAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in reserve!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    // Small blocks are the buddy's aligned ones: no header and malloc's alignment.
+    // A full small allocator falls through to a mapping
+    void* ptr = NULL;
+    if (size < a->small_limit) ptr = BitmapBuddyAllocator_memalign(&a->small, PSEUDO_ALIGNMENT, size);
+    if (!ptr) ptr = large_reserve(a, size, PSEUDO_MAPPING_SIZE, false);
+    update_stats(a);
+    return ptr;
+}
+
+void* PseudoAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    if (!a || !ptr) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+
+    if (is_small(a, ptr)) {
+        int result = BitmapBuddyAllocator_free(&a->small, ptr);
+        update_stats(a);
+        return (void*)(intptr_t)result;
+    }
+
+    PseudoMapping* header = mapping_of(a, ptr);
+    if (!header) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Pointer is not a block of this allocator!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    size_t mapping_size = header->mapping_size;
+    a->large_fragmentation -= mapping_size - header->size;
+    header->mapping_size = 0; // A cached mapping is not a live block
+    cache_put(a, mapping_start(a, ptr), mapping_size);
+    update_stats(a);
+    return (void*)0;
+}
+
+size_t PseudoAllocator_block_usable_size(Allocator* alloc, void* ptr) {
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    if (!a || !ptr) return 0;
+    if (is_small(a, ptr)) return BitmapBuddyAllocator_usable_size(&a->small, ptr);
+    PseudoMapping* header = mapping_of(a, ptr);
+    return header ? header->mapping_size - ((char*)ptr - mapping_start(a, ptr)) : 0;
+}
+
+// Small blocks stay in place while they fit, mappings grow with mremap.
+// Anything else moves, possibly between the buddy and a mapping
+void* PseudoAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    if (!a) return NULL;
+    if (!ptr) return PseudoAllocator_reserve(alloc, size);
+    if (size == 0) {
+        PseudoAllocator_release(alloc, ptr);
+        return NULL;
+    }
+
+    size_t old_size;
+    void* result = NULL;
+    if (is_small(a, ptr)) {
+        old_size = BitmapBuddyAllocator_usable_size(&a->small, ptr);
+        if (old_size == 0) return NULL;
+        if (size <= old_size) result = BitmapBuddyAllocator_realloc(&a->small, ptr, size);
+    } else {
+        PseudoMapping* header = mapping_of(a, ptr);
+        if (!header) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Invalid pointer in realloc\n" RESET);
+            #endif
+            return NULL;
+        }
+        old_size = header->mapping_size - ((char*)ptr - mapping_start(a, ptr));
+        result = large_resize(a, ptr, header, size);
+    }
+    if (!result) {
+        result = PseudoAllocator_reserve(alloc, size);
+        if (!result) return NULL;
+        memcpy(result, ptr, old_size < size ? old_size : size);
+        PseudoAllocator_release(alloc, ptr);
+    }
+    update_stats(a);
+    return result;
+}
+
+// Small alignments come from the buddy, whose blocks are aligned to their size.
+// Mappings place the block at the alignment up to a page, beyond it they are trimmed
+void* PseudoAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in memalign!\n" RESET);
+        #endif
+        return NULL;
+    }
+    if (alignment < PSEUDO_ALIGNMENT) alignment = PSEUDO_ALIGNMENT;
+
+    void* ptr = NULL;
+    if (size < a->small_limit && alignment <= a->small_limit) {
+        ptr = BitmapBuddyAllocator_memalign(&a->small, alignment, size);
+    }
+    if (!ptr && alignment <= a->page_size) {
+        ptr = large_reserve(a, size, alignment > PSEUDO_MAPPING_SIZE ? alignment : PSEUDO_MAPPING_SIZE, false);
+    } else if (!ptr) {
+        ptr = large_reserve_aligned(a, alignment, size);
+    }
+    update_stats(a);
+    return ptr;
+}
+
+// Small blocks are cleared below the buddy's high-water mark, mappings only
+// when they come from the cache
+void* PseudoAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    PseudoAllocator* a = (PseudoAllocator*)alloc;
+    size_t total;
+    if (!a || __builtin_mul_overflow(nmemb, size, &total) || total == 0) return NULL;
+
+    char* ptr = NULL;
+    if (total < a->small_limit) {
+        char* high_water = a->small.high_water;
+        ptr = BitmapBuddyAllocator_memalign(&a->small, PSEUDO_ALIGNMENT, total);
+        if (ptr && ptr < high_water) {
+            char* dirty_end = ptr + total < high_water ? ptr + total : high_water;
+            zero_memory(ptr, dirty_end - ptr);
+        }
+    }
+    if (!ptr) ptr = large_reserve(a, total, PSEUDO_MAPPING_SIZE, true);
+    update_stats(a);
+    return ptr;
+}
+
+void* pseudo_malloc(size_t size) {
+    if (!pseudo_default_ready) {
+        if (!PseudoAllocator_create(&pseudo_default, PSEUDO_BUDDY_MEMORY, PSEUDO_BUDDY_LEVELS)) return NULL;
+        pseudo_default_ready = true;
+    }
+    return PseudoAllocator_malloc(&pseudo_default, size);
+}
+
+void pseudo_free(void* ptr) {
+    if (!ptr || !pseudo_default_ready) return;
+    PseudoAllocator_free(&pseudo_default, ptr);
+}
+
+int PseudoAllocator_print_state(PseudoAllocator* a) {
+    printf("Pseudo Allocator state:\n");
+    printf("\tSmall requests: below %zu bytes, %zu bytes of buddy memory\n", a->small_limit, a->small.memory_size);
+    printf("\tInternal fragmentation: %zu bytes (%zu in mappings)\n",
+           ((VariableBlockAllocator *) a)->internal_fragmentation, a->large_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator *) a)->sparse_free_memory);
+    printf("\tRegion cache: %zu of %zu bytes, %zu hits, %zu misses\n",
+           a->cached_bytes, a->cache_max_bytes, a->cache_hits, a->cache_misses);
+    for (int bucket = 0; bucket < PSEUDO_CACHE_BUCKETS; bucket++) {
+        int count = 0;
+        for (int i = 0; i < PSEUDO_CACHE_SLOTS; i++) count += a->cache[bucket][i].start != NULL;
+        if (count) printf("\tBucket %d (%lu+ pages): %d regions\n", bucket, 1ul << bucket, count);
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include <size_class_allocator.h>
+
+extern inline SizeClassAllocator* SizeClassAllocator_create(SizeClassAllocator* a, size_t memory_size);
+extern inline int SizeClassAllocator_destroy(SizeClassAllocator* a);
+extern inline void* SizeClassAllocator_malloc(SizeClassAllocator* a, size_t size);
+extern inline int SizeClassAllocator_free(SizeClassAllocator* a, void* ptr);
+
+// Fill class_size[] and the size -> class lookup table
+static void build_classes(SizeClassAllocator* a) {
+    int count = 0;
+    size_t size = SIZE_CLASS_MIN;
+    while (size <= SIZE_CLASS_MAX && count < SIZE_CLASS_COUNT) {
+        a->class_size[count++] = size;
+        // Step is 1/8 of the current power of two, never below 8 bytes
+        size_t octave = (size_t)1 << (63 - __builtin_clzll(size));
+        size += (octave / 8 > 8) ? octave / 8 : 8;
+    }
+    assert(count == SIZE_CLASS_COUNT);
+
+    int class = 0;
+    for (int i = 0; i < SIZE_CLASS_LOOKUP_SIZE; i++) {
+        while (a->class_size[class] < (size_t)i * 8) class++;
+        a->lookup[i] = (uint8_t)class;
+    }
+}
+
+// Pool owning ptr, by binary search over the pools sorted by address
+static int class_of_pointer(SizeClassAllocator* a, void* ptr) {
+    int lo = 0, hi = SIZE_CLASS_COUNT - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        SlabAllocator* slab = &a->classes[a->by_address[mid]];
+        if ((char*)ptr < slab->memory_start) {
+            hi = mid - 1;
+        } else if ((char*)ptr >= slab->memory_start + slab->memory_size) {
+            lo = mid + 1;
+        } else {
+            return a->by_address[mid];
+        }
+    }
+    return -1;
+}
+
+void* SizeClassAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    SizeClassAllocator* a = (SizeClassAllocator*)alloc;
+    size_t memory_size = va_arg(args, size_t);
+    va_end(args);
+    if (!alloc || memory_size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid parameters in create!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    build_classes(a);
+    a->memory_size = memory_size;
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation = 0;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory = 0;
+
+    // Each class gets the same share of the budget, and at least one slot
+    size_t per_class = memory_size / SIZE_CLASS_COUNT;
+    for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+        size_t n_slabs = per_class / a->class_size[i];
+        if (n_slabs == 0) n_slabs = 1;
+        if (!SlabAllocator_create_with_mode(&a->classes[i], a->class_size[i], n_slabs, SLAB_MODE_BITMAP)) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to create pool for class %zu!\n" RESET, a->class_size[i]);
+            #endif
+            while (--i >= 0) SlabAllocator_destroy(&a->classes[i]);
+            return NULL;
+        }
+        ((VariableBlockAllocator *) alloc)->sparse_free_memory += n_slabs * a->class_size[i];
+    }
+
+    // One mapping for the requested sizes of every class
+    size_t total_slabs = 0;
+    for (int i = 0; i < SIZE_CLASS_COUNT; i++) total_slabs += a->classes[i].num_slabs;
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    a->requested_size_bytes = (total_slabs * sizeof(uint16_t) + page_size - 1) & ~(page_size - 1);
+    uint16_t* sizes = mmap(NULL, a->requested_size_bytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (sizes == MAP_FAILED) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to map requested size array!\n" RESET);
+        #endif
+        for (int i = 0; i < SIZE_CLASS_COUNT; i++) SlabAllocator_destroy(&a->classes[i]);
+        return NULL;
+    }
+    for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+        a->requested_size[i] = sizes;
+        sizes += a->classes[i].num_slabs;
+    }
+
+    // Insertion sort of the pools by start address
+    for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+        int j = i;
+        while (j > 0 && a->classes[a->by_address[j - 1]].memory_start > a->classes[i].memory_start) {
+            a->by_address[j] = a->by_address[j - 1];
+            j--;
+        }
+        a->by_address[j] = (uint8_t)i;
+    }
+
+    alloc->init = SizeClassAllocator_init;
+    alloc->dest = SizeClassAllocator_cleanup;
+    alloc->malloc = SizeClassAllocator_reserve;
+    alloc->free = SizeClassAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = NULL;
+    alloc->usable_size = NULL;
+    alloc->memalign = NULL;
+    alloc->calloc = NULL;
+    return a;
+}
+
+void* SizeClassAllocator_cleanup(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    SizeClassAllocator* a = (SizeClassAllocator*)alloc;
+    for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+        if (SlabAllocator_destroy(&a->classes[i]) != 0) {
+            return (void*)-1;
+        }
+    }
+    munmap(a->requested_size[0], a->requested_size_bytes);
+    return (void*)0;
+}
+
+void* SizeClassAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    SizeClassAllocator* a = (SizeClassAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+
+    int class = (a) ? SizeClassAllocator_class_of(a, size) : -1;
+    if (class < 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size (%zu, max %d) in reserve!\n" RESET,
+               size, SIZE_CLASS_MAX);
+        #endif
+        return NULL;
+    }
+
+    SlabAllocator* slab = &a->classes[class];
+    void* ptr = SlabAllocator_malloc(slab);
+    if (!ptr) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Size class %zu is full\n" RESET, a->class_size[class]);
+        #endif
+        return NULL;
+    }
+    a->requested_size[class][((char*)ptr - slab->slabs_start) / slab->slab_size] = (uint16_t)size;
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation += a->class_size[class] - size;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory -= a->class_size[class];
+    return ptr;
+}
+
+void* SizeClassAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    SizeClassAllocator* a = (SizeClassAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    if (!a || !ptr) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+
+    int class = class_of_pointer(a, ptr);
+    if (class < 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Pointer outside allocator memory range!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    SlabAllocator* slab = &a->classes[class];
+    if (SlabAllocator_free(slab, ptr) != 0) {
+        return (void*)-1;
+    }
+    // Slot start checked by the slab, the index is exact
+    size_t size = a->requested_size[class][((char*)ptr - slab->slabs_start) / slab->slab_size];
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation -= a->class_size[class] - size;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory += a->class_size[class];
+    return (void*)0;
+}
+
+int SizeClassAllocator_print_state(SizeClassAllocator* a) {
+    printf("Size Class Allocator state:\n");
+    printf("\tMemory budget: %zu bytes\n", a->memory_size);
+    printf("\tInternal fragmentation: %zu bytes\n", ((VariableBlockAllocator *) a)->internal_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator *) a)->sparse_free_memory);
+    for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+        SlabAllocator* slab = &a->classes[i];
+        printf("\tClass %2d (%4zu bytes): %u/%u used\n", i, a->class_size[i],
+               slab->num_slabs - slab->free_list_size, slab->num_slabs);
+    }
+    return 0;
+}
@@ -1,13 +1,46 @@
 #include "slab_allocator.h"
 
+extern inline SlabAllocator* SlabAllocator_create_with_pages(SlabAllocator* a, size_t slab_size, size_t n_slabs, SlabMode mode,
+                                                             size_t alignment, ArenaPages pages);
+extern inline SlabAllocator* SlabAllocator_create_aligned(SlabAllocator* a, size_t slab_size, size_t n_slabs, SlabMode mode, size_t alignment);
+extern inline SlabAllocator* SlabAllocator_create_with_mode(SlabAllocator* a, size_t slab_size, size_t n_slabs, SlabMode mode);
 extern inline SlabAllocator* SlabAllocator_create(SlabAllocator* a, size_t slab_size, size_t n_slabs);
 extern inline int SlabAllocator_destroy(SlabAllocator* a);
 extern inline void* SlabAllocator_malloc(SlabAllocator* a);
 extern inline int SlabAllocator_free(SlabAllocator* a, void* ptr);
+extern inline int SlabAllocator_malloc_batch(SlabAllocator* a, size_t n, void** out);
+extern inline int SlabAllocator_free_batch(SlabAllocator* a, size_t n, void** ptrs);
 
 // Calculate actual size needed for a slab including metadata
-static inline size_t get_slab_total_size(size_t requested_size) {
-    return sizeof(SlabNode) + requested_size;
+static inline size_t get_slab_total_size(size_t requested_size, SlabMode mode, size_t alignment) {
+    size_t size;
+    if (mode == SLAB_MODE_BITMAP) {
+        size = requested_size;
+    } else if (mode == SLAB_MODE_EMBEDDED) {
+        // A free slot must hold the 4-byte link, keep slots 4-byte aligned for it
+        if (requested_size < sizeof(uint32_t)) requested_size = sizeof(uint32_t);
+        size = (requested_size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+    } else {
+        size = sizeof(SlabNode) + requested_size;
+    }
+    // A slot size multiple of the alignment keeps every payload aligned once the first one is
+    if (alignment > 1) size = (size + alignment - 1) & ~(alignment - 1);
+    return size;
+}
+
+// Embedded free list link, stored in the first bytes of a free slot
+static inline uint32_t* embedded_link(SlabAllocator* slab, uint32_t index) {
+    return (uint32_t*)(slab->slabs_start + (size_t)index * slab->slab_size);
+}
+
+// Check if slot at index is currently free
+static int slab_is_free(SlabAllocator* a, uint index) {
+    if (a->mode == SLAB_MODE_BITMAP || a->mode == SLAB_MODE_EMBEDDED) {
+        return !bitmap_test(&a->slot_bitmap, index);
+    }
+    if (index >= a->bump_index) return 1; // Never handed out
+    SlabNode* slab_node = (SlabNode*)(a->slabs_start + (size_t)index * a->slab_size);
+    return slab_node->in_free_list;
 }
 
 // Initialize SlabAllocator
@@ -23,13 +56,19 @@ void *SlabAllocator_init(Allocator* alloc, ...) {
     va_list args;
     va_start(args, alloc);
 
-    // Parse variadic args (slab_size, n_slabs)
+    // Parse variadic args (slab_size, n_slabs, mode, alignment, pages)
     size_t requested_size = va_arg(args, size_t);
     size_t n_slabs = va_arg(args, size_t);
+    SlabMode mode = (SlabMode)va_arg(args, int);
+    size_t alignment = va_arg(args, size_t);
+    ArenaPages pages = (ArenaPages)va_arg(args, int);
     va_end(args);
 
     // Validate input parameters
-    if (!alloc || requested_size == 0 || n_slabs == 0) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    if (!alloc || requested_size == 0 || n_slabs == 0 || n_slabs >= SLAB_EMBEDDED_NIL ||
+        (mode != SLAB_MODE_LIST && mode != SLAB_MODE_EMBEDDED && mode != SLAB_MODE_BITMAP) ||
+        (alignment & (alignment - 1)) != 0 || alignment > page_size) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to create: invalid parameters!\n" RESET);
         #endif
@@ -37,19 +76,31 @@ void *SlabAllocator_init(Allocator* alloc, ...) {
     }
 
     // Calculate actual slab size including metadata
-    slab->slab_size = get_slab_total_size(requested_size);
-
-    // Calculate total memory needed including space for DoubleLinkedList
-    size_t list_size = sizeof(DoubleLinkedList);
-    size_t memory_size = slab->slab_size * n_slabs + list_size;
+    slab->mode = mode;
+    slab->slab_size = get_slab_total_size(requested_size, mode, alignment);
+
+    // Calculate total memory needed including space for DoubleLinkedList (or the bitmap)
+    size_t list_size = 0;
+    if (mode == SLAB_MODE_LIST) {
+        list_size = sizeof(DoubleLinkedList);
+    } else {
+        // Keep the first slot 16-byte aligned after the bitmap words
+        list_size = ((n_slabs + 31) / 32) * sizeof(uint);
+        list_size = (list_size + 15) & ~(size_t)15;
+    }
+    // Slots start where the first payload is aligned (mmap memory is page aligned)
+    size_t header_size = (mode == SLAB_MODE_LIST) ? sizeof(SlabNode) : 0;
+    size_t slabs_offset = list_size;
+    if (alignment > 1) {
+        slabs_offset = ((list_size + header_size + alignment - 1) & ~(alignment - 1)) - header_size;
+    }
+    size_t memory_size = slab->slab_size * n_slabs + slabs_offset;
     // Round up to page size
-    size_t page_size = sysconf(_SC_PAGESIZE);
     memory_size = (memory_size + page_size - 1) & ~(page_size - 1);
 
     // Allocate memory using mmap
-    slab->memory_start = mmap(NULL, memory_size, PROT_READ | PROT_WRITE,
-                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (slab->memory_start == MAP_FAILED) {
+    slab->memory_start = map_arena(memory_size, pages, &slab->backing);
+    if (!slab->memory_start) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to allocate managed memory!\n" RESET);
         #endif
@@ -57,29 +108,37 @@ void *SlabAllocator_init(Allocator* alloc, ...) {
     }
 
     slab->memory_size = memory_size;
-    
-    // Initialize free list at start of managed memory
-    slab->free_list = (DoubleLinkedList*)slab->memory_start;
-    if (!list_create(slab->free_list)) {
-        #ifdef DEBUG
-        printf(RED "ERROR: Failed to create free list!\n" RESET);
-        #endif
-        munmap(slab->memory_start, memory_size);
-        return NULL;
-    }
-
-    // Initialize free list with slabs
-    char* current = slab->memory_start + list_size;
-    for (size_t i = 0; i < n_slabs; i++) {
-        SlabNode* slab_node = (SlabNode*)current;
-        // Clear the entire slab area
-        // memset(current, 0, slab->slab_size);
-        // Set data pointer to just after the SlabNode structure
-        slab_node->data = current + sizeof(SlabNode);
-        slab_node->in_free_list = 1; // Mark as free
-        list_push_front(slab->free_list, &slab_node->node);
-        current += slab->slab_size;
+    slab->slabs_start = slab->memory_start + slabs_offset;
+    slab->alignment = alignment;
+
+    if (mode == SLAB_MODE_BITMAP || mode == SLAB_MODE_EMBEDDED) {
+        // Fresh mmap memory is zeroed: every slot starts free. In SLAB_MODE_EMBEDDED
+        // slots are linked only once freed, fresh ones come from bump_index
+        slab->free_list = NULL;
+        slab->free_head = SLAB_EMBEDDED_NIL;
+        slab->bitmap_hint = 0;
+        if (!bitmap_create(&slab->slot_bitmap, n_slabs, slab->memory_start)) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to create slot bitmap!\n" RESET);
+            #endif
+            unmap_arena(slab->memory_start, memory_size, slab->backing);
+            return NULL;
+        }
+    } else {
+        // Initialize free list at start of managed memory
+        slab->free_list = (DoubleLinkedList*)slab->memory_start;
+        slab->free_head = SLAB_EMBEDDED_NIL;
+        if (!list_create(slab->free_list)) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to create free list!\n" RESET);
+            #endif
+            unmap_arena(slab->memory_start, memory_size, slab->backing);
+            return NULL;
+        }
+        // Headers are written when a slot is first handed out, fresh ones come from bump_index
     }
+    // No slot is touched here: init cost and resident memory do not depend on n_slabs
+    slab->bump_index = 0;
     slab->free_list_size = n_slabs;
     slab->num_slabs = n_slabs;
 
@@ -91,6 +150,12 @@ void *SlabAllocator_init(Allocator* alloc, ...) {
     alloc->dest = SlabAllocator_cleanup;
     alloc->malloc = SlabAllocator_reserve;
     alloc->free = SlabAllocator_release;
+    alloc->malloc_batch = SlabAllocator_reserve_batch;
+    alloc->free_batch = SlabAllocator_release_batch;
+    alloc->realloc = NULL;
+    alloc->usable_size = NULL;
+    alloc->memalign = NULL;
+    alloc->calloc = NULL;
     return (void*)1;
 }
 
@@ -105,7 +170,7 @@ void *SlabAllocator_cleanup(Allocator* alloc, ...) {
 
     SlabAllocator* slab = (SlabAllocator*)alloc;
     if (slab->memory_start) {
-        munmap(slab->memory_start, slab->memory_size);
+        unmap_arena(slab->memory_start, slab->memory_size, slab->backing);
     }
     // memset(slab, 0, sizeof(SlabAllocator));
     return (void*)1;
@@ -121,12 +186,52 @@ void *SlabAllocator_reserve(Allocator* alloc, ...) {
     }
 
     SlabAllocator* slab = (SlabAllocator*)alloc;
-    if (slab->free_list->size == 0) {
+    if (slab->free_list_size == 0) {
         #ifdef DEBUG
         printf(RED "ERROR: Failed to allocate: out of memory!\n" RESET);
         #endif
         return NULL;  // Out of memory
     }
+
+    if (slab->mode == SLAB_MODE_BITMAP) {
+        // Next-fit from the hint, wrap around once
+        int index = bitmap_find_zero_from(&slab->slot_bitmap, slab->bitmap_hint);
+        if (index < 0) index = bitmap_find_zero_from(&slab->slot_bitmap, 0);
+        if (index < 0) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Slot bitmap out of sync with free count!\n" RESET);
+            #endif
+            return NULL;
+        }
+        bitmap_set(&slab->slot_bitmap, index);
+        slab->bitmap_hint = (uint)(index + 1) < slab->num_slabs ? (uint)(index + 1) : 0;
+        slab->free_list_size--;
+        return slab->slabs_start + (size_t)index * slab->slab_size;
+    }
+
+    if (slab->mode == SLAB_MODE_EMBEDDED) {
+        slab->free_list_size--;
+        // Recycled slots first, they are more likely to be in cache
+        if (slab->free_head == SLAB_EMBEDDED_NIL) {
+            bitmap_set(&slab->slot_bitmap, slab->bump_index);
+            return (void*)embedded_link(slab, slab->bump_index++);
+        }
+        // Pop the head slot and follow its link
+        bitmap_set(&slab->slot_bitmap, slab->free_head);
+        uint32_t* link = embedded_link(slab, slab->free_head);
+        slab->free_head = *link;
+        return (void*)link;
+    }
+
+    if (slab->free_list->size == 0) {
+        // First use of this slot: write its header now
+        SlabNode* slab_node = (SlabNode*)(slab->slabs_start + (size_t)slab->bump_index++ * slab->slab_size);
+        slab_node->data = (char*)slab_node + sizeof(SlabNode);
+        slab_node->in_free_list = 0;
+        slab->free_list_size--;
+        return slab_node->data;
+    }
+
     Node* node = list_pop_front(slab->free_list);
     if (!node) {
         #ifdef DEBUG
@@ -143,26 +248,12 @@ void *SlabAllocator_reserve(Allocator* alloc, ...) {
     // memset(slab_node->data, 0, slab->user_size);
 
     return slab_node->data;
-    return slab_node->data;
 }
 
 
 
-// Free a slab
-void *SlabAllocator_release(Allocator* alloc, ...) {
-    if (!alloc) {
-        #ifdef DEBUG
-        printf(RED "ERROR: NULL allocator passed to SlabAllocator_free\n" RESET);
-        #endif
-        return NULL;
-    }
-
-    SlabAllocator* slab = (SlabAllocator*)alloc;
-    va_list args;
-    va_start(args, alloc);
-    void* ptr = va_arg(args, void*);
-    va_end(args);
-
+// Release a slot, returns NULL if ptr is not an allocated slot
+static void* slab_release(SlabAllocator* slab, void* ptr) {
     if (!ptr) {
         #ifdef EBUG
         printf(RED "ERROR:Skipping free of NULL pointer\n" RESET);
@@ -182,6 +273,37 @@ void *SlabAllocator_release(Allocator* alloc, ...) {
         return NULL;
     }
 
+    if (slab->mode == SLAB_MODE_EMBEDDED || slab->mode == SLAB_MODE_BITMAP) {
+        // Find the slot by pointer arithmetic, it must be the start of a slot
+        size_t offset = (char*)ptr - slab->slabs_start;
+        if ((char*)ptr < slab->slabs_start || offset % slab->slab_size != 0 ||
+            offset / slab->slab_size >= slab->num_slabs) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to free: pointer is not the start of a slot!\n" RESET);
+            #endif
+            return NULL;
+        }
+        uint32_t index = (uint32_t)(offset / slab->slab_size);
+
+        // Double free detection is a single bit test, the bitmap lives outside the payloads
+        if (!bitmap_test(&slab->slot_bitmap, index)) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to free: slot already free!\n" RESET);
+            #endif
+            return NULL;
+        }
+        bitmap_clear(&slab->slot_bitmap, index);
+        if (slab->mode == SLAB_MODE_BITMAP) {
+            slab->free_list_size++;
+            return (void*)1;
+        }
+
+        *embedded_link(slab, index) = slab->free_head;
+        slab->free_head = index;
+        slab->free_list_size++;
+        return (void*)1;
+    }
+
     // Calculate the slab node pointer from the data pointer
     SlabNode* slab_node = (SlabNode*)((char*)ptr - sizeof(SlabNode));
     
@@ -203,14 +325,6 @@ void *SlabAllocator_release(Allocator* alloc, ...) {
         return NULL;
     }
 
-    // Check if node is already in free list using list_find
-    if (list_find(slab->free_list, &slab_node->node)) {
-        #ifdef DEBUG
-        printf(RED "ERROR: Failed to free: slab node already in free list!\n" RESET);
-        #endif
-        return NULL;
-    }
-
     // Clear the entire slab area before adding to free list
     // memset(slab_node, 0, slab->slab_size);
     // Add to free list
@@ -221,9 +335,94 @@ void *SlabAllocator_release(Allocator* alloc, ...) {
     return (void*)1;
 }
 
+// Free a slab
+void *SlabAllocator_release(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to SlabAllocator_free\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    va_list args;
+    va_start(args, alloc);
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    return slab_release((SlabAllocator*)alloc, ptr);
+}
+
+// Allocate up to n slots in one pass: recycled slots first, then a run from the bump pointer
+int SlabAllocator_reserve_batch(Allocator* alloc, size_t n, const size_t* sizes, void** out) {
+    (void)sizes; // Fixed size
+    SlabAllocator* slab = (SlabAllocator*)alloc;
+    size_t count = n < slab->free_list_size ? n : slab->free_list_size;
+    size_t i = 0;
+
+    if (slab->mode == SLAB_MODE_BITMAP) {
+        // Keep scanning from the last slot found, wrap around once
+        int index = slab->bitmap_hint;
+        for (; i < count; i++) {
+            index = bitmap_find_zero_from(&slab->slot_bitmap, index);
+            if (index < 0) index = bitmap_find_zero_from(&slab->slot_bitmap, 0);
+            bitmap_set(&slab->slot_bitmap, index);
+            out[i] = slab->slabs_start + (size_t)index * slab->slab_size;
+        }
+        if (count > 0) slab->bitmap_hint = (uint)(index + 1) < slab->num_slabs ? (uint)(index + 1) : 0;
+    } else if (slab->mode == SLAB_MODE_EMBEDDED) {
+        for (; i < count && slab->free_head != SLAB_EMBEDDED_NIL; i++) {
+            bitmap_set(&slab->slot_bitmap, slab->free_head);
+            uint32_t* link = embedded_link(slab, slab->free_head);
+            slab->free_head = *link;
+            out[i] = link;
+        }
+        for (; i < count; i++) {
+            bitmap_set(&slab->slot_bitmap, slab->bump_index);
+            out[i] = embedded_link(slab, slab->bump_index++);
+        }
+    } else {
+        for (; i < count && slab->free_list->size > 0; i++) {
+            SlabNode* slab_node = (SlabNode*)list_pop_front(slab->free_list);
+            slab_node->in_free_list = 0;
+            out[i] = slab_node->data;
+        }
+        for (; i < count; i++) {
+            SlabNode* slab_node = (SlabNode*)(slab->slabs_start + (size_t)slab->bump_index++ * slab->slab_size);
+            slab_node->data = (char*)slab_node + sizeof(SlabNode);
+            slab_node->in_free_list = 0;
+            out[i] = slab_node->data;
+        }
+    }
+    slab->free_list_size -= count;
+
+    for (; i < n; i++) out[i] = NULL;
+    #ifdef DEBUG
+    if (count < n) printf(RED "ERROR: Batch of %zu slabs, only %zu free!\n" RESET, n, count);
+    #endif
+    return (int)count;
+}
+
+// Release n slots without going through the variadic entry point
+int SlabAllocator_release_batch(Allocator* alloc, size_t n, void** ptrs) {
+    SlabAllocator* slab = (SlabAllocator*)alloc;
+    int released = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!ptrs[i]) continue;
+        if (!slab_release(slab, ptrs[i])) {
+            ptrs[i] = NULL;
+            continue;
+        }
+        released++;
+    }
+    return released;
+}
+
 void SlabAllocator_print_state(SlabAllocator* a) {
     printf("\tSlabAllocator Info:\n");
+    printf("\tMode: %s\n", a->mode == SLAB_MODE_EMBEDDED ? "embedded" :
+                           a->mode == SLAB_MODE_BITMAP ? "bitmap" : "list");
     printf("\tSlab Size: %zu\n", a->slab_size);
+    printf("\tPages: %s\n", arena_backing_name(a->backing));
+    if (a->alignment > 1) printf("\tAlignment: %zu\n", a->alignment);
     printf("\tSlots: %u/%u used\n", 
            a->num_slabs - a->free_list_size,
            a->num_slabs);
@@ -257,20 +456,11 @@ void SlabAllocator_print_memory_map(SlabAllocator* a) {
 
 // Print each slab's status
 void print_slab_info(SlabAllocator* a, uint slab_index) {
-    char* slab_start = a->memory_start + (slab_index * a->slab_size);
+    char* slab_start = a->slabs_start + (slab_index * a->slab_size);
     printf("\nSlab %u [%p]:\n", slab_index, (void*)slab_start);
     
     // Check if slab is in free list
-    int is_free = 0;
-    Node* current = a->free_list->head;
-    while (current) {
-        SlabNode* slab_node = (SlabNode*)current;
-        if (slab_node->data == slab_start) {
-            is_free = 1;
-            break;
-        }
-        current = current->next;
-    }
+    int is_free = slab_is_free(a, slab_index);
     
     printf("\tStatus: %s\n", is_free ? "\tFREE" : "\tUSED");
     
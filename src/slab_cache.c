@@ -0,0 +1,353 @@
+#include "slab_cache.h"
+
+extern inline SlabCache* SlabCache_create_aligned(SlabCache* cache, size_t object_size, size_t objects_per_chunk, size_t max_empty_chunks, size_t alignment, bool coloring);
+extern inline SlabCache* SlabCache_create(SlabCache* cache, size_t object_size, size_t objects_per_chunk, size_t max_empty_chunks);
+extern inline int SlabCache_destroy(SlabCache* cache);
+extern inline void* SlabCache_malloc(SlabCache* cache);
+extern inline int SlabCache_free(SlabCache* cache, void* ptr);
+
+// Embedded free list link, stored in the first bytes of a free slot
+static inline uint32_t* chunk_link(SlabCache* cache, SlabChunk* chunk, uint32_t index) {
+    return (uint32_t*)(chunk->slots_start + (size_t)index * cache->slot_size);
+}
+
+// List a chunk belongs to, given how many free slots it has
+static inline DoubleLinkedList* chunk_list(SlabCache* cache, SlabChunk* chunk) {
+    if (chunk->num_free == 0) return &cache->full;
+    if (chunk->num_free == cache->objects_per_chunk) return &cache->empty;
+    return &cache->partial;
+}
+
+// First slot of an uncolored chunk: the header, then one bit per slot
+static inline size_t slots_offset_for(size_t objects, size_t alignment) {
+    size_t offset = SLAB_CHUNK_HEADER_SIZE + ((objects + 31) / 32) * sizeof(uint);
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+// Position of chunk in the sorted chunk array, or where it would be inserted
+static uint chunk_position(SlabCache* cache, SlabChunk* chunk) {
+    uint low = 0, high = cache->num_chunks;
+    while (low < high) {
+        uint mid = low + (high - low) / 2;
+        if (cache->chunks[mid] < chunk) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Add a chunk to the sorted array, doubling its mapping when full
+static bool SlabCache_register_chunk(SlabCache* cache, SlabChunk* chunk) {
+    if (cache->num_chunks == cache->chunks_capacity) {
+        size_t page_size = sysconf(_SC_PAGESIZE);
+        size_t old_size = (size_t)cache->chunks_capacity * sizeof(SlabChunk*);
+        size_t new_size = old_size ? old_size * 2 : page_size;
+        void* chunks = old_size ? mremap(cache->chunks, old_size, new_size, MREMAP_MAYMOVE)
+                                : mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunks == MAP_FAILED) {
+            #ifdef DEBUG
+            printf(RED "ERROR: Failed to grow the chunk array!\n" RESET);
+            #endif
+            return false;
+        }
+        cache->chunks = chunks;
+        cache->chunks_capacity = new_size / sizeof(SlabChunk*);
+    }
+    uint position = chunk_position(cache, chunk);
+    memmove(&cache->chunks[position + 1], &cache->chunks[position], (cache->num_chunks - position) * sizeof(SlabChunk*));
+    cache->chunks[position] = chunk;
+    cache->num_chunks++;
+    return true;
+}
+
+// Map a new chunk aligned to chunk_size, so release can find it by masking
+static SlabChunk* SlabCache_map_chunk(SlabCache* cache) {
+    size_t size = cache->chunk_size;
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t map_size = (size > page_size) ? size * 2 : size;
+    char* raw = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to map a new chunk!\n" RESET);
+        #endif
+        return NULL;
+    }
+    // Trim the over-mapped head and tail
+    char* aligned = (char*)(((uintptr_t)raw + size - 1) & ~(uintptr_t)(size - 1));
+    if (aligned > raw) munmap(raw, aligned - raw);
+    if (raw + map_size > aligned + size) munmap(aligned + size, raw + map_size - (aligned + size));
+
+    SlabChunk* chunk = (SlabChunk*)aligned;
+    if (!SlabCache_register_chunk(cache, chunk)) {
+        munmap(aligned, size);
+        return NULL;
+    }
+    // Coloring: successive chunks start their slots one color_step further, so the
+    // first objects of every chunk do not all compete for the same cache sets
+    chunk->slots_start = aligned + cache->slots_offset + (size_t)cache->next_color * cache->color_step;
+    cache->next_color = (cache->next_color + 1) % cache->num_colors;
+    chunk->num_free = cache->objects_per_chunk;
+    // Slots are linked only once freed, only the header page is touched here
+    chunk->free_head = SLAB_CACHE_NIL;
+    chunk->bump_index = 0;
+    // Fresh mmap memory is zeroed: no slot is in use
+    bitmap_create(&chunk->slot_bitmap, cache->objects_per_chunk, aligned + SLAB_CHUNK_HEADER_SIZE);
+    return chunk;
+}
+
+static void SlabCache_unmap_chunk(SlabCache* cache, SlabChunk* chunk) {
+    uint position = chunk_position(cache, chunk);
+    cache->num_chunks--;
+    memmove(&cache->chunks[position], &cache->chunks[position + 1], (cache->num_chunks - position) * sizeof(SlabChunk*));
+    munmap(chunk, cache->chunk_size);
+}
+
+// Initialize SlabCache
+void *SlabCache_init(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to SlabCache_init\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    SlabCache* cache = (SlabCache*)alloc;
+    va_list args;
+    va_start(args, alloc);
+
+    // Parse variadic args (object_size, objects_per_chunk, max_empty_chunks, alignment, coloring)
+    size_t object_size = va_arg(args, size_t);
+    size_t objects_per_chunk = va_arg(args, size_t);
+    size_t max_empty_chunks = va_arg(args, size_t);
+    size_t alignment = va_arg(args, size_t);
+    int coloring = va_arg(args, int);
+    va_end(args);
+
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    if (object_size == 0 || objects_per_chunk == 0 || objects_per_chunk >= SLAB_CACHE_NIL ||
+        (alignment & (alignment - 1)) != 0 || alignment > page_size) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to create: invalid parameters!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    // A free slot must hold the 4-byte link, keep slots 4-byte aligned for it
+    size_t slot_size = object_size < sizeof(uint32_t) ? sizeof(uint32_t) : object_size;
+    if (alignment < sizeof(uint32_t)) alignment = sizeof(uint32_t);
+    slot_size = (slot_size + alignment - 1) & ~(alignment - 1);
+
+    // Smallest power of two chunk (at least a page) that fits the requested objects
+    size_t chunk_size = page_size;
+    while (chunk_size < slots_offset_for(objects_per_chunk, alignment) + objects_per_chunk * slot_size) {
+        chunk_size <<= 1;
+    }
+    // Fill the chunk with as many slots as fit, the bitmap is sized for the most that could
+    size_t slots_offset = slots_offset_for((chunk_size - SLAB_CHUNK_HEADER_SIZE) / slot_size, alignment);
+    objects_per_chunk = (chunk_size - slots_offset) / slot_size;
+    if (objects_per_chunk > INT_MAX) objects_per_chunk = INT_MAX; // Bitmap indices are int
+
+    // The unused tail of a chunk gives the number of colors
+    size_t color_step = alignment > CACHE_LINE_SIZE ? alignment : CACHE_LINE_SIZE;
+    size_t slack = chunk_size - slots_offset - objects_per_chunk * slot_size;
+    cache->alignment = alignment;
+    cache->slots_offset = slots_offset;
+    cache->color_step = color_step;
+    cache->num_colors = coloring ? (uint)(slack / color_step) + 1 : 1;
+    cache->next_color = 0;
+
+    cache->user_size = object_size;
+    cache->slot_size = slot_size;
+    cache->chunk_size = chunk_size;
+    cache->objects_per_chunk = objects_per_chunk;
+    cache->max_empty_chunks = max_empty_chunks;
+    cache->num_chunks = 0;
+    cache->chunks = NULL;
+    cache->chunks_capacity = 0;
+    cache->num_allocated = 0;
+    list_create(&cache->full);
+    list_create(&cache->partial);
+    list_create(&cache->empty);
+
+    // Setup interface methods
+    alloc->init = SlabCache_init;
+    alloc->dest = SlabCache_cleanup;
+    alloc->malloc = SlabCache_reserve;
+    alloc->free = SlabCache_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = SlabCache_release_batch;
+    alloc->realloc = NULL;
+    alloc->usable_size = NULL;
+    alloc->memalign = NULL;
+    alloc->calloc = NULL;
+    return (void*)1;
+}
+
+// Clean up SlabCache, every chunk is returned to the OS
+void *SlabCache_cleanup(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to SlabCache_cleanup\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    SlabCache* cache = (SlabCache*)alloc;
+    DoubleLinkedList* lists[] = { &cache->full, &cache->partial, &cache->empty };
+    for (int i = 0; i < 3; i++) {
+        Node* node;
+        while ((node = list_pop_front(lists[i])) != NULL) {
+            SlabCache_unmap_chunk(cache, (SlabChunk*)node);
+        }
+    }
+    if (cache->chunks) munmap(cache->chunks, (size_t)cache->chunks_capacity * sizeof(SlabChunk*));
+    cache->chunks = NULL;
+    cache->chunks_capacity = 0;
+    cache->num_allocated = 0;
+    return (void*)1;
+}
+
+// Allocate an object, mapping a new chunk if every chunk is full
+void *SlabCache_reserve(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to SlabCache_reserve\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    SlabCache* cache = (SlabCache*)alloc;
+    SlabChunk* chunk = (SlabChunk*)cache->partial.head;
+    if (!chunk) chunk = (SlabChunk*)cache->empty.head;
+    if (!chunk) {
+        chunk = SlabCache_map_chunk(cache);
+        if (!chunk) return NULL;
+        list_push_front(&cache->empty, &chunk->node);
+    }
+
+    DoubleLinkedList* before = chunk_list(cache, chunk);
+    uint32_t* link;
+    if (chunk->free_head != SLAB_CACHE_NIL) {
+        link = chunk_link(cache, chunk, chunk->free_head);
+        chunk->free_head = *link;
+    } else {
+        link = chunk_link(cache, chunk, chunk->bump_index++);
+    }
+    bitmap_set(&chunk->slot_bitmap, ((char*)link - chunk->slots_start) / cache->slot_size);
+    chunk->num_free--;
+    cache->num_allocated++;
+
+    DoubleLinkedList* after = chunk_list(cache, chunk);
+    if (after != before) {
+        list_detach(before, &chunk->node);
+        list_push_front(after, &chunk->node);
+    }
+    return (void*)link;
+}
+
+// Free an object, chunks that become empty are kept up to max_empty_chunks
+void *SlabCache_release(Allocator* alloc, ...) {
+    if (!alloc) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator passed to SlabCache_release\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    SlabCache* cache = (SlabCache*)alloc;
+    va_list args;
+    va_start(args, alloc);
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+
+    if (!ptr) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Skipping free of NULL pointer\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    // The chunk header sits at the chunk_size-aligned address below ptr, read only once
+    // the chunk is known to be mapped by this cache
+    SlabChunk* chunk = (SlabChunk*)((uintptr_t)ptr & ~(uintptr_t)(cache->chunk_size - 1));
+    uint position = chunk_position(cache, chunk);
+    if (position == cache->num_chunks || cache->chunks[position] != chunk) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to free: pointer does not belong to this cache!\n" RESET);
+        #endif
+        return NULL;
+    }
+    size_t offset = (char*)ptr - chunk->slots_start;
+    if ((char*)ptr < chunk->slots_start || offset % cache->slot_size != 0 ||
+        offset / cache->slot_size >= cache->objects_per_chunk) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to free: pointer is not the start of a slot!\n" RESET);
+        #endif
+        return NULL;
+    }
+    uint32_t index = (uint32_t)(offset / cache->slot_size);
+    if (!bitmap_test(&chunk->slot_bitmap, index)) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to free: slot already free!\n" RESET);
+        #endif
+        return NULL;
+    }
+
+    DoubleLinkedList* before = chunk_list(cache, chunk);
+    bitmap_clear(&chunk->slot_bitmap, index);
+    *chunk_link(cache, chunk, index) = chunk->free_head;
+    chunk->free_head = index;
+    chunk->num_free++;
+    cache->num_allocated--;
+
+    DoubleLinkedList* after = chunk_list(cache, chunk);
+    if (after != before) {
+        list_detach(before, &chunk->node);
+        list_push_front(after, &chunk->node);
+    }
+
+    // Hysteresis: release the least recently emptied chunk past the limit
+    if ((uint)cache->empty.size > cache->max_empty_chunks) {
+        SlabCache_unmap_chunk(cache, (SlabChunk*)list_pop_back(&cache->empty));
+    }
+    return (void*)1;
+}
+
+// Release reports failures as NULL, which the generic fallback cannot see
+int SlabCache_release_batch(Allocator* alloc, size_t n, void** ptrs) {
+    int released = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!ptrs[i]) continue;
+        if (!SlabCache_release(alloc, ptrs[i])) {
+            ptrs[i] = NULL;
+            continue;
+        }
+        released++;
+    }
+    return released;
+}
+
+uint SlabCache_shrink(SlabCache* cache) {
+    if (!cache) return 0;
+    uint released = 0;
+    Node* node;
+    while ((node = list_pop_front(&cache->empty)) != NULL) {
+        SlabCache_unmap_chunk(cache, (SlabChunk*)node);
+        released++;
+    }
+    return released;
+}
+
+void SlabCache_print_state(SlabCache* cache) {
+    printf("\tSlabCache Info:\n");
+    printf("\tObject Size: %zu (slot %zu)\n", cache->user_size, cache->slot_size);
+    printf("\tChunk Size: %zu (%u objects)\n", cache->chunk_size, cache->objects_per_chunk);
+    printf("\tAlignment: %zu, colors: %u (step %zu)\n", cache->alignment, cache->num_colors, cache->color_step);
+    printf("\tChunks: %u (full %d, partial %d, empty %d, max empty %u)\n",
+           cache->num_chunks, cache->full.size, cache->partial.size,
+           cache->empty.size, cache->max_empty_chunks);
+    printf("\tObjects: %zu/%zu used\n", cache->num_allocated,
+           (size_t)cache->num_chunks * cache->objects_per_chunk);
+}
@@ -95,6 +95,73 @@ int test_bitmap_find_first() {
     return 0;
 }
 
+int test_bitmap_find_zero_from() {
+    Bitmap b;
+    bitmap_create(&b, 70, NULL);  // 3 words, last one partial
+    assert(&b != NULL);
+
+    assert(bitmap_find_zero_from(&b, 0) == 0);
+    assert(bitmap_find_zero_from(&b, 69) == 69);
+    assert(bitmap_find_zero_from(&b, 70) == -1); // Out of range
+
+    // Bits before start are ignored
+    bitmap_set(&b, 5);
+    assert(bitmap_find_zero_from(&b, 5) == 6);
+    assert(bitmap_find_zero_from(&b, 3) == 3);
+
+    // Skip full words
+    for (int i = 0; i < 64; i++) {
+        bitmap_set(&b, i);
+    }
+    assert(bitmap_find_zero_from(&b, 1) == 64);
+
+    // Padding bits of the last word are not reported
+    for (int i = 64; i < 70; i++) {
+        bitmap_set(&b, i);
+    }
+    assert(bitmap_find_zero_from(&b, 0) == -1);
+    bitmap_clear(&b, 40);
+    assert(bitmap_find_zero_from(&b, 0) == 40);
+    assert(bitmap_find_zero_from(&b, 41) == -1);
+
+    bitmap_destroy(&b);
+    return 0;
+}
+
+int test_bitmap_find_zero_in_range() {
+    Bitmap b;
+    bitmap_create(&b, 2000, NULL);  // Long enough for the vector path
+    assert(&b != NULL);
+
+    assert(bitmap_find_zero_in_range(&b, 10, 20) == 10);
+    assert(bitmap_find_zero_in_range(&b, 20, 20) == -1); // Empty range
+    assert(bitmap_find_zero_in_range(&b, 0, 2001) == -1); // Out of range
+
+    // Nearly full: a single zero far from the start
+    for (int i = 0; i < 2000; i++) {
+        bitmap_set(&b, i);
+    }
+    assert(bitmap_find_zero_in_range(&b, 0, 2000) == -1);
+    bitmap_clear(&b, 1717);
+    assert(bitmap_find_zero_in_range(&b, 0, 2000) == 1717);
+    assert(bitmap_find_zero_in_range(&b, 3, 1717) == -1); // End is exclusive
+    assert(bitmap_find_zero_in_range(&b, 1717, 1718) == 1717);
+    assert(bitmap_find_zero_in_range(&b, 1718, 2000) == -1);
+
+    // Every position of the zero within and across words
+    bitmap_set(&b, 1717);
+    for (int i = 0; i < 2000; i += 37) {
+        bitmap_clear(&b, i);
+        assert(bitmap_find_zero_in_range(&b, 0, 2000) == i);
+        assert(bitmap_find_zero_in_range(&b, i, i + 1) == i);
+        if (i > 0) assert(bitmap_find_zero_in_range(&b, 0, i) == -1);
+        bitmap_set(&b, i);
+    }
+
+    bitmap_destroy(&b);
+    return 0;
+}
+
 int test_bitmap_print() {
     // Mostly for visual inspection
     Bitmap b;
@@ -118,11 +185,13 @@ int test_bitmap() {
     printf("=== Running Bitmap Tests ===\n");
 
     int tests_passed = 0;
-    int total_tests = 4;
+    int total_tests = 6;
     
     if (test_bitmap_create_destroy() == 0) tests_passed++;
     if (test_bitmap_set_clear_test() == 0) tests_passed++;
     if (test_bitmap_find_first() == 0) tests_passed++;
+    if (test_bitmap_find_zero_from() == 0) tests_passed++;
+    if (test_bitmap_find_zero_in_range() == 0) tests_passed++;
     if (test_bitmap_print() == 0) tests_passed++;
     if (tests_passed == total_tests) {
         printf("\033[1;32mAll Bitmap tests passed!\033[0m\n");
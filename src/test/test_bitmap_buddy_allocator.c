@@ -280,6 +280,16 @@ static int test_invalid_releases() {
     // Try to release the same pointer again - should fail
     assert(BitmapBuddyAllocator_free(&allocator, ptr) == -1);
     
+    // Aligned addresses never returned by memalign: their zeroed metadata must not release the root
+    void* live = BitmapBuddyAllocator_malloc(&allocator, 10);
+    char* start = allocator.memory_start;
+    void* fake[2] = {start, start + 2 * allocator.min_block_size};
+    assert(BitmapBuddyAllocator_free(&allocator, fake[0]) == -1);
+    assert(BitmapBuddyAllocator_free(&allocator, fake[1]) == -1);
+    assert(BitmapBuddyAllocator_free_batch(&allocator, 2, fake) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == MEMORY_SIZE - allocator.min_block_size);
+    assert(BitmapBuddyAllocator_free(&allocator, live) == 0);
+    
     #ifdef VERBOSE
     BitmapBuddyAllocator_print_state(&allocator);
     printf("Invalid releases test passed\n");
@@ -290,6 +300,455 @@ static int test_invalid_releases() {
     return 0;
 }
 
+// Test batch allocation and release with full coalescing
+static int test_batch() {
+    BitmapBuddyAllocator allocator;
+    void* ptrs[MEMORY_SIZE / 16];
+    void* shuffled[MEMORY_SIZE / 16 + 1];
+    size_t sizes[MEMORY_SIZE / 16];
+    
+    #ifdef VERBOSE
+    printf("Testing batch allocation...\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t small_size = allocator.min_block_size - BITMAP_METADATA_SIZE;
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    
+    // Two double blocks and the rest in single blocks fill the whole arena
+    int n = (int)(MEMORY_SIZE / allocator.min_block_size) - 2;
+    for (int i = 0; i < n; i++) sizes[i] = (i < 2) ? small_size * 2 : small_size;
+    assert(BitmapBuddyAllocator_malloc_batch(&allocator, n, sizes, ptrs) == n);
+    for (int i = 0; i < n; i++) {
+        assert(ptrs[i] != NULL);
+        fill_memory_pattern(ptrs[i], sizes[i], (unsigned char)i);
+    }
+    assert(BitmapBuddyAllocator_malloc(&allocator, small_size) == NULL);
+    for (int i = 0; i < n; i++) assert(!verify_memory_pattern(ptrs[i], sizes[i], (unsigned char)i));
+    
+    // Shuffled order plus a duplicate: the duplicate is rejected and set to NULL
+    for (int i = 0; i < n; i++) shuffled[i] = ptrs[(i * 5 + 3) % n];
+    shuffled[n] = ptrs[n / 2];
+    assert(BitmapBuddyAllocator_free_batch(&allocator, n + 1, shuffled) == n);
+    int rejected = 0;
+    for (int i = 0; i <= n; i++) rejected += (shuffled[i] == NULL);
+    assert(rejected == 1);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    
+    // Fully coalesced: the largest block is available again
+    void* large_ptr = BitmapBuddyAllocator_malloc(&allocator, MEMORY_SIZE - (allocator.min_block_size - small_size));
+    assert(large_ptr != NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, large_ptr) == 0);
+    
+    #ifdef VERBOSE
+    BitmapBuddyAllocator_print_state(&allocator);
+    printf("Batch allocation test passed\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test realloc in place (grow and shrink) and moving realloc
+static int test_realloc() {
+    BitmapBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing realloc...\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    size_t small_size = allocator.min_block_size - BITMAP_METADATA_SIZE;
+    
+    void* ptr = BitmapBuddyAllocator_realloc(&allocator, NULL, small_size);
+    assert(ptr != NULL);
+    assert(BitmapBuddyAllocator_usable_size(&allocator, ptr) == small_size);
+    fill_memory_pattern(ptr, small_size, 0xA5);
+    
+    // Growing takes the free right buddies, the pointer does not move
+    assert(BitmapBuddyAllocator_realloc(&allocator, ptr, small_size * 2) == ptr);
+    assert(BitmapBuddyAllocator_usable_size(&allocator, ptr) == 2 * allocator.min_block_size - BITMAP_METADATA_SIZE);
+    assert(BitmapBuddyAllocator_realloc(&allocator, ptr, MEMORY_SIZE / 2 - BITMAP_METADATA_SIZE) == ptr);
+    assert(!verify_memory_pattern(ptr, small_size, 0xA5));
+    void* other = BitmapBuddyAllocator_malloc(&allocator, MEMORY_SIZE / 2 - BITMAP_METADATA_SIZE);
+    assert(other != NULL);
+    assert(BitmapBuddyAllocator_malloc(&allocator, 1) == NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, other) == 0);
+    
+    // Shrinking releases the tail: the next block starts right after it
+    assert(BitmapBuddyAllocator_realloc(&allocator, ptr, 10) == ptr);
+    assert(BitmapBuddyAllocator_usable_size(&allocator, ptr) == small_size);
+    void* neighbour = BitmapBuddyAllocator_malloc(&allocator, small_size);
+    assert((char*)neighbour == (char*)ptr + allocator.min_block_size);
+    
+    // The right buddy is taken: the block moves and keeps its contents
+    void* moved = BitmapBuddyAllocator_realloc(&allocator, ptr, small_size * 2);
+    assert(moved != NULL && moved != ptr);
+    assert(!verify_memory_pattern(moved, small_size, 0xA5));
+    assert(BitmapBuddyAllocator_usable_size(&allocator, ptr) == 0); // Released
+    
+    assert(BitmapBuddyAllocator_realloc(&allocator, moved, 0) == NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, neighbour) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    // Fully merged again
+    void* large_ptr = BitmapBuddyAllocator_malloc(&allocator, MEMORY_SIZE - BITMAP_METADATA_SIZE);
+    assert(large_ptr != NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, large_ptr) == 0);
+    
+    #ifdef VERBOSE
+    printf("Realloc test passed\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+static int test_memalign() {
+    BitmapBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing memalign...\n");
+    #endif
+    
+    // Larger arena so that page aligned blocks fit
+    size_t memory_size = 1 << 16;
+    assert(BitmapBuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    
+    // Aligned blocks have no header: the whole block is usable
+    void* small = BitmapBuddyAllocator_memalign(&allocator, 64, 10);
+    assert(small != NULL && (uintptr_t)small % 64 == 0);
+    assert(BitmapBuddyAllocator_usable_size(&allocator, small) == allocator.min_block_size);
+    void* page = BitmapBuddyAllocator_memalign(&allocator, 4096, 100);
+    assert(page != NULL && (uintptr_t)page % 4096 == 0);
+    assert(BitmapBuddyAllocator_usable_size(&allocator, page) == 4096);
+    void* plain = BitmapBuddyAllocator_malloc(&allocator, 100);
+    assert(plain != NULL);
+    fill_memory_pattern(page, 4096, 0x5A);
+    fill_memory_pattern(small, allocator.min_block_size, 0xC3);
+    
+    // Resizing within the block keeps it in place
+    assert(BitmapBuddyAllocator_realloc(&allocator, small, 20) == small);
+    assert(!verify_memory_pattern(small, allocator.min_block_size, 0xC3));
+    assert(!verify_memory_pattern(page, 4096, 0x5A));
+    
+    // Alignments that are not powers of two or that no block can give
+    assert(BitmapBuddyAllocator_memalign(&allocator, 48, 10) == NULL);
+    assert(BitmapBuddyAllocator_memalign(&allocator, memory_size * 2, 10) == NULL);
+    
+    assert(BitmapBuddyAllocator_free(&allocator, small) == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, page) == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, page) == -1); // Double free
+    assert(BitmapBuddyAllocator_free(&allocator, plain) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    // Fully merged again
+    void* large_ptr = BitmapBuddyAllocator_malloc(&allocator, memory_size - BITMAP_METADATA_SIZE);
+    assert(large_ptr != NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, large_ptr) == 0);
+    
+    #ifdef VERBOSE
+    printf("Memalign test passed\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+static int test_calloc() {
+    BitmapBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing calloc...\n");
+    #endif
+    
+    // Large enough for blocks of whole pages
+    size_t memory_size = 1 << 22;
+    assert(BitmapBuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    
+    // Fresh from mmap: above the high-water mark
+    void* small = BitmapBuddyAllocator_calloc(&allocator, 16, 64);
+    assert(small != NULL && (char*)small < allocator.high_water);
+    assert(!verify_memory_pattern(small, 16 * 64, 0));
+    fill_memory_pattern(small, 16 * 64, 0xFF);
+    assert(BitmapBuddyAllocator_free(&allocator, small) == 0);
+    
+    // The same block again: dirty, cleared with memset
+    small = BitmapBuddyAllocator_calloc(&allocator, 16, 64);
+    assert(small != NULL);
+    assert(!verify_memory_pattern(small, 16 * 64, 0));
+    
+    // Dirty block of ZERO_MADVISE_MIN bytes: cleared with madvise
+    size_t large_size = memory_size / 4;
+    void* large = BitmapBuddyAllocator_calloc(&allocator, 1, large_size);
+    assert(large != NULL);
+    assert(!verify_memory_pattern(large, large_size, 0));
+    fill_memory_pattern(large, large_size, 0xAB);
+    assert(BitmapBuddyAllocator_free(&allocator, large) == 0);
+    large = BitmapBuddyAllocator_calloc(&allocator, large_size, 1);
+    assert(large != NULL);
+    assert(!verify_memory_pattern(large, large_size, 0));
+    fill_memory_pattern(large, large_size, 0xAB);
+    assert(BitmapBuddyAllocator_free(&allocator, large) == 0);
+    
+    // Generic fallback: malloc and memset
+    ((Allocator*)&allocator)->calloc = NULL;
+    large = BitmapBuddyAllocator_calloc(&allocator, 1, large_size);
+    assert(large != NULL);
+    assert(!verify_memory_pattern(large, large_size, 0));
+    assert(BitmapBuddyAllocator_free(&allocator, large) == 0);
+    ((Allocator*)&allocator)->calloc = BitmapBuddyAllocator_callocate;
+    
+    // nmemb * size overflows
+    assert(BitmapBuddyAllocator_calloc(&allocator, SIZE_MAX / 2, 4) == NULL);
+    
+    assert(BitmapBuddyAllocator_free(&allocator, small) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    #ifdef VERBOSE
+    printf("Calloc test passed\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Pages of [ptr, ptr + size) mapped in memory
+static size_t resident_pages(void* ptr, size_t size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    unsigned char vec[size / page_size + 1];
+    assert(mincore(ptr, size, vec) == 0);
+    size_t resident = 0;
+    for (size_t i = 0; i < (size + page_size - 1) / page_size; i++) resident += vec[i] & 1;
+    return resident;
+}
+
+// Test purging: free pages go back to the kernel on request, at once or after the decay
+static int test_purge() {
+    BitmapBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing purge and decay...\n");
+    #endif
+    
+    // Blocks of a quarter of the arena: x and z are buddies, y is the buddy of the free last quarter
+    size_t memory_size = 1 << 22;
+    size_t block = memory_size / 4;
+    size_t usable = block - BITMAP_METADATA_SIZE;
+    size_t pages = block / sysconf(_SC_PAGESIZE);
+    assert(BitmapBuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    char* start = allocator.memory_start;
+    BitmapBuddyAllocator_set_decay(&allocator, -1);
+    char* x = BitmapBuddyAllocator_malloc(&allocator, usable);
+    char* z = BitmapBuddyAllocator_malloc(&allocator, usable);
+    char* y = BitmapBuddyAllocator_malloc(&allocator, usable);
+    assert(x == start + BITMAP_METADATA_SIZE && z == x + block && y == z + block);
+    fill_memory_pattern(x, usable, 0xAB);
+    fill_memory_pattern(y, usable, 0xAB);
+    
+    // Never purged on its own, on request only the dirty free block goes
+    assert(BitmapBuddyAllocator_free(&allocator, x) == 0);
+    assert(allocator.purged_bytes == 0);
+    assert(resident_pages(start, block) == pages);
+    assert(BitmapBuddyAllocator_purge(&allocator) == block);
+    assert(resident_pages(start, block) == 0);
+    assert(BitmapBuddyAllocator_purge(&allocator) == 0);
+    
+    // calloc knows the purged pages are zero: only the header is written
+    char* zeroed = BitmapBuddyAllocator_calloc(&allocator, 1, usable);
+    assert(zeroed == x);
+    assert(resident_pages(start, block) <= 1);
+    assert(!verify_memory_pattern(zeroed, usable, 0));
+    fill_memory_pattern(zeroed, usable, 0xCD);
+    assert(BitmapBuddyAllocator_free(&allocator, zeroed) == 0);
+    zeroed = BitmapBuddyAllocator_calloc(&allocator, 1, usable); // Dirty again
+    assert(!verify_memory_pattern(zeroed, usable, 0));
+    assert(BitmapBuddyAllocator_free(&allocator, zeroed) == 0);
+    
+    // No decay: purged as soon as it is released, small blocks once they merge into a page
+    BitmapBuddyAllocator_set_decay(&allocator, 0);
+    assert(resident_pages(start, block) == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, y) == 0);
+    assert(resident_pages(start + 2 * block, block) == 0);
+    void* small[2];
+    size_t small_sizes[2] = {1000, 1000};
+    assert(BitmapBuddyAllocator_malloc_batch(&allocator, 2, small_sizes, small) == 2);
+    fill_memory_pattern(small[0], 1000, 0xAB);
+    fill_memory_pattern(small[1], 1000, 0xAB);
+    assert(BitmapBuddyAllocator_free(&allocator, small[0]) == 0);
+    assert(resident_pages(start, block) == 1);
+    assert(BitmapBuddyAllocator_free_batch(&allocator, 1, &small[1]) == 1);
+    assert(resident_pages(start, block) == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, z) == 0);
+    
+    // Decay: x has been free long enough when y is released, y has not
+    BitmapBuddyAllocator_set_decay(&allocator, 50);
+    x = BitmapBuddyAllocator_malloc(&allocator, usable);
+    z = BitmapBuddyAllocator_malloc(&allocator, usable);
+    y = BitmapBuddyAllocator_malloc(&allocator, usable);
+    assert(x == start + BITMAP_METADATA_SIZE && y == x + 2 * block);
+    fill_memory_pattern(x, usable, 0xAB);
+    fill_memory_pattern(y, usable, 0xAB);
+    assert(BitmapBuddyAllocator_free(&allocator, x) == 0);
+    assert(resident_pages(start, block) == pages);
+    usleep(60 * 1000);
+    assert(BitmapBuddyAllocator_free(&allocator, y) == 0);
+    assert(resident_pages(start, block) == 0);
+    assert(resident_pages(start + 2 * block, block) == pages);
+    
+    assert(BitmapBuddyAllocator_free(&allocator, z) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == memory_size);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    
+    // No decay, a batch of buddies of a page or more: their merged block goes, the live neighbour stays
+    assert(BitmapBuddyAllocator_create(&allocator, 1 << 20, 8) != NULL);
+    BitmapBuddyAllocator_set_decay(&allocator, 0);
+    size_t node = allocator.min_block_size;
+    char* live = BitmapBuddyAllocator_malloc(&allocator, 1000);
+    char* left = BitmapBuddyAllocator_malloc(&allocator, 1000);
+    void* pair[2];
+    size_t pair_sizes[2] = {1000, 1000};
+    assert(BitmapBuddyAllocator_malloc_batch(&allocator, 2, pair_sizes, pair) == 2);
+    assert((char*)pair[0] == live + 2 * node && (char*)pair[1] == live + 3 * node);
+    fill_memory_pattern(live, 1000, 0xAB);
+    fill_memory_pattern(pair[0], 1000, 0xAB);
+    fill_memory_pattern(pair[1], 1000, 0xAB);
+    assert(BitmapBuddyAllocator_free_batch(&allocator, 2, pair) == 2);
+    assert(!verify_memory_pattern(live, 1000, 0xAB));
+    assert(resident_pages(allocator.memory_start + 2 * node, 2 * node) == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, left) == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, live) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == 1 << 20);
+    
+    #ifdef VERBOSE
+    printf("Purge and decay test passed\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test deferred coalescing: released blocks wait in the quick lists and come back first
+static int test_quick_lists() {
+    BitmapBuddyAllocator allocator;
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing quick lists...\n");
+    #endif
+    
+    size_t memory_size = 1 << 16;
+    assert(BitmapBuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    BitmapBuddyAllocator_set_quick_lists(&allocator, 4);
+    
+    // Ping-pong: the released block is handed out again, unmerged
+    void* ptr = BitmapBuddyAllocator_malloc(&allocator, 100);
+    assert(ptr != NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, ptr) == 0);
+    assert(base->sparse_free_memory == memory_size);
+    assert(BitmapBuddyAllocator_usable_size(&allocator, ptr) == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, ptr) == -1); // Double free while in the quick list
+    assert(BitmapBuddyAllocator_malloc(&allocator, 100) == ptr);
+    
+    // A full list merges its older half
+    void* blocks[10];
+    for (int i = 0; i < 10; i++) {
+        blocks[i] = BitmapBuddyAllocator_malloc(&allocator, 100);
+        assert(blocks[i] != NULL);
+    }
+    for (int i = 0; i < 10; i++) {
+        assert(BitmapBuddyAllocator_free(&allocator, blocks[i]) == 0);
+        assert(allocator.quick_counts[allocator.num_levels] <= 4);
+    }
+    assert(BitmapBuddyAllocator_malloc(&allocator, 100) == blocks[9]); // LIFO
+    assert(BitmapBuddyAllocator_free(&allocator, blocks[9]) == 0);
+    
+    // The quick blocks keep the first half split: the second half is still free,
+    // a request for the whole arena merges the lists first
+    assert(BitmapBuddyAllocator_free(&allocator, ptr) == 0);
+    void* half = BitmapBuddyAllocator_malloc(&allocator, memory_size / 2 - BITMAP_METADATA_SIZE);
+    assert(half != NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, half) == 0);
+    assert(allocator.quick_counts[1] == 1);
+    void* whole = BitmapBuddyAllocator_malloc(&allocator, memory_size - BITMAP_METADATA_SIZE);
+    assert(whole != NULL);
+    assert(allocator.quick_counts[allocator.num_levels] == 0 && allocator.quick_counts[1] == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, whole) == 0);
+    
+    // Turning them off merges what is left
+    void* aligned = BitmapBuddyAllocator_memalign(&allocator, 1024, 1000);
+    assert(aligned != NULL && (uintptr_t)aligned % 1024 == 0);
+    assert(BitmapBuddyAllocator_free(&allocator, aligned) == 0);
+    BitmapBuddyAllocator_set_quick_lists(&allocator, 0);
+    assert(base->sparse_free_memory == memory_size);
+    assert(base->internal_fragmentation == 0);
+    whole = BitmapBuddyAllocator_malloc(&allocator, memory_size - BITMAP_METADATA_SIZE);
+    assert(whole != NULL);
+    assert(BitmapBuddyAllocator_free(&allocator, whole) == 0);
+    
+    #ifdef VERBOSE
+    printf("Quick lists test passed\n");
+    #endif
+    
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test arenas on huge pages: whatever backing the system gives, the allocator behaves the same
+static int test_huge_pages() {
+    BitmapBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing huge page arenas...\n");
+    #endif
+    
+    // Smaller than a huge page: always base pages
+    assert(BitmapBuddyAllocator_create_with_pages(&allocator, 1 << 16, 6, ARENA_PAGES_HUGE) != NULL);
+    assert(allocator.backing == ARENA_BACKING_BASE);
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    
+    size_t memory_size = 4 * HUGE_PAGE_SIZE;
+    assert(BitmapBuddyAllocator_create_with_pages(&allocator, memory_size, 12, ARENA_PAGES_HUGE) != NULL);
+    #ifdef VERBOSE
+    printf("Arena backed by %s\n", arena_backing_name(allocator.backing));
+    #endif
+    if (allocator.backing != ARENA_BACKING_BASE) {
+        assert((uintptr_t)allocator.memory_start % HUGE_PAGE_SIZE == 0);
+    }
+    
+    void* blocks[64];
+    for (int i = 0; i < 64; i++) {
+        blocks[i] = BitmapBuddyAllocator_malloc(&allocator, 1000 + i * 500);
+        assert(blocks[i] != NULL);
+        fill_memory_pattern(blocks[i], 1000 + i * 500, (unsigned char)i);
+    }
+    for (int i = 0; i < 64; i++) {
+        assert(!verify_memory_pattern(blocks[i], 1000 + i * 500, (unsigned char)i));
+        assert(BitmapBuddyAllocator_free(&allocator, blocks[i]) == 0);
+    }
+    
+    // A zeroed block over the whole arena
+    char* whole = BitmapBuddyAllocator_calloc(&allocator, 1, memory_size / 2);
+    assert(whole != NULL);
+    assert(!verify_memory_pattern(whole, memory_size / 2, 0));
+    assert(BitmapBuddyAllocator_free(&allocator, whole) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(BitmapBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Huge page arenas test passed\n");
+    #endif
+    return 0;
+}
+
 int test_bitmap_buddy_allocator() {
     int result = 0;
     
@@ -302,6 +761,13 @@ int test_bitmap_buddy_allocator() {
     result |= test_varied_sizes();
     result |= test_buddy_merging();
     result |= test_invalid_releases();
+    result |= test_batch();
+    result |= test_realloc();
+    result |= test_memalign();
+    result |= test_calloc();
+    result |= test_huge_pages();
+    result |= test_quick_lists();
+    result |= test_purge();
     
     
     if (result != 0) {
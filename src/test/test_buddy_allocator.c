@@ -274,7 +274,430 @@ static int test_invalid_releases() {
     return 0;
 }
 
+// Test batch allocation and release with full coalescing
+static int test_batch() {
+    BuddyAllocator allocator;
+    void* ptrs[MEMORY_SIZE / 16];
+    void* shuffled[MEMORY_SIZE / 16 + 1];
+    size_t sizes[MEMORY_SIZE / 16];
+    
+    #ifdef VERBOSE
+    printf("Testing batch allocation...\n");
+    #endif
+    
+    assert(BuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t small_size = allocator.min_block_size - BUDDY_METADATA_SIZE;
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    
+    // Two double blocks and the rest in single blocks fill the whole arena
+    int n = (int)(MEMORY_SIZE / allocator.min_block_size) - 2;
+    for (int i = 0; i < n; i++) sizes[i] = (i < 2) ? small_size * 2 : small_size;
+    assert(BuddyAllocator_malloc_batch(&allocator, n, sizes, ptrs) == n);
+    for (int i = 0; i < n; i++) {
+        assert(ptrs[i] != NULL);
+        fill_memory_pattern(ptrs[i], sizes[i], (unsigned char)i);
+    }
+    assert(BuddyAllocator_malloc(&allocator, small_size) == NULL);
+    for (int i = 0; i < n; i++) assert(!verify_memory_pattern(ptrs[i], sizes[i], (unsigned char)i));
+    
+    // Shuffled order plus a duplicate: the duplicate is rejected and set to NULL
+    for (int i = 0; i < n; i++) shuffled[i] = ptrs[(i * 5 + 3) % n];
+    shuffled[n] = ptrs[n / 2];
+    assert(BuddyAllocator_free_batch(&allocator, n + 1, shuffled) == n);
+    int rejected = 0;
+    for (int i = 0; i <= n; i++) rejected += (shuffled[i] == NULL);
+    assert(rejected == 1);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    
+    // Fully coalesced: the largest block is available again
+    void* large_ptr = BuddyAllocator_malloc(&allocator, MEMORY_SIZE - (allocator.min_block_size - small_size));
+    assert(large_ptr != NULL);
+    assert(BuddyAllocator_free(&allocator, large_ptr) == 0);
+    
+    #ifdef VERBOSE
+    BuddyAllocator_print_state(&allocator);
+    printf("Batch allocation test passed\n");
+    #endif
+    
+    assert(BuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test that free_level_mask tracks the non-empty free lists on a deep tree
+static int test_level_mask() {
+    BuddyAllocator allocator;
+    void* ptrs[64];
+    
+    #ifdef VERBOSE
+    printf("Testing free level mask...\n");
+    #endif
+    
+    assert(BuddyAllocator_create(&allocator, 1 << 20, 20) != NULL);
+    assert(allocator.free_level_mask == 1);
+    size_t small_size = allocator.min_block_size - BUDDY_METADATA_SIZE;
+    
+    // Splitting the root down to the last level leaves one free block per level
+    for (int i = 0; i < 64; i++) {
+        ptrs[i] = BuddyAllocator_malloc(&allocator, small_size);
+        assert(ptrs[i] != NULL);
+        for (uint l = 0; l < allocator.num_levels; l++) {
+            assert(((allocator.free_level_mask >> l) & 1) == (allocator.free_lists[l]->size > 0));
+        }
+    }
+    // Every other block free: the larger request is served from a higher level
+    for (int i = 0; i < 64; i += 2) assert(BuddyAllocator_free(&allocator, ptrs[i]) == 0);
+    void* large_ptr = BuddyAllocator_malloc(&allocator, small_size * 4);
+    assert(large_ptr != NULL);
+    assert((char*)large_ptr > (char*)ptrs[63]);
+    assert(BuddyAllocator_free(&allocator, large_ptr) == 0);
+    
+    for (int i = 1; i < 64; i += 2) assert(BuddyAllocator_free(&allocator, ptrs[i]) == 0);
+    assert(allocator.free_level_mask == 1);
+    
+    #ifdef VERBOSE
+    printf("Free level mask test passed\n");
+    #endif
+    
+    assert(BuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test realloc in place (grow and shrink), moving realloc and the generic fallback
+static int test_realloc() {
+    BuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing realloc...\n");
+    #endif
+    
+    assert(BuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    size_t small_size = allocator.min_block_size - BUDDY_METADATA_SIZE;
+    
+    void* ptr = BuddyAllocator_realloc(&allocator, NULL, small_size);
+    assert(ptr != NULL);
+    assert(BuddyAllocator_usable_size(&allocator, ptr) == small_size);
+    fill_memory_pattern(ptr, small_size, 0xA5);
+    
+    // Growing absorbs the free right buddies, the pointer does not move
+    assert(BuddyAllocator_realloc(&allocator, ptr, small_size * 2) == ptr);
+    assert(BuddyAllocator_usable_size(&allocator, ptr) == 2 * allocator.min_block_size - BUDDY_METADATA_SIZE);
+    assert(BuddyAllocator_realloc(&allocator, ptr, MEMORY_SIZE / 2 - BUDDY_METADATA_SIZE) == ptr);
+    assert(!verify_memory_pattern(ptr, small_size, 0xA5));
+    
+    // Shrinking gives the tail back: the next block starts right after it
+    assert(BuddyAllocator_realloc(&allocator, ptr, 10) == ptr);
+    assert(BuddyAllocator_usable_size(&allocator, ptr) == small_size);
+    void* neighbour = BuddyAllocator_malloc(&allocator, small_size);
+    assert((char*)neighbour == (char*)ptr + allocator.min_block_size);
+    
+    // The right buddy is taken: the block moves and keeps its contents
+    void* moved = BuddyAllocator_realloc(&allocator, ptr, small_size * 2);
+    assert(moved != NULL && moved != ptr);
+    assert(!verify_memory_pattern(moved, small_size, 0xA5));
+    assert(BuddyAllocator_usable_size(&allocator, ptr) == 0); // Released
+    
+    // Generic fallback: copy through usable_size
+    ((Allocator*)&allocator)->realloc = NULL;
+    void* copied = Allocator_realloc((Allocator*)&allocator, moved, small_size * 4);
+    assert(copied != NULL && copied != moved);
+    assert(!verify_memory_pattern(copied, small_size, 0xA5));
+    ((Allocator*)&allocator)->realloc = BuddyAllocator_reallocate;
+    
+    assert(BuddyAllocator_realloc(&allocator, copied, 0) == NULL);
+    assert(BuddyAllocator_free(&allocator, neighbour) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    #ifdef VERBOSE
+    printf("Realloc test passed\n");
+    #endif
+    
+    assert(BuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
 // Main test function
+static int test_memalign() {
+    BuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing memalign...\n");
+    #endif
+    
+    // Larger arena so that page aligned blocks fit
+    size_t memory_size = 1 << 16;
+    assert(BuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    
+    // Aligned blocks have no header: the whole block is usable
+    void* small = BuddyAllocator_memalign(&allocator, 64, 10);
+    assert(small != NULL && (uintptr_t)small % 64 == 0);
+    assert(BuddyAllocator_usable_size(&allocator, small) == allocator.min_block_size);
+    void* page = BuddyAllocator_memalign(&allocator, 4096, 100);
+    assert(page != NULL && (uintptr_t)page % 4096 == 0);
+    assert(BuddyAllocator_usable_size(&allocator, page) == 4096);
+    void* plain = BuddyAllocator_malloc(&allocator, 100);
+    assert(plain != NULL);
+    fill_memory_pattern(page, 4096, 0x5A);
+    fill_memory_pattern(small, allocator.min_block_size, 0xC3);
+    
+    // Resizing within the block keeps it in place
+    assert(BuddyAllocator_realloc(&allocator, small, 20) == small);
+    assert(!verify_memory_pattern(small, allocator.min_block_size, 0xC3));
+    assert(!verify_memory_pattern(page, 4096, 0x5A));
+    
+    // Alignments that are not powers of two or that no block can give
+    assert(BuddyAllocator_memalign(&allocator, 48, 10) == NULL);
+    assert(BuddyAllocator_memalign(&allocator, memory_size * 2, 10) == NULL);
+    
+    assert(BuddyAllocator_free(&allocator, small) == 0);
+    assert(BuddyAllocator_free(&allocator, page) == 0);
+    assert(BuddyAllocator_free(&allocator, page) == -1); // Double free
+    assert(BuddyAllocator_free(&allocator, plain) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    // Aligned blocks merged by one batch: the ones absorbed by an earlier merge leave no entry behind
+    void* batch[4];
+    for (int i = 0; i < 4; i++) {
+        batch[i] = BuddyAllocator_memalign(&allocator, 64, 10);
+        assert(batch[i] != NULL);
+    }
+    assert(BuddyAllocator_free_batch(&allocator, 4, batch) == 4);
+    for (size_t i = 0; i < memory_size / allocator.min_block_size; i++) assert(allocator.aligned_nodes[i] == NULL);
+    
+    // Fully merged again
+    void* large_ptr = BuddyAllocator_malloc(&allocator, memory_size - BUDDY_METADATA_SIZE);
+    assert(large_ptr != NULL);
+    assert(BuddyAllocator_free(&allocator, large_ptr) == 0);
+    
+    #ifdef VERBOSE
+    printf("Memalign test passed\n");
+    #endif
+    
+    assert(BuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+static int test_calloc() {
+    BuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing calloc...\n");
+    #endif
+    
+    // Large enough for blocks of whole pages
+    size_t memory_size = 1 << 22;
+    assert(BuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    size_t initial_free = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    
+    // Fresh from mmap: above the high-water mark
+    void* small = BuddyAllocator_calloc(&allocator, 16, 64);
+    assert(small != NULL && (char*)small < allocator.high_water);
+    assert(!verify_memory_pattern(small, 16 * 64, 0));
+    fill_memory_pattern(small, 16 * 64, 0xFF);
+    assert(BuddyAllocator_free(&allocator, small) == 0);
+    
+    // The same block again: dirty, cleared with memset
+    small = BuddyAllocator_calloc(&allocator, 16, 64);
+    assert(small != NULL);
+    assert(!verify_memory_pattern(small, 16 * 64, 0));
+    
+    // Dirty block of ZERO_MADVISE_MIN bytes: cleared with madvise
+    size_t large_size = memory_size / 4;
+    void* large = BuddyAllocator_calloc(&allocator, 1, large_size);
+    assert(large != NULL);
+    assert(!verify_memory_pattern(large, large_size, 0));
+    fill_memory_pattern(large, large_size, 0xAB);
+    assert(BuddyAllocator_free(&allocator, large) == 0);
+    large = BuddyAllocator_calloc(&allocator, large_size, 1);
+    assert(large != NULL);
+    assert(!verify_memory_pattern(large, large_size, 0));
+    fill_memory_pattern(large, large_size, 0xAB);
+    assert(BuddyAllocator_free(&allocator, large) == 0);
+    
+    // Generic fallback: malloc and memset
+    ((Allocator*)&allocator)->calloc = NULL;
+    large = BuddyAllocator_calloc(&allocator, 1, large_size);
+    assert(large != NULL);
+    assert(!verify_memory_pattern(large, large_size, 0));
+    assert(BuddyAllocator_free(&allocator, large) == 0);
+    ((Allocator*)&allocator)->calloc = BuddyAllocator_callocate;
+    
+    // nmemb * size overflows
+    assert(BuddyAllocator_calloc(&allocator, SIZE_MAX / 2, 4) == NULL);
+    
+    assert(BuddyAllocator_free(&allocator, small) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == initial_free);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    #ifdef VERBOSE
+    printf("Calloc test passed\n");
+    #endif
+    
+    assert(BuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Pages of [ptr, ptr + size) mapped in memory
+static size_t resident_pages(void* ptr, size_t size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    unsigned char vec[size / page_size + 1];
+    assert(mincore(ptr, size, vec) == 0);
+    size_t resident = 0;
+    for (size_t i = 0; i < (size + page_size - 1) / page_size; i++) resident += vec[i] & 1;
+    return resident;
+}
+
+static int test_purge() {
+    BuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing purge and decay...\n");
+    #endif
+    
+    // Blocks of a quarter of the arena: x and z are buddies, y is the buddy of the free last quarter
+    size_t memory_size = 1 << 22;
+    size_t block = memory_size / 4;
+    size_t usable = block - BUDDY_METADATA_SIZE;
+    size_t pages = block / sysconf(_SC_PAGESIZE);
+    assert(BuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    char* start = allocator.memory_start;
+    BuddyAllocator_set_decay(&allocator, -1);
+    char* x = BuddyAllocator_malloc(&allocator, usable);
+    char* z = BuddyAllocator_malloc(&allocator, usable);
+    char* y = BuddyAllocator_malloc(&allocator, usable);
+    assert(x == start + BUDDY_METADATA_SIZE && z == x + block && y == z + block);
+    fill_memory_pattern(x, usable, 0xAB);
+    fill_memory_pattern(y, usable, 0xAB);
+    
+    // Never purged on its own, on request only the dirty free block goes
+    assert(BuddyAllocator_free(&allocator, x) == 0);
+    assert(allocator.purged_bytes == 0);
+    assert(resident_pages(start, block) == pages);
+    assert(BuddyAllocator_purge(&allocator) == block);
+    assert(resident_pages(start, block) == 0);
+    assert(BuddyAllocator_purge(&allocator) == 0);
+    
+    // calloc knows the purged pages are zero: only the header is written
+    char* zeroed = BuddyAllocator_calloc(&allocator, 1, usable);
+    assert(zeroed == x);
+    assert(resident_pages(start, block) <= 1);
+    assert(!verify_memory_pattern(zeroed, usable, 0));
+    fill_memory_pattern(zeroed, usable, 0xCD);
+    assert(BuddyAllocator_free(&allocator, zeroed) == 0);
+    zeroed = BuddyAllocator_calloc(&allocator, 1, usable); // Dirty again
+    assert(!verify_memory_pattern(zeroed, usable, 0));
+    assert(BuddyAllocator_free(&allocator, zeroed) == 0);
+    
+    // No decay: purged as soon as it is released
+    BuddyAllocator_set_decay(&allocator, 0);
+    assert(resident_pages(start, block) == 0);
+    assert(BuddyAllocator_free(&allocator, y) == 0);
+    assert(resident_pages(start + 2 * block, block) == 0);
+    assert(BuddyAllocator_free(&allocator, z) == 0);
+    
+    // Decay: x has been free long enough when y is released, y has not
+    BuddyAllocator_set_decay(&allocator, 50);
+    x = BuddyAllocator_malloc(&allocator, usable);
+    z = BuddyAllocator_malloc(&allocator, usable);
+    y = BuddyAllocator_malloc(&allocator, usable);
+    assert(x == start + BUDDY_METADATA_SIZE && y == x + 2 * block);
+    fill_memory_pattern(x, usable, 0xAB);
+    fill_memory_pattern(y, usable, 0xAB);
+    assert(BuddyAllocator_free(&allocator, x) == 0);
+    assert(resident_pages(start, block) == pages);
+    usleep(60 * 1000);
+    assert(BuddyAllocator_free(&allocator, y) == 0);
+    assert(resident_pages(start, block) == 0);
+    assert(resident_pages(start + 2 * block, block) == pages);
+    
+    assert(BuddyAllocator_free(&allocator, z) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == memory_size);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    
+    #ifdef VERBOSE
+    printf("Purge and decay test passed\n");
+    #endif
+    
+    assert(BuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test deferred coalescing: released blocks wait in the quick lists and come back first
+static int test_quick_lists() {
+    BuddyAllocator allocator;
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing quick lists...\n");
+    #endif
+    
+    size_t memory_size = 1 << 16;
+    assert(BuddyAllocator_create(&allocator, memory_size, 8) != NULL);
+    BuddyAllocator_set_quick_lists(&allocator, 4);
+    uint min_level = allocator.num_levels - 1;
+    
+    // Ping-pong: the released block is handed out again, unmerged
+    void* ptr = BuddyAllocator_malloc(&allocator, 100);
+    assert(ptr != NULL);
+    assert(BuddyAllocator_free(&allocator, ptr) == 0);
+    assert(base->sparse_free_memory == memory_size);
+    assert(allocator.quick_counts[min_level] == 1);
+    assert(BuddyAllocator_usable_size(&allocator, ptr) == 0);
+    assert(BuddyAllocator_free(&allocator, ptr) == -1); // Double free while in the quick list
+    assert(BuddyAllocator_malloc(&allocator, 100) == ptr);
+    assert(allocator.quick_counts[min_level] == 0);
+    
+    // A full list merges its older half
+    void* blocks[10];
+    for (int i = 0; i < 10; i++) {
+        blocks[i] = BuddyAllocator_malloc(&allocator, 100);
+        assert(blocks[i] != NULL);
+    }
+    for (int i = 0; i < 10; i++) {
+        assert(BuddyAllocator_free(&allocator, blocks[i]) == 0);
+        assert(allocator.quick_counts[min_level] <= 4);
+    }
+    assert(BuddyAllocator_malloc(&allocator, 100) == blocks[9]); // LIFO
+    assert(BuddyAllocator_free(&allocator, blocks[9]) == 0);
+    
+    // The quick blocks keep the first half split: the second half is still free,
+    // a request for the whole arena merges the lists first
+    assert(BuddyAllocator_free(&allocator, ptr) == 0);
+    void* half = BuddyAllocator_malloc(&allocator, memory_size / 2 - BUDDY_METADATA_SIZE);
+    assert(half != NULL);
+    assert(BuddyAllocator_free(&allocator, half) == 0);
+    assert(allocator.quick_counts[1] == 1);
+    void* whole = BuddyAllocator_malloc(&allocator, memory_size - BUDDY_METADATA_SIZE);
+    assert(whole != NULL);
+    assert(allocator.quick_counts[min_level] == 0 && allocator.quick_counts[1] == 0);
+    
+    // A block dirtied after a purge is zeroed by calloc even if it comes from a quick list
+    assert(BuddyAllocator_free(&allocator, whole) == 0);
+    assert(BuddyAllocator_purge(&allocator) > 0);
+    assert(allocator.quick_counts[0] == 0);
+    char* dirty = BuddyAllocator_malloc(&allocator, 8000);
+    fill_memory_pattern(dirty, 8000, 0xAB);
+    assert(BuddyAllocator_free(&allocator, dirty) == 0);
+    assert(BuddyAllocator_calloc(&allocator, 1, 8000) == dirty);
+    assert(!verify_memory_pattern(dirty, 8000, 0));
+    assert(BuddyAllocator_free(&allocator, dirty) == 0);
+    
+    // Turning them off merges what is left
+    BuddyAllocator_set_quick_lists(&allocator, 0);
+    assert(base->sparse_free_memory == memory_size);
+    assert(base->internal_fragmentation == 0);
+    assert(allocator.free_lists[0]->size == 1);
+    assert(BuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Quick lists test passed\n");
+    #endif
+    return 0;
+}
+
 int test_buddy_allocator() {
     int result = 0;
     
@@ -287,6 +710,13 @@ int test_buddy_allocator() {
     result |= test_varied_sizes();
     result |= test_buddy_merging();
     result |= test_invalid_releases();
+    result |= test_batch();
+    result |= test_level_mask();
+    result |= test_realloc();
+    result |= test_memalign();
+    result |= test_calloc();
+    result |= test_purge();
+    result |= test_quick_lists();
     
     
     if (result != 0) {
@@ -0,0 +1,206 @@
+#include <test_concurrent_buddy_allocator.h>
+#define MEMORY_SIZE (1 << 20)
+#define NUM_LEVELS 12 // 256B min blocks
+#define NUM_SUBTREES 4
+#define NUM_THREADS 8
+#define THREAD_ROUNDS 200
+#define THREAD_BATCH 32
+
+static inline int subtree_index(ConcurrentBuddyAllocator* a, void* ptr) {
+    for (uint i = 0; i < a->num_subtrees; i++) {
+        if ((char*)ptr >= a->subtree_start[i] && (char*)ptr < a->subtree_start[i] + a->subtree_size) return i;
+    }
+    return -1;
+}
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    ConcurrentBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+    
+    assert(ConcurrentBuddyAllocator_create(NULL, MEMORY_SIZE, NUM_LEVELS, NUM_SUBTREES) == NULL);
+    assert(ConcurrentBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS, 0) == NULL);
+    assert(ConcurrentBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS, 3) == NULL);
+    assert(ConcurrentBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS, 2 * CONCURRENT_BUDDY_MAX_SUBTREES) == NULL);
+    assert(ConcurrentBuddyAllocator_create(&allocator, MEMORY_SIZE, 2, NUM_SUBTREES) == NULL);
+    
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that a full home subtree spills into the others, and that every block goes back to its own
+static int test_spill() {
+    ConcurrentBuddyAllocator allocator;
+    void* ptrs[NUM_SUBTREES + 1];
+    
+    #ifdef VERBOSE
+    printf("Testing requests spilling to other subtrees...\n");
+    #endif
+    
+    assert(ConcurrentBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS, NUM_SUBTREES) != NULL);
+    assert(allocator.subtree_size == MEMORY_SIZE / NUM_SUBTREES);
+    assert(allocator.subtrees[0].buddy.min_block_size == MEMORY_SIZE >> NUM_LEVELS);
+    
+    // Each request takes a whole subtree
+    size_t whole = allocator.subtree_size - BUDDY_METADATA_SIZE;
+    int used[NUM_SUBTREES] = {0};
+    for (int i = 0; i < NUM_SUBTREES; i++) {
+        ptrs[i] = ConcurrentBuddyAllocator_malloc(&allocator, whole);
+        assert(ptrs[i] != NULL);
+        int index = subtree_index(&allocator, ptrs[i]);
+        assert(index >= 0 && !used[index]);
+        used[index] = 1;
+    }
+    assert(ConcurrentBuddyAllocator_malloc(&allocator, whole) == NULL);
+    assert(ConcurrentBuddyAllocator_malloc(&allocator, allocator.subtree_size) == NULL); // Larger than a subtree
+    ConcurrentBuddyAllocator_update_stats(&allocator);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == 0);
+    
+    for (int i = 0; i < NUM_SUBTREES; i++) {
+        assert(ConcurrentBuddyAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    assert(ConcurrentBuddyAllocator_free(&allocator, ptrs[0]) == -1);
+    assert(ConcurrentBuddyAllocator_free(&allocator, &allocator) == -1);
+    ConcurrentBuddyAllocator_update_stats(&allocator);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == MEMORY_SIZE);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(ConcurrentBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Spilling requests test passed\n");
+    #endif
+    return 0;
+}
+
+// Test realloc across subtrees, aligned and zeroed blocks
+static int test_resize_align_zero() {
+    ConcurrentBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing realloc, memalign and calloc...\n");
+    #endif
+    
+    assert(ConcurrentBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS, NUM_SUBTREES) != NULL);
+    size_t quarter = allocator.subtree_size / 4;
+    
+    // Fill the rest of the home subtree, so the block cannot grow where it is
+    char* ptr = ConcurrentBuddyAllocator_malloc(&allocator, 100);
+    int home = subtree_index(&allocator, ptr);
+    void* filler = ConcurrentBuddyAllocator_malloc(&allocator, 2 * quarter - BUDDY_METADATA_SIZE);
+    assert(subtree_index(&allocator, filler) == home);
+    fill_memory_pattern(ptr, 100, 0x61);
+    char* moved = ConcurrentBuddyAllocator_realloc(&allocator, ptr, 3 * quarter);
+    assert(moved != NULL && subtree_index(&allocator, moved) != home);
+    assert(!verify_memory_pattern(moved, 100, 0x61));
+    assert(ConcurrentBuddyAllocator_usable_size(&allocator, moved) >= 3 * quarter);
+    assert(ConcurrentBuddyAllocator_realloc(&allocator, moved, 0) == NULL);
+    assert(ConcurrentBuddyAllocator_free(&allocator, filler) == 0);
+    
+    void* aligned = ConcurrentBuddyAllocator_memalign(&allocator, 4096, 100);
+    assert(aligned != NULL && (uintptr_t)aligned % 4096 == 0);
+    assert(ConcurrentBuddyAllocator_memalign(&allocator, 48, 100) == NULL);
+    assert(ConcurrentBuddyAllocator_free(&allocator, aligned) == 0);
+    
+    char* dirty = ConcurrentBuddyAllocator_malloc(&allocator, 1000);
+    fill_memory_pattern(dirty, 1000, 0xFF);
+    assert(ConcurrentBuddyAllocator_free(&allocator, dirty) == 0);
+    char* zeroed = ConcurrentBuddyAllocator_calloc(&allocator, 10, 100);
+    assert(zeroed == dirty);
+    for (int i = 0; i < 1000; i++) assert(zeroed[i] == 0);
+    assert(ConcurrentBuddyAllocator_free(&allocator, zeroed) == 0);
+    
+    ConcurrentBuddyAllocator_update_stats(&allocator);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == MEMORY_SIZE);
+    assert(ConcurrentBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Realloc, memalign and calloc test passed\n");
+    #endif
+    return 0;
+}
+
+struct ThreadArgs {
+    ConcurrentBuddyAllocator* allocator;
+    unsigned char pattern;
+};
+
+static void* thread_worker(void* arg) {
+    ConcurrentBuddyAllocator* allocator = ((struct ThreadArgs*)arg)->allocator;
+    unsigned char pattern = ((struct ThreadArgs*)arg)->pattern;
+    void* ptrs[THREAD_BATCH];
+    size_t sizes[THREAD_BATCH];
+    for (int round = 0; round < THREAD_ROUNDS; round++) {
+        for (int i = 0; i < THREAD_BATCH; i++) {
+            sizes[i] = 16 + (size_t)((round * 31 + i * 17) % 2000);
+            ptrs[i] = ConcurrentBuddyAllocator_malloc(allocator, sizes[i]);
+            assert(ptrs[i] != NULL);
+            fill_memory_pattern(ptrs[i], sizes[i], pattern);
+        }
+        // No other thread may have been handed the same memory
+        for (int i = 0; i < THREAD_BATCH; i++) {
+            assert(!verify_memory_pattern(ptrs[i], sizes[i], pattern));
+            assert(ConcurrentBuddyAllocator_free(allocator, ptrs[i]) == 0);
+        }
+    }
+    return NULL;
+}
+
+// Test concurrent use: more threads than subtrees, then everything merged back
+static int test_threads() {
+    ConcurrentBuddyAllocator allocator;
+    pthread_t threads[NUM_THREADS];
+    struct ThreadArgs args[NUM_THREADS];
+    
+    #ifdef VERBOSE
+    printf("Testing concurrent threads...\n");
+    #endif
+    
+    assert(ConcurrentBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS, NUM_SUBTREES) != NULL);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        args[i].allocator = &allocator;
+        args[i].pattern = (unsigned char)(0x10 + i);
+        assert(pthread_create(&threads[i], NULL, thread_worker, &args[i]) == 0);
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    // Nothing was lost: every subtree is whole again
+    ConcurrentBuddyAllocator_update_stats(&allocator);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == MEMORY_SIZE);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    for (int i = 0; i < NUM_SUBTREES; i++) {
+        void* whole = ConcurrentBuddyAllocator_malloc(&allocator, allocator.subtree_size - BUDDY_METADATA_SIZE);
+        assert(whole != NULL);
+    }
+    assert(ConcurrentBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Concurrent threads test passed\n");
+    #endif
+    return 0;
+}
+
+int test_concurrent_buddy_allocator() {
+    int result = 0;
+    
+    printf("=== Running ConcurrentBuddyAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_spill();
+    result |= test_resize_align_zero();
+    result |= test_threads();
+
+    if (result != 0) {
+        printf(RED "Some ConcurrentBuddyAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All ConcurrentBuddyAllocator tests passed!\n" RESET);
+    }
+    printf("=== ConcurrentBuddyAllocator Tests Complete ===\n");
+    
+    return result;
+}
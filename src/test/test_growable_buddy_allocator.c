@@ -0,0 +1,215 @@
+#include <test_growable_buddy_allocator.h>
+#define SUPERBLOCK_SIZE (1 << 20)
+#define NUM_LEVELS 12 // 512B min blocks
+#define MAX_SUPERBLOCKS 4
+#define HALF_BLOCK (SUPERBLOCK_SIZE / 2 - BITMAP_METADATA_SIZE) // Fills half a superblock
+#define QUARTER_BLOCK (SUPERBLOCK_SIZE / 4 - BITMAP_METADATA_SIZE)
+
+static inline int superblock_index(GrowableBuddyAllocator* a, void* ptr) {
+    for (uint i = 0; i < a->num_superblocks; i++) {
+        char* start = a->superblocks[i].buddy.memory_start;
+        if ((char*)ptr >= start && (char*)ptr < start + a->superblock_size) return i;
+    }
+    return -1;
+}
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    GrowableBuddyAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+
+    assert(GrowableBuddyAllocator_create(NULL, SUPERBLOCK_SIZE, NUM_LEVELS, MAX_SUPERBLOCKS) == NULL);
+    assert(GrowableBuddyAllocator_create(&allocator, SUPERBLOCK_SIZE, NUM_LEVELS, 0) == NULL);
+    assert(GrowableBuddyAllocator_create(&allocator, SUPERBLOCK_SIZE, NUM_LEVELS, GROWABLE_BUDDY_MAX_SUPERBLOCKS + 1) == NULL);
+    assert(GrowableBuddyAllocator_create(&allocator, SUPERBLOCK_SIZE, 0, MAX_SUPERBLOCKS) == NULL);
+
+    // Only the first superblock is mapped at creation
+    assert(GrowableBuddyAllocator_create(&allocator, SUPERBLOCK_SIZE, NUM_LEVELS, MAX_SUPERBLOCKS) != NULL);
+    assert(allocator.num_superblocks == 1);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == SUPERBLOCK_SIZE);
+    assert(GrowableBuddyAllocator_malloc(&allocator, SUPERBLOCK_SIZE) == NULL); // Larger than a superblock
+    assert(allocator.num_superblocks == 1);
+    assert(GrowableBuddyAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that superblocks are mapped when full and unmapped when empty, one kept as a spare
+static int test_grow_and_shrink() {
+    GrowableBuddyAllocator allocator;
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+    void* blocks[2 * MAX_SUPERBLOCKS];
+
+    #ifdef VERBOSE
+    printf("Testing growth and shrinking...\n");
+    #endif
+
+    assert(GrowableBuddyAllocator_create(&allocator, SUPERBLOCK_SIZE, NUM_LEVELS, MAX_SUPERBLOCKS) != NULL);
+    for (int i = 0; i < 2 * MAX_SUPERBLOCKS; i++) {
+        blocks[i] = GrowableBuddyAllocator_malloc(&allocator, HALF_BLOCK);
+        assert(blocks[i] != NULL);
+        assert(allocator.num_superblocks == (uint)i / 2 + 1);
+        fill_memory_pattern(blocks[i], HALF_BLOCK, (unsigned char)i);
+    }
+    assert(allocator.grown == MAX_SUPERBLOCKS - 1);
+    assert(base->sparse_free_memory == 0);
+    assert(GrowableBuddyAllocator_malloc(&allocator, 100) == NULL); // All superblocks mapped and full
+
+    // Blocks do not overlap across superblocks
+    for (int i = 0; i < 2 * MAX_SUPERBLOCKS; i++) {
+        assert(!verify_memory_pattern(blocks[i], HALF_BLOCK, (unsigned char)i));
+    }
+
+    // Each superblock left empty goes back, but the last empty one
+    for (int i = 0; i < 2 * MAX_SUPERBLOCKS; i++) {
+        assert(GrowableBuddyAllocator_free(&allocator, blocks[i]) == 0);
+    }
+    assert(GrowableBuddyAllocator_free(&allocator, blocks[0]) == -1); // Already released
+    assert(allocator.num_superblocks == 1);
+    assert(allocator.shrunk == MAX_SUPERBLOCKS - 1);
+    assert(base->sparse_free_memory == SUPERBLOCK_SIZE);
+    assert(base->internal_fragmentation == 0);
+
+    // The spare is enough for a heap that goes back and forth over a superblock boundary
+    void* first = GrowableBuddyAllocator_malloc(&allocator, HALF_BLOCK);
+    void* second = GrowableBuddyAllocator_malloc(&allocator, HALF_BLOCK);
+    for (int i = 0; i < 100; i++) {
+        void* over = GrowableBuddyAllocator_malloc(&allocator, 100);
+        assert(over != NULL && allocator.num_superblocks == 2);
+        assert(GrowableBuddyAllocator_free(&allocator, over) == 0);
+        assert(allocator.num_superblocks == 2);
+    }
+    assert(allocator.grown == MAX_SUPERBLOCKS);
+    assert(GrowableBuddyAllocator_free(&allocator, first) == 0);
+    assert(GrowableBuddyAllocator_free(&allocator, second) == 0);
+    assert(allocator.num_superblocks == 1);
+    assert(GrowableBuddyAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Growth and shrinking test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that requests go to the fullest superblock able to serve them
+static int test_fullest_first() {
+    GrowableBuddyAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing fullest first placement...\n");
+    #endif
+
+    assert(GrowableBuddyAllocator_create(&allocator, SUPERBLOCK_SIZE, NUM_LEVELS, MAX_SUPERBLOCKS) != NULL);
+    void* left = GrowableBuddyAllocator_malloc(&allocator, HALF_BLOCK);
+    void* right = GrowableBuddyAllocator_malloc(&allocator, HALF_BLOCK);
+    void* small = GrowableBuddyAllocator_malloc(&allocator, 100);
+    assert(superblock_index(&allocator, left) == 0 && superblock_index(&allocator, right) == 0);
+    assert(superblock_index(&allocator, small) == 1);
+
+    // Superblock 0 has half of it free, superblock 1 almost all: small blocks go to 0
+    assert(GrowableBuddyAllocator_free(&allocator, left) == 0);
+    void* next = GrowableBuddyAllocator_malloc(&allocator, 100);
+    assert(superblock_index(&allocator, next) == 0);
+
+    assert(GrowableBuddyAllocator_free(&allocator, next) == 0);
+    assert(GrowableBuddyAllocator_free(&allocator, right) == 0);
+    assert(GrowableBuddyAllocator_free(&allocator, small) == 0);
+    assert(allocator.num_superblocks == 1);
+
+    // Enough free bytes but no block large enough: the failure is remembered until a release
+    void* quarters[4];
+    for (int i = 0; i < 4; i++) {
+        quarters[i] = GrowableBuddyAllocator_malloc(&allocator, QUARTER_BLOCK);
+        assert(superblock_index(&allocator, quarters[i]) == 0);
+    }
+    assert(GrowableBuddyAllocator_free(&allocator, quarters[0]) == 0);
+    assert(GrowableBuddyAllocator_free(&allocator, quarters[2]) == 0);
+    void* large = GrowableBuddyAllocator_malloc(&allocator, HALF_BLOCK);
+    assert(superblock_index(&allocator, large) == 1);
+    assert(allocator.superblocks[0].max_free < HALF_BLOCK + BITMAP_METADATA_SIZE);
+    assert(GrowableBuddyAllocator_free(&allocator, quarters[1]) == 0);
+    assert(allocator.superblocks[0].max_free == SUPERBLOCK_SIZE);
+
+    assert(GrowableBuddyAllocator_free(&allocator, quarters[3]) == 0);
+    assert(GrowableBuddyAllocator_free(&allocator, large) == 0);
+    assert(allocator.num_superblocks == 1);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == SUPERBLOCK_SIZE);
+    assert(GrowableBuddyAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Fullest first placement test passed\n");
+    #endif
+    return 0;
+}
+
+// Test realloc across superblocks, aligned and zeroed blocks
+static int test_resize_align_zero() {
+    GrowableBuddyAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing realloc, memalign and calloc...\n");
+    #endif
+
+    assert(GrowableBuddyAllocator_create(&allocator, SUPERBLOCK_SIZE, NUM_LEVELS, MAX_SUPERBLOCKS) != NULL);
+
+    // Larger than what is left of its superblock: the block moves to a new one
+    char* ptr = GrowableBuddyAllocator_malloc(&allocator, 100);
+    void* filler = GrowableBuddyAllocator_malloc(&allocator, HALF_BLOCK);
+    fill_memory_pattern(ptr, 100, 0x61);
+    char* moved = GrowableBuddyAllocator_realloc(&allocator, ptr, SUPERBLOCK_SIZE * 3 / 4);
+    assert(moved != NULL && superblock_index(&allocator, moved) == 1);
+    assert(!verify_memory_pattern(moved, 100, 0x61));
+    assert(GrowableBuddyAllocator_usable_size(&allocator, moved) >= SUPERBLOCK_SIZE * 3 / 4);
+    assert(GrowableBuddyAllocator_usable_size(&allocator, &allocator) == 0);
+    assert(GrowableBuddyAllocator_realloc(&allocator, moved, 0) == NULL);
+    assert(GrowableBuddyAllocator_free(&allocator, filler) == 0);
+    assert(allocator.num_superblocks == 1);
+
+    void* aligned = GrowableBuddyAllocator_memalign(&allocator, 4096, 100);
+    assert(aligned != NULL && (uintptr_t)aligned % 4096 == 0);
+    assert(GrowableBuddyAllocator_memalign(&allocator, 48, 100) == NULL);
+    assert(GrowableBuddyAllocator_free(&allocator, aligned) == 0);
+
+    char* dirty = GrowableBuddyAllocator_malloc(&allocator, 1000);
+    fill_memory_pattern(dirty, 1000, 0xFF);
+    assert(GrowableBuddyAllocator_free(&allocator, dirty) == 0);
+    char* zeroed = GrowableBuddyAllocator_calloc(&allocator, 10, 100);
+    assert(zeroed == dirty);
+    for (int i = 0; i < 1000; i++) assert(zeroed[i] == 0);
+    assert(GrowableBuddyAllocator_free(&allocator, zeroed) == 0);
+    assert(GrowableBuddyAllocator_free(&allocator, zeroed) == -1);
+
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == SUPERBLOCK_SIZE);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(GrowableBuddyAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Realloc, memalign and calloc test passed\n");
+    #endif
+    return 0;
+}
+
+int test_growable_buddy_allocator() {
+    int result = 0;
+
+    printf("=== Running GrowableBuddyAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_grow_and_shrink();
+    result |= test_fullest_first();
+    result |= test_resize_align_zero();
+
+    if (result != 0) {
+        printf(RED "Some GrowableBuddyAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All GrowableBuddyAllocator tests passed!\n" RESET);
+    }
+    printf("=== GrowableBuddyAllocator Tests Complete ===\n");
+
+    return result;
+}
@@ -0,0 +1,164 @@
+#include <test_implicit_buddy_allocator.h>
+#define MEMORY_SIZE (1 << 10) // 1KB
+#define NUM_LEVELS 4 // 64B min blocks, like BuddyAllocator (1024/2^4)
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    ImplicitBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+    
+    assert(ImplicitBuddyAllocator_create(&allocator, 0, NUM_LEVELS) == NULL);
+    assert(ImplicitBuddyAllocator_create(&allocator, MEMORY_SIZE, 0) == NULL);
+    assert(ImplicitBuddyAllocator_create(NULL, MEMORY_SIZE, NUM_LEVELS) == NULL);
+    
+    // A memory size that is not a power of two is rounded down
+    assert(ImplicitBuddyAllocator_create(&allocator, 3000, 2) != NULL);
+    assert(allocator.memory_size == 2048 && allocator.min_block_size == 512);
+    assert(ImplicitBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that every minimum block can be handed out, with no header in front of it
+static int test_fill() {
+    ImplicitBuddyAllocator allocator;
+    void* ptrs[MEMORY_SIZE / 64];
+    
+    #ifdef VERBOSE
+    printf("Testing filling the arena...\n");
+    #endif
+    
+    assert(ImplicitBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    uint32_t n = allocator.num_blocks;
+    for (uint32_t i = 0; i < n; i++) {
+        ptrs[i] = ImplicitBuddyAllocator_malloc(&allocator, allocator.min_block_size);
+        assert(ptrs[i] != NULL);
+        assert((size_t)((char*)ptrs[i] - allocator.memory_start) % allocator.min_block_size == 0);
+        fill_memory_pattern(ptrs[i], allocator.min_block_size, (unsigned char)i);
+    }
+    assert(ImplicitBuddyAllocator_malloc(&allocator, 1) == NULL);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == 0);
+    for (uint32_t i = 0; i < n; i++) {
+        assert(!verify_memory_pattern(ptrs[i], allocator.min_block_size, (unsigned char)i));
+        assert(ImplicitBuddyAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    assert(allocator.free_order_mask == 1u << (allocator.num_levels - 1));
+    assert(ImplicitBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Fill test passed\n");
+    #endif
+    return 0;
+}
+
+// Test buddy merging and fragmentation counters
+static int test_buddy_merging() {
+    ImplicitBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing buddy merging...\n");
+    #endif
+    
+    assert(ImplicitBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t small_size = allocator.min_block_size;
+    
+    void* ptr1 = ImplicitBuddyAllocator_malloc(&allocator, small_size);
+    void* ptr2 = ImplicitBuddyAllocator_malloc(&allocator, small_size - 10);
+    assert(ptr1 != NULL && ptr2 != NULL);
+    assert((char*)ptr2 == (char*)ptr1 + small_size); // Buddies
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 10);
+    
+    // Release both blocks, they merge back up to the root
+    assert(ImplicitBuddyAllocator_free(&allocator, ptr2) == 0);
+    assert(ImplicitBuddyAllocator_free(&allocator, ptr1) == 0);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == allocator.memory_size);
+    
+    void* whole = ImplicitBuddyAllocator_malloc(&allocator, allocator.memory_size);
+    assert(whole == allocator.memory_start);
+    assert(ImplicitBuddyAllocator_free(&allocator, whole) == 0);
+    
+    #ifdef VERBOSE
+    ImplicitBuddyAllocator_print_state(&allocator);
+    printf("Buddy merging test passed\n");
+    #endif
+    
+    assert(ImplicitBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test invalid releases
+static int test_invalid_releases() {
+    ImplicitBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid releases...\n");
+    #endif
+    
+    assert(ImplicitBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    assert(ImplicitBuddyAllocator_free(&allocator, NULL) == -1);
+    
+    void* ptr = ImplicitBuddyAllocator_malloc(&allocator, allocator.min_block_size * 2);
+    assert(ptr != NULL);
+    assert(ImplicitBuddyAllocator_free(&allocator, (char*)ptr + 1) == -1); // Not a block start
+    assert(ImplicitBuddyAllocator_free(&allocator, (char*)ptr + allocator.min_block_size) == -1); // Inside the block
+    assert(ImplicitBuddyAllocator_free(&allocator, ptr) == 0);
+    assert(ImplicitBuddyAllocator_free(&allocator, ptr) == -1); // Double free
+    
+    char invalid_ptr[64];
+    assert(ImplicitBuddyAllocator_free(&allocator, invalid_ptr) == -1);
+    assert(ImplicitBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Invalid releases test passed\n");
+    #endif
+    return 0;
+}
+
+// Test the metadata footprint against BuddyAllocator on a deep tree
+static int test_metadata_size() {
+    ImplicitBuddyAllocator allocator;
+    BuddyAllocator buddy;
+    
+    #ifdef VERBOSE
+    printf("Testing metadata size...\n");
+    #endif
+    
+    assert(ImplicitBuddyAllocator_create(&allocator, 1 << 20, 16) != NULL);
+    assert(BuddyAllocator_create(&buddy, 1 << 20, 16) != NULL);
+    size_t buddy_metadata = buddy.node_allocator.memory_size + buddy.list_allocator.memory_size;
+    assert(allocator.metadata_size * 10 < buddy_metadata);
+    
+    #ifdef VERBOSE
+    printf("Metadata: %zu bytes (BuddyAllocator: %zu bytes)\n", allocator.metadata_size, buddy_metadata);
+    #endif
+    assert(BuddyAllocator_destroy(&buddy) == 0);
+    assert(ImplicitBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+int test_implicit_buddy_allocator() {
+    int result = 0;
+    
+    printf("=== Running ImplicitBuddyAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_fill();
+    result |= test_buddy_merging();
+    result |= test_invalid_releases();
+    result |= test_metadata_size();
+
+    if (result != 0) {
+        printf(RED "Some ImplicitBuddyAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All ImplicitBuddyAllocator tests passed!\n" RESET);
+    }
+    printf("=== ImplicitBuddyAllocator Tests Complete ===\n");
+    
+    return result;
+}
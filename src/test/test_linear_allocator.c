@@ -0,0 +1,241 @@
+#include <test_linear_allocator.h>
+#define CHUNK_SIZE (64 * 1024)
+#define NUM_THREADS 4
+
+static inline size_t num_chunks(LinearAllocator* a) {
+    size_t n = 0;
+    for (LinearChunk* c = a->current; c; c = c->prev) n++;
+    return n;
+}
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    LinearAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+
+    assert(LinearAllocator_create(NULL, CHUNK_SIZE) == NULL);
+    assert(LinearAllocator_create(&allocator, 0) == NULL);
+
+    // The chunk size is rounded up to the page size
+    assert(LinearAllocator_create(&allocator, 100) != NULL);
+    assert(allocator.chunk_size == (size_t)PAGESIZE && allocator.mapped == (size_t)PAGESIZE);
+    assert(LinearAllocator_malloc(&allocator, 0) == NULL);
+    assert(LinearAllocator_free(&allocator, NULL) == -1);
+    assert(LinearAllocator_free(&allocator, &allocator) == -1);
+    assert(LinearAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that blocks are bumped one after the other, aligned, and chunks are added when full
+static int test_bump() {
+    LinearAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing bump allocation...\n");
+    #endif
+
+    assert(LinearAllocator_create(&allocator, CHUNK_SIZE) != NULL);
+    char* first = LinearAllocator_malloc(&allocator, 10);
+    char* second = LinearAllocator_malloc(&allocator, 100);
+    assert((uintptr_t)first % LINEAR_ALIGNMENT == 0 && (uintptr_t)second % LINEAR_ALIGNMENT == 0);
+    assert(second == first + LINEAR_ALIGNMENT); // No metadata between blocks
+    fill_memory_pattern(first, 10, 0x11);
+    fill_memory_pattern(second, 100, 0x22);
+
+    // Only the last block goes back at once
+    assert(LinearAllocator_free(&allocator, first) == 0);
+    assert(LinearAllocator_free(&allocator, second) == 0);
+    assert(LinearAllocator_malloc(&allocator, 100) == second);
+    assert(!verify_memory_pattern(first, 10, 0x11));
+
+    // A full chunk is followed by a new one, a block larger than a chunk gets its own
+    for (int i = 0; i < CHUNK_SIZE / 1024; i++) assert(LinearAllocator_malloc(&allocator, 1024) != NULL);
+    assert(num_chunks(&allocator) == 2);
+    char* large = LinearAllocator_malloc(&allocator, 4 * CHUNK_SIZE);
+    assert(large != NULL && num_chunks(&allocator) == 3);
+    fill_memory_pattern(large, 4 * CHUNK_SIZE, 0x33);
+    assert(allocator.mapped >= 6 * CHUNK_SIZE);
+
+    void* aligned = LinearAllocator_memalign(&allocator, 4096, 100);
+    assert(aligned != NULL && (uintptr_t)aligned % 4096 == 0);
+    assert(LinearAllocator_memalign(&allocator, 48, 100) == NULL);
+    assert(!verify_memory_pattern(large, 4 * CHUNK_SIZE, 0x33));
+    assert(LinearAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Bump allocation test passed\n");
+    #endif
+    return 0;
+}
+
+// Test rewinding to marks, across chunks
+static int test_mark_reset() {
+    LinearAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing marks and resets...\n");
+    #endif
+
+    assert(LinearAllocator_create(&allocator, CHUNK_SIZE) != NULL);
+    char* kept = LinearAllocator_malloc(&allocator, 1000);
+    fill_memory_pattern(kept, 1000, 0x44);
+    LinearMark mark = LinearAllocator_mark(&allocator);
+    char* after = LinearAllocator_malloc(&allocator, 1000);
+
+    // Within the chunk: the next block is where the first block after the mark was
+    assert(LinearAllocator_reset_to(&allocator, mark) == 0);
+    assert(LinearAllocator_malloc(&allocator, 1000) == after);
+
+    // Across chunks: the newer chunks go, one stays as the spare
+    for (int i = 0; i < 3 * CHUNK_SIZE / 1024; i++) assert(LinearAllocator_malloc(&allocator, 1024) != NULL);
+    assert(num_chunks(&allocator) == 4);
+    LinearMark inner = LinearAllocator_mark(&allocator);
+    assert(LinearAllocator_reset_to(&allocator, mark) == 0);
+    assert(num_chunks(&allocator) == 1);
+    assert(allocator.spare != NULL && allocator.mapped == 2 * CHUNK_SIZE);
+    assert(LinearAllocator_malloc(&allocator, 1000) == after);
+    assert(!verify_memory_pattern(kept, 1000, 0x44));
+
+    // Marks already released, or of another allocator, are refused
+    assert(LinearAllocator_reset_to(&allocator, inner) == -1);
+    LinearAllocator other;
+    assert(LinearAllocator_create(&other, CHUNK_SIZE) != NULL);
+    assert(LinearAllocator_reset_to(&other, mark) == -1);
+    assert(LinearAllocator_destroy(&other) == 0);
+
+    // The spare is reused by the next chunk
+    for (int i = 0; i < CHUNK_SIZE / 1024; i++) assert(LinearAllocator_malloc(&allocator, 1024) != NULL);
+    assert(num_chunks(&allocator) == 2 && allocator.spare == NULL && allocator.mapped == 2 * CHUNK_SIZE);
+    assert(LinearAllocator_reset(&allocator) == 0);
+    assert(LinearAllocator_malloc(&allocator, 1000) == kept);
+    assert(LinearAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Marks and resets test passed\n");
+    #endif
+    return 0;
+}
+
+// Test realloc in place and out of place, and calloc on reused memory
+static int test_resize_zero() {
+    LinearAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing realloc and calloc...\n");
+    #endif
+
+    assert(LinearAllocator_create(&allocator, CHUNK_SIZE) != NULL);
+    char* ptr = LinearAllocator_realloc(&allocator, NULL, 100);
+    fill_memory_pattern(ptr, 100, 0x55);
+    assert(LinearAllocator_realloc(&allocator, ptr, 1000) == ptr); // The last block grows in place
+    assert(LinearAllocator_realloc(&allocator, ptr, 50) == ptr);
+    char* next = LinearAllocator_malloc(&allocator, 10);
+    assert(next == ptr + 64);
+
+    // Not the last one: the block moves, with its contents
+    char* moved = LinearAllocator_realloc(&allocator, ptr, 200);
+    assert(moved != NULL && moved != ptr);
+    assert(!verify_memory_pattern(moved, 50, 0x55));
+    // Too large for the chunk: the last block moves to a new chunk
+    char* grown = LinearAllocator_realloc(&allocator, moved, 2 * CHUNK_SIZE);
+    assert(grown != NULL && num_chunks(&allocator) == 2);
+    assert(!verify_memory_pattern(grown, 50, 0x55));
+    assert(LinearAllocator_realloc(&allocator, grown, 0) == NULL);
+
+    // Memory handed out before a reset is dirty, the rest comes zeroed from mmap
+    assert(LinearAllocator_reset(&allocator) == 0);
+    char* dirty = LinearAllocator_calloc(&allocator, 10, 100);
+    for (int i = 0; i < 1000; i++) assert(dirty[i] == 0);
+    fill_memory_pattern(dirty, 1000, 0xFF);
+    assert(LinearAllocator_free(&allocator, dirty) == 0);
+    char* zeroed = LinearAllocator_calloc(&allocator, 20, 100);
+    assert(zeroed == dirty);
+    for (int i = 0; i < 2000; i++) assert(zeroed[i] == 0);
+    assert(LinearAllocator_calloc(&allocator, SIZE_MAX, 2) == NULL);
+    assert(LinearAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Realloc and calloc test passed\n");
+    #endif
+    return 0;
+}
+
+// A scope that allocates from the scratch arena and leaves it as it found it
+static char* scratch_scope(size_t size, char** inside) {
+    LINEAR_SCRATCH_SCOPE(scope);
+    *inside = LinearAllocator_malloc(scope.allocator, size);
+    fill_memory_pattern(*inside, size, 0x66);
+    return scope.top;
+}
+
+static void* scratch_thread(void* arg) {
+    LinearAllocator** scratch = (LinearAllocator**)arg;
+    *scratch = LinearAllocator_scratch();
+    char* inside;
+    char* top = scratch_scope(500, &inside);
+    assert((*scratch)->top == top);
+    return NULL;
+}
+
+// Test that the scratch arena is per thread and rewound at the end of a scope
+static int test_scratch() {
+    #ifdef VERBOSE
+    printf("Testing scratch arenas...\n");
+    #endif
+
+    LinearAllocator* scratch = LinearAllocator_scratch();
+    assert(scratch != NULL && LinearAllocator_scratch() == scratch);
+    char* inside;
+    char* top = scratch_scope(1000, &inside);
+    assert(scratch->top == top && inside == (char*)(((uintptr_t)top + LINEAR_ALIGNMENT - 1) & ~(uintptr_t)(LINEAR_ALIGNMENT - 1)));
+
+    // Nested scopes unwind one at a time
+    {
+        LINEAR_SCRATCH_SCOPE(outer);
+        char* outer_block = LinearAllocator_malloc(outer.allocator, 100);
+        char* inner_block;
+        scratch_scope(2 * LINEAR_SCRATCH_CHUNK_SIZE, &inner_block);
+        assert(LinearAllocator_malloc(outer.allocator, 100) == outer_block + 112);
+    }
+    assert(scratch->top == top);
+
+    pthread_t threads[NUM_THREADS];
+    LinearAllocator* scratches[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++) pthread_create(&threads[i], NULL, scratch_thread, &scratches[i]);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        assert(scratches[i] != scratch);
+    }
+
+    #ifdef VERBOSE
+    printf("Scratch arenas test passed\n");
+    #endif
+    return 0;
+}
+
+int test_linear_allocator() {
+    int result = 0;
+
+    printf("=== Running LinearAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_bump();
+    result |= test_mark_reset();
+    result |= test_resize_zero();
+    result |= test_scratch();
+
+    if (result != 0) {
+        printf(RED "Some LinearAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All LinearAllocator tests passed!\n" RESET);
+    }
+    printf("=== LinearAllocator Tests Complete ===\n");
+
+    return result;
+}
@@ -0,0 +1,178 @@
+#include <test_magazine_allocator.h>
+#define OBJECT_SIZE 32
+#define NUM_OBJECTS 1024
+#define NUM_THREADS 4
+#define THREAD_ROUNDS 200
+#define THREAD_BATCH 50
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    MagazineAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+    
+    assert(MagazineAllocator_create(&allocator, 0, NUM_OBJECTS) == NULL);
+    assert(MagazineAllocator_create(&allocator, OBJECT_SIZE, 0) == NULL);
+    assert(MagazineAllocator_create(NULL, OBJECT_SIZE, NUM_OBJECTS) == NULL);
+    
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that every object can be handed out and comes back through the magazines
+static int test_exhaustion() {
+    MagazineAllocator allocator;
+    void** ptrs = malloc(NUM_OBJECTS * sizeof(void*));
+    
+    #ifdef VERBOSE
+    printf("Testing allocation exhaustion...\n");
+    #endif
+    
+    assert(MagazineAllocator_create(&allocator, OBJECT_SIZE, NUM_OBJECTS) != NULL);
+    for (int round = 0; round < 2; round++) {
+        for (size_t i = 0; i < NUM_OBJECTS; i++) {
+            ptrs[i] = MagazineAllocator_malloc(&allocator);
+            assert(ptrs[i] != NULL);
+            fill_memory_pattern(ptrs[i], OBJECT_SIZE, (unsigned char)i);
+        }
+        assert(MagazineAllocator_malloc(&allocator) == NULL);
+        for (size_t i = 0; i < NUM_OBJECTS; i++) {
+            assert(!verify_memory_pattern(ptrs[i], OBJECT_SIZE, (unsigned char)i));
+        }
+        // Frees fill magazines, full ones are handed to the depot
+        for (size_t i = 0; i < NUM_OBJECTS; i++) {
+            assert(MagazineAllocator_free(&allocator, ptrs[i]) == 0);
+        }
+        assert(allocator.num_full > 0);
+    }
+    
+    char invalid_ptr[OBJECT_SIZE];
+    assert(MagazineAllocator_free(&allocator, invalid_ptr) == -1);
+    
+    // Pointers inside an object are rejected at once
+    void* held = MagazineAllocator_malloc(&allocator);
+    assert(MagazineAllocator_free(&allocator, (char*)held + 3) == -1);
+    
+    // Double frees are dropped when the magazine holding them reaches the depot: full ones
+    // here, the partial ones at the flush. Every object then comes back exactly once
+    for (size_t i = 0; i < 3 * MAGAZINE_SIZE; i++) {
+        ptrs[i] = MagazineAllocator_malloc(&allocator);
+        assert(ptrs[i] != NULL);
+    }
+    assert(MagazineAllocator_free(&allocator, held) == 0);
+    assert(MagazineAllocator_free(&allocator, held) == 0);
+    for (size_t i = 0; i < 3 * MAGAZINE_SIZE; i++) {
+        assert(MagazineAllocator_free(&allocator, ptrs[i]) == 0);
+        if (i == MAGAZINE_SIZE) assert(MagazineAllocator_free(&allocator, ptrs[0]) == 0);
+    }
+    MagazineAllocator_thread_flush(&allocator);
+    for (size_t i = 0; i < NUM_OBJECTS; i++) {
+        ptrs[i] = MagazineAllocator_malloc(&allocator);
+        assert(ptrs[i] != NULL);
+        fill_memory_pattern(ptrs[i], OBJECT_SIZE, (unsigned char)i);
+    }
+    assert(MagazineAllocator_malloc(&allocator) == NULL);
+    for (size_t i = 0; i < NUM_OBJECTS; i++) {
+        assert(!verify_memory_pattern(ptrs[i], OBJECT_SIZE, (unsigned char)i));
+        assert(MagazineAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    
+    #ifdef VERBOSE
+    MagazineAllocator_print_state(&allocator);
+    #endif
+    
+    MagazineAllocator_thread_flush(&allocator);
+    free(ptrs);
+    assert(MagazineAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Allocation exhaustion test passed\n");
+    #endif
+    return 0;
+}
+
+struct ThreadArgs {
+    MagazineAllocator* allocator;
+    unsigned char pattern;
+};
+
+static void* thread_worker(void* arg) {
+    MagazineAllocator* allocator = ((struct ThreadArgs*)arg)->allocator;
+    unsigned char pattern = ((struct ThreadArgs*)arg)->pattern;
+    void* ptrs[THREAD_BATCH];
+    for (int round = 0; round < THREAD_ROUNDS; round++) {
+        for (int i = 0; i < THREAD_BATCH; i++) {
+            ptrs[i] = MagazineAllocator_malloc(allocator);
+            assert(ptrs[i] != NULL);
+            fill_memory_pattern(ptrs[i], OBJECT_SIZE, pattern);
+        }
+        // No other thread may have been handed the same objects
+        for (int i = 0; i < THREAD_BATCH; i++) {
+            assert(!verify_memory_pattern(ptrs[i], OBJECT_SIZE, pattern));
+            assert(MagazineAllocator_free(allocator, ptrs[i]) == 0);
+        }
+    }
+    return NULL;
+}
+
+// Test concurrent use, thread exit returns the magazines to the depot
+static int test_threads() {
+    MagazineAllocator allocator;
+    pthread_t threads[NUM_THREADS];
+    struct ThreadArgs args[NUM_THREADS];
+    
+    #ifdef VERBOSE
+    printf("Testing concurrent threads...\n");
+    #endif
+    
+    assert(MagazineAllocator_create(&allocator, OBJECT_SIZE, NUM_OBJECTS) != NULL);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        args[i].allocator = &allocator;
+        args[i].pattern = (unsigned char)(0x10 + i);
+        assert(pthread_create(&threads[i], NULL, thread_worker, &args[i]) == 0);
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    // Nothing was lost: every object can still be allocated
+    void** ptrs = malloc(NUM_OBJECTS * sizeof(void*));
+    for (size_t i = 0; i < NUM_OBJECTS; i++) {
+        ptrs[i] = MagazineAllocator_malloc(&allocator);
+        assert(ptrs[i] != NULL);
+    }
+    for (size_t i = 0; i < NUM_OBJECTS; i++) {
+        assert(MagazineAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    free(ptrs);
+    
+    MagazineAllocator_thread_flush(&allocator);
+    assert(MagazineAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Concurrent threads test passed\n");
+    #endif
+    return 0;
+}
+
+int test_magazine_allocator() {
+    int result = 0;
+    
+    printf("=== Running MagazineAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_exhaustion();
+    result |= test_threads();
+
+    if (result != 0) {
+        printf(RED "Some MagazineAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All MagazineAllocator tests passed!\n" RESET);
+    }
+    printf("=== MagazineAllocator Tests Complete ===\n");
+    
+    return result;
+}
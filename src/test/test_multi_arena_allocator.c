@@ -0,0 +1,252 @@
+#include <test_multi_arena_allocator.h>
+#define ARENA_SIZE (1 << 20)
+#define NUM_LEVELS 12 // 256B min blocks
+#define NUM_ARENAS 4
+#define NUM_PAIRS 3
+#define PIPELINE_ITEMS 20000
+#define RING_SIZE 64 // A power of two
+
+static inline int arena_index(MultiArenaAllocator* a, void* ptr) {
+    for (uint i = 0; i < a->num_arenas; i++) {
+        char* start = a->arenas[i].buddy.memory_start;
+        if ((char*)ptr >= start && (char*)ptr < start + a->arena_size) return i;
+    }
+    return -1;
+}
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    MultiArenaAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+
+    assert(MultiArenaAllocator_create(NULL, ARENA_SIZE, NUM_LEVELS, NUM_ARENAS) == NULL);
+    assert(MultiArenaAllocator_create(&allocator, ARENA_SIZE, NUM_LEVELS, 0) == NULL);
+    assert(MultiArenaAllocator_create(&allocator, ARENA_SIZE, NUM_LEVELS, MULTI_ARENA_MAX_ARENAS + 1) == NULL);
+
+    // Too many levels: the minimum block must still hold the remote stack link
+    assert(MultiArenaAllocator_create(&allocator, 4096, 10, 3) != NULL);
+    assert(allocator.arenas[0].buddy.min_block_size >= BITMAP_METADATA_SIZE + sizeof(void*));
+    assert(MultiArenaAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+struct Releaser {
+    MultiArenaAllocator* allocator;
+    void* ptr; // Released only from another arena than the one holding it
+    int home; // Arena of the thread, found through a probe block
+    int result;
+};
+
+static void* releaser_thread(void* arg) {
+    struct Releaser* r = (struct Releaser*)arg;
+    void* probe = MultiArenaAllocator_malloc(r->allocator, 100);
+    r->home = arena_index(r->allocator, probe);
+    if (r->home != arena_index(r->allocator, r->ptr)) r->result = MultiArenaAllocator_free(r->allocator, r->ptr);
+    MultiArenaAllocator_free(r->allocator, probe);
+    return NULL;
+}
+
+// Test that a release from another arena waits on the stack until the arena allocates again
+static int test_remote_free() {
+    MultiArenaAllocator allocator;
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+
+    #ifdef VERBOSE
+    printf("Testing releases from other arenas...\n");
+    #endif
+
+    assert(MultiArenaAllocator_create(&allocator, ARENA_SIZE, NUM_LEVELS, 2) != NULL);
+    char* ptr = MultiArenaAllocator_malloc(&allocator, 1000);
+    assert(ptr != NULL);
+    int home = arena_index(&allocator, ptr);
+
+    // A release in the own arena is immediate
+    void* local = MultiArenaAllocator_malloc(&allocator, 100);
+    assert(arena_index(&allocator, local) == home);
+    assert(MultiArenaAllocator_free(&allocator, local) == 0);
+    assert(MultiArenaAllocator_free(&allocator, &allocator) == -1);
+    MultiArenaAllocator_update_stats(&allocator);
+    assert(allocator.remote_frees == 0);
+    size_t free_before = base->sparse_free_memory;
+
+    // Consecutive threads alternate between the two arenas: the second one at the latest is remote
+    struct Releaser releaser = {&allocator, ptr, home, -1};
+    for (int tries = 0; tries < 2 && releaser.home == home; tries++) {
+        pthread_t thread;
+        assert(pthread_create(&thread, NULL, releaser_thread, &releaser) == 0);
+        pthread_join(thread, NULL);
+    }
+    assert(releaser.home != home && releaser.result == 0);
+
+    MultiArenaAllocator_update_stats(&allocator);
+    assert(allocator.remote_frees == 1 && allocator.remote_pending == 1);
+    assert(base->sparse_free_memory == free_before);
+
+    // The next allocation in the arena releases it first, and can then reuse it
+    char* again = MultiArenaAllocator_malloc(&allocator, 1000);
+    assert(again == ptr);
+    MultiArenaAllocator_update_stats(&allocator);
+    assert(allocator.remote_pending == 0);
+    assert(MultiArenaAllocator_free(&allocator, again) == 0);
+
+    MultiArenaAllocator_update_stats(&allocator);
+    assert(base->sparse_free_memory == 2 * ARENA_SIZE);
+    assert(base->internal_fragmentation == 0);
+    assert(MultiArenaAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Releases from other arenas test passed\n");
+    #endif
+    return 0;
+}
+
+// Test realloc across arenas, aligned and zeroed blocks
+static int test_resize_align_zero() {
+    MultiArenaAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing realloc, memalign and calloc...\n");
+    #endif
+
+    assert(MultiArenaAllocator_create(&allocator, ARENA_SIZE, NUM_LEVELS, NUM_ARENAS) != NULL);
+
+    // Larger than what is left of the home arena: the block moves
+    char* ptr = MultiArenaAllocator_malloc(&allocator, 100);
+    int home = arena_index(&allocator, ptr);
+    void* filler = MultiArenaAllocator_malloc(&allocator, ARENA_SIZE / 2 - BITMAP_METADATA_SIZE);
+    assert(arena_index(&allocator, filler) == home);
+    fill_memory_pattern(ptr, 100, 0x61);
+    char* moved = MultiArenaAllocator_realloc(&allocator, ptr, ARENA_SIZE * 3 / 4);
+    assert(moved != NULL && arena_index(&allocator, moved) != home);
+    assert(!verify_memory_pattern(moved, 100, 0x61));
+    assert(MultiArenaAllocator_usable_size(&allocator, moved) >= ARENA_SIZE * 3 / 4);
+    assert(MultiArenaAllocator_realloc(&allocator, moved, 0) == NULL);
+    assert(MultiArenaAllocator_free(&allocator, filler) == 0);
+
+    void* aligned = MultiArenaAllocator_memalign(&allocator, 4096, 100);
+    assert(aligned != NULL && (uintptr_t)aligned % 4096 == 0);
+    assert(MultiArenaAllocator_memalign(&allocator, 48, 100) == NULL);
+    assert(MultiArenaAllocator_free(&allocator, aligned) == 0);
+
+    char* dirty = MultiArenaAllocator_malloc(&allocator, 1000);
+    fill_memory_pattern(dirty, 1000, 0xFF);
+    assert(MultiArenaAllocator_free(&allocator, dirty) == 0);
+    char* zeroed = MultiArenaAllocator_calloc(&allocator, 10, 100);
+    assert(zeroed == dirty);
+    for (int i = 0; i < 1000; i++) assert(zeroed[i] == 0);
+    assert(MultiArenaAllocator_free(&allocator, zeroed) == 0);
+
+    // moved was released remotely: collect it before counting
+    MultiArenaAllocator_collect(&allocator);
+    MultiArenaAllocator_update_stats(&allocator);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == NUM_ARENAS * ARENA_SIZE);
+    assert(MultiArenaAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Realloc, memalign and calloc test passed\n");
+    #endif
+    return 0;
+}
+
+// Single producer, single consumer ring of blocks
+struct Pipe {
+    MultiArenaAllocator* allocator;
+    void* slots[RING_SIZE];
+    size_t head; // Next slot to write, only the producer stores it
+    size_t tail; // Next slot to read, only the consumer stores it
+    unsigned char pattern;
+};
+
+static inline size_t item_size(int i) {
+    return 16 + (size_t)((i * 37) % 1500);
+}
+
+static void* producer_thread(void* arg) {
+    struct Pipe* pipe = (struct Pipe*)arg;
+    for (int i = 0; i < PIPELINE_ITEMS; i++) {
+        void* ptr = MultiArenaAllocator_malloc(pipe->allocator, item_size(i));
+        assert(ptr != NULL);
+        fill_memory_pattern(ptr, item_size(i), pipe->pattern);
+        while (pipe->head - __atomic_load_n(&pipe->tail, __ATOMIC_ACQUIRE) == RING_SIZE) sched_yield();
+        pipe->slots[pipe->head % RING_SIZE] = ptr;
+        __atomic_store_n(&pipe->head, pipe->head + 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void* consumer_thread(void* arg) {
+    struct Pipe* pipe = (struct Pipe*)arg;
+    for (int i = 0; i < PIPELINE_ITEMS; i++) {
+        while (__atomic_load_n(&pipe->head, __ATOMIC_ACQUIRE) == pipe->tail) sched_yield();
+        void* ptr = pipe->slots[pipe->tail % RING_SIZE];
+        __atomic_store_n(&pipe->tail, pipe->tail + 1, __ATOMIC_RELEASE);
+        // No other thread may have been handed the same memory
+        assert(!verify_memory_pattern(ptr, item_size(i), pipe->pattern));
+        assert(MultiArenaAllocator_free(pipe->allocator, ptr) == 0);
+    }
+    return NULL;
+}
+
+// Test producer/consumer pairs: every block is allocated in one thread and released in another
+static int test_pipeline() {
+    MultiArenaAllocator allocator;
+    pthread_t producers[NUM_PAIRS], consumers[NUM_PAIRS];
+    struct Pipe pipes[NUM_PAIRS];
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+
+    #ifdef VERBOSE
+    printf("Testing producer/consumer pipelines...\n");
+    #endif
+
+    assert(MultiArenaAllocator_create(&allocator, ARENA_SIZE, NUM_LEVELS, NUM_ARENAS) != NULL);
+    for (int i = 0; i < NUM_PAIRS; i++) {
+        pipes[i] = (struct Pipe){.allocator = &allocator, .head = 0, .tail = 0, .pattern = (unsigned char)(0x20 + i)};
+        assert(pthread_create(&producers[i], NULL, producer_thread, &pipes[i]) == 0);
+        assert(pthread_create(&consumers[i], NULL, consumer_thread, &pipes[i]) == 0);
+    }
+    for (int i = 0; i < NUM_PAIRS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    // Nothing was lost: once the stacks are collected every arena is whole again
+    MultiArenaAllocator_update_stats(&allocator);
+    assert(allocator.remote_frees > 0);
+    MultiArenaAllocator_collect(&allocator);
+    MultiArenaAllocator_update_stats(&allocator);
+    assert(allocator.remote_pending == 0);
+    assert(base->sparse_free_memory == NUM_ARENAS * ARENA_SIZE);
+    assert(base->internal_fragmentation == 0);
+    assert(MultiArenaAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Producer/consumer pipelines test passed\n");
+    #endif
+    return 0;
+}
+
+int test_multi_arena_allocator() {
+    int result = 0;
+
+    printf("=== Running MultiArenaAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_remote_free();
+    result |= test_resize_align_zero();
+    result |= test_pipeline();
+
+    if (result != 0) {
+        printf(RED "Some MultiArenaAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All MultiArenaAllocator tests passed!\n" RESET);
+    }
+    printf("=== MultiArenaAllocator Tests Complete ===\n");
+
+    return result;
+}
@@ -0,0 +1,264 @@
+#include <test_pseudo_allocator.h>
+#define MEMORY_SIZE (1 << 16)
+#define NUM_LEVELS 10 // 64B min blocks
+
+static inline bool in_small(PseudoAllocator* a, void* ptr) {
+    return (char*)ptr >= a->small.memory_start && (char*)ptr < a->small.memory_start + a->small.memory_size;
+}
+
+// Test that requests are routed by size
+static int test_routing() {
+    PseudoAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing small and large requests...\n");
+    #endif
+    
+    assert(PseudoAllocator_create(NULL, MEMORY_SIZE, NUM_LEVELS) == NULL);
+    assert(PseudoAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t limit = allocator.small_limit;
+    
+    void* small = PseudoAllocator_malloc(&allocator, limit - 1);
+    assert(small != NULL && in_small(&allocator, small));
+    void* large = PseudoAllocator_malloc(&allocator, limit);
+    assert(large != NULL && !in_small(&allocator, large));
+    assert((uintptr_t)large % 16 == 0);
+    void* huge = PseudoAllocator_malloc(&allocator, 3 * allocator.page_size);
+    assert(huge != NULL && !in_small(&allocator, huge));
+    assert(PseudoAllocator_usable_size(&allocator, huge) >= 3 * allocator.page_size);
+    assert(PseudoAllocator_usable_size(&allocator, small) >= limit - 1);
+    assert(PseudoAllocator_malloc(&allocator, 0) == NULL);
+    
+    fill_memory_pattern(small, limit - 1, 0x11);
+    fill_memory_pattern(large, limit, 0x22);
+    fill_memory_pattern(huge, 3 * allocator.page_size, 0x33);
+    assert(!verify_memory_pattern(small, limit - 1, 0x11));
+    assert(!verify_memory_pattern(large, limit, 0x22));
+    assert(!verify_memory_pattern(huge, 3 * allocator.page_size, 0x33));
+    
+    assert(PseudoAllocator_free(&allocator, small) == 0);
+    assert(PseudoAllocator_free(&allocator, large) == 0);
+    assert(PseudoAllocator_free(&allocator, huge) == 0);
+    assert(allocator.large_fragmentation == 0);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(PseudoAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Small and large requests test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that released mappings are reused
+static int test_region_cache() {
+    PseudoAllocator allocator;
+    void* ptrs[PSEUDO_CACHE_SLOTS + 2];
+    
+    #ifdef VERBOSE
+    printf("Testing the region cache...\n");
+    #endif
+    
+    assert(PseudoAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t size = 5 * allocator.page_size;
+    
+    // Same size again: the same mapping, no mmap
+    void* first = PseudoAllocator_malloc(&allocator, size);
+    assert(first != NULL && allocator.cache_misses == 1);
+    assert(PseudoAllocator_free(&allocator, first) == 0);
+    assert(allocator.cached_bytes > 0);
+    void* second = PseudoAllocator_malloc(&allocator, size - 100);
+    assert(second == first && allocator.cache_hits == 1);
+    assert(allocator.cached_bytes == 0);
+    
+    // Other buckets miss
+    void* other = PseudoAllocator_malloc(&allocator, 64 * allocator.page_size);
+    assert(other != NULL && allocator.cache_misses == 2);
+    assert(PseudoAllocator_free(&allocator, other) == 0);
+    assert(PseudoAllocator_free(&allocator, second) == 0);
+    assert(PseudoAllocator_free(&allocator, second) == -1); // Double free of a cached mapping
+    
+    // A full bucket evicts, the cache never holds more than its slots
+    for (int i = 0; i < PSEUDO_CACHE_SLOTS + 2; i++) {
+        ptrs[i] = PseudoAllocator_malloc(&allocator, size);
+        assert(ptrs[i] != NULL);
+    }
+    for (int i = 0; i < PSEUDO_CACHE_SLOTS + 2; i++) {
+        assert(PseudoAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    int cached = 0;
+    for (int b = 0; b < PSEUDO_CACHE_BUCKETS; b++) {
+        for (int i = 0; i < PSEUDO_CACHE_SLOTS; i++) cached += allocator.cache[b][i].start != NULL;
+    }
+    assert(cached == PSEUDO_CACHE_SLOTS + 1); // Full bucket plus the 64 page mapping
+    
+    // A disabled cache unmaps right away
+    PseudoAllocator_destroy(&allocator);
+    assert(PseudoAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    allocator.cache_max_bytes = 0;
+    first = PseudoAllocator_malloc(&allocator, size);
+    assert(PseudoAllocator_free(&allocator, first) == 0);
+    assert(allocator.cached_bytes == 0);
+    assert(PseudoAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Region cache test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that small requests move to mappings when the buddy is full
+static int test_small_overflow() {
+    PseudoAllocator allocator;
+    void* ptrs[64];
+    
+    #ifdef VERBOSE
+    printf("Testing a full small allocator...\n");
+    #endif
+    
+    // 4 KiB of small memory in 256B blocks
+    assert(PseudoAllocator_create(&allocator, 1 << 12, 4) != NULL);
+    int mapped = 0;
+    for (int i = 0; i < 64; i++) {
+        ptrs[i] = PseudoAllocator_malloc(&allocator, 200);
+        assert(ptrs[i] != NULL);
+        mapped += !in_small(&allocator, ptrs[i]);
+        fill_memory_pattern(ptrs[i], 200, (unsigned char)i);
+    }
+    assert(mapped == 64 - 16);
+    for (int i = 0; i < 64; i++) {
+        assert(!verify_memory_pattern(ptrs[i], 200, (unsigned char)i));
+        assert(PseudoAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(PseudoAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Full small allocator test passed\n");
+    #endif
+    return 0;
+}
+
+// Test realloc across the buddy and the mappings, aligned and zeroed blocks
+static int test_resize_align_zero() {
+    PseudoAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing realloc, memalign and calloc...\n");
+    #endif
+    
+    assert(PseudoAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t page = allocator.page_size;
+    
+    // Small to small in place, then to a mapping, then grown by mremap
+    char* ptr = PseudoAllocator_malloc(&allocator, 40);
+    assert(ptr != NULL && (uintptr_t)ptr % PSEUDO_ALIGNMENT == 0);
+    fill_memory_pattern(ptr, 40, 0x44);
+    assert(PseudoAllocator_realloc(&allocator, ptr, 60) == ptr);
+    ptr = PseudoAllocator_realloc(&allocator, ptr, 2 * page);
+    assert(ptr != NULL && !in_small(&allocator, ptr));
+    assert(!verify_memory_pattern(ptr, 40, 0x44));
+    fill_memory_pattern(ptr, 2 * page, 0x45);
+    ptr = PseudoAllocator_realloc(&allocator, ptr, 64 * page);
+    assert(ptr != NULL && PseudoAllocator_usable_size(&allocator, ptr) >= 64 * page);
+    assert(!verify_memory_pattern(ptr, 2 * page, 0x45));
+    
+    // Shrinking keeps the block and unmaps the tail
+    assert(PseudoAllocator_realloc(&allocator, ptr, page) == ptr);
+    assert(PseudoAllocator_usable_size(&allocator, ptr) < 64 * page);
+    assert(!verify_memory_pattern(ptr, page, 0x45));
+    assert(PseudoAllocator_realloc(&allocator, NULL, 0) == NULL);
+    assert(PseudoAllocator_realloc(&allocator, ptr, 0) == NULL);
+    
+    // Alignments served by the buddy, by the block offset and by trimming
+    size_t alignments[] = {8, 64, 256, page, 4 * page};
+    size_t sizes[] = {24, 100, 3 * page};
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 3; j++) {
+            void* aligned = PseudoAllocator_memalign(&allocator, alignments[i], sizes[j]);
+            assert(aligned != NULL && (uintptr_t)aligned % alignments[i] == 0);
+            assert(PseudoAllocator_usable_size(&allocator, aligned) >= sizes[j]);
+            fill_memory_pattern(aligned, sizes[j], 0x46);
+            assert(PseudoAllocator_free(&allocator, aligned) == 0);
+        }
+    }
+    
+    // Dirty memory comes back zeroed, from the buddy and from the cache
+    char* dirty = PseudoAllocator_malloc(&allocator, 5 * page);
+    fill_memory_pattern(dirty, 5 * page, 0xFF);
+    assert(PseudoAllocator_free(&allocator, dirty) == 0);
+    char* zeroed = PseudoAllocator_calloc(&allocator, 5, page);
+    assert(zeroed == dirty && allocator.cache_hits > 0);
+    for (size_t i = 0; i < 5 * page; i++) assert(zeroed[i] == 0);
+    char* small = PseudoAllocator_malloc(&allocator, 100);
+    fill_memory_pattern(small, 100, 0xFF);
+    assert(PseudoAllocator_free(&allocator, small) == 0);
+    char* small_zeroed = PseudoAllocator_calloc(&allocator, 10, 10);
+    assert(small_zeroed == small);
+    for (int i = 0; i < 100; i++) assert(small_zeroed[i] == 0);
+    assert(PseudoAllocator_calloc(&allocator, SIZE_MAX, 2) == NULL);
+    assert(PseudoAllocator_free(&allocator, zeroed) == 0);
+    assert(PseudoAllocator_free(&allocator, small_zeroed) == 0);
+    
+    assert(allocator.large_fragmentation == 0);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(PseudoAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Realloc, memalign and calloc test passed\n");
+    #endif
+    return 0;
+}
+
+// Test invalid and repeated releases, and the process-wide allocator
+static int test_invalid_releases() {
+    PseudoAllocator allocator;
+    int on_stack = 0;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid releases...\n");
+    #endif
+    
+    assert(PseudoAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    assert(PseudoAllocator_free(&allocator, NULL) == -1);
+    assert(PseudoAllocator_free(&allocator, &on_stack) == -1);
+    void* small = PseudoAllocator_malloc(&allocator, 10);
+    assert(PseudoAllocator_free(&allocator, small) == 0);
+    assert(PseudoAllocator_free(&allocator, small) == -1);
+    assert(PseudoAllocator_destroy(&allocator) == 0);
+    
+    char* a = pseudo_malloc(100);
+    char* b = pseudo_malloc(100000);
+    assert(a != NULL && b != NULL);
+    fill_memory_pattern(a, 100, 0x5A);
+    fill_memory_pattern(b, 100000, 0xA5);
+    assert(!verify_memory_pattern(a, 100, 0x5A));
+    assert(!verify_memory_pattern(b, 100000, 0xA5));
+    pseudo_free(a);
+    pseudo_free(b);
+    pseudo_free(NULL);
+    
+    #ifdef VERBOSE
+    printf("Invalid releases test passed\n");
+    #endif
+    return 0;
+}
+
+int test_pseudo_allocator() {
+    int result = 0;
+    
+    printf("=== Running PseudoAllocator Tests ===\n");
+    result |= test_routing();
+    result |= test_region_cache();
+    result |= test_small_overflow();
+    result |= test_resize_align_zero();
+    result |= test_invalid_releases();
+
+    if (result != 0) {
+        printf(RED "Some PseudoAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All PseudoAllocator tests passed!\n" RESET);
+    }
+    printf("=== PseudoAllocator Tests Complete ===\n");
+    
+    return result;
+}
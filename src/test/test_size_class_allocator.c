@@ -0,0 +1,175 @@
+#include <test_size_class_allocator.h>
+#define MEMORY_SIZE (4 << 20) // 4MB, enough for every 8-byte step in the largest classes
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    SizeClassAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+    
+    assert(SizeClassAllocator_create(&allocator, 0) == NULL);
+    assert(SizeClassAllocator_create(NULL, MEMORY_SIZE) == NULL);
+    
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test the size -> class table
+static int test_class_lookup() {
+    SizeClassAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing class lookup...\n");
+    #endif
+    
+    assert(SizeClassAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    assert(allocator.class_size[0] == SIZE_CLASS_MIN);
+    assert(allocator.class_size[SIZE_CLASS_COUNT - 1] == SIZE_CLASS_MAX);
+    
+    for (size_t size = 1; size <= SIZE_CLASS_MAX; size++) {
+        int class = SizeClassAllocator_class_of(&allocator, size);
+        assert(class >= 0 && class < SIZE_CLASS_COUNT);
+        // Smallest class that fits
+        assert(allocator.class_size[class] >= size);
+        assert(class == 0 || allocator.class_size[class - 1] < size);
+        // Waste bounded by the class spacing
+        if (size > 128) assert((allocator.class_size[class] - size) * 8 < size);
+    }
+    assert(SizeClassAllocator_class_of(&allocator, 0) == -1);
+    assert(SizeClassAllocator_class_of(&allocator, SIZE_CLASS_MAX + 1) == -1);
+    assert(SizeClassAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Class lookup test passed\n");
+    #endif
+    return 0;
+}
+
+// Test allocation and release across all the classes
+static int test_alloc_free() {
+    SizeClassAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing allocation and release...\n");
+    #endif
+    
+    assert(SizeClassAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    size_t free_memory = ((VariableBlockAllocator*)&allocator)->sparse_free_memory;
+    
+    void* ptrs[SIZE_CLASS_MAX / 8];
+    int n = 0;
+    for (size_t size = 8; size <= SIZE_CLASS_MAX; size += 8) {
+        size_t requested = size - 3;
+        ptrs[n] = SizeClassAllocator_malloc(&allocator, requested);
+        assert(ptrs[n] != NULL);
+        fill_memory_pattern(ptrs[n], requested, (unsigned char)n);
+        n++;
+    }
+    #ifdef VERBOSE
+    SizeClassAllocator_print_state(&allocator);
+    #endif
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation > 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory < free_memory);
+    
+    // Too large requests are refused
+    assert(SizeClassAllocator_malloc(&allocator, SIZE_CLASS_MAX + 1) == NULL);
+    
+    for (int i = 0; i < n; i++) {
+        assert(!verify_memory_pattern(ptrs[i], (size_t)(i + 1) * 8 - 3, (unsigned char)i));
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        assert(SizeClassAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == free_memory);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(SizeClassAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Allocation and release test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that a full class does not spill into the others
+static int test_class_exhaustion() {
+    SizeClassAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing class exhaustion...\n");
+    #endif
+    
+    assert(SizeClassAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    int class = SizeClassAllocator_class_of(&allocator, 64);
+    uint n = allocator.classes[class].num_slabs;
+    void** ptrs = malloc(n * sizeof(void*));
+    for (uint i = 0; i < n; i++) {
+        ptrs[i] = SizeClassAllocator_malloc(&allocator, 64);
+        assert(ptrs[i] != NULL);
+    }
+    assert(SizeClassAllocator_malloc(&allocator, 64) == NULL);
+    // Other classes are unaffected
+    void* other = SizeClassAllocator_malloc(&allocator, 100);
+    assert(other != NULL);
+    assert(SizeClassAllocator_free(&allocator, other) == 0);
+    
+    for (uint i = 0; i < n; i++) {
+        assert(SizeClassAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    free(ptrs);
+    assert(SizeClassAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Class exhaustion test passed\n");
+    #endif
+    return 0;
+}
+
+// Test invalid releases
+static int test_invalid_free() {
+    SizeClassAllocator allocator;
+    int local;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid releases...\n");
+    #endif
+    
+    assert(SizeClassAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    void* ptr = SizeClassAllocator_malloc(&allocator, 32);
+    assert(ptr != NULL);
+    
+    assert(SizeClassAllocator_free(&allocator, NULL) == -1);
+    assert(SizeClassAllocator_free(&allocator, &local) == -1); // Outside every class
+    assert(SizeClassAllocator_free(&allocator, (char*)ptr + 1) == -1); // Not a slot start
+    assert(SizeClassAllocator_free(&allocator, ptr) == 0);
+    assert(SizeClassAllocator_free(&allocator, ptr) == -1); // Double free
+    assert(SizeClassAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Invalid releases test passed\n");
+    #endif
+    return 0;
+}
+
+int test_size_class_allocator() {
+    int result = 0;
+    
+    printf("=== Running SizeClassAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_class_lookup();
+    result |= test_alloc_free();
+    result |= test_class_exhaustion();
+    result |= test_invalid_free();
+
+    if (result != 0) {
+        printf(RED "Some SizeClassAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All SizeClassAllocator tests passed!\n" RESET);
+    }
+    printf("=== SizeClassAllocator Tests Complete ===\n");
+    
+    return result;
+}
@@ -204,6 +204,248 @@ static int test_invalid_free() {
     return 0;
 }
 
+// Test the header-free embedded layout
+static int test_embedded_mode() {
+    SlabAllocator allocator;
+    const size_t object_size = 16;
+    void* ptrs[NUM_SLABS];
+    
+    #ifdef VERBOSE
+    printf("Testing embedded free list mode...\n");
+    #endif
+    
+    assert(SlabAllocator_create_with_mode(&allocator, object_size, NUM_SLABS, SLAB_MODE_EMBEDDED) != NULL);
+    
+    // No per-slot header, no DoubleLinkedList
+    assert(allocator.slab_size == object_size);
+    assert(allocator.free_list == NULL);
+    assert(allocator.free_list_size == NUM_SLABS);
+    
+    for (size_t i = 0; i < NUM_SLABS; i++) {
+        ptrs[i] = SlabAllocator_malloc(&allocator);
+        assert(ptrs[i] != NULL);
+        // Slots are packed back to back
+        assert(((char*)ptrs[i] - allocator.slabs_start) % object_size == 0);
+        fill_memory_pattern(ptrs[i], object_size, (unsigned char)i);
+    }
+    assert(SlabAllocator_malloc(&allocator) == NULL);
+    for (size_t i = 0; i < NUM_SLABS; i++) {
+        assert(!verify_memory_pattern(ptrs[i], object_size, (unsigned char)i));
+    }
+    
+    #ifdef VERBOSE
+    SlabAllocator_print_state(&allocator);
+    #endif
+    
+    // Pointers inside a slot are rejected
+    assert(SlabAllocator_free(&allocator, (char*)ptrs[0] + 1) == -1);
+    
+    // Freed slots are reused LIFO
+    assert(SlabAllocator_free(&allocator, ptrs[3]) == 0);
+    assert(SlabAllocator_free(&allocator, ptrs[3]) == -1); // Double free of the head
+    assert(SlabAllocator_free(&allocator, ptrs[5]) == 0);
+    assert(SlabAllocator_free(&allocator, ptrs[3]) == -1); // Double free past the head
+    assert(allocator.free_list_size == 2);
+    assert(SlabAllocator_malloc(&allocator) == ptrs[5]);
+    assert(SlabAllocator_malloc(&allocator) == ptrs[3]);
+    
+    for (size_t i = 0; i < NUM_SLABS; i++) {
+        assert(SlabAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    assert(allocator.free_list_size == NUM_SLABS);
+    SlabAllocator_destroy(&allocator);
+    
+    #ifdef VERBOSE
+    printf("Embedded free list mode test passed\n");
+    #endif
+    return 0;
+}
+// Test the bitmap-backed layout
+static int test_bitmap_mode() {
+    SlabAllocator allocator;
+    const size_t object_size = 24;
+    const size_t n_slabs = 100; // More than one bitmap word
+    void* ptrs[100];
+    
+    #ifdef VERBOSE
+    printf("Testing bitmap mode...\n");
+    #endif
+    
+    assert(SlabAllocator_create_with_mode(&allocator, object_size, n_slabs, SLAB_MODE_BITMAP) != NULL);
+    assert(allocator.slab_size == object_size);
+    assert(allocator.slot_bitmap.num_bits == (int)n_slabs);
+    
+    for (size_t i = 0; i < n_slabs; i++) {
+        ptrs[i] = SlabAllocator_malloc(&allocator);
+        assert(ptrs[i] != NULL);
+        // Next-fit hands out slots in address order on a fresh pool
+        assert(ptrs[i] == allocator.slabs_start + i * object_size);
+        fill_memory_pattern(ptrs[i], object_size, (unsigned char)i);
+    }
+    assert(SlabAllocator_malloc(&allocator) == NULL);
+    for (size_t i = 0; i < n_slabs; i++) {
+        assert(!verify_memory_pattern(ptrs[i], object_size, (unsigned char)i));
+    }
+    
+    // Double free and interior pointers are rejected
+    assert(SlabAllocator_free(&allocator, ptrs[40]) == 0);
+    assert(SlabAllocator_free(&allocator, ptrs[40]) == -1);
+    assert(SlabAllocator_free(&allocator, (char*)ptrs[41] + 8) == -1);
+    
+    // The search wraps around from the hint to the freed slot
+    assert(SlabAllocator_malloc(&allocator) == ptrs[40]);
+    
+    #ifdef VERBOSE
+    SlabAllocator_print_state(&allocator);
+    #endif
+    
+    for (size_t i = 0; i < n_slabs; i++) {
+        assert(SlabAllocator_free(&allocator, ptrs[i]) == 0);
+    }
+    assert(allocator.free_list_size == n_slabs);
+    SlabAllocator_destroy(&allocator);
+    
+    #ifdef VERBOSE
+    printf("Bitmap mode test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that init does not touch the slots
+static int test_lazy_init() {
+    SlabAllocator allocator;
+    const size_t n_slabs = 1 << 20; // 64MB of 64-byte slots
+    long page_size = sysconf(_SC_PAGESIZE);
+    unsigned char resident = 1;
+    
+    #ifdef VERBOSE
+    printf("Testing lazy slot initialization...\n");
+    #endif
+    
+    for (int mode = SLAB_MODE_LIST; mode <= SLAB_MODE_EMBEDDED; mode++) {
+        assert(SlabAllocator_create_with_mode(&allocator, 64, n_slabs, mode) != NULL);
+        assert(allocator.bump_index == 0);
+        assert(allocator.free_list_size == n_slabs);
+        // The last page of the pool was never faulted in
+        char* last_page = allocator.memory_start + allocator.memory_size - page_size;
+        assert(mincore(last_page, page_size, &resident) == 0);
+        assert((resident & 1) == 0);
+        
+        // Fresh slots come from the bump pointer in address order
+        void* a = SlabAllocator_malloc(&allocator);
+        void* b = SlabAllocator_malloc(&allocator);
+        assert(a != NULL && b != NULL);
+        assert((char*)b - (char*)a == (long)allocator.slab_size);
+        assert(allocator.bump_index == 2);
+        
+        // A slot past the bump pointer was never handed out
+        assert(SlabAllocator_free(&allocator, (char*)b + allocator.slab_size) == -1);
+        
+        // Recycled slots are preferred over fresh ones
+        assert(SlabAllocator_free(&allocator, a) == 0);
+        assert(SlabAllocator_malloc(&allocator) == a);
+        assert(allocator.bump_index == 2);
+        assert(allocator.free_list_size == n_slabs - 2);
+        
+        assert(SlabAllocator_free(&allocator, a) == 0);
+        assert(SlabAllocator_free(&allocator, b) == 0);
+        assert(allocator.free_list_size == n_slabs);
+        SlabAllocator_destroy(&allocator);
+    }
+    
+    #ifdef VERBOSE
+    printf("Lazy slot initialization test passed\n");
+    #endif
+    return 0;
+}
+
+// Test payload alignment in every mode
+static int test_aligned() {
+    SlabAllocator allocator;
+    const size_t alignments[] = {8, 16, 64};
+    void* ptrs[NUM_SLABS];
+    
+    #ifdef VERBOSE
+    printf("Testing aligned slots...\n");
+    #endif
+    
+    // Alignment must be a power of two up to the page size
+    assert(SlabAllocator_create_aligned(&allocator, 24, NUM_SLABS, SLAB_MODE_LIST, 24) == NULL);
+    assert(SlabAllocator_create_aligned(&allocator, 24, NUM_SLABS, SLAB_MODE_LIST, 1 << 20) == NULL);
+    
+    for (int mode = SLAB_MODE_LIST; mode <= SLAB_MODE_BITMAP; mode++) {
+        for (size_t a = 0; a < sizeof(alignments) / sizeof(alignments[0]); a++) {
+            assert(SlabAllocator_create_aligned(&allocator, 40, NUM_SLABS, mode, alignments[a]) != NULL);
+            assert(allocator.slab_size % alignments[a] == 0);
+            for (size_t i = 0; i < NUM_SLABS; i++) {
+                ptrs[i] = SlabAllocator_malloc(&allocator);
+                assert(ptrs[i] != NULL);
+                assert((uintptr_t)ptrs[i] % alignments[a] == 0);
+                fill_memory_pattern(ptrs[i], 40, (unsigned char)i);
+            }
+            for (size_t i = 0; i < NUM_SLABS; i++) {
+                assert(!verify_memory_pattern(ptrs[i], 40, (unsigned char)i));
+                assert(SlabAllocator_free(&allocator, ptrs[i]) == 0);
+            }
+            SlabAllocator_destroy(&allocator);
+        }
+    }
+    
+    #ifdef VERBOSE
+    printf("Aligned slots test passed\n");
+    #endif
+    return 0;
+}
+
+// Test batch allocation and release in every mode
+static int test_batch() {
+    SlabAllocator allocator;
+    void* ptrs[NUM_SLABS + 4];
+    
+    #ifdef VERBOSE
+    printf("Testing batch allocation...\n");
+    #endif
+    
+    for (int mode = SLAB_MODE_LIST; mode <= SLAB_MODE_BITMAP; mode++) {
+        assert(SlabAllocator_create_with_mode(&allocator, SLAB_SIZE, NUM_SLABS, mode) != NULL);
+        
+        // Recycled slots and never-used slots in the same batch
+        void* first = SlabAllocator_malloc(&allocator);
+        assert(first != NULL);
+        assert(SlabAllocator_free(&allocator, first) == 0);
+        assert(SlabAllocator_malloc_batch(&allocator, 4, ptrs) == 4);
+        for (int i = 0; i < 4; i++) {
+            assert(ptrs[i] != NULL);
+            fill_memory_pattern(ptrs[i], SLAB_SIZE, (unsigned char)i);
+            for (int j = 0; j < i; j++) assert(ptrs[i] != ptrs[j]);
+        }
+        
+        // Fewer free slots than requested: the tail comes back NULL
+        assert(SlabAllocator_malloc_batch(&allocator, NUM_SLABS, ptrs + 4) == NUM_SLABS - 4);
+        for (int i = 4; i < NUM_SLABS; i++) assert(ptrs[i] != NULL);
+        for (int i = NUM_SLABS; i < NUM_SLABS + 4; i++) assert(ptrs[i] == NULL);
+        assert(allocator.free_list_size == 0);
+        for (int i = 0; i < 4; i++) assert(!verify_memory_pattern(ptrs[i], SLAB_SIZE, (unsigned char)i));
+        
+        // A duplicate and a foreign pointer are rejected, the rest is released
+        char invalid_ptr[SLAB_SIZE];
+        ptrs[NUM_SLABS] = ptrs[NUM_SLABS - 1]; // Caught by the occupancy bit in embedded mode too
+        ptrs[NUM_SLABS + 1] = invalid_ptr;
+        assert(SlabAllocator_free_batch(&allocator, NUM_SLABS + 2, ptrs) == NUM_SLABS);
+        assert(ptrs[NUM_SLABS] == NULL && ptrs[NUM_SLABS + 1] == NULL);
+        assert(allocator.free_list_size == NUM_SLABS);
+        
+        // Everything is reusable through the generic entry points
+        assert(Allocator_malloc_batch((Allocator*)&allocator, NUM_SLABS, NULL, ptrs) == NUM_SLABS);
+        assert(Allocator_free_batch((Allocator*)&allocator, NUM_SLABS, ptrs) == NUM_SLABS);
+        SlabAllocator_destroy(&allocator);
+    }
+    
+    #ifdef VERBOSE
+    printf("Batch allocation test passed\n");
+    #endif
+    return 0;
+}
 
 int test_slab_allocator() {
     int result = 0;
@@ -214,6 +456,11 @@ int test_slab_allocator() {
     result |= test_alloc_pattern();
     result |= test_exhaustion();
     result |= test_invalid_free();
+    result |= test_embedded_mode();
+    result |= test_bitmap_mode();
+    result |= test_lazy_init();
+    result |= test_aligned();
+    result |= test_batch();
 
     if (result != 0) {
         printf(RED "Some SlabAllocator tests failed!\n" RESET);
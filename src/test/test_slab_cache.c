@@ -0,0 +1,242 @@
+#include <test_slab_cache.h>
+#define OBJECT_SIZE 64
+#define OBJECTS_PER_CHUNK 32
+#define MAX_EMPTY_CHUNKS 1
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    SlabCache cache;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+    
+    assert(SlabCache_create(&cache, 0, OBJECTS_PER_CHUNK, MAX_EMPTY_CHUNKS) == NULL);
+    assert(SlabCache_create(&cache, OBJECT_SIZE, 0, MAX_EMPTY_CHUNKS) == NULL);
+    assert(SlabCache_create(NULL, OBJECT_SIZE, OBJECTS_PER_CHUNK, MAX_EMPTY_CHUNKS) == NULL);
+    
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that chunks are mapped on demand
+static int test_grow() {
+    SlabCache cache;
+    
+    #ifdef VERBOSE
+    printf("Testing growth...\n");
+    #endif
+    
+    assert(SlabCache_create(&cache, OBJECT_SIZE, OBJECTS_PER_CHUNK, MAX_EMPTY_CHUNKS) != NULL);
+    // Nothing is mapped until the first allocation
+    assert(cache.num_chunks == 0);
+    assert(cache.objects_per_chunk >= OBJECTS_PER_CHUNK);
+    
+    size_t n = cache.objects_per_chunk * 3 + 1;
+    void** ptrs = malloc(n * sizeof(void*));
+    for (size_t i = 0; i < n; i++) {
+        ptrs[i] = SlabCache_malloc(&cache);
+        assert(ptrs[i] != NULL);
+        fill_memory_pattern(ptrs[i], OBJECT_SIZE, (unsigned char)i);
+    }
+    assert(cache.num_chunks == 4);
+    assert(cache.full.size == 3);
+    assert(cache.partial.size == 1);
+    for (size_t i = 0; i < n; i++) {
+        assert(!verify_memory_pattern(ptrs[i], OBJECT_SIZE, (unsigned char)i));
+    }
+    
+    #ifdef VERBOSE
+    SlabCache_print_state(&cache);
+    #endif
+    
+    for (size_t i = 0; i < n; i++) {
+        assert(SlabCache_free(&cache, ptrs[i]) == 0);
+    }
+    assert(cache.num_allocated == 0);
+    free(ptrs);
+    assert(SlabCache_destroy(&cache) == 0);
+    
+    #ifdef VERBOSE
+    printf("Growth test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that empty chunks go back to the OS past the hysteresis
+static int test_shrink() {
+    SlabCache cache;
+    
+    #ifdef VERBOSE
+    printf("Testing chunk release...\n");
+    #endif
+    
+    assert(SlabCache_create(&cache, OBJECT_SIZE, OBJECTS_PER_CHUNK, MAX_EMPTY_CHUNKS) != NULL);
+    size_t per_chunk = cache.objects_per_chunk;
+    size_t n = per_chunk * 3;
+    void** ptrs = malloc(n * sizeof(void*));
+    for (size_t i = 0; i < n; i++) {
+        ptrs[i] = SlabCache_malloc(&cache);
+        assert(ptrs[i] != NULL);
+    }
+    assert(cache.num_chunks == 3);
+    
+    // Empty the first chunk: it stays mapped (within the hysteresis)
+    for (size_t i = 0; i < per_chunk; i++) {
+        assert(SlabCache_free(&cache, ptrs[i]) == 0);
+    }
+    assert(cache.num_chunks == 3);
+    assert(cache.empty.size == 1);
+    
+    // Empty the second chunk: one of them is unmapped
+    for (size_t i = per_chunk; i < 2 * per_chunk; i++) {
+        assert(SlabCache_free(&cache, ptrs[i]) == 0);
+    }
+    assert(cache.num_chunks == 2);
+    assert(cache.empty.size == MAX_EMPTY_CHUNKS);
+    
+    // The retained empty chunk is reused before mapping a new one
+    void* p = SlabCache_malloc(&cache);
+    assert(p != NULL);
+    assert(cache.num_chunks == 2);
+    assert(SlabCache_free(&cache, p) == 0);
+    
+    assert(SlabCache_shrink(&cache) == 1);
+    assert(cache.num_chunks == 1);
+    
+    for (size_t i = 2 * per_chunk; i < n; i++) {
+        assert(SlabCache_free(&cache, ptrs[i]) == 0);
+    }
+    free(ptrs);
+    assert(SlabCache_destroy(&cache) == 0);
+    
+    #ifdef VERBOSE
+    printf("Chunk release test passed\n");
+    #endif
+    return 0;
+}
+
+// Test invalid releases
+static int test_invalid_free() {
+    SlabCache cache, other;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid releases...\n");
+    #endif
+    
+    assert(SlabCache_create(&cache, OBJECT_SIZE, OBJECTS_PER_CHUNK, MAX_EMPTY_CHUNKS) != NULL);
+    assert(SlabCache_create(&other, OBJECT_SIZE, OBJECTS_PER_CHUNK, MAX_EMPTY_CHUNKS) != NULL);
+    void* ptr = SlabCache_malloc(&cache);
+    void* keep = SlabCache_malloc(&cache);
+    void* foreign = SlabCache_malloc(&other);
+    assert(ptr != NULL && keep != NULL && foreign != NULL);
+    
+    assert(SlabCache_free(&cache, NULL) == -1);
+    assert(SlabCache_free(&cache, (char*)ptr + 1) == -1); // Not a slot start
+    assert(SlabCache_free(&cache, (char*)keep + cache.slot_size) == -1); // Never handed out
+    assert(SlabCache_free(&cache, foreign) == -1); // Another cache's chunk
+    assert(SlabCache_free(&cache, ptr) == 0);
+    assert(SlabCache_free(&cache, ptr) == -1); // Double free
+    
+    // Double free of a slot past the head of the free list
+    void* first = SlabCache_malloc(&cache);
+    void* second = SlabCache_malloc(&cache);
+    assert(SlabCache_free(&cache, first) == 0);
+    assert(SlabCache_free(&cache, second) == 0);
+    assert(SlabCache_free(&cache, first) == -1);
+    assert(cache.num_allocated == 1);
+    first = SlabCache_malloc(&cache);
+    second = SlabCache_malloc(&cache);
+    assert(first != NULL && second != NULL && first != second);
+    assert(SlabCache_free(&cache, first) == 0);
+    assert(SlabCache_free(&cache, second) == 0);
+    
+    // Pointers outside every chunk are rejected without reading a header
+    char* heap = malloc(OBJECT_SIZE);
+    assert(SlabCache_free(&cache, heap) == -1);
+    free(heap);
+    assert(SlabCache_free(&cache, keep) == 0);
+    assert(SlabCache_shrink(&cache) == 1);
+    assert(SlabCache_free(&cache, keep) == -1); // Its chunk is unmapped
+    assert(SlabCache_free(&other, foreign) == 0);
+    assert(SlabCache_destroy(&cache) == 0);
+    assert(SlabCache_destroy(&other) == 0);
+    
+    #ifdef VERBOSE
+    printf("Invalid releases test passed\n");
+    #endif
+    return 0;
+}
+
+// Test object alignment and chunk coloring
+static int test_coloring() {
+    SlabCache cache;
+    const size_t object_size = 320; // Leaves a few cache lines of slack in a page
+    
+    #ifdef VERBOSE
+    printf("Testing alignment and coloring...\n");
+    #endif
+    
+    assert(SlabCache_create_aligned(&cache, object_size, 1, 0, 24, true) == NULL);
+    assert(SlabCache_create_aligned(&cache, object_size, 1, 0, CACHE_LINE_SIZE, true) != NULL);
+    assert(cache.num_colors > 1);
+    
+    // One chunk per color and one more, which wraps to the first color
+    uint n_chunks = cache.num_colors + 1;
+    size_t n = (size_t)n_chunks * cache.objects_per_chunk;
+    void** ptrs = malloc(n * sizeof(void*));
+    for (size_t i = 0; i < n; i++) {
+        ptrs[i] = SlabCache_malloc(&cache);
+        assert(ptrs[i] != NULL);
+        assert((uintptr_t)ptrs[i] % CACHE_LINE_SIZE == 0);
+    }
+    assert(cache.num_chunks == n_chunks);
+    #ifdef VERBOSE
+    SlabCache_print_state(&cache);
+    #endif
+    
+    // Objects are handed out in order within a chunk: the first object of every chunk
+    // sits at a different offset until the colors wrap around
+    for (uint c = 0; c < n_chunks; c++) {
+        size_t offset = (uintptr_t)ptrs[(size_t)c * cache.objects_per_chunk] & (cache.chunk_size - 1);
+        assert(offset == cache.slots_offset + (size_t)(c % cache.num_colors) * cache.color_step);
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        assert(SlabCache_free(&cache, ptrs[i]) == 0);
+    }
+    free(ptrs);
+    assert(SlabCache_destroy(&cache) == 0);
+    
+    // Without coloring every chunk uses the same offset
+    assert(SlabCache_create_aligned(&cache, object_size, 1, 0, CACHE_LINE_SIZE, false) != NULL);
+    assert(cache.num_colors == 1);
+    assert(SlabCache_destroy(&cache) == 0);
+    
+    #ifdef VERBOSE
+    printf("Alignment and coloring test passed\n");
+    #endif
+    return 0;
+}
+
+int test_slab_cache() {
+    int result = 0;
+    
+    printf("=== Running SlabCache Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_grow();
+    result |= test_shrink();
+    result |= test_invalid_free();
+    result |= test_coloring();
+
+    if (result != 0) {
+        printf(RED "Some SlabCache tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All SlabCache tests passed!\n" RESET);
+    }
+    printf("=== SlabCache Tests Complete ===\n");
+    
+    return result;
+}
@@ -0,0 +1,226 @@
+#include <test_tlsf_allocator.h>
+#define MEMORY_SIZE (1 << 20)
+#define FREE_AT_START (MEMORY_SIZE - TLSF_HEADER_SIZE) // All but the end sentinel
+#define NUM_BLOCKS 1000
+#define ROUNDS 20000
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    TlsfAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+
+    assert(TlsfAllocator_create(NULL, MEMORY_SIZE) == NULL);
+    assert(TlsfAllocator_create(&allocator, 0) == NULL);
+    assert(TlsfAllocator_create(&allocator, TLSF_MIN_BLOCK) == NULL);
+    assert(TlsfAllocator_create(&allocator, TLSF_MAX_MEMORY + TLSF_ALIGNMENT) == NULL);
+
+    assert(TlsfAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == FREE_AT_START);
+    assert(TlsfAllocator_malloc(&allocator, 0) == NULL);
+    assert(TlsfAllocator_malloc(&allocator, MEMORY_SIZE) == NULL);
+    assert(TlsfAllocator_free(&allocator, NULL) == -1);
+    assert(TlsfAllocator_free(&allocator, &allocator) == -1);
+    assert(TlsfAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that blocks fit their requests closely, unlike power of two buddies
+static int test_good_fit() {
+    TlsfAllocator allocator;
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+
+    #ifdef VERBOSE
+    printf("Testing good fit...\n");
+    #endif
+
+    assert(TlsfAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    size_t sizes[] = {1, 100, 255, 600, 1000, 5000, 70000};
+    void* blocks[sizeof(sizes) / sizeof(sizes[0])];
+    size_t requested = 0;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        blocks[i] = TlsfAllocator_malloc(&allocator, sizes[i]);
+        assert(blocks[i] != NULL && (uintptr_t)blocks[i] % TLSF_ALIGNMENT == 0);
+        size_t usable = TlsfAllocator_usable_size(&allocator, blocks[i]);
+        assert(usable >= sizes[i] && usable < sizes[i] + TLSF_MIN_BLOCK);
+        fill_memory_pattern(blocks[i], sizes[i], (unsigned char)i);
+        requested += sizes[i];
+    }
+    // Header and rounding only: under TLSF_MIN_BLOCK bytes per block
+    assert(base->internal_fragmentation < TLSF_MIN_BLOCK * sizeof(sizes) / sizeof(sizes[0]));
+    assert(base->sparse_free_memory == FREE_AT_START - requested - base->internal_fragmentation);
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        assert(!verify_memory_pattern(blocks[i], sizes[i], (unsigned char)i));
+        assert(TlsfAllocator_free(&allocator, blocks[i]) == 0);
+    }
+    assert(base->internal_fragmentation == 0 && base->sparse_free_memory == FREE_AT_START);
+    assert(TlsfAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Good fit test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that released blocks merge with both neighbours, whatever the order
+static int test_coalescing() {
+    TlsfAllocator allocator;
+
+    #ifdef VERBOSE
+    printf("Testing coalescing...\n");
+    #endif
+
+    assert(TlsfAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    void* left = TlsfAllocator_malloc(&allocator, 1000);
+    void* middle = TlsfAllocator_malloc(&allocator, 2000);
+    void* right = TlsfAllocator_malloc(&allocator, 3000);
+    assert((char*)middle > (char*)left && (char*)right > (char*)middle);
+
+    assert(TlsfAllocator_free(&allocator, middle) == 0);
+    assert(TlsfAllocator_free(&allocator, middle) == -1);
+    // The hole is reused by a request that fits it
+    assert(TlsfAllocator_malloc(&allocator, 1900) == middle);
+    assert(TlsfAllocator_free(&allocator, middle) == 0);
+    assert(TlsfAllocator_free(&allocator, left) == 0);
+    assert(TlsfAllocator_free(&allocator, right) == 0);
+    assert(TlsfAllocator_free(&allocator, left) == -1); // Merged away, its tag still says free
+
+    // Everything merged back: the whole arena is one block again
+    void* all = TlsfAllocator_malloc(&allocator, FREE_AT_START - TLSF_HEADER_SIZE);
+    assert(all == left);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == 0);
+    assert(TlsfAllocator_free(&allocator, all) == 0);
+    assert(TlsfAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Coalescing test passed\n");
+    #endif
+    return 0;
+}
+
+// Test realloc in place and out of place, aligned and zeroed blocks
+static int test_resize_align_zero() {
+    TlsfAllocator allocator;
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+
+    #ifdef VERBOSE
+    printf("Testing realloc, memalign and calloc...\n");
+    #endif
+
+    assert(TlsfAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    char* ptr = TlsfAllocator_malloc(&allocator, 100);
+    fill_memory_pattern(ptr, 100, 0x61);
+    assert(TlsfAllocator_realloc(&allocator, ptr, 5000) == ptr); // The next block is free
+    assert(TlsfAllocator_realloc(&allocator, ptr, 50) == ptr);
+    assert(TlsfAllocator_usable_size(&allocator, ptr) < 50 + TLSF_MIN_BLOCK);
+    void* wall = TlsfAllocator_malloc(&allocator, 100);
+    assert((char*)wall > ptr);
+    char* moved = TlsfAllocator_realloc(&allocator, ptr, 1000);
+    assert(moved != NULL && moved != ptr);
+    assert(!verify_memory_pattern(moved, 50, 0x61));
+    assert(TlsfAllocator_realloc(&allocator, moved, 0) == NULL);
+    assert(TlsfAllocator_free(&allocator, wall) == 0);
+    assert(base->internal_fragmentation == 0 && base->sparse_free_memory == FREE_AT_START);
+
+    void* aligned = TlsfAllocator_memalign(&allocator, 4096, 100);
+    assert(aligned != NULL && (uintptr_t)aligned % 4096 == 0);
+    void* after = TlsfAllocator_malloc(&allocator, 10); // Goes in the gap before the aligned block
+    assert((char*)after < (char*)aligned);
+    assert(TlsfAllocator_memalign(&allocator, 48, 100) == NULL);
+    assert(TlsfAllocator_free(&allocator, aligned) == 0);
+    assert(TlsfAllocator_free(&allocator, after) == 0);
+
+    char* dirty = TlsfAllocator_malloc(&allocator, 1000);
+    fill_memory_pattern(dirty, 1000, 0xFF);
+    assert(TlsfAllocator_free(&allocator, dirty) == 0);
+    char* zeroed = TlsfAllocator_calloc(&allocator, 20, 100);
+    assert(zeroed == dirty);
+    for (int i = 0; i < 2000; i++) assert(zeroed[i] == 0);
+    assert(TlsfAllocator_free(&allocator, zeroed) == 0);
+    assert(TlsfAllocator_calloc(&allocator, SIZE_MAX, 2) == NULL);
+
+    assert(base->internal_fragmentation == 0 && base->sparse_free_memory == FREE_AT_START);
+    assert(TlsfAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Realloc, memalign and calloc test passed\n");
+    #endif
+    return 0;
+}
+
+// Random mix of all the operations, contents checked and counters back to the start
+static int test_random_mix() {
+    TlsfAllocator allocator;
+    VariableBlockAllocator* base = (VariableBlockAllocator*)&allocator;
+    static char* blocks[NUM_BLOCKS];
+    static size_t sizes[NUM_BLOCKS];
+
+    #ifdef VERBOSE
+    printf("Testing a random mix of operations...\n");
+    #endif
+
+    assert(TlsfAllocator_create(&allocator, MEMORY_SIZE) != NULL);
+    memset(blocks, 0, sizeof(blocks));
+    srand(42);
+    for (int r = 0; r < ROUNDS; r++) {
+        int i = rand() % NUM_BLOCKS;
+        if (blocks[i]) {
+            assert(!verify_memory_pattern(blocks[i], sizes[i], (unsigned char)i));
+            if (rand() % 4 == 0) {
+                size_t size = 1 + rand() % 2000;
+                char* resized = TlsfAllocator_realloc(&allocator, blocks[i], size);
+                if (!resized) continue;
+                if (size > sizes[i]) fill_memory_pattern(resized + sizes[i], size - sizes[i], (unsigned char)i);
+                blocks[i] = resized;
+                sizes[i] = size;
+            } else {
+                assert(TlsfAllocator_free(&allocator, blocks[i]) == 0);
+                blocks[i] = NULL;
+            }
+        } else {
+            sizes[i] = 1 + rand() % 2000;
+            blocks[i] = (rand() % 8 == 0) ? TlsfAllocator_memalign(&allocator, 256, sizes[i])
+                                          : TlsfAllocator_malloc(&allocator, sizes[i]);
+            if (blocks[i]) fill_memory_pattern(blocks[i], sizes[i], (unsigned char)i);
+        }
+    }
+    for (int i = 0; i < NUM_BLOCKS; i++) {
+        if (!blocks[i]) continue;
+        assert(!verify_memory_pattern(blocks[i], sizes[i], (unsigned char)i));
+        assert(TlsfAllocator_free(&allocator, blocks[i]) == 0);
+    }
+    assert(base->internal_fragmentation == 0 && base->sparse_free_memory == FREE_AT_START);
+    assert(TlsfAllocator_malloc(&allocator, FREE_AT_START - TLSF_HEADER_SIZE) != NULL);
+    assert(TlsfAllocator_destroy(&allocator) == 0);
+
+    #ifdef VERBOSE
+    printf("Random mix test passed\n");
+    #endif
+    return 0;
+}
+
+int test_tlsf_allocator() {
+    int result = 0;
+
+    printf("=== Running TlsfAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_good_fit();
+    result |= test_coalescing();
+    result |= test_resize_align_zero();
+    result |= test_random_mix();
+
+    if (result != 0) {
+        printf(RED "Some TlsfAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All TlsfAllocator tests passed!\n" RESET);
+    }
+    printf("=== TlsfAllocator Tests Complete ===\n");
+
+    return result;
+}
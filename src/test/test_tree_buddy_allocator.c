@@ -0,0 +1,192 @@
+#include <test_tree_buddy_allocator.h>
+#define MEMORY_SIZE (1 << 10) // 1KB
+#define NUM_LEVELS 4 // 64B min blocks, like BitmapBuddyAllocator (1024/2^4)
+#define STRESS_OPERATIONS 20000
+
+// Test creation with invalid parameters
+static int test_invalid_init() {
+    TreeBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid creation parameters...\n");
+    #endif
+    
+    assert(TreeBuddyAllocator_create(&allocator, 0, NUM_LEVELS) == NULL);
+    assert(TreeBuddyAllocator_create(&allocator, MEMORY_SIZE, 0) == NULL);
+    assert(TreeBuddyAllocator_create(&allocator, MEMORY_SIZE, TREE_BUDDY_MAX_LEVELS) == NULL);
+    assert(TreeBuddyAllocator_create(NULL, MEMORY_SIZE, NUM_LEVELS) == NULL);
+    
+    // Too many levels for the header: the minimum block grows
+    assert(TreeBuddyAllocator_create(&allocator, MEMORY_SIZE, 10) != NULL);
+    assert(allocator.min_block_size > TREE_BUDDY_METADATA_SIZE);
+    assert(allocator.min_block_size << allocator.num_levels == MEMORY_SIZE);
+    assert(TreeBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Invalid creation parameters test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that every minimum block can be handed out and merged back
+static int test_fill() {
+    TreeBuddyAllocator allocator;
+    void* ptrs[1 << NUM_LEVELS];
+    
+    #ifdef VERBOSE
+    printf("Testing filling the arena...\n");
+    #endif
+    
+    assert(TreeBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    size_t small_size = allocator.min_block_size - TREE_BUDDY_METADATA_SIZE;
+    int n = 1 << allocator.num_levels;
+    for (int i = 0; i < n; i++) {
+        ptrs[i] = TreeBuddyAllocator_malloc(&allocator, small_size);
+        assert(ptrs[i] != NULL);
+        fill_memory_pattern(ptrs[i], small_size, (unsigned char)i);
+    }
+    assert(TreeBuddyAllocator_malloc(&allocator, 1) == NULL);
+    assert(allocator.longest[0] == 0);
+    assert(((VariableBlockAllocator*)&allocator)->sparse_free_memory == 0);
+    // Free in an order that keeps splitting buddies apart
+    for (int i = 0; i < n; i++) {
+        int j = (i * 5 + 3) % n;
+        assert(!verify_memory_pattern(ptrs[j], small_size, (unsigned char)j));
+        assert(TreeBuddyAllocator_free(&allocator, ptrs[j]) == 0);
+    }
+    assert(allocator.longest[0] == allocator.num_levels + 1);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(TreeBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Fill test passed\n");
+    #endif
+    return 0;
+}
+
+// Test that large blocks are reserved and released without touching their subtree
+static int test_large_blocks() {
+    TreeBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing large blocks...\n");
+    #endif
+    
+    assert(TreeBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    void* whole = TreeBuddyAllocator_malloc(&allocator, MEMORY_SIZE - TREE_BUDDY_METADATA_SIZE);
+    assert(whole == allocator.memory_start + TREE_BUDDY_METADATA_SIZE);
+    assert(allocator.longest[0] == 0);
+    assert(allocator.longest[1] == allocator.num_levels && allocator.longest[allocator.num_nodes - 1] == 1);
+    assert(TreeBuddyAllocator_malloc(&allocator, 1) == NULL);
+    assert(TreeBuddyAllocator_free(&allocator, whole) == 0);
+    
+    // A half and a quarter: the largest free block left is a quarter
+    void* half = TreeBuddyAllocator_malloc(&allocator, MEMORY_SIZE / 2 - TREE_BUDDY_METADATA_SIZE);
+    void* quarter = TreeBuddyAllocator_malloc(&allocator, MEMORY_SIZE / 4 - TREE_BUDDY_METADATA_SIZE);
+    assert(half != NULL && quarter != NULL);
+    assert(allocator.longest[0] == allocator.num_levels - 1);
+    assert(TreeBuddyAllocator_malloc(&allocator, MEMORY_SIZE / 2 - TREE_BUDDY_METADATA_SIZE) == NULL);
+    
+    // A small block splits the free quarter
+    void* small = TreeBuddyAllocator_malloc(&allocator, 1);
+    assert(small != NULL);
+    assert(TreeBuddyAllocator_free(&allocator, half) == 0);
+    assert(allocator.longest[0] == allocator.num_levels);
+    assert(TreeBuddyAllocator_free(&allocator, quarter) == 0);
+    assert(TreeBuddyAllocator_free(&allocator, small) == 0);
+    assert(allocator.longest[0] == allocator.num_levels + 1);
+    
+    #ifdef VERBOSE
+    TreeBuddyAllocator_print_state(&allocator);
+    printf("Large blocks test passed\n");
+    #endif
+    assert(TreeBuddyAllocator_destroy(&allocator) == 0);
+    return 0;
+}
+
+// Test invalid releases
+static int test_invalid_releases() {
+    TreeBuddyAllocator allocator;
+    
+    #ifdef VERBOSE
+    printf("Testing invalid releases...\n");
+    #endif
+    
+    assert(TreeBuddyAllocator_create(&allocator, MEMORY_SIZE, NUM_LEVELS) != NULL);
+    assert(TreeBuddyAllocator_free(&allocator, NULL) == -1);
+    
+    void* ptr = TreeBuddyAllocator_malloc(&allocator, allocator.min_block_size * 2);
+    assert(ptr != NULL);
+    assert(TreeBuddyAllocator_free(&allocator, (char*)ptr + allocator.min_block_size) == -1); // Inside the block
+    assert(TreeBuddyAllocator_free(&allocator, ptr) == 0);
+    assert(TreeBuddyAllocator_free(&allocator, ptr) == -1); // Double free
+    
+    char invalid_ptr[64];
+    assert(TreeBuddyAllocator_free(&allocator, invalid_ptr + TREE_BUDDY_METADATA_SIZE) == -1);
+    assert(TreeBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Invalid releases test passed\n");
+    #endif
+    return 0;
+}
+
+// Random reserves and releases, then everything must merge back into the root
+static int test_stress() {
+    TreeBuddyAllocator allocator;
+    void* ptrs[256] = {0};
+    size_t sizes[256];
+    
+    #ifdef VERBOSE
+    printf("Testing random operations...\n");
+    #endif
+    
+    assert(TreeBuddyAllocator_create(&allocator, 1 << 16, 10) != NULL);
+    srand(12);
+    for (int op = 0; op < STRESS_OPERATIONS; op++) {
+        int i = rand() % 256;
+        if (ptrs[i]) {
+            assert(!verify_memory_pattern(ptrs[i], sizes[i], (unsigned char)i));
+            assert(TreeBuddyAllocator_free(&allocator, ptrs[i]) == 0);
+            ptrs[i] = NULL;
+        } else {
+            sizes[i] = 1 + (size_t)(rand() % 2000);
+            ptrs[i] = TreeBuddyAllocator_malloc(&allocator, sizes[i]);
+            if (ptrs[i]) fill_memory_pattern(ptrs[i], sizes[i], (unsigned char)i);
+        }
+    }
+    for (int i = 0; i < 256; i++) {
+        if (ptrs[i]) {
+            assert(!verify_memory_pattern(ptrs[i], sizes[i], (unsigned char)i));
+            assert(TreeBuddyAllocator_free(&allocator, ptrs[i]) == 0);
+        }
+    }
+    assert(allocator.longest[0] == allocator.num_levels + 1);
+    assert(((VariableBlockAllocator*)&allocator)->internal_fragmentation == 0);
+    assert(TreeBuddyAllocator_destroy(&allocator) == 0);
+    
+    #ifdef VERBOSE
+    printf("Random operations test passed\n");
+    #endif
+    return 0;
+}
+
+int test_tree_buddy_allocator() {
+    int result = 0;
+    
+    printf("=== Running TreeBuddyAllocator Tests ===\n");
+    result |= test_invalid_init();
+    result |= test_fill();
+    result |= test_large_blocks();
+    result |= test_invalid_releases();
+    result |= test_stress();
+
+    if (result != 0) {
+        printf(RED "Some TreeBuddyAllocator tests failed!\n" RESET);
+    } else {
+        printf(GREEN "All TreeBuddyAllocator tests passed!\n" RESET);
+    }
+    printf("=== TreeBuddyAllocator Tests Complete ===\n");
+    
+    return result;
+}
@@ -0,0 +1,416 @@
+#include <tlsf_allocator.h>
+
+extern inline TlsfAllocator* TlsfAllocator_create(TlsfAllocator* a, size_t memory_size);
+extern inline int TlsfAllocator_destroy(TlsfAllocator* a);
+extern inline void* TlsfAllocator_malloc(TlsfAllocator* a, size_t size);
+extern inline int TlsfAllocator_free(TlsfAllocator* a, void* ptr);
+extern inline void* TlsfAllocator_realloc(TlsfAllocator* a, void* ptr, size_t size);
+extern inline size_t TlsfAllocator_usable_size(TlsfAllocator* a, void* ptr);
+extern inline void* TlsfAllocator_memalign(TlsfAllocator* a, size_t alignment, size_t size);
+extern inline void* TlsfAllocator_calloc(TlsfAllocator* a, size_t nmemb, size_t size);
+
+#define FLAGS (TLSF_BLOCK_FREE | TLSF_PREV_FREE)
+
+static inline size_t block_size(TlsfBlock* b) {
+    return b->size & ~(size_t)FLAGS;
+}
+
+static inline bool is_free(TlsfBlock* b) {
+    return b->size & TLSF_BLOCK_FREE;
+}
+
+static inline TlsfBlock* next_block(TlsfBlock* b) {
+    return (TlsfBlock*)((char*)b + block_size(b));
+}
+
+static inline TlsfBlock* prev_block(TlsfBlock* b) {
+    return (TlsfBlock*)((char*)b - (size_t)b->prev_units * TLSF_ALIGNMENT);
+}
+
+static inline char* payload(TlsfBlock* b) {
+    return (char*)b + TLSF_HEADER_SIZE;
+}
+
+static inline TlsfBlock* block_of(void* ptr) {
+    return (TlsfBlock*)((char*)ptr - TLSF_HEADER_SIZE);
+}
+
+static inline int msb(size_t x) {
+    return 63 - __builtin_clzll(x);
+}
+
+// Lists of the blocks of size bytes
+static inline void mapping_insert(size_t size, int* fl, int* sl) {
+    if (size < ((size_t)1 << TLSF_FL_SHIFT)) {
+        *fl = 0;
+        *sl = (int)(size / TLSF_ALIGNMENT);
+    } else {
+        int bit = msb(size);
+        *sl = (int)(size >> (bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = bit - TLSF_FL_SHIFT + 1;
+    }
+}
+
+// First list whose blocks are all at least size bytes: size is rounded up to the next list
+static inline bool mapping_search(size_t size, int* fl, int* sl) {
+    if (size >= ((size_t)1 << TLSF_FL_SHIFT)) size += ((size_t)1 << (msb(size) - TLSF_SL_LOG2)) - 1;
+    mapping_insert(size, fl, sl);
+    return *fl < TLSF_FL_COUNT;
+}
+
+// Head of the first non-empty list from (fl, sl) on: two bitmap scans, no loop
+static inline TlsfBlock* find_suitable(TlsfAllocator* a, int* fl, int* sl) {
+    uint32_t sl_map = a->sl_bitmap[*fl] & (~0u << *sl);
+    if (!sl_map) {
+        uint32_t fl_map = (*fl + 1 < 32) ? a->fl_bitmap & (~0u << (*fl + 1)) : 0;
+        if (!fl_map) return NULL;
+        *fl = __builtin_ctz(fl_map);
+        sl_map = a->sl_bitmap[*fl];
+    }
+    *sl = __builtin_ctz(sl_map);
+    return a->free_lists[*fl][*sl];
+}
+
+// Good fit: the head of the first list whose blocks are all large enough. When there is
+// none, the head of the list of needed itself may still be
+static TlsfBlock* find_block(TlsfAllocator* a, size_t needed) {
+    int fl, sl;
+    if (mapping_search(needed, &fl, &sl)) {
+        TlsfBlock* b = find_suitable(a, &fl, &sl);
+        if (b) return b;
+    }
+    mapping_insert(needed, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT) return NULL;
+    TlsfBlock* b = a->free_lists[fl][sl];
+    return (b && block_size(b) >= needed) ? b : NULL;
+}
+
+static inline void insert_free(TlsfAllocator* a, TlsfBlock* b) {
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    TlsfBlock* head = a->free_lists[fl][sl];
+    b->next_free = head;
+    b->prev_free = NULL;
+    if (head) head->prev_free = b;
+    a->free_lists[fl][sl] = b;
+    a->fl_bitmap |= 1u << fl;
+    a->sl_bitmap[fl] |= 1u << sl;
+}
+
+static inline void remove_free(TlsfAllocator* a, TlsfBlock* b) {
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    if (b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        a->free_lists[fl][sl] = b->next_free;
+    }
+    if (b->next_free) b->next_free->prev_free = b->prev_free;
+    if (!a->free_lists[fl][sl]) {
+        a->sl_bitmap[fl] &= ~(1u << sl);
+        if (!a->sl_bitmap[fl]) a->fl_bitmap &= ~(1u << fl);
+    }
+}
+
+// Write the tag of b and tell the next block about it
+static inline void set_block(TlsfBlock* b, size_t size, bool free) {
+    b->size = size | (b->size & TLSF_PREV_FREE) | (free ? TLSF_BLOCK_FREE : 0);
+    TlsfBlock* next = next_block(b);
+    next->prev_units = (uint32_t)(size / TLSF_ALIGNMENT);
+    next->size = free ? next->size | TLSF_PREV_FREE : next->size & ~(size_t)TLSF_PREV_FREE;
+}
+
+static inline void mark_written(TlsfAllocator* a, char* end) {
+    if (end > a->high_water) a->high_water = end;
+}
+
+// Cut a free block off the end of b if at least TLSF_MIN_BLOCK bytes are left past size,
+// merged with the next block when that one is free too
+static void trim(TlsfAllocator* a, TlsfBlock* b, size_t size) {
+    size_t total = block_size(b);
+    if (total - size < TLSF_MIN_BLOCK) return;
+    TlsfBlock* rest = (TlsfBlock*)((char*)b + size);
+    TlsfBlock* next = next_block(b);
+    size_t rest_size = total - size;
+    if (is_free(next)) {
+        remove_free(a, next);
+        rest_size += block_size(next);
+    }
+    b->size = size | (b->size & FLAGS);
+    rest->size = 0;
+    rest->prev_units = (uint32_t)(size / TLSF_ALIGNMENT);
+    set_block(rest, rest_size, true);
+    mark_written(a, (char*)rest + TLSF_MIN_BLOCK);
+    insert_free(a, rest);
+    ((VariableBlockAllocator*)a)->sparse_free_memory += total - size;
+}
+
+// Hand out the free block b (already off its list) for a request of size bytes, needing `needed`
+static void* use_block(TlsfAllocator* a, TlsfBlock* b, size_t needed, size_t size) {
+    VariableBlockAllocator* base = (VariableBlockAllocator*)a;
+    base->sparse_free_memory -= block_size(b);
+    set_block(b, block_size(b), false);
+    trim(a, b, needed);
+    b->slack = (uint32_t)(block_size(b) - size);
+    base->internal_fragmentation += b->slack;
+    mark_written(a, (char*)next_block(b));
+    return payload(b);
+}
+
+// Whole block for a request of size bytes, 0 if it cannot be served
+static inline size_t adjust_size(TlsfAllocator* a, size_t size) {
+    if (size == 0 || size > a->memory_size) return 0;
+    size_t needed = (size + TLSF_HEADER_SIZE + TLSF_ALIGNMENT - 1) & ~(size_t)(TLSF_ALIGNMENT - 1);
+    return needed < TLSF_MIN_BLOCK ? TLSF_MIN_BLOCK : needed;
+}
+
+static void* reserve(TlsfAllocator* a, size_t size) {
+    size_t needed = adjust_size(a, size);
+    TlsfBlock* b = needed ? find_block(a, needed) : NULL;
+    if (!b) {
+        #ifdef DEBUG
+        printf(RED "ERROR: No free block of %zu bytes\n" RESET, needed);
+        #endif
+        return NULL;
+    }
+    remove_free(a, b);
+    return use_block(a, b, needed, size);
+}
+
+// Used block of the allocator at ptr, NULL if ptr cannot be one. The tag is checked
+// against the arena and the next block, but a pointer into a payload can still pass
+static TlsfBlock* used_block(TlsfAllocator* a, void* ptr) {
+    char* end = a->memory_start + a->memory_size - TLSF_HEADER_SIZE;
+    if (!ptr || (char*)ptr < payload((TlsfBlock*)a->memory_start) || (char*)ptr >= end ||
+        ((uintptr_t)ptr & (TLSF_ALIGNMENT - 1)) != 0) {
+        return NULL;
+    }
+    TlsfBlock* b = block_of(ptr);
+    size_t size = block_size(b);
+    if (is_free(b) || size < TLSF_MIN_BLOCK || size > (size_t)(end - (char*)b) ||
+        next_block(b)->prev_units != size / TLSF_ALIGNMENT) {
+        return NULL;
+    }
+    return b;
+}
+
+void* TlsfAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    size_t memory_size = va_arg(args, size_t);
+    va_end(args);
+    memory_size &= ~(size_t)(TLSF_ALIGNMENT - 1);
+    if (!alloc || memory_size < TLSF_MIN_BLOCK + TLSF_HEADER_SIZE || memory_size > TLSF_MAX_MEMORY) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid allocator or memory size (%zu)\n" RESET, memory_size);
+        #endif
+        return NULL;
+    }
+
+    a->memory_size = memory_size;
+    a->mapping_size = (memory_size + PAGESIZE - 1) / PAGESIZE * PAGESIZE;
+    a->memory_start = map_arena(a->mapping_size, ARENA_PAGES_BASE, &a->backing);
+    if (!a->memory_start) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to map %zu bytes\n" RESET, a->mapping_size);
+        #endif
+        return NULL;
+    }
+    a->fl_bitmap = 0;
+    memset(a->sl_bitmap, 0, sizeof(a->sl_bitmap));
+    memset(a->free_lists, 0, sizeof(a->free_lists));
+
+    // One free block, then a used sentinel of size 0 closing the arena
+    TlsfBlock* first = (TlsfBlock*)a->memory_start;
+    TlsfBlock* sentinel = (TlsfBlock*)(a->memory_start + memory_size - TLSF_HEADER_SIZE);
+    sentinel->size = 0;
+    first->size = 0;
+    first->prev_units = 0;
+    set_block(first, memory_size - TLSF_HEADER_SIZE, true);
+    insert_free(a, first);
+    a->high_water = a->memory_start + TLSF_MIN_BLOCK;
+
+    ((VariableBlockAllocator*)a)->internal_fragmentation = 0;
+    ((VariableBlockAllocator*)a)->sparse_free_memory = memory_size - TLSF_HEADER_SIZE;
+
+    alloc->init = TlsfAllocator_init;
+    alloc->dest = TlsfAllocator_cleanup;
+    alloc->malloc = TlsfAllocator_reserve;
+    alloc->free = TlsfAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = TlsfAllocator_reallocate;
+    alloc->usable_size = TlsfAllocator_block_usable_size;
+    alloc->memalign = TlsfAllocator_reserve_aligned;
+    alloc->calloc = TlsfAllocator_callocate;
+    return a;
+}
+
+void* TlsfAllocator_cleanup(Allocator* alloc, ...) {
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    if (!a || !a->memory_start) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or memory in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    int result = unmap_arena(a->memory_start, a->mapping_size, a->backing);
+    a->memory_start = NULL;
+    return (void*)(intptr_t)(result == 0 ? 0 : -1);
+}
+
+void* TlsfAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size in reserve!\n" RESET);
+        #endif
+        return NULL;
+    }
+    return reserve(a, size);
+}
+
+void* TlsfAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    TlsfBlock* b = a ? used_block(a, ptr) : NULL;
+    if (!b) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator, invalid pointer or double free in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    VariableBlockAllocator* base = (VariableBlockAllocator*)a;
+    size_t size = block_size(b);
+    base->internal_fragmentation -= b->slack;
+    base->sparse_free_memory += size;
+    b->size |= TLSF_BLOCK_FREE; // Stays on the tag if b is merged into the previous block: a second free fails
+
+    // Boundary tags: merge with the free neighbours
+    if (b->size & TLSF_PREV_FREE) {
+        TlsfBlock* prev = prev_block(b);
+        remove_free(a, prev);
+        size += block_size(prev);
+        b = prev;
+    }
+    TlsfBlock* next = (TlsfBlock*)((char*)b + size);
+    if (is_free(next)) {
+        remove_free(a, next);
+        size += block_size(next);
+    }
+    set_block(b, size, true);
+    insert_free(a, b);
+    return (void*)0;
+}
+
+// Shrinks in place, grows in place over a free next block, otherwise moves
+void* TlsfAllocator_reallocate(Allocator* alloc, void* ptr, size_t size) {
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    if (!a) return NULL;
+    if (!ptr) return size ? reserve(a, size) : NULL;
+    if (size == 0) {
+        TlsfAllocator_release(alloc, ptr);
+        return NULL;
+    }
+    TlsfBlock* b = used_block(a, ptr);
+    size_t needed = adjust_size(a, size);
+    if (!b || !needed) return NULL;
+
+    VariableBlockAllocator* base = (VariableBlockAllocator*)a;
+    size_t total = block_size(b);
+    TlsfBlock* next = next_block(b);
+    if (needed > total && is_free(next) && total + block_size(next) >= needed) {
+        remove_free(a, next);
+        base->sparse_free_memory -= block_size(next);
+        total += block_size(next);
+        set_block(b, total, false);
+    }
+    if (needed <= total) {
+        base->internal_fragmentation -= b->slack;
+        trim(a, b, needed);
+        b->slack = (uint32_t)(block_size(b) - size);
+        base->internal_fragmentation += b->slack;
+        mark_written(a, (char*)next_block(b));
+        return ptr;
+    }
+
+    void* result = reserve(a, size);
+    if (!result) return NULL;
+    memcpy(result, ptr, total - TLSF_HEADER_SIZE);
+    TlsfAllocator_release(alloc, ptr);
+    return result;
+}
+
+size_t TlsfAllocator_block_usable_size(Allocator* alloc, void* ptr) {
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    TlsfBlock* b = a ? used_block(a, ptr) : NULL;
+    return b ? block_size(b) - TLSF_HEADER_SIZE : 0;
+}
+
+// A block with room for the alignment: the part before the aligned payload goes back as a free block
+void* TlsfAllocator_reserve_aligned(Allocator* alloc, size_t alignment, size_t size) {
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    if (!a || size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment <= TLSF_ALIGNMENT) return reserve(a, size);
+    size_t needed = adjust_size(a, size);
+    if (!needed || alignment > a->memory_size) return NULL;
+    TlsfBlock* b = find_block(a, needed + alignment + TLSF_MIN_BLOCK);
+    if (!b) return NULL;
+    remove_free(a, b);
+
+    uintptr_t aligned = ((uintptr_t)payload(b) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (aligned != (uintptr_t)payload(b) && aligned - (uintptr_t)payload(b) < TLSF_MIN_BLOCK) {
+        aligned = ((uintptr_t)payload(b) + TLSF_MIN_BLOCK + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    size_t gap = aligned - (uintptr_t)payload(b);
+    if (gap) {
+        // b is free and its previous block is not: the gap stays a block of its own
+        TlsfBlock* rest = (TlsfBlock*)((char*)b + gap);
+        size_t rest_size = block_size(b) - gap;
+        b->size = gap | (b->size & FLAGS);
+        rest->size = TLSF_PREV_FREE;
+        rest->prev_units = (uint32_t)(gap / TLSF_ALIGNMENT);
+        set_block(rest, rest_size, true);
+        insert_free(a, b);
+        b = rest;
+    }
+    return use_block(a, b, needed, size);
+}
+
+// The arena comes zeroed from mmap: only the part of the block below the high water mark is cleared
+void* TlsfAllocator_callocate(Allocator* alloc, size_t nmemb, size_t size) {
+    TlsfAllocator* a = (TlsfAllocator*)alloc;
+    size_t total;
+    if (!a || __builtin_mul_overflow(nmemb, size, &total) || total == 0) return NULL;
+    char* high_water = a->high_water; // Before the block is carved out
+    char* ptr = reserve(a, total);
+    if (ptr && high_water > ptr) memset(ptr, 0, (size_t)(high_water - ptr) < total ? (size_t)(high_water - ptr) : total);
+    return ptr;
+}
+
+int TlsfAllocator_print_state(TlsfAllocator* a) {
+    if (!a) return -1;
+    printf("TLSF Allocator state:\n");
+    printf("\tMemory size: %zu bytes (%s pages)\n", a->memory_size, arena_backing_name(a->backing));
+    printf("\tInternal fragmentation: %zu bytes\n", ((VariableBlockAllocator*)a)->internal_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator*)a)->sparse_free_memory);
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        if (!(a->fl_bitmap & (1u << fl))) continue;
+        printf("\tFirst level %d:", fl);
+        for (int sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            uint n = 0;
+            for (TlsfBlock* b = a->free_lists[fl][sl]; b; b = b->next_free) n++;
+            if (n) printf(" [%d] %u", sl, n);
+        }
+        printf("\n");
+    }
+    return 0;
+}
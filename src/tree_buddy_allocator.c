@@ -0,0 +1,218 @@
+#include <tree_buddy_allocator.h>
+
+extern inline TreeBuddyAllocator* TreeBuddyAllocator_create(TreeBuddyAllocator* a, size_t memory_size, int num_levels);
+extern inline int TreeBuddyAllocator_destroy(TreeBuddyAllocator* a);
+extern inline void* TreeBuddyAllocator_malloc(TreeBuddyAllocator* a, size_t size);
+extern inline int TreeBuddyAllocator_free(TreeBuddyAllocator* a, void* ptr);
+
+// Node idx of order k sits at level num_levels - k
+static inline char* block_start(TreeBuddyAllocator* a, size_t idx, uint order) {
+    size_t level = a->num_levels - order;
+    size_t first = ((size_t)1 << level) - 1;
+    return a->memory_start + (idx - first) * (a->min_block_size << order);
+}
+
+// Recompute the ancestors of idx (of order 'order'), stops as soon as a value does not change
+static inline void update_ancestors(TreeBuddyAllocator* a, size_t idx, uint order) {
+    while (idx > 0) {
+        idx = (idx - 1) / 2;
+        order++;
+        uint8_t left = a->longest[2 * idx + 1];
+        uint8_t right = a->longest[2 * idx + 2];
+        // Two whole free children merge into a whole free parent
+        uint8_t value = (left == order && right == order) ? order + 1 : (left > right ? left : right);
+        if (a->longest[idx] == value) return;
+        a->longest[idx] = value;
+    }
+}
+
+void* TreeBuddyAllocator_init(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    TreeBuddyAllocator* a = (TreeBuddyAllocator*)alloc;
+    size_t memory_size = va_arg(args, size_t);
+    int num_levels = va_arg(args, int);
+    va_end(args);
+    if (!alloc || memory_size <= TREE_BUDDY_METADATA_SIZE || num_levels <= 0 ||
+        num_levels >= TREE_BUDDY_MAX_LEVELS) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Invalid allocator or invalid number of levels (%d)\n" RESET, num_levels);
+        #endif
+        return NULL;
+    }
+
+    // Minimum blocks must hold the header and at least one byte
+    size_t min_block_size = memory_size >> num_levels;
+    while (min_block_size < (TREE_BUDDY_METADATA_SIZE + 1) && num_levels > 0) {
+        num_levels--;
+        min_block_size = memory_size >> num_levels;
+    }
+    a->num_levels = num_levels;
+    a->min_block_size = min_block_size;
+    a->memory_size = memory_size;
+    a->num_nodes = ((size_t)1 << (num_levels + 1)) - 1;
+
+    // Tree after the arena, blocks keep the page alignment
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t arena_size = (memory_size + page_size - 1) & ~(page_size - 1);
+    a->mapping_size = (arena_size + a->num_nodes + page_size - 1) & ~(page_size - 1);
+    char* mapping = mmap(NULL, a->mapping_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to allocate memory in init!\n" RESET);
+        #endif
+        return NULL;
+    }
+    a->memory_start = mapping;
+    a->longest = (uint8_t*)(mapping + arena_size);
+
+    // Everything is free: each node holds its own order + 1
+    for (uint level = 0; level <= a->num_levels; level++) {
+        memset(a->longest + ((size_t)1 << level) - 1, a->num_levels - level + 1, (size_t)1 << level);
+    }
+
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation = 0;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory = min_block_size << num_levels;
+
+    alloc->init = TreeBuddyAllocator_init;
+    alloc->dest = TreeBuddyAllocator_cleanup;
+    alloc->malloc = TreeBuddyAllocator_reserve;
+    alloc->free = TreeBuddyAllocator_release;
+    alloc->malloc_batch = NULL;
+    alloc->free_batch = NULL;
+    alloc->realloc = NULL;
+    alloc->usable_size = NULL;
+    alloc->memalign = NULL;
+    alloc->calloc = NULL;
+    return a;
+}
+
+void* TreeBuddyAllocator_cleanup(Allocator* alloc, ...) {
+    TreeBuddyAllocator* a = (TreeBuddyAllocator*)alloc;
+    if (!a || !a->memory_start) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or memory in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    if (munmap(a->memory_start, a->mapping_size) != 0) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Failed to unmap memory in destructor\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    a->memory_start = NULL;
+    return (void*)0;
+}
+
+void* TreeBuddyAllocator_reserve(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    TreeBuddyAllocator* a = (TreeBuddyAllocator*)alloc;
+    size_t size = va_arg(args, size_t);
+    va_end(args);
+    if (!a || size == 0 || size > (size_t)INT32_MAX) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or invalid size (%zu) in reserve!\n" RESET, size);
+        #endif
+        return NULL;
+    }
+
+    // Smallest order holding size bytes plus the header: ceil(log2(minimum blocks needed))
+    size_t units = (size + TREE_BUDDY_METADATA_SIZE - 1) / a->min_block_size;
+    uint order = units ? 64 - __builtin_clzll(units) : 0;
+    if (order > a->num_levels || a->longest[0] <= order) {
+        #ifdef DEBUG
+        printf(RED "ERROR: No free block of order %u\n" RESET, order);
+        #endif
+        return NULL;
+    }
+
+    // Walk down to a node of the right order, taking the child that fits more tightly
+    size_t idx = 0;
+    for (uint current = a->num_levels; current > order; current--) {
+        size_t left = 2 * idx + 1;
+        uint8_t l = a->longest[left];
+        uint8_t r = a->longest[left + 1];
+        idx = (l > order && (r <= order || l <= r)) ? left : left + 1;
+    }
+    a->longest[idx] = 0;
+    update_ancestors(a, idx, order);
+
+    char* block = block_start(a, idx, order);
+    TreeBuddyMetadata* meta = (TreeBuddyMetadata*)block;
+    meta->node_idx = (int)idx;
+    meta->size = (int)size;
+
+    size_t block_size = a->min_block_size << order;
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation += block_size - size;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory -= block_size;
+    return block + TREE_BUDDY_METADATA_SIZE;
+}
+
+void* TreeBuddyAllocator_release(Allocator* alloc, ...) {
+    va_list args;
+    va_start(args, alloc);
+    TreeBuddyAllocator* a = (TreeBuddyAllocator*)alloc;
+    void* ptr = va_arg(args, void*);
+    va_end(args);
+    if (!a || !ptr) {
+        #ifdef DEBUG
+        printf(RED "ERROR: NULL allocator or pointer in release\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    if ((char*)ptr < a->memory_start + TREE_BUDDY_METADATA_SIZE ||
+        (char*)ptr >= a->memory_start + a->memory_size) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Pointer outside managed memory!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+
+    // The header names the node, which must be allocated and start right before ptr
+    TreeBuddyMetadata* meta = (TreeBuddyMetadata*)((char*)ptr - TREE_BUDDY_METADATA_SIZE);
+    int node_idx = meta->node_idx;
+    if (node_idx < 0 || (size_t)node_idx >= a->num_nodes) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Double free or invalid pointer!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+    size_t idx = (size_t)node_idx;
+    uint order = a->num_levels - (63 - __builtin_clzll(idx + 1));
+    if (a->longest[idx] != 0 || block_start(a, idx, order) != (char*)meta) {
+        #ifdef DEBUG
+        printf(RED "ERROR: Double free or invalid pointer!\n" RESET);
+        #endif
+        return (void*)-1;
+    }
+
+    size_t block_size = a->min_block_size << order;
+    ((VariableBlockAllocator *) alloc)->internal_fragmentation -= block_size - meta->size;
+    ((VariableBlockAllocator *) alloc)->sparse_free_memory += block_size;
+    meta->node_idx = -1;
+    meta->size = -1;
+
+    // The descendants still hold their free values from before the reserve
+    a->longest[idx] = order + 1;
+    update_ancestors(a, idx, order);
+    return (void*)0;
+}
+
+int TreeBuddyAllocator_print_state(TreeBuddyAllocator* a) {
+    printf("Tree Buddy Allocator state:\n");
+    printf("\tMemory size: %zu bytes\n", a->memory_size);
+    printf("\tNumber of levels: %u\n", a->num_levels);
+    printf("\tMin block size: %zu bytes\n", a->min_block_size);
+    printf("\tTree: %zu bytes\n", a->num_nodes);
+    printf("\tInternal fragmentation: %zu bytes\n", ((VariableBlockAllocator *) a)->internal_fragmentation);
+    printf("\tFree memory: %zu bytes\n", ((VariableBlockAllocator *) a)->sparse_free_memory);
+    if (a->longest[0] == 0) {
+        printf("\tLargest free block: none\n");
+    } else {
+        printf("\tLargest free block: %zu bytes\n", a->min_block_size << (a->longest[0] - 1));
+    }
+    return 0;
+}